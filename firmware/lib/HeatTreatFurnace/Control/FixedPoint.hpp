@@ -0,0 +1,92 @@
+#ifndef HEAT_TREAT_FURNACE_FIXED_POINT_HPP
+#define HEAT_TREAT_FURNACE_FIXED_POINT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace HeatTreatFurnace::Control
+{
+    /**
+     * @brief Signed Q15.16 fixed point, for control code on cores without an FPU.
+     *
+     * Range is ±32767 with a resolution of 1/65536. Arithmetic saturates instead of wrapping,
+     * so an out of range intermediate clamps the output rather than flipping its sign.
+     */
+    class Fixed16
+    {
+    public:
+        static constexpr int FRACTION_BITS = 16;
+        static constexpr int32_t ONE = int32_t{1} << FRACTION_BITS;
+
+        constexpr Fixed16() = default;
+
+        static constexpr Fixed16 FromRaw(int32_t aRaw)
+        {
+            Fixed16 value;
+            value.myRaw = aRaw;
+            return value;
+        }
+
+        static constexpr Fixed16 FromFloat(float aValue)
+        {
+            return FromRaw(PrivSaturate(static_cast<int64_t>(aValue * static_cast<float>(ONE) + (aValue < 0.0f ? -0.5f : 0.5f))));
+        }
+
+        [[nodiscard]] constexpr float ToFloat() const
+        {
+            return static_cast<float>(myRaw) / static_cast<float>(ONE);
+        }
+
+        [[nodiscard]] constexpr int32_t Raw() const
+        {
+            return myRaw;
+        }
+
+        friend constexpr Fixed16 operator+(Fixed16 aLeft, Fixed16 aRight)
+        {
+            return FromRaw(PrivSaturate(int64_t{aLeft.myRaw} + aRight.myRaw));
+        }
+
+        friend constexpr Fixed16 operator-(Fixed16 aLeft, Fixed16 aRight)
+        {
+            return FromRaw(PrivSaturate(int64_t{aLeft.myRaw} - aRight.myRaw));
+        }
+
+        friend constexpr Fixed16 operator*(Fixed16 aLeft, Fixed16 aRight)
+        {
+            return FromRaw(PrivSaturate((int64_t{aLeft.myRaw} * aRight.myRaw) >> FRACTION_BITS));
+        }
+
+        friend constexpr Fixed16 operator/(Fixed16 aLeft, Fixed16 aRight)
+        {
+            if (aRight.myRaw == 0)
+            {
+                return FromRaw(aLeft.myRaw < 0 ? std::numeric_limits<int32_t>::min() : std::numeric_limits<int32_t>::max());
+            }
+            return FromRaw(PrivSaturate((int64_t{aLeft.myRaw} << FRACTION_BITS) / aRight.myRaw));
+        }
+
+        constexpr Fixed16& operator+=(Fixed16 aOther)
+        {
+            return *this = *this + aOther;
+        }
+
+        constexpr Fixed16& operator-=(Fixed16 aOther)
+        {
+            return *this = *this - aOther;
+        }
+
+        friend constexpr auto operator<=>(Fixed16 aLeft, Fixed16 aRight) = default;
+
+    private:
+        static constexpr int32_t PrivSaturate(int64_t aValue)
+        {
+            return static_cast<int32_t>(std::clamp<int64_t>(aValue, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+        }
+
+        int32_t myRaw = 0;
+    };
+} //namespace HeatTreatFurnace::Control
+
+#endif //HEAT_TREAT_FURNACE_FIXED_POINT_HPP
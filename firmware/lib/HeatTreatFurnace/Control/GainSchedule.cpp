@@ -0,0 +1,139 @@
+#include "GainSchedule.hpp"
+
+#include <charconv>
+
+namespace HeatTreatFurnace::Control
+{
+    namespace
+    {
+        bool ReadNumber(std::string_view& aText, float& aOut)
+        {
+            while (!aText.empty() && aText.front() == ' ')
+            {
+                aText.remove_prefix(1);
+            }
+            auto [ptr, ec] = std::from_chars(aText.data(), aText.data() + aText.size(), aOut);
+            if (ec != std::errc())
+            {
+                return false;
+            }
+            aText.remove_prefix(static_cast<size_t>(ptr - aText.data()));
+            while (!aText.empty() && aText.front() == ' ')
+            {
+                aText.remove_prefix(1);
+            }
+            return true;
+        }
+
+        bool Consume(std::string_view& aText, char aExpected)
+        {
+            if (aText.empty() || aText.front() != aExpected)
+            {
+                return false;
+            }
+            aText.remove_prefix(1);
+            return true;
+        }
+    }
+
+    Furnace::Result GainSchedule::Configure(const Furnace::PidSchedule& aSchedule, const PidGains& aDefault)
+    {
+        for (size_t i = 0; i < aSchedule.size(); ++i)
+        {
+            const Furnace::PidBreakpoint& point = aSchedule[i];
+            if (point.kp < 0.0f || point.ki < 0.0f || point.kd < 0.0f)
+            {
+                return {false, "PID_Schedule gains can't be negative"};
+            }
+            if (i > 0 && point.temperature <= aSchedule[i - 1].temperature)
+            {
+                return {false, "PID_Schedule temperatures must increase"};
+            }
+        }
+
+        myBands.clear();
+        myBand = 0;
+        if (aSchedule.empty())
+        {
+            myBands.push_back({0.0f, aDefault, {}});
+            return {true, ""};
+        }
+
+        for (size_t i = 0; i < aSchedule.size(); ++i)
+        {
+            const Furnace::PidBreakpoint& point = aSchedule[i];
+            ScheduleBand band{point.temperature, {point.kp, point.ki, point.kd}, {}};
+            if (i + 1 < aSchedule.size())
+            {
+                const Furnace::PidBreakpoint& next = aSchedule[i + 1];
+                const float width = next.temperature - point.temperature;
+                band.slope = {(next.kp - point.kp) / width, (next.ki - point.ki) / width, (next.kd - point.kd) / width};
+            }
+            myBands.push_back(band);
+        }
+        return {true, ""};
+    }
+
+    PidGains GainSchedule::GainsAt(float aTemperature)
+    {
+        while (myBand + 1 < myBands.size() && aTemperature >= myBands[myBand + 1].temperature)
+        {
+            ++myBand;
+        }
+        while (myBand > 0 && aTemperature < myBands[myBand].temperature)
+        {
+            --myBand;
+        }
+
+        const ScheduleBand& band = myBands[myBand];
+        // Held at the first breakpoint's gains below it; the last band's slope is 0
+        const float offset = aTemperature > band.temperature ? aTemperature - band.temperature : 0.0f;
+        return {
+            band.gains.kp + band.slope.kp * offset,
+            band.gains.ki + band.slope.ki * offset,
+            band.gains.kd + band.slope.kd * offset
+        };
+    }
+
+    size_t GainSchedule::Band() const
+    {
+        return myBand;
+    }
+
+    size_t GainSchedule::BandCount() const
+    {
+        return myBands.size();
+    }
+
+    Furnace::Result GainSchedule::Parse(std::string_view aText, Furnace::PidSchedule& aOut)
+    {
+        aOut.clear();
+        while (!aText.empty() && aText.front() == ' ')
+        {
+            aText.remove_prefix(1);
+        }
+        while (!aText.empty())
+        {
+            if (aOut.full())
+            {
+                return {false, "PID_Schedule has more than 8 breakpoints"};
+            }
+
+            Furnace::PidBreakpoint point;
+            if (!ReadNumber(aText, point.temperature) || !Consume(aText, ':')
+                || !ReadNumber(aText, point.kp) || !Consume(aText, ':')
+                || !ReadNumber(aText, point.ki) || !Consume(aText, ':')
+                || !ReadNumber(aText, point.kd))
+            {
+                return {false, "PID_Schedule breakpoints are °C:Kp:Ki:Kd"};
+            }
+            aOut.push_back(point);
+
+            if (!aText.empty() && !Consume(aText, ','))
+            {
+                return {false, "PID_Schedule breakpoints are separated by commas"};
+            }
+        }
+        return {true, ""};
+    }
+} //namespace HeatTreatFurnace::Control
@@ -0,0 +1,150 @@
+#ifndef HEAT_TREAT_FURNACE_GAIN_SCHEDULE_HPP
+#define HEAT_TREAT_FURNACE_GAIN_SCHEDULE_HPP
+
+#include <string_view>
+
+#include "etl/vector.h"
+#include "Pid.hpp"
+#include "Furnace/Preferences.hpp"
+#include "Furnace/Result.hpp"
+
+namespace HeatTreatFurnace::Control
+{
+    struct PidGains
+    {
+        float kp = 0.0f;
+        float ki = 0.0f;
+        float kd = 0.0f;
+    };
+
+    /**
+     * @brief PID gains by temperature from the PID_Schedule breakpoints (SPECIFICATION.md §3.8).
+     *
+     * Gains are interpolated linearly between breakpoints and held at the first and last outside them.
+     * Each band stores its gains' slopes, worked out in Configure(), and the band the last lookup landed
+     * in is kept: the kiln moves a fraction of a degree between samples, so GainsAt() almost always
+     * starts in the right band and at most steps to its neighbour.
+     */
+    class GainSchedule
+    {
+    public:
+        /** @brief Checks aSchedule is sorted with no negative gains; an empty one gives aDefault everywhere */
+        Furnace::Result Configure(const Furnace::PidSchedule& aSchedule, const PidGains& aDefault);
+
+        /** @brief Interpolated gains at aTemperature */
+        [[nodiscard]] PidGains GainsAt(float aTemperature);
+
+        /** @brief Index of the band GainsAt() last used; band i starts at breakpoint i */
+        [[nodiscard]] size_t Band() const;
+
+        [[nodiscard]] size_t BandCount() const;
+
+        /** @brief PID_Schedule text, "°C:Kp:Ki:Kd" breakpoints separated by commas; empty gives an empty schedule */
+        static Furnace::Result Parse(std::string_view aText, Furnace::PidSchedule& aOut);
+
+    private:
+        struct ScheduleBand
+        {
+            float temperature;
+            PidGains gains;
+            PidGains slope; // per °C, to the next breakpoint
+        };
+
+        etl::vector<ScheduleBand, Furnace::MAX_PID_BREAKPOINTS> myBands;
+        size_t myBand = 0;
+    };
+
+    /**
+     * @brief Pid whose gains follow a GainSchedule.
+     *
+     * The gains are scheduled on the setpoint rather than the measurement: it follows the kiln closely
+     * enough, and doesn't carry thermocouple noise into the gains. Changing gains goes through
+     * Pid::SetGains(), so neither crossing a breakpoint nor the interpolation in between bumps the output.
+     */
+    template <typename T>
+    class GainScheduledPid
+    {
+    public:
+        explicit GainScheduledPid(const PidConfig& aConfig = {}) :
+            myPid(aConfig)
+        {
+            Configure(aConfig, {});
+        }
+
+        /** @brief Gains from aSchedule, or from aConfig if it's empty or invalid; the rest of aConfig as Pid */
+        Furnace::Result Configure(const PidConfig& aConfig, const Furnace::PidSchedule& aSchedule)
+        {
+            const PidGains fixed{aConfig.kp, aConfig.ki, aConfig.kd};
+            Furnace::Result result = mySchedule.Configure(aSchedule, fixed);
+            if (!result)
+            {
+                mySchedule.Configure({}, fixed);
+            }
+
+            // Keep the gains in use, so the next Update() moves to the new ones without a bump
+            PidConfig config = aConfig;
+            if (myHasGains)
+            {
+                config.kp = myGains.kp;
+                config.ki = myGains.ki;
+                config.kd = myGains.kd;
+            }
+            myPid.Configure(config);
+            return result;
+        }
+
+        /** @brief Pid::Update() with the gains for aSetpoint */
+        T Update(float aSetpoint, float aMeasured, float aFeedforward = 0.0f)
+        {
+            const PidGains gains = mySchedule.GainsAt(aSetpoint);
+            if (!myHasGains || gains.kp != myGains.kp || gains.ki != myGains.ki || gains.kd != myGains.kd)
+            {
+                myPid.SetGains(FromFloat<T>(gains.kp), FromFloat<T>(gains.ki), FromFloat<T>(gains.kd));
+                myGains = gains;
+                myHasGains = true;
+            }
+            return myPid.Update(FromFloat<T>(aSetpoint), FromFloat<T>(aMeasured), FromFloat<T>(aFeedforward));
+        }
+
+        void Reset()
+        {
+            myPid.Reset();
+        }
+
+        [[nodiscard]] T Integral() const
+        {
+            return myPid.Integral();
+        }
+
+        [[nodiscard]] T Output() const
+        {
+            return myPid.Output();
+        }
+
+        [[nodiscard]] const PidGains& Gains() const
+        {
+            return myGains;
+        }
+
+        [[nodiscard]] const GainSchedule& Schedule() const
+        {
+            return mySchedule;
+        }
+
+        [[nodiscard]] const Pid<T>& GetPid() const
+        {
+            return myPid;
+        }
+
+    private:
+        Pid<T> myPid;
+        GainSchedule mySchedule;
+        PidGains myGains;
+        bool myHasGains = false;
+    };
+
+    using FloatGainScheduledPid = GainScheduledPid<float>;
+    using FixedGainScheduledPid = GainScheduledPid<Fixed16>;
+} //namespace HeatTreatFurnace::Control
+
+#endif //HEAT_TREAT_FURNACE_GAIN_SCHEDULE_HPP
@@ -0,0 +1,140 @@
+#include "LoopScheduler.hpp"
+
+#include <algorithm>
+
+namespace HeatTreatFurnace::Control
+{
+    LoopScheduler::LoopScheduler(Time::Clock& aClock, Log::LogService& aLog) :
+        Loggable(aLog), myClock(aClock)
+    {
+    }
+
+    Furnace::Result LoopScheduler::AddStage(etl::string_view aName, std::chrono::microseconds aPeriod, std::chrono::microseconds aDeadline, StageFunction aFunction, bool aIsSafety)
+    {
+        if (myStages.full())
+        {
+            return {false, "Too many loop stages"};
+        }
+        if (aPeriod.count() <= 0 || aDeadline.count() <= 0 || !aFunction.is_valid())
+        {
+            return {false, "Loop stage needs a period, a deadline and a function"};
+        }
+
+        Stage stage{aPeriod, aDeadline, std::chrono::microseconds(0), aFunction, aIsSafety, {}};
+        stage.stats.name = aName;
+
+        // Stable for equal periods, so stages added first run first
+        auto position = std::upper_bound(myStages.begin(), myStages.end(), aPeriod, [](std::chrono::microseconds aValue, const Stage& aStage) { return aValue < aStage.period; });
+        myStages.insert(position, stage);
+        return {true, ""};
+    }
+
+    void LoopScheduler::SetSafetyMissHandler(SafetyMissHandler aHandler)
+    {
+        mySafetyMissHandler = aHandler;
+    }
+
+    void LoopScheduler::Start()
+    {
+        const std::chrono::microseconds now = myClock.Now();
+        for (Stage& stage : myStages)
+        {
+            stage.nextRelease = now;
+        }
+    }
+
+    std::chrono::microseconds LoopScheduler::Tick()
+    {
+        for (Stage& stage : myStages)
+        {
+            const std::chrono::microseconds now = myClock.Now();
+            if (now >= stage.nextRelease)
+            {
+                PrivRun(stage, now);
+            }
+        }
+
+        std::chrono::microseconds next = std::chrono::microseconds::max();
+        for (const Stage& stage : myStages)
+        {
+            next = std::min(next, stage.nextRelease);
+        }
+        return next;
+    }
+
+    void LoopScheduler::RunUntil(std::chrono::microseconds aEnd)
+    {
+        while (myClock.Now() < aEnd)
+        {
+            myClock.SleepUntil(std::min(Tick(), aEnd));
+        }
+    }
+
+    size_t LoopScheduler::StageCount() const
+    {
+        return myStages.size();
+    }
+
+    const LoopStageStats& LoopScheduler::GetStats(size_t aStage) const
+    {
+        return myStages[aStage].stats;
+    }
+
+    void LoopScheduler::ResetStats()
+    {
+        for (Stage& stage : myStages)
+        {
+            etl::string_view name = stage.stats.name;
+            stage.stats = {};
+            stage.stats.name = name;
+        }
+    }
+
+    void LoopScheduler::PrivRun(Stage& aStage, std::chrono::microseconds aNow)
+    {
+        const std::chrono::microseconds release = aStage.nextRelease;
+        const std::chrono::microseconds jitter = aNow - release;
+
+        aStage.function();
+        const std::chrono::microseconds finished = myClock.Now();
+
+        LoopStageStats& stats = aStage.stats;
+        stats.jitter.Record(jitter);
+        stats.execution.Record(finished - aNow);
+        ++stats.jitterHistogram[PrivJitterBucket(jitter)];
+
+        // Next release is the first one still in the future; any passed over were never run
+        aStage.nextRelease = release + aStage.period;
+        if (aStage.nextRelease <= finished)
+        {
+            const int64_t behind = (finished - aStage.nextRelease) / aStage.period + 1;
+            stats.skippedReleases += static_cast<uint32_t>(behind);
+            aStage.nextRelease += behind * aStage.period;
+        }
+
+        if (finished > release + aStage.deadline)
+        {
+            ++stats.deadlineMisses;
+            if (aStage.isSafety)
+            {
+                Log(Log::LogLevel::Error, "Safety stage {} missed its deadline by {}us", std::string_view(stats.name.data(), stats.name.size()), (finished - release - aStage.deadline).count());
+                if (mySafetyMissHandler.is_valid())
+                {
+                    mySafetyMissHandler(stats.name);
+                }
+            }
+        }
+    }
+
+    size_t LoopScheduler::PrivJitterBucket(std::chrono::microseconds aJitter)
+    {
+        size_t bucket = 0;
+        std::chrono::microseconds limit = FIRST_JITTER_BUCKET;
+        while (bucket < JITTER_BUCKETS - 1 && aJitter >= limit)
+        {
+            ++bucket;
+            limit *= 2;
+        }
+        return bucket;
+    }
+} //namespace HeatTreatFurnace::Control
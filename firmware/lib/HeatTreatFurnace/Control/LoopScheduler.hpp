@@ -0,0 +1,123 @@
+#ifndef HEAT_TREAT_FURNACE_LOOP_SCHEDULER_HPP
+#define HEAT_TREAT_FURNACE_LOOP_SCHEDULER_HPP
+
+#include <chrono>
+#include <cstdint>
+
+#include "etl/array.h"
+#include "etl/delegate.h"
+#include "etl/string_view.h"
+#include "etl/vector.h"
+#include "Furnace/Result.hpp"
+#include "Log/LogService.hpp"
+#include "Time/Clock.hpp"
+
+namespace HeatTreatFurnace::Control
+{
+    /** @brief min/avg/max of a duration, without keeping samples */
+    struct TimingStats
+    {
+        std::chrono::microseconds min = std::chrono::microseconds::max();
+        std::chrono::microseconds max{0};
+        std::chrono::microseconds total{0};
+        uint32_t count = 0;
+
+        void Record(std::chrono::microseconds aSample)
+        {
+            min = std::min(min, aSample);
+            max = std::max(max, aSample);
+            total += aSample;
+            ++count;
+        }
+
+        [[nodiscard]] std::chrono::microseconds Average() const
+        {
+            return count == 0 ? std::chrono::microseconds(0) : total / count;
+        }
+    };
+
+    /** @brief Release jitter histogram: bucket i counts jitter below FIRST_BUCKET << i, the last bucket everything above */
+    constexpr size_t JITTER_BUCKETS = 12;
+    constexpr std::chrono::microseconds FIRST_JITTER_BUCKET{100};
+
+    struct LoopStageStats
+    {
+        etl::string_view name;
+        TimingStats jitter; // how late each run started after its release time
+        TimingStats execution;
+        etl::array<uint32_t, JITTER_BUCKETS> jitterHistogram{};
+        uint32_t deadlineMisses = 0;
+        uint32_t skippedReleases = 0; // releases dropped because the stage fell a whole period behind
+    };
+
+    /**
+     * @brief Runs the furnace stages (sensor read, PID, SSR output, safety, history) at fixed rates.
+     *
+     * Cooperative and single threaded: each Tick() runs every stage that is due, shortest period first
+     * (rate monotonic priority), then the caller sleeps until the next release. Releases are fixed
+     * multiples of each stage's period from Start(), so a slow run delays a stage but doesn't make it
+     * drift. A stage finishing after its release + deadline is a deadline miss; misses on safety stages
+     * are reported to the safety miss handler, which the furnace binds to StateMachine::OnSafetyDeadlineMissed.
+     */
+    class LoopScheduler : public Log::Loggable
+    {
+    public:
+        static constexpr size_t MAX_STAGES = 8;
+
+        using StageFunction = etl::delegate<void()>;
+        using SafetyMissHandler = etl::delegate<void(etl::string_view aStage)>;
+
+        LoopScheduler(Time::Clock& aClock, Log::LogService& aLog);
+        ~LoopScheduler() override = default;
+
+        /**
+         * @param aName Must outlive the scheduler, a string literal in practice
+         * @param aDeadline Time after each release the stage must have finished by, usually its period
+         * @param aFunction Bound object must outlive the scheduler
+         */
+        Furnace::Result AddStage(etl::string_view aName, std::chrono::microseconds aPeriod, std::chrono::microseconds aDeadline, StageFunction aFunction, bool aIsSafety = false);
+
+        void SetSafetyMissHandler(SafetyMissHandler aHandler);
+
+        /** @brief First release of every stage is now */
+        void Start();
+
+        /** @brief Run every stage that is due; returns when the next stage is released */
+        std::chrono::microseconds Tick();
+
+        /** @brief Tick and sleep on the clock until aEnd */
+        void RunUntil(std::chrono::microseconds aEnd);
+
+        [[nodiscard]] size_t StageCount() const;
+        [[nodiscard]] const LoopStageStats& GetStats(size_t aStage) const;
+        void ResetStats();
+
+    protected:
+        [[nodiscard]] const etl::string_view& GetLogDomain() override
+        {
+            return myDomain;
+        };
+
+    private:
+        struct Stage
+        {
+            std::chrono::microseconds period;
+            std::chrono::microseconds deadline;
+            std::chrono::microseconds nextRelease;
+            StageFunction function;
+            bool isSafety;
+            LoopStageStats stats;
+        };
+
+        void PrivRun(Stage& aStage, std::chrono::microseconds aNow);
+        static size_t PrivJitterBucket(std::chrono::microseconds aJitter);
+
+        Time::Clock& myClock;
+        etl::vector<Stage, MAX_STAGES> myStages; // sorted by period, shortest first
+        SafetyMissHandler mySafetyMissHandler;
+
+        static constexpr etl::string_view myDomain = "LoopScheduler";
+    };
+} //namespace HeatTreatFurnace::Control
+
+#endif //HEAT_TREAT_FURNACE_LOOP_SCHEDULER_HPP
@@ -0,0 +1,148 @@
+#ifndef HEAT_TREAT_FURNACE_PID_HPP
+#define HEAT_TREAT_FURNACE_PID_HPP
+
+#include <algorithm>
+#include <chrono>
+
+#include "FixedPoint.hpp"
+#include "Furnace/Preferences.hpp"
+
+namespace HeatTreatFurnace::Control
+{
+    struct PidConfig
+    {
+        float kp = 20.0f;
+        float ki = 0.2f;
+        float kd = 0.1f;
+        std::chrono::milliseconds sampleTime{5000}; // time between Update() calls
+        float integralMax = 100.0f; // anti-windup limit on ∫error dt, SPECIFICATION.md §3.3
+        float outputMin = 0.0f;
+        float outputMax = 100.0f; // heat percent
+
+        /** @brief PID_Kp, PID_Ki, PID_Kd, updating once per PID_Window */
+        static PidConfig FromPreferences(const Furnace::Preferences& aPreferences)
+        {
+            PidConfig config;
+            config.kp = aPreferences.pidKp;
+            config.ki = aPreferences.pidKi;
+            config.kd = aPreferences.pidKd;
+            config.sampleTime = std::chrono::milliseconds(aPreferences.pidWindowMs);
+            return config;
+        }
+    };
+
+    template <typename T>
+    constexpr T FromFloat(float aValue)
+    {
+        return static_cast<T>(aValue);
+    }
+
+    template <>
+    constexpr Fixed16 FromFloat<Fixed16>(float aValue)
+    {
+        return Fixed16::FromFloat(aValue);
+    }
+
+    /**
+     * @brief PID controller from SPECIFICATION.md §3, updated at a fixed sample time.
+     *
+     * Everything that depends only on the configuration, such as Kd/dt, is worked out in Configure(),
+     * so Update() is a fixed handful of multiply-adds with no branches on the data and no allocation.
+     * Use FloatPid on cores with an FPU and FixedPid on those without.
+     */
+    template <typename T>
+    class Pid
+    {
+    public:
+        explicit Pid(const PidConfig& aConfig = {})
+        {
+            Configure(aConfig);
+        }
+
+        /** @brief Change gains or limits; the integral and last error are kept so output doesn't jump */
+        void Configure(const PidConfig& aConfig)
+        {
+            const float dt = std::chrono::duration<float>(aConfig.sampleTime).count();
+            myKp = FromFloat<T>(aConfig.kp);
+            myKi = FromFloat<T>(aConfig.ki);
+            myKdOverDt = FromFloat<T>(dt > 0.0f ? aConfig.kd / dt : 0.0f);
+            myDt = FromFloat<T>(dt);
+            myIntegralMin = FromFloat<T>(-aConfig.integralMax);
+            myIntegralMax = FromFloat<T>(aConfig.integralMax);
+            myOutputMin = FromFloat<T>(aConfig.outputMin);
+            myOutputMax = FromFloat<T>(aConfig.outputMax);
+            myIntegral = std::clamp(myIntegral, myIntegralMin, myIntegralMax);
+        }
+
+        /**
+         * @brief Change gains between samples without a bump in the output.
+         * The integral and its limits are rescaled so Ki × integral, the I term, stays what it was and can reach
+         * as far as before; P and D move only as far as the gains do.
+         */
+        void SetGains(T aKp, T aKi, T aKd)
+        {
+            if (myKi != T{} && aKi != T{})
+            {
+                const T scale = myKi / aKi;
+                myIntegral = myIntegral * scale;
+                myIntegralMin = myIntegralMin * scale;
+                myIntegralMax = myIntegralMax * scale;
+            }
+            myKp = aKp;
+            myKi = aKi;
+            myKdOverDt = myDt != T{} ? aKd / myDt : T{};
+        }
+
+        /**
+         * @brief One sample: returns heat percent for aSetpoint given the aMeasured kiln temperature
+         * @param aFeedforward Heat percent the model says aSetpoint needs, e.g. ThermalEstimator::FeedforwardPercent();
+         * the PID then only has to correct the model's error
+         */
+        T Update(T aSetpoint, T aMeasured, T aFeedforward = T{})
+        {
+            const T error = aSetpoint - aMeasured;
+            myIntegral = std::clamp(myIntegral + error * myDt, myIntegralMin, myIntegralMax);
+            const T derivative = (error - myLastError) * myKdOverDt;
+            myLastError = error;
+            myOutput = std::clamp(aFeedforward + myKp * error + myKi * myIntegral + derivative, myOutputMin, myOutputMax);
+            return myOutput;
+        }
+
+        /** @brief SPECIFICATION.md §3.4: on stop, finish, error and cooling */
+        void Reset()
+        {
+            myIntegral = T{};
+            myLastError = T{};
+            myOutput = T{};
+        }
+
+        [[nodiscard]] T Integral() const
+        {
+            return myIntegral;
+        }
+
+        [[nodiscard]] T Output() const
+        {
+            return myOutput;
+        }
+
+    private:
+        T myKp{};
+        T myKi{};
+        T myKdOverDt{};
+        T myDt{};
+        T myIntegralMin{};
+        T myIntegralMax{};
+        T myOutputMin{};
+        T myOutputMax{};
+
+        T myIntegral{};
+        T myLastError{};
+        T myOutput{};
+    };
+
+    using FloatPid = Pid<float>;
+    using FixedPid = Pid<Fixed16>;
+} //namespace HeatTreatFurnace::Control
+
+#endif //HEAT_TREAT_FURNACE_PID_HPP
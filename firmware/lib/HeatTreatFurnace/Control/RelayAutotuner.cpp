@@ -0,0 +1,268 @@
+#include "RelayAutotuner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <numbers>
+
+#include "GainSchedule.hpp"
+
+namespace HeatTreatFurnace::Control
+{
+    Furnace::Result RelayAutotuner::Start(const AutotuneConfig& aConfig)
+    {
+        if (aConfig.setpoint + aConfig.hysteresis >= aConfig.maxTemperature)
+        {
+            return {false, "Autotune setpoint is above MAX_Temperature"};
+        }
+        if (aConfig.outputStep <= 0.0f || aConfig.outputStep > 50.0f || aConfig.hysteresis < 0.0f || aConfig.cycles == 0)
+        {
+            return {false, "Autotune needs a relay step of up to 50%, a hysteresis and at least one cycle"};
+        }
+        if (aConfig.runawayMargin <= aConfig.hysteresis)
+        {
+            return {false, "Autotune runaway margin must be wider than the hysteresis"};
+        }
+
+        *this = RelayAutotuner();
+        myConfig = aConfig;
+        myStatus = AutotuneStatus::RUNNING;
+        return {true, ""};
+    }
+
+    float RelayAutotuner::Update(float aTemperature, std::chrono::milliseconds aElapsed)
+    {
+        if (myStatus != AutotuneStatus::RUNNING)
+        {
+            return 0.0f;
+        }
+
+        myElapsed += aElapsed;
+        if (aTemperature > myConfig.maxTemperature)
+        {
+            PrivFail("Autotune aborted, kiln over MAX_Temperature");
+            return 0.0f;
+        }
+        if (aTemperature > myConfig.setpoint + myConfig.runawayMargin)
+        {
+            PrivFail("Autotune aborted, thermal runaway");
+            return 0.0f;
+        }
+        if (myElapsed > myConfig.maxDuration)
+        {
+            PrivFail("Autotune timed out before the oscillation settled");
+            return 0.0f;
+        }
+
+        if (myCycling)
+        {
+            myHeatingTime += myHeating ? aElapsed : std::chrono::milliseconds(0);
+            myPeak = std::max(myPeak, aTemperature);
+            myTrough = std::min(myTrough, aTemperature);
+        }
+
+        if (myHeating && aTemperature > myConfig.setpoint + myConfig.hysteresis)
+        {
+            myHeating = false;
+        }
+        else if (!myHeating && aTemperature < myConfig.setpoint - myConfig.hysteresis)
+        {
+            myHeating = true;
+            if (myCycling)
+            {
+                PrivEndCycle();
+            }
+            myCycling = true;
+            myCycleStart = myElapsed;
+            myHeatingTime = std::chrono::milliseconds(0);
+            myPeak = aTemperature;
+            myTrough = aTemperature;
+        }
+
+        return myStatus == AutotuneStatus::RUNNING ? PrivOutput() : 0.0f;
+    }
+
+    void RelayAutotuner::Cancel()
+    {
+        if (myStatus == AutotuneStatus::RUNNING)
+        {
+            myStatus = AutotuneStatus::IDLE;
+        }
+    }
+
+    AutotuneStatus RelayAutotuner::GetStatus() const
+    {
+        return myStatus;
+    }
+
+    const AutotuneResult& RelayAutotuner::GetResult() const
+    {
+        return myResult;
+    }
+
+    const Log::LogMessage& RelayAutotuner::GetError() const
+    {
+        return myError;
+    }
+
+    uint8_t RelayAutotuner::ConsistentCycles() const
+    {
+        return myConsistent;
+    }
+
+    float RelayAutotuner::Setpoint() const
+    {
+        return myConfig.setpoint;
+    }
+
+    PidConfig RelayAutotuner::ProposedConfig(const PidConfig& aBase) const
+    {
+        PidConfig config = aBase;
+        config.kp = myResult.kp;
+        config.ki = myResult.ki;
+        config.kd = myResult.kd;
+        if (myResult.ki > 0.0f)
+        {
+            // Let the integral term alone reach full output, or it can't hold the bias and leaves an offset
+            config.integralMax = config.outputMax / myResult.ki;
+        }
+        return config;
+    }
+
+    Furnace::Result RelayAutotuner::CheckSchedule(const PidConfig& aBase, const Furnace::PidSchedule& aSchedule) const
+    {
+        if (myStatus != AutotuneStatus::DONE)
+        {
+            return {false, "Autotune hasn't finished"};
+        }
+
+        GainSchedule schedule;
+        Furnace::Result result = schedule.Configure(aSchedule, {aBase.kp, aBase.ki, aBase.kd});
+        if (!result)
+        {
+            return result;
+        }
+
+        const PidGains scheduled = schedule.GainsAt(myConfig.setpoint);
+        const struct
+        {
+            const char* name;
+            float scheduled;
+            float proposed;
+        } gains[] = {{"Kp", scheduled.kp, myResult.kp}, {"Ki", scheduled.ki, myResult.ki}, {"Kd", scheduled.kd, myResult.kd}};
+        for (const auto& gain : gains)
+        {
+            if (gain.scheduled > gain.proposed * myConfig.scheduleTolerance || gain.scheduled * myConfig.scheduleTolerance < gain.proposed)
+            {
+                Log::LogMessage message = std::format("PID_Schedule {} at {}°C is {}, autotune proposes {}", gain.name, myConfig.setpoint, gain.scheduled, gain.proposed);
+                return {false, message};
+            }
+        }
+        return {true, ""};
+    }
+
+    Furnace::PidSchedule RelayAutotuner::ProposedSchedule(const Furnace::PidSchedule& aSchedule) const
+    {
+        Furnace::PidSchedule schedule = aSchedule;
+        if (myStatus != AutotuneStatus::DONE)
+        {
+            return schedule;
+        }
+
+        const Furnace::PidBreakpoint proposed{myConfig.setpoint, myResult.kp, myResult.ki, myResult.kd};
+        const auto after = std::find_if(schedule.begin(), schedule.end(), [&](const Furnace::PidBreakpoint& aPoint)
+        {
+            return aPoint.temperature >= proposed.temperature;
+        });
+        if (after != schedule.end() && after->temperature == proposed.temperature)
+        {
+            *after = proposed;
+        }
+        else if (!schedule.full())
+        {
+            schedule.insert(after, proposed);
+        }
+        else
+        {
+            // Full: the neighbour nearer the setpoint gives way, which keeps the order
+            auto nearest = after == schedule.end() ? after - 1 : after;
+            if (after != schedule.begin() && after != schedule.end() && proposed.temperature - (after - 1)->temperature < after->temperature - proposed.temperature)
+            {
+                nearest = after - 1;
+            }
+            *nearest = proposed;
+        }
+        return schedule;
+    }
+
+    void RelayAutotuner::PrivEndCycle()
+    {
+        const float periodS = std::chrono::duration<float>(myElapsed - myCycleStart).count();
+        const float amplitude = (myPeak - myTrough) / 2.0f;
+        const float asymmetry = 2.0f * std::chrono::duration<float>(myHeatingTime).count() / periodS - 1.0f;
+
+        const float step = PrivStep();
+        myBias = std::clamp(myBias + step * asymmetry, 0.0f, 100.0f);
+
+        const bool symmetric = std::abs(asymmetry) <= myConfig.tolerance;
+        const bool repeats = myLastPeriodS > 0.0f && myLastAmplitude > 0.0f
+            && std::abs(periodS - myLastPeriodS) <= myConfig.tolerance * myLastPeriodS
+            && std::abs(amplitude - myLastAmplitude) <= myConfig.tolerance * myLastAmplitude;
+        myLastPeriodS = periodS;
+        myLastAmplitude = amplitude;
+
+        if (!symmetric)
+        {
+            myConsistent = 0;
+            myPeriodSumS = 0.0f;
+            myAmplitudeSum = 0.0f;
+            return;
+        }
+        if (!repeats)
+        {
+            myConsistent = 0;
+            myPeriodSumS = 0.0f;
+            myAmplitudeSum = 0.0f;
+        }
+        myPeriodSumS += periodS;
+        myAmplitudeSum += amplitude;
+        ++myConsistent;
+        if (myConsistent < myConfig.cycles)
+        {
+            return;
+        }
+
+        // Describing function of a relay with hysteresis: Ku = 4d / (π √(a² - ε²))
+        const float meanAmplitude = myAmplitudeSum / static_cast<float>(myConsistent);
+        const float hysteresis = std::min(myConfig.hysteresis, 0.9f * meanAmplitude);
+        const float ultimateGain = 4.0f * step / (std::numbers::pi_v<float> * std::sqrt(meanAmplitude * meanAmplitude - hysteresis * hysteresis));
+        const float ultimatePeriodS = myPeriodSumS / static_cast<float>(myConsistent);
+
+        // Ziegler–Nichols no overshoot: Kp = 0.2 Ku, Ti = Tu / 2, Td = Tu / 3
+        myResult.ultimateGain = ultimateGain;
+        myResult.ultimatePeriod = std::chrono::duration<float>(ultimatePeriodS);
+        myResult.amplitude = meanAmplitude;
+        myResult.bias = myBias;
+        myResult.kp = 0.2f * ultimateGain;
+        myResult.ki = myResult.kp / (ultimatePeriodS / 2.0f);
+        myResult.kd = myResult.kp * ultimatePeriodS / 3.0f;
+        myStatus = AutotuneStatus::DONE;
+    }
+
+    void RelayAutotuner::PrivFail(const char* aReason)
+    {
+        myStatus = AutotuneStatus::FAILED;
+        myError = aReason;
+    }
+
+    float RelayAutotuner::PrivStep() const
+    {
+        // Narrowed near 0% and 100% so the relay stays symmetric about the bias
+        return std::min({myConfig.outputStep, myBias, 100.0f - myBias});
+    }
+
+    float RelayAutotuner::PrivOutput() const
+    {
+        return myHeating ? myBias + PrivStep() : myBias - PrivStep();
+    }
+} //namespace HeatTreatFurnace::Control
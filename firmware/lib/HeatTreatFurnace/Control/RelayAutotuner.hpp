@@ -0,0 +1,130 @@
+#ifndef HEAT_TREAT_FURNACE_RELAY_AUTOTUNER_HPP
+#define HEAT_TREAT_FURNACE_RELAY_AUTOTUNER_HPP
+
+#include <chrono>
+#include <cstdint>
+
+#include "Pid.hpp"
+#include "Furnace/Preferences.hpp"
+#include "Furnace/Result.hpp"
+
+namespace HeatTreatFurnace::Control
+{
+    struct AutotuneConfig
+    {
+        float setpoint = 500.0f; // °C the kiln oscillates around
+        float outputStep = 50.0f; // relay swings the heat percent this far either side of the bias
+        float hysteresis = 1.0f; // °C either side of the setpoint before the relay switches
+        uint8_t cycles = 3; // consecutive consistent cycles needed
+        float tolerance = 0.1f; // how far a cycle's period and amplitude may differ from the last one's
+        std::chrono::minutes maxDuration{8 * 60}; // including the heat up
+        float maxTemperature = 1350.0f; // °C
+        float runawayMargin = 50.0f; // °C above the setpoint
+        float scheduleTolerance = 2.0f; // factor the scheduled gains may be off the proposed ones, see CheckSchedule()
+
+        /** @brief MAX_Temperature, and Thermal_Runaway as the margin when it's enabled */
+        static AutotuneConfig FromPreferences(const Furnace::Preferences& aPreferences, float aSetpoint)
+        {
+            AutotuneConfig config;
+            config.setpoint = aSetpoint;
+            config.maxTemperature = aPreferences.maxTemperature;
+            if (aPreferences.thermalRunaway > 0.0f)
+            {
+                config.runawayMargin = aPreferences.thermalRunaway;
+            }
+            return config;
+        }
+    };
+
+    struct AutotuneResult
+    {
+        float ultimateGain = 0.0f; // Ku, heat percent per °C
+        std::chrono::duration<float> ultimatePeriod{0.0f}; // Tu
+        float amplitude = 0.0f; // °C, half the peak to peak oscillation
+        float bias = 0.0f; // heat percent that held the setpoint on average
+        float kp = 0.0f;
+        float ki = 0.0f;
+        float kd = 0.0f;
+    };
+
+    enum class AutotuneStatus : uint8_t
+    {
+        IDLE,
+        RUNNING,
+        DONE,
+        FAILED
+    };
+
+    /**
+     * @brief Relay feedback autotune (Åström–Hägglund) for the heater PID.
+     *
+     * Drives the heater between bias ± outputStep, switching as the kiln crosses setpoint ± hysteresis,
+     * which makes it oscillate at its ultimate period. Each cycle only updates a handful of running
+     * values: the peak and trough, the time spent heating and cooling, and sums over the consistent
+     * cycles so far. The bias is nudged every cycle until heating and cooling take equally long, since a
+     * kiln heats far faster than it cools and a lopsided relay skews the measurement.
+     *
+     * Gains use the Ziegler–Nichols "no overshoot" rule; overshooting a heat treatment costs more than a
+     * slow approach. Any reading over MAX_Temperature or the runaway margin fails the autotune, as does
+     * running out of time.
+     */
+    class RelayAutotuner
+    {
+    public:
+        Furnace::Result Start(const AutotuneConfig& aConfig);
+
+        /** @brief One sensor reading aElapsed after the last; returns the heat percent to apply until the next */
+        float Update(float aTemperature, std::chrono::milliseconds aElapsed);
+
+        void Cancel();
+
+        [[nodiscard]] AutotuneStatus GetStatus() const;
+        [[nodiscard]] const AutotuneResult& GetResult() const;
+        [[nodiscard]] const Log::LogMessage& GetError() const;
+        [[nodiscard]] uint8_t ConsistentCycles() const;
+
+        /** @brief °C the kiln oscillates around, for State.set_temp and the thermal runaway check */
+        [[nodiscard]] float Setpoint() const;
+
+        /** @brief The proposed gains, and an integral limit to suit Ki, with the rest of aBase unchanged */
+        [[nodiscard]] PidConfig ProposedConfig(const PidConfig& aBase) const;
+
+        /**
+         * @brief Whether the gains aSchedule gives at the autotune setpoint, or aBase's if it's empty, are within
+         * scheduleTolerance of the proposed ones. Fails with the first gain that isn't, or if aSchedule is invalid.
+         */
+        [[nodiscard]] Furnace::Result CheckSchedule(const PidConfig& aBase, const Furnace::PidSchedule& aSchedule) const;
+
+        /** @brief aSchedule with the proposed gains at the autotune setpoint, replacing the nearest breakpoint if it's full */
+        [[nodiscard]] Furnace::PidSchedule ProposedSchedule(const Furnace::PidSchedule& aSchedule) const;
+
+    private:
+        void PrivEndCycle();
+        void PrivFail(const char* aReason);
+        [[nodiscard]] float PrivStep() const;
+        [[nodiscard]] float PrivOutput() const;
+
+        AutotuneConfig myConfig;
+        AutotuneStatus myStatus = AutotuneStatus::IDLE;
+        AutotuneResult myResult;
+        Log::LogMessage myError;
+
+        float myBias = 50.0f;
+        bool myHeating = true;
+        bool myCycling = false; // seen the first switch back to heating, so a cycle is being measured
+        std::chrono::milliseconds myElapsed{0};
+        std::chrono::milliseconds myCycleStart{0};
+        std::chrono::milliseconds myHeatingTime{0};
+        float myPeak = 0.0f;
+        float myTrough = 0.0f;
+
+        // Last cycle, and sums over the consistent ones since
+        float myLastPeriodS = 0.0f;
+        float myLastAmplitude = 0.0f;
+        float myPeriodSumS = 0.0f;
+        float myAmplitudeSum = 0.0f;
+        uint8_t myConsistent = 0;
+    };
+} //namespace HeatTreatFurnace::Control
+
+#endif //HEAT_TREAT_FURNACE_RELAY_AUTOTUNER_HPP
@@ -0,0 +1,98 @@
+#include "SsrScheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace HeatTreatFurnace::Control
+{
+    SsrScheduler::SsrScheduler(const SsrConfig& aConfig)
+    {
+        Configure(aConfig);
+    }
+
+    void SsrScheduler::Configure(const SsrConfig& aConfig)
+    {
+        myConfig = aConfig;
+        PrivUpdateBand();
+    }
+
+    void SsrScheduler::SetDuty(float aHeatPercent)
+    {
+        myDuty = std::clamp(aHeatPercent, 0.0f, 100.0f) / 100.0f;
+        PrivUpdateBand();
+    }
+
+    bool SsrScheduler::Update(std::chrono::milliseconds aElapsed)
+    {
+        const float elapsedMs = static_cast<float>(aElapsed.count());
+        myErrorMs += (myOn ? elapsedMs : 0.0f) - myDuty * elapsedMs;
+        myHeld += aElapsed;
+        PrivClampError();
+
+        const bool switchOff = myOn && myHeld >= myConfig.minOnTime && myErrorMs >= myHalfBandMs && myDuty < 1.0f;
+        const bool switchOn = !myOn && myHeld >= myConfig.minOffTime && myErrorMs <= -myHalfBandMs && myDuty > 0.0f;
+        if (switchOff || switchOn)
+        {
+            myOn = !myOn;
+            myHeld = std::chrono::milliseconds(0);
+            ++mySwitchCount;
+        }
+        return myOn;
+    }
+
+    std::chrono::milliseconds SsrScheduler::TimeToNextSwitch() const
+    {
+        // Error moves at (1 - duty) while on and -duty while off; switch when it crosses the band and the hold is up
+        const float rate = myOn ? 1.0f - myDuty : myDuty;
+        if (rate <= 0.0f)
+        {
+            return std::chrono::milliseconds::max();
+        }
+
+        const float toBandMs = std::max(0.0f, myHalfBandMs + (myOn ? -myErrorMs : myErrorMs)) / rate;
+        const std::chrono::milliseconds hold = (myOn ? myConfig.minOnTime : myConfig.minOffTime) - myHeld;
+        return std::max({std::chrono::milliseconds(static_cast<int64_t>(std::ceil(toBandMs))), hold, std::chrono::milliseconds(0)});
+    }
+
+    void SsrScheduler::Reset()
+    {
+        if (myOn)
+        {
+            ++mySwitchCount;
+        }
+        myOn = false;
+        myErrorMs = 0.0f;
+        myHeld = std::chrono::milliseconds(0);
+    }
+
+    bool SsrScheduler::IsOn() const
+    {
+        return myOn;
+    }
+
+    float SsrScheduler::GetDuty() const
+    {
+        return myDuty * 100.0f;
+    }
+
+    uint32_t SsrScheduler::SwitchCount() const
+    {
+        return mySwitchCount;
+    }
+
+    void SsrScheduler::PrivUpdateBand()
+    {
+        // Error swings (1 - d) × onTime = d × offTime per cycle, so this band makes a cycle one window long
+        myHalfBandMs = myDuty * (1.0f - myDuty) * static_cast<float>(myConfig.window.count()) / 2.0f;
+        PrivClampError();
+    }
+
+    void SsrScheduler::PrivClampError()
+    {
+        // Never owe or be owed more than a window, and never heat at 0% or cut out at 100% to settle up
+        const float windowMs = static_cast<float>(myConfig.window.count());
+        const float low = myDuty <= 0.0f ? 0.0f : -windowMs;
+        const float high = myDuty >= 1.0f ? 0.0f : windowMs;
+        myErrorMs = std::clamp(myErrorMs, low, high);
+    }
+} //namespace HeatTreatFurnace::Control
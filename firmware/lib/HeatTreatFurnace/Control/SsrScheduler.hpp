@@ -0,0 +1,77 @@
+#ifndef HEAT_TREAT_FURNACE_SSR_SCHEDULER_HPP
+#define HEAT_TREAT_FURNACE_SSR_SCHEDULER_HPP
+
+#include <chrono>
+#include <cstdint>
+
+#include "Furnace/Preferences.hpp"
+
+namespace HeatTreatFurnace::Control
+{
+    struct SsrConfig
+    {
+        std::chrono::milliseconds window{5000}; // shortest on + off cycle, PID_Window
+        std::chrono::milliseconds minOnTime{1000};
+        std::chrono::milliseconds minOffTime{1000};
+
+        /** @brief PID_Window, SSR_Min_On, SSR_Min_Off */
+        static SsrConfig FromPreferences(const Furnace::Preferences& aPreferences)
+        {
+            SsrConfig config;
+            config.window = std::chrono::milliseconds(aPreferences.pidWindowMs);
+            config.minOnTime = std::chrono::milliseconds(aPreferences.ssrMinOnMs);
+            config.minOffTime = std::chrono::milliseconds(aPreferences.ssrMinOffMs);
+            return config;
+        }
+    };
+
+    /**
+     * @brief Turns the PID's heat percent into on/off pulses for the heater SSR (SPECIFICATION.md §3.5).
+     *
+     * Rather than a fixed pulse at the start of every PID_Window, it keeps a running error between the
+     * on-time delivered and the on-time asked for, sigma-delta style, and switches when that error
+     * leaves a hysteresis band sized for one switching cycle per window, provided the current state
+     * has been held for its minimum time. In the middle of the range that is the same two switches a
+     * window as the fixed approach; near 0% and 100%, where a fixed window produces a sliver of a pulse
+     * every window, the pulse is stretched to the minimum time and the cycle to several windows.
+     * Because all the state is in the error, a duty change mid-window just changes how fast it moves;
+     * there is no plan to throw away.
+     */
+    class SsrScheduler
+    {
+    public:
+        explicit SsrScheduler(const SsrConfig& aConfig = {});
+
+        void Configure(const SsrConfig& aConfig);
+
+        /** @param aHeatPercent 0-100, clamped */
+        void SetDuty(float aHeatPercent);
+
+        /** @brief Account for aElapsed in the current state, then switch if due; returns whether the SSR is on */
+        bool Update(std::chrono::milliseconds aElapsed);
+
+        /** @brief When Update() will next switch at the current duty, or milliseconds::max() if it won't */
+        [[nodiscard]] std::chrono::milliseconds TimeToNextSwitch() const;
+
+        /** @brief Output off, no error carried over, e.g. when the PID is reset */
+        void Reset();
+
+        [[nodiscard]] bool IsOn() const;
+        [[nodiscard]] float GetDuty() const;
+        [[nodiscard]] uint32_t SwitchCount() const;
+
+    private:
+        void PrivUpdateBand();
+        void PrivClampError();
+
+        SsrConfig myConfig;
+        float myDuty = 0.0f; // 0-1
+        float myErrorMs = 0.0f; // on-time delivered minus on-time asked for
+        float myHalfBandMs = 0.0f;
+        std::chrono::milliseconds myHeld{0}; // time in the current state
+        bool myOn = false;
+        uint32_t mySwitchCount = 0;
+    };
+} //namespace HeatTreatFurnace::Control
+
+#endif //HEAT_TREAT_FURNACE_SSR_SCHEDULER_HPP
@@ -0,0 +1,61 @@
+#include "TemperatureFilter.hpp"
+
+namespace HeatTreatFurnace::Control
+{
+    TemperatureFilter::TemperatureFilter(const TemperatureFilterConfig& aConfig) :
+        myConfig(aConfig)
+    {
+    }
+
+    void TemperatureFilter::Configure(const TemperatureFilterConfig& aConfig)
+    {
+        myConfig = aConfig;
+    }
+
+    void TemperatureFilter::Reset()
+    {
+        myEstimate = {};
+        myCovariance = 0.0f;
+        myStarted = false;
+    }
+
+    const TemperatureEstimate& TemperatureFilter::Update(float aMeasured, std::chrono::milliseconds aElapsed)
+    {
+        const float r = myConfig.measurementNoise * myConfig.measurementNoise;
+        if (!myStarted)
+        {
+            myEstimate = {aMeasured, 0.0f, r, myConfig.initialRateSpread * myConfig.initialRateSpread};
+            myCovariance = 0.0f;
+            myStarted = true;
+            return myEstimate;
+        }
+
+        // Predict: the temperature moves on at the current rate, and both grow less certain
+        const float dt = std::chrono::duration<float>(aElapsed).count();
+        const float q = myConfig.rateNoise * myConfig.rateNoise;
+        float p00 = myEstimate.variance;
+        float p01 = myCovariance;
+        float p11 = myEstimate.rateVariance;
+        myEstimate.temperature += myEstimate.rate * dt;
+        p00 += dt * (2.0f * p01 + dt * p11) + q * dt * dt * dt / 3.0f;
+        p01 += dt * p11 + q * dt * dt / 2.0f;
+        p11 += q * dt;
+
+        // Correct by the reading, weighted by how uncertain the prediction is against the reading
+        const float innovation = aMeasured - myEstimate.temperature;
+        const float s = p00 + r;
+        const float k0 = p00 / s;
+        const float k1 = p01 / s;
+        myEstimate.temperature += k0 * innovation;
+        myEstimate.rate += k1 * innovation;
+        myEstimate.rateVariance = p11 - k1 * p01;
+        myEstimate.variance = (1.0f - k0) * p00;
+        myCovariance = (1.0f - k0) * p01;
+        return myEstimate;
+    }
+
+    const TemperatureEstimate& TemperatureFilter::Estimate() const
+    {
+        return myEstimate;
+    }
+} //namespace HeatTreatFurnace::Control
@@ -0,0 +1,65 @@
+#ifndef HEAT_TREAT_FURNACE_TEMPERATURE_FILTER_HPP
+#define HEAT_TREAT_FURNACE_TEMPERATURE_FILTER_HPP
+
+#include <chrono>
+
+namespace HeatTreatFurnace::Control
+{
+    struct TemperatureFilterConfig
+    {
+        float measurementNoise = 0.5f; // °C, standard deviation of one reading; the MAX31855 resolves 0.25 °C
+        float rateNoise = 0.0005f; // °C/s per √s, how fast the heating rate is expected to wander
+        float initialRateSpread = 0.1f; // °C/s, standard deviation of the rate before any readings
+    };
+
+    struct TemperatureEstimate
+    {
+        float temperature = 0.0f; // °C
+        float rate = 0.0f; // °C/s
+        float variance = 0.0f; // °C², of temperature
+        float rateVariance = 0.0f; // (°C/s)²
+
+        /** @brief For State.temp_change */
+        [[nodiscard]] float RatePerHour() const
+        {
+            return rate * 3600.0f;
+        }
+    };
+
+    /**
+     * @brief Kalman filter on the thermocouple for temperature and heating rate (SPECIFICATION.md §3.10).
+     *
+     * The state is temperature and rate, the rate wandering as white noise; the covariance is three
+     * floats, as it is symmetric. Each Update() is a predict and a correct with a fixed dozen or so
+     * multiply-adds and one divide, whatever the history. With a constant sample time the gains settle
+     * to those of an alpha-beta filter within a few dozen samples; keeping the covariance is what
+     * lets the first samples, and samples at an irregular interval, be weighted correctly.
+     *
+     * The filtered temperature goes to the PID in place of the raw reading, so thermocouple noise no
+     * longer drives the derivative term, and the rate goes to State.temp_change.
+     */
+    class TemperatureFilter
+    {
+    public:
+        explicit TemperatureFilter(const TemperatureFilterConfig& aConfig = {});
+
+        /** @brief New noise figures; the estimate is kept */
+        void Configure(const TemperatureFilterConfig& aConfig);
+
+        /** @brief Forget the estimate; the next reading starts it again, e.g. after a thermocouple fault */
+        void Reset();
+
+        /** @brief One reading, aElapsed after the last */
+        const TemperatureEstimate& Update(float aMeasured, std::chrono::milliseconds aElapsed);
+
+        [[nodiscard]] const TemperatureEstimate& Estimate() const;
+
+    private:
+        TemperatureFilterConfig myConfig;
+        TemperatureEstimate myEstimate;
+        float myCovariance = 0.0f; // between temperature and rate
+        bool myStarted = false;
+    };
+} //namespace HeatTreatFurnace::Control
+
+#endif //HEAT_TREAT_FURNACE_TEMPERATURE_FILTER_HPP
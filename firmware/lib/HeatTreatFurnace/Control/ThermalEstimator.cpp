@@ -0,0 +1,109 @@
+#include "ThermalEstimator.hpp"
+
+#include <algorithm>
+
+namespace HeatTreatFurnace::Control
+{
+    namespace
+    {
+        // Temperatures above ambient run to ~1000 °C against a heat fraction of 0-1; scale the loss
+        // regressor down to match so the covariance stays well conditioned in float
+        constexpr float LOSS_SCALE = 1000.0f;
+
+        // Keep estimates within a factor of this of the preferences, so a bad stretch of data
+        // (a door opened, a thermocouple glitch) can't produce a nonsense feedforward
+        constexpr float MAX_DEVIATION = 5.0f;
+
+        // Stop forgetting once the covariance has grown this far past its starting size; holding a
+        // setpoint gives no new information and the covariance would otherwise grow without bound
+        constexpr float MAX_COVARIANCE_GROWTH = 10.0f;
+    }
+
+    ThermalEstimator::ThermalEstimator(const Furnace::Preferences& aPreferences, float aForgetting) :
+        myForgetting(aForgetting)
+    {
+        Reset(aPreferences);
+    }
+
+    void ThermalEstimator::Reset(const Furnace::Preferences& aPreferences)
+    {
+        myHeaterPowerW = aPreferences.heaterPowerW;
+        myAmbient = aPreferences.ambientTemperature;
+        myTheta[0] = aPreferences.heaterPowerW / aPreferences.thermalMassJPerC;
+        myTheta[1] = aPreferences.lossWPerC / aPreferences.thermalMassJPerC * LOSS_SCALE;
+        myPrior[0] = myTheta[0];
+        myPrior[1] = myTheta[1];
+
+        // One prior standard deviation is the whole prior value
+        myCovariance[0][0] = myTheta[0] * myTheta[0];
+        myCovariance[1][1] = myTheta[1] * myTheta[1];
+        myCovariance[0][1] = 0.0f;
+        myCovariance[1][0] = 0.0f;
+        myHasLast = false;
+    }
+
+    void ThermalEstimator::Update(float aTemperature, float aHeatPercent, std::chrono::milliseconds aElapsed)
+    {
+        const float dt = std::chrono::duration<float>(aElapsed).count();
+        if (!myHasLast || dt <= 0.0f)
+        {
+            myLastTemperature = aTemperature;
+            myHasLast = true;
+            return;
+        }
+
+        // dT/dt over the interval against the heat applied and the loss at its start
+        const float y = (aTemperature - myLastTemperature) / dt;
+        const float phi[2] = {std::clamp(aHeatPercent, 0.0f, 100.0f) / 100.0f, -(myLastTemperature - myAmbient) / LOSS_SCALE};
+        myLastTemperature = aTemperature;
+
+        const float pPhi[2] = {
+            myCovariance[0][0] * phi[0] + myCovariance[0][1] * phi[1],
+            myCovariance[1][0] * phi[0] + myCovariance[1][1] * phi[1]
+        };
+        const float denominator = myForgetting + phi[0] * pPhi[0] + phi[1] * pPhi[1];
+        const float gain[2] = {pPhi[0] / denominator, pPhi[1] / denominator};
+        const float error = y - (phi[0] * myTheta[0] + phi[1] * myTheta[1]);
+
+        for (int i = 0; i < 2; ++i)
+        {
+            myTheta[i] = std::clamp(myTheta[i] + gain[i] * error, myPrior[i] / MAX_DEVIATION, myPrior[i] * MAX_DEVIATION);
+        }
+
+        const float trace = myCovariance[0][0] + myCovariance[1][1];
+        const float forget = trace > MAX_COVARIANCE_GROWTH * (myPrior[0] * myPrior[0] + myPrior[1] * myPrior[1]) ? 1.0f : myForgetting;
+        for (int row = 0; row < 2; ++row)
+        {
+            for (int column = 0; column < 2; ++column)
+            {
+                myCovariance[row][column] = (myCovariance[row][column] - gain[row] * pPhi[column]) / forget;
+            }
+        }
+    }
+
+    float ThermalEstimator::FeedforwardPercent(float aSetpoint, float aSlope) const
+    {
+        const float needed = (aSlope + LossRate() * (aSetpoint - myAmbient)) / HeatingRate();
+        return std::clamp(needed * 100.0f, 0.0f, 100.0f);
+    }
+
+    float ThermalEstimator::HeatingRate() const
+    {
+        return myTheta[0];
+    }
+
+    float ThermalEstimator::LossRate() const
+    {
+        return myTheta[1] / LOSS_SCALE;
+    }
+
+    float ThermalEstimator::ThermalMassJPerC() const
+    {
+        return myHeaterPowerW / HeatingRate();
+    }
+
+    float ThermalEstimator::LossWPerC() const
+    {
+        return LossRate() * ThermalMassJPerC();
+    }
+} //namespace HeatTreatFurnace::Control
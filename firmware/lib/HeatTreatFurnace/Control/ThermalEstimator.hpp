@@ -0,0 +1,59 @@
+#ifndef HEAT_TREAT_FURNACE_THERMAL_ESTIMATOR_HPP
+#define HEAT_TREAT_FURNACE_THERMAL_ESTIMATOR_HPP
+
+#include <chrono>
+
+#include "Furnace/Preferences.hpp"
+
+namespace HeatTreatFurnace::Control
+{
+    /**
+     * @brief Online fit of the first-order kiln model of SPECIFICATION.md §4, for feedforward.
+     *
+     * The model is dT/dt = heatingRate × u - lossRate × (T - ambient), with u the heat fraction.
+     * heatingRate is heater power over thermal mass, lossRate the loss coefficient over thermal mass;
+     * only these ratios can be observed, so the heater power is taken as Kiln_Heater_Power and thermal
+     * mass and loss are worked out from it. Both rates are fitted by recursive least squares with a
+     * forgetting factor, starting from the Kiln_* preferences: a 2×2 covariance and a few multiplies per
+     * sample, no history kept.
+     */
+    class ThermalEstimator
+    {
+    public:
+        static constexpr float DEFAULT_FORGETTING = 0.999f;
+
+        explicit ThermalEstimator(const Furnace::Preferences& aPreferences = {}, float aForgetting = DEFAULT_FORGETTING);
+
+        /** @brief Start again from the Kiln_* preferences, e.g. after they change */
+        void Reset(const Furnace::Preferences& aPreferences);
+
+        /**
+         * @brief One sample: aTemperature now, after aHeatPercent was applied for aElapsed.
+         * The first sample after a reset only records the temperature.
+         */
+        void Update(float aTemperature, float aHeatPercent, std::chrono::milliseconds aElapsed);
+
+        /** @brief Heat percent that holds aSetpoint while it moves at aSlope °C/s, clamped to 0-100 */
+        [[nodiscard]] float FeedforwardPercent(float aSetpoint, float aSlope) const;
+
+        [[nodiscard]] float HeatingRate() const; // °C/s at full power
+        [[nodiscard]] float LossRate() const; // 1/s
+        [[nodiscard]] float ThermalMassJPerC() const;
+        [[nodiscard]] float LossWPerC() const;
+
+    private:
+        float myForgetting;
+        float myHeaterPowerW = 0.0f;
+        float myAmbient = 0.0f;
+
+        // Parameters [heatingRate, lossRate] and their covariance
+        float myPrior[2]{};
+        float myTheta[2]{};
+        float myCovariance[2][2]{};
+
+        float myLastTemperature = 0.0f;
+        bool myHasLast = false;
+    };
+} //namespace HeatTreatFurnace::Control
+
+#endif //HEAT_TREAT_FURNACE_THERMAL_ESTIMATOR_HPP
@@ -0,0 +1,122 @@
+#include "ZoneEngine.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace HeatTreatFurnace::Control
+{
+    ZoneEngine::ZoneEngine(const ZoneConfig& aZones, const PidConfig& aPid)
+    {
+        if (!Configure(aZones, aPid))
+        {
+            Configure({}, aPid);
+        }
+    }
+
+    Furnace::Result ZoneEngine::Configure(const ZoneConfig& aZones, const PidConfig& aPid)
+    {
+        if (aZones.zoneCount == 0 || aZones.zoneCount > MAX_ZONES)
+        {
+            return {false, "Zone count must be 1-64"};
+        }
+
+        const float dt = std::chrono::duration<float>(aPid.sampleTime).count();
+        myCount = aZones.zoneCount;
+        myMaxSpread = aZones.maxSpread;
+        myDt = dt;
+        myOutputMin = aPid.outputMin;
+        myOutputMax = aPid.outputMax;
+        for (size_t i = 0; i < MAX_ZONES; ++i)
+        {
+            myKp[i] = aPid.kp;
+            myKi[i] = aPid.ki;
+            myKdOverDt[i] = dt > 0.0f ? aPid.kd / dt : 0.0f;
+            myIntegralMax[i] = aPid.integralMax;
+            myIntegral[i] = std::clamp(myIntegral[i], -aPid.integralMax, aPid.integralMax);
+        }
+        return {true, ""};
+    }
+
+    void ZoneEngine::SetGains(size_t aZone, float aKp, float aKi, float aKd)
+    {
+        if (aZone >= myCount)
+        {
+            return;
+        }
+        if (myKi[aZone] != 0.0f && aKi != 0.0f)
+        {
+            const float scale = myKi[aZone] / aKi;
+            myIntegral[aZone] *= scale;
+            myIntegralMax[aZone] *= scale;
+        }
+        myKp[aZone] = aKp;
+        myKi[aZone] = aKi;
+        myKdOverDt[aZone] = myDt > 0.0f ? aKd / myDt : 0.0f;
+    }
+
+    void ZoneEngine::SetOffset(size_t aZone, float aOffset)
+    {
+        if (aZone < myCount)
+        {
+            myOffset[aZone] = aOffset;
+        }
+    }
+
+    std::span<const float> ZoneEngine::Update(float aSetpoint, std::span<const float> aMeasured)
+    {
+        const size_t count = std::min(myCount, aMeasured.size());
+        const float* measured = aMeasured.data();
+
+        // Each loop is one step over all zones; min/max rather than if keeps them branch free
+        float coldest = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < count; ++i)
+        {
+            coldest = std::min(coldest, measured[i]);
+        }
+        const float ceiling = myMaxSpread > 0.0f ? coldest + myMaxSpread : std::numeric_limits<float>::max();
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            mySetpoint[i] = std::min(aSetpoint + myOffset[i], ceiling);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float error = mySetpoint[i] - measured[i];
+            const float integral = std::min(std::max(myIntegral[i] + error * myDt, -myIntegralMax[i]), myIntegralMax[i]);
+            const float derivative = (error - myLastError[i]) * myKdOverDt[i];
+            const float output = myKp[i] * error + myKi[i] * integral + derivative;
+            myIntegral[i] = integral;
+            myLastError[i] = error;
+            myOutput[i] = std::min(std::max(output, myOutputMin), myOutputMax);
+        }
+        return {myOutput.data(), count};
+    }
+
+    void ZoneEngine::Reset()
+    {
+        myIntegral.fill(0.0f);
+        myLastError.fill(0.0f);
+        myOutput.fill(0.0f);
+    }
+
+    size_t ZoneEngine::ZoneCount() const
+    {
+        return myCount;
+    }
+
+    std::span<const float> ZoneEngine::Setpoints() const
+    {
+        return {mySetpoint.data(), myCount};
+    }
+
+    std::span<const float> ZoneEngine::Outputs() const
+    {
+        return {myOutput.data(), myCount};
+    }
+
+    std::span<const float> ZoneEngine::Integrals() const
+    {
+        return {myIntegral.data(), myCount};
+    }
+} //namespace HeatTreatFurnace::Control
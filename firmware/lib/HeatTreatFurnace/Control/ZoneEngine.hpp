@@ -0,0 +1,82 @@
+#ifndef HEAT_TREAT_FURNACE_ZONE_ENGINE_HPP
+#define HEAT_TREAT_FURNACE_ZONE_ENGINE_HPP
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "Pid.hpp"
+#include "Furnace/Result.hpp"
+
+namespace HeatTreatFurnace::Control
+{
+    constexpr size_t MAX_ZONES = 64;
+
+    struct ZoneConfig
+    {
+        size_t zoneCount = 1; // each with its own element and thermocouple
+        float maxSpread = 0.0f; // °C a zone may run ahead of the coldest one, 0 = no limit
+    };
+
+    /**
+     * @brief PID control of every zone of a multi-zone furnace (SPECIFICATION.md §3.9).
+     *
+     * Zone state is kept as one array per field rather than one Pid per zone, and Update() runs each
+     * step of the PID over all zones before the next, with no branches on the data: the compiler turns
+     * each step into SIMD over 4-16 zones at a time where the target has it, and the loops stay short
+     * on one that doesn't. Arrays are sized for MAX_ZONES so nothing is allocated.
+     *
+     * Zones are coupled through the spread limit: a zone's setpoint is held to the coldest zone's
+     * temperature plus maxSpread, so a fast zone waits for a slow one instead of pulling away and
+     * heating it through the load.
+     */
+    class ZoneEngine
+    {
+    public:
+        explicit ZoneEngine(const ZoneConfig& aZones = {}, const PidConfig& aPid = {});
+
+        /** @brief Zone count and spread, and aPid for every zone; fails and changes nothing for 0 or over MAX_ZONES zones */
+        Furnace::Result Configure(const ZoneConfig& aZones, const PidConfig& aPid);
+
+        /** @brief Gains for one zone, bumpless as Pid::SetGains() */
+        void SetGains(size_t aZone, float aKp, float aKi, float aKd);
+
+        /** @brief °C added to the program setpoint for one zone, e.g. to run the bottom a little hot */
+        void SetOffset(size_t aZone, float aOffset);
+
+        /**
+         * @brief One sample for every zone
+         * @param aMeasured ZoneCount() thermocouple readings
+         * @return ZoneCount() heat percents, valid until the next call
+         */
+        std::span<const float> Update(float aSetpoint, std::span<const float> aMeasured);
+
+        /** @brief SPECIFICATION.md §3.4, for every zone */
+        void Reset();
+
+        [[nodiscard]] size_t ZoneCount() const;
+        [[nodiscard]] std::span<const float> Setpoints() const; // after offsets and the spread limit
+        [[nodiscard]] std::span<const float> Outputs() const;
+        [[nodiscard]] std::span<const float> Integrals() const;
+
+    private:
+        size_t myCount = 1;
+        float myMaxSpread = 0.0f;
+        float myDt = 0.0f;
+        float myOutputMin = 0.0f;
+        float myOutputMax = 100.0f;
+
+        // Per zone
+        alignas(64) std::array<float, MAX_ZONES> myKp{};
+        alignas(64) std::array<float, MAX_ZONES> myKi{};
+        alignas(64) std::array<float, MAX_ZONES> myKdOverDt{};
+        alignas(64) std::array<float, MAX_ZONES> myIntegralMax{};
+        alignas(64) std::array<float, MAX_ZONES> myOffset{};
+        alignas(64) std::array<float, MAX_ZONES> mySetpoint{};
+        alignas(64) std::array<float, MAX_ZONES> myIntegral{};
+        alignas(64) std::array<float, MAX_ZONES> myLastError{};
+        alignas(64) std::array<float, MAX_ZONES> myOutput{};
+    };
+} //namespace HeatTreatFurnace::Control
+
+#endif //HEAT_TREAT_FURNACE_ZONE_ENGINE_HPP
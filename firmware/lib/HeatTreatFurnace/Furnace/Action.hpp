@@ -11,11 +11,12 @@ namespace HeatTreatFurnace::Furnace
         RESUME_PROFILE,
         STOP_PROFILE,
         COMPLETE_PROFILE,
-        RESTART
+        RESTART,
+        START_AUTOTUNE
     };
 
     const std::map<StateId, std::set<ActionId>> validStateActions = {
-        {StateId::IDLE, {ActionId::LOAD_PROFILE, ActionId::RESTART, ActionId::STOP_PROFILE}},
+        {StateId::IDLE, {ActionId::LOAD_PROFILE, ActionId::RESTART, ActionId::STOP_PROFILE, ActionId::START_AUTOTUNE}},
         {StateId::LOADED, {ActionId::CLEAR_PROFILE, ActionId::LOAD_PROFILE, ActionId::RESTART, ActionId::START_PROFILE, ActionId::STOP_PROFILE}},
         {StateId::RUNNING,
          {ActionId::RESTART, ActionId::PAUSE_PROFILE, ActionId::COMPLETE_PROFILE, ActionId::STOP_PROFILE}},
@@ -24,7 +25,8 @@ namespace HeatTreatFurnace::Furnace
         {StateId::CANCELLED, {ActionId::CLEAR_PROFILE, ActionId::LOAD_PROFILE, ActionId::RESTART, ActionId::START_PROFILE, ActionId::STOP_PROFILE}},
         {StateId::ERROR, {ActionId::CLEAR_PROFILE, ActionId::LOAD_PROFILE, ActionId::START_PROFILE, ActionId::STOP_PROFILE}},
         {StateId::WAITING_FOR_TEMP,
-         {ActionId::PAUSE_PROFILE, ActionId::STOP_PROFILE}}
+         {ActionId::PAUSE_PROFILE, ActionId::STOP_PROFILE}},
+        {StateId::AUTOTUNING, {ActionId::STOP_PROFILE}}
     };
 
     class ActionBase
@@ -0,0 +1,60 @@
+#ifndef HEAT_TREAT_FURNACE_PREFERENCES_HPP
+#define HEAT_TREAT_FURNACE_PREFERENCES_HPP
+
+#include <cstdint>
+
+#include "etl/vector.h"
+#include "Sensor/ThermocoupleType.hpp"
+
+namespace HeatTreatFurnace::Furnace
+{
+    /** @brief PID gains to use at one temperature, see PID_Schedule */
+    struct PidBreakpoint
+    {
+        float temperature = 0.0f; // °C
+        float kp = 0.0f;
+        float ki = 0.0f;
+        float kd = 0.0f;
+    };
+
+    constexpr size_t MAX_PID_BREAKPOINTS = 8;
+    using PidSchedule = etl::vector<PidBreakpoint, MAX_PID_BREAKPOINTS>;
+
+    /**
+     * @brief Controller settings from furnace.conf (SPECIFICATION.md Appendix A)
+     *
+     * Names in the comments are the preference keys used by the frontend and furnace.conf.
+     */
+    struct Preferences
+    {
+        float pidKp = 20.0f; // PID_Kp
+        float pidKi = 0.2f; // PID_Ki
+        float pidKd = 0.1f; // PID_Kd
+        PidSchedule pidSchedule; // PID_Schedule, sorted by temperature; empty = PID_Kp/Ki/Kd at every temperature
+        uint32_t pidWindowMs = 5000; // PID_Window
+        uint32_t ssrMinOnMs = 1000; // SSR_Min_On
+        uint32_t ssrMinOffMs = 1000; // SSR_Min_Off
+
+        float minTemperature = 10.0f; // MIN_Temperature, °C
+        float maxTemperature = 1350.0f; // MAX_Temperature, °C
+        float maxHousingTemperature = 130.0f; // MAX_Housing_Temperature, °C
+        float thermalRunaway = 0.0f; // Thermal_Runaway, °C above setpoint, 0 = disabled
+        uint32_t alarmTimeoutS = 5; // Alarm_Timeout
+        uint32_t logWindowS = 10; // LOG_Window
+        uint8_t max31855ErrorGraceCount = 5; // MAX31855_Error_Grace_Count
+        Sensor::ThermocoupleType thermocoupleType = Sensor::ThermocoupleType::K; // Thermocouple_Type, "K", "N", "S" or "R"
+
+        // The default kiln below manages 180°C/h up to 650°C, and ~90°C/h at MAX_Temperature
+        float maxHeatingRate = 180.0f; // MAX_Heating_Rate, °C/hour, 0 = disabled
+        uint32_t maxProgramHours = 72; // MAX_Program_Hours, 0 = disabled
+        float maxProgramEnergyKWh = 0.0f; // MAX_Program_Energy, kWh, 0 = disabled
+
+        // Nominal kiln characteristics, used to check a program is physically achievable
+        float heaterPowerW = 3000.0f; // Kiln_Heater_Power, W
+        float thermalMassJPerC = 40000.0f; // Kiln_Thermal_Mass, J/°C
+        float lossWPerC = 1.5f; // Kiln_Loss_Coefficient, W/°C
+        float ambientTemperature = 20.0f; // Kiln_Ambient_Temperature, °C
+    };
+} //namespace HeatTreatFurnace::Furnace
+
+#endif //HEAT_TREAT_FURNACE_PREFERENCES_HPP
@@ -0,0 +1,128 @@
+#include "Profile.hpp"
+
+#include <utility>
+
+#include <flatbuffers/flatbuffers.h>
+#include "furnace_generated.h"
+
+namespace HeatTreatFurnace::Furnace
+{
+    Profile::Profile(Profile&& aOther) noexcept
+    {
+        *this = std::move(aOther);
+    }
+
+    Profile& Profile::operator=(Profile&& aOther) noexcept
+    {
+        if (this != &aOther)
+        {
+            // Moving the vector keeps its heap allocation, so the span and root pointer stay valid
+            myName = std::move(aOther.myName);
+            myStorage = std::move(aOther.myStorage);
+            myBuffer = aOther.myBuffer;
+            myProgram = aOther.myProgram;
+            aOther.Clear();
+        }
+        return *this;
+    }
+
+    Result Profile::Load(std::string_view aName, std::vector<uint8_t>&& aBuffer)
+    {
+        Result res = PrivVerify(aBuffer);
+        if (!res)
+        {
+            return res;
+        }
+
+        myStorage = std::move(aBuffer);
+        PrivAttach(aName, myStorage);
+        return {true, ""};
+    }
+
+    Result Profile::Map(std::string_view aName, std::span<const uint8_t> aBuffer)
+    {
+        Result res = PrivVerify(aBuffer);
+        if (!res)
+        {
+            return res;
+        }
+
+        myStorage.clear();
+        PrivAttach(aName, aBuffer);
+        return {true, ""};
+    }
+
+    void Profile::Clear()
+    {
+        myName.clear();
+        myStorage.clear();
+        myBuffer = {};
+        myProgram = nullptr;
+    }
+
+    bool Profile::IsLoaded() const
+    {
+        return myProgram != nullptr;
+    }
+
+    const std::string& Profile::Name() const
+    {
+        return myName;
+    }
+
+    std::string_view Profile::Description() const
+    {
+        if (myProgram == nullptr || myProgram->description() == nullptr)
+        {
+            return {};
+        }
+        return myProgram->description()->string_view();
+    }
+
+    size_t Profile::SegmentCount() const
+    {
+        if (myProgram == nullptr)
+        {
+            return 0;
+        }
+        return myProgram->segments()->size();
+    }
+
+    ProfileSegment Profile::Segment(size_t aIndex) const
+    {
+        const ::Furnace::ProgramSegment* segment = myProgram->segments()->Get(static_cast<flatbuffers::uoffset_t>(aIndex));
+        return {
+            segment->target(),
+            std::chrono::seconds(segment->ramp_time_s()),
+            std::chrono::seconds(segment->dwell_time_s())
+        };
+    }
+
+    std::span<const uint8_t> Profile::Buffer() const
+    {
+        return myBuffer;
+    }
+
+    Result Profile::PrivVerify(std::span<const uint8_t> aBuffer)
+    {
+        flatbuffers::Verifier verifier(aBuffer.data(), aBuffer.size());
+        if (!verifier.VerifyBuffer<::Furnace::Program>(nullptr))
+        {
+            return {false, "Program buffer is corrupt"};
+        }
+
+        const ::Furnace::Program* program = flatbuffers::GetRoot<::Furnace::Program>(aBuffer.data());
+        if (program->segments() == nullptr)
+        {
+            return {false, "Program has no segments"};
+        }
+        return {true, ""};
+    }
+
+    void Profile::PrivAttach(std::string_view aName, std::span<const uint8_t> aBuffer)
+    {
+        myName = aName;
+        myBuffer = aBuffer;
+        myProgram = flatbuffers::GetRoot<::Furnace::Program>(myBuffer.data());
+    }
+} //HeatTreatFurnace::Furnace
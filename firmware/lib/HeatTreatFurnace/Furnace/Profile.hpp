@@ -2,9 +2,19 @@
 #define HEAT_TREAT_FURNACE_PROFILE_HPP
 
 #include <chrono>
+#include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "Result.hpp"
+
+namespace Furnace
+{
+    struct Program;
+}
+
 namespace HeatTreatFurnace::Furnace
 {
     /**
@@ -19,7 +29,7 @@ namespace HeatTreatFurnace::Furnace
     auto span = 1h + 3min + 30s;
      */
 
-    class ProfileSegment
+    struct ProfileSegment
     {
         float target = 0.0f;
         std::chrono::milliseconds rampTime = std::chrono::milliseconds(0);
@@ -28,12 +38,47 @@ namespace HeatTreatFurnace::Furnace
 
     /**
      * @brief Temperature profile to follow
+     *
+     * Backed by a compiled Program buffer (see proto/furnace.fbs). Segments are read
+     * directly out of the buffer, so loading a profile does not parse or copy them.
      */
-    struct Profile
+    class Profile
     {
-        std::string name;
-        std::string description;
-        std::vector<ProfileSegment> segments;
+    public:
+        Profile() = default;
+        ~Profile() = default;
+
+        Profile(const Profile&) = delete;
+        Profile& operator=(const Profile&) = delete;
+
+        Profile(Profile&& aOther) noexcept;
+        Profile& operator=(Profile&& aOther) noexcept;
+
+        /** @brief Verify and take ownership of a compiled program read from flash */
+        Result Load(std::string_view aName, std::vector<uint8_t>&& aBuffer);
+
+        /** @brief Verify and borrow a compiled program, e.g. a memory mapped partition. aBuffer must outlive the profile. */
+        Result Map(std::string_view aName, std::span<const uint8_t> aBuffer);
+
+        void Clear();
+
+        [[nodiscard]] bool IsLoaded() const;
+        [[nodiscard]] const std::string& Name() const;
+        [[nodiscard]] std::string_view Description() const;
+        [[nodiscard]] size_t SegmentCount() const;
+        [[nodiscard]] ProfileSegment Segment(size_t aIndex) const;
+
+        /** @brief The compiled program this profile reads from */
+        [[nodiscard]] std::span<const uint8_t> Buffer() const;
+
+    private:
+        static Result PrivVerify(std::span<const uint8_t> aBuffer);
+        void PrivAttach(std::string_view aName, std::span<const uint8_t> aBuffer);
+
+        std::string myName;
+        std::vector<uint8_t> myStorage;
+        std::span<const uint8_t> myBuffer;
+        const ::Furnace::Program* myProgram = nullptr;
     };
 } //HeatTreatFurnace::Furnace
 
@@ -29,6 +29,7 @@ namespace HeatTreatFurnace::Furnace
         CANCELLED,
         ERROR,
         WAITING_FOR_TEMP,
+        AUTOTUNING,
         NUM_STATES
     };
 
@@ -56,30 +57,31 @@ namespace HeatTreatFurnace::Furnace
 
         StateName Name()
         {
-            StateName name = "";
             switch (myStateId)
             {
+            case StateId::TRANSITIONING:
+                return "Transitioning";
             case StateId::IDLE:
-                name = "Idle";
+                return "Idle";
             case StateId::LOADED:
-                name = "Loaded";
+                return "Loaded";
             case StateId::RUNNING:
-                name = "Running";
+                return "Running";
             case StateId::PAUSED:
-                name = "Paused";
+                return "Paused";
             case StateId::COMPLETED:
-                name = "Completed";
+                return "Completed";
             case StateId::CANCELLED:
-                name = "Cancelled";
+                return "Cancelled";
             case StateId::ERROR:
-                name = "Error";
+                return "Error";
             case StateId::WAITING_FOR_TEMP:
-                name = "WaitingForTemp";
+                return "WaitingForTemp";
+            case StateId::AUTOTUNING:
+                return "Autotuning";
             default:
-                break;
+                return "";
             }
-
-            return name;
         }
 
     protected:
@@ -186,6 +188,17 @@ namespace HeatTreatFurnace::Furnace
 
         [[nodiscard]] StateId State() const override { return StateId::WAITING_FOR_TEMP; }
     };
+
+    class AutotuningState : public BaseState
+    {
+    public:
+        explicit AutotuningState(FurnaceState& aFurnace) :
+            BaseState(aFurnace, StateId::AUTOTUNING)
+        {
+        }
+
+        [[nodiscard]] StateId State() const override { return StateId::AUTOTUNING; }
+    };
 } //namespace furnace
 
 #endif //HEAT_TREAT_FURNACE_STATE_HPP
@@ -8,10 +8,11 @@
 
 namespace HeatTreatFurnace::Furnace
 {
-    StateMachine::StateMachine(FurnaceState& aFurnace, Log::LogService& aLog) :
+    StateMachine::StateMachine(FurnaceState& aFurnace, Time::Clock& aClock, Log::LogService& aLog) :
         Loggable(aLog),
         myLog(aLog), myFurnace(aFurnace),
         myCurrentState(StateId::IDLE),
+        myClock(aClock),
         myTransitioningState(TransitioningState(aFurnace)),
         myIdleState(IdleState(aFurnace)),
         myLoadedState(LoadedState(aFurnace)),
@@ -20,7 +21,8 @@ namespace HeatTreatFurnace::Furnace
         myCompletedState(CompletedState(aFurnace)),
         myCancelledState(CancelledState(aFurnace)),
         myErrorState(ErrorState(aFurnace)),
-        myWaitingForTempState(WaitingForTempState(aFurnace))
+        myWaitingForTempState(WaitingForTempState(aFurnace)),
+        myAutotuningState(AutotuningState(aFurnace))
     {
 
         myStates = etl::make_map<StateId, BaseState&>(
@@ -32,11 +34,28 @@ namespace HeatTreatFurnace::Furnace
             etl::pair{StateId::COMPLETED, myCompletedState},
             etl::pair{StateId::CANCELLED, myCancelledState},
             etl::pair{StateId::ERROR, myErrorState},
-            etl::pair{StateId::WAITING_FOR_TEMP, myWaitingForTempState}
+            etl::pair{StateId::WAITING_FOR_TEMP, myWaitingForTempState},
+            etl::pair{StateId::AUTOTUNING, myAutotuningState}
             );
 
     }
 
+    StateMachine::StateMachine(FurnaceState& aFurnace, StateMap&& aStates, Time::Clock& aClock, Log::LogService& aLog) :
+        StateMachine(aFurnace, aClock, aLog)
+    {
+        myOwnedStates = std::move(aStates);
+        for (auto& [id, state] : myOwnedStates)
+        {
+            if (!state || state->State() != id)
+            {
+                Log(Log::LogLevel::Warn, "Ignoring a state registered as {}", static_cast<int>(id));
+                continue;
+            }
+            myStates.erase(id);
+            myStates.insert(etl::pair<StateId, BaseState&>{id, *state});
+        }
+    }
+
     StateId StateMachine::GetState() const
     {
         return myCurrentState;
@@ -60,15 +79,257 @@ namespace HeatTreatFurnace::Furnace
         return true;
     }
 
+    void StateMachine::ApplyPreferences(const Preferences& aPreferences)
+    {
+        myPreferences = aPreferences;
+        myProfileValidator.SetPreferences(aPreferences);
+        Result res = myPid.Configure(Control::PidConfig::FromPreferences(aPreferences), aPreferences.pidSchedule);
+        if (!res)
+        {
+            Log(Log::LogLevel::Warn, "{}, using PID_Kp/Ki/Kd at every temperature", res.message);
+        }
+        myThermalEstimator.Reset(aPreferences);
+    }
+
+    Result StateMachine::StartAutotune(float aSetpoint)
+    {
+        if (!CanTransition(StateId::AUTOTUNING))
+        {
+            return {false, "Can't autotune in this state"};
+        }
+
+        Result res = myAutotuner.Start(Control::AutotuneConfig::FromPreferences(myPreferences, aSetpoint));
+        if (!res)
+        {
+            return res;
+        }
+        if (!TransitionTo(StateId::AUTOTUNING))
+        {
+            myAutotuner.Cancel();
+            return {false, "Can't autotune in this state"};
+        }
+
+        Log(Log::LogLevel::Info, "Autotuning around {}", aSetpoint);
+        return {true, ""};
+    }
+
+    float StateMachine::UpdateAutotune(float aKilnTemperature, std::chrono::milliseconds aElapsed)
+    {
+        if (myCurrentState != StateId::AUTOTUNING)
+        {
+            return 0.0f;
+        }
+
+        const float heat = myAutotuner.Update(aKilnTemperature, aElapsed);
+        switch (myAutotuner.GetStatus())
+        {
+        case Control::AutotuneStatus::DONE:
+        {
+            const Control::AutotuneResult& result = myAutotuner.GetResult();
+            Log(Log::LogLevel::Info, "Autotune done: Ku {} Tu {}s, proposed Kp {} Ki {} Kd {}", result.ultimateGain, result.ultimatePeriod.count(), result.kp, result.ki, result.kd);
+            Result res = myAutotuner.CheckSchedule(Control::PidConfig::FromPreferences(myPreferences), myPreferences.pidSchedule);
+            if (!res)
+            {
+                Log(Log::LogLevel::Warn, "{}", res.message);
+            }
+            TransitionTo(StateId::IDLE);
+            return 0.0f;
+        }
+        case Control::AutotuneStatus::FAILED:
+            Log(Log::LogLevel::Error, "{}", myAutotuner.GetError());
+            TransitionTo(StateId::ERROR);
+            myErrorMessage = myAutotuner.GetError();
+            return 0.0f;
+        default:
+            return heat;
+        }
+    }
+
+    const Control::RelayAutotuner& StateMachine::GetAutotuner() const
+    {
+        return myAutotuner;
+    }
+
+    void StateMachine::OnSafetyDeadlineMissed(etl::string_view aStage)
+    {
+        Log::LogMessage message = std::format("Safety stage {} missed its deadline", std::string_view(aStage.data(), aStage.size()));
+        Log(Log::LogLevel::Error, "{}", message);
+        TransitionTo(StateId::ERROR);
+        myErrorMessage = message;
+    }
+
+    void StateMachine::OnSafetyTrip(const Safety::FaultReport& aReport)
+    {
+        // Called again for each fault added, so the message lists them all
+        myErrorMessage = aReport.Describe();
+        if (myCurrentState == StateId::ERROR)
+        {
+            return;
+        }
+        Log(Log::LogLevel::Error, "Safety monitor tripped: {}", myErrorMessage);
+        TransitionTo(StateId::ERROR);
+    }
+
+    const Log::LogMessage& StateMachine::GetErrorMessage() const
+    {
+        return myErrorMessage;
+    }
+
+    Result StateMachine::LoadProfile(std::unique_ptr<Profile> aProfile, float aKilnTemperature)
+    {
+        if (!aProfile || !aProfile->IsLoaded())
+        {
+            return {false, "No profile to load"};
+        }
+
+        const Program::ValidationReport report = myProfileValidator.Validate(*aProfile, aKilnTemperature);
+        if (!report.IsValid())
+        {
+            Result res{false, ""};
+            report.Describe(res.message);
+            Log(Log::LogLevel::Warn, "Rejected profile {}: {}", aProfile->Name(), res.message);
+            return res;
+        }
+
+        myProfileToLoad = std::move(aProfile);
+        if (!TransitionTo(StateId::LOADED))
+        {
+            myProfileToLoad.reset();
+            return {false, "Can't load a profile in this state"};
+        }
+
+        myLoadedProfile = std::move(myProfileToLoad);
+        myLoadedTimeline = std::make_unique<Program::ProfileTimeline>(*myLoadedProfile);
+        myStartPosition = {};
+        myProgramStart = std::chrono::microseconds(0);
+        myProgramStopped = std::chrono::microseconds(0);
+        return {true, ""};
+    }
+
+    Result StateMachine::StartProfile(int32_t aSegment, int32_t aMinute, float aKilnTemperature)
+    {
+        if (!myLoadedTimeline)
+        {
+            return {false, "No profile loaded"};
+        }
+
+        const Program::TimelinePosition position = myLoadedTimeline->SeekStart(aSegment, aMinute, aKilnTemperature);
+        if (position.phase == Program::SegmentPhase::COMPLETE)
+        {
+            return {false, "Start point is past the end of the program"};
+        }
+
+        if (!TransitionTo(StateId::RUNNING))
+        {
+            return {false, "Can't start a profile in this state"};
+        }
+
+        myStartPosition = position;
+        myProgramStart = myClock.Now() - (myLoadedTimeline->TotalDuration() - position.remainingProgram);
+        Log(Log::LogLevel::Info, "Started {} at segment {}", myLoadedProfile->Name(), position.segment + 1);
+        return {true, ""};
+    }
+
+    const Program::TimelinePosition& StateMachine::GetStartPosition() const
+    {
+        return myStartPosition;
+    }
+
+    const Program::ProfileTimeline* StateMachine::GetTimeline() const
+    {
+        return myLoadedTimeline.get();
+    }
+
+    const Profile* StateMachine::GetProfile() const
+    {
+        return myLoadedProfile.get();
+    }
+
+    std::chrono::milliseconds StateMachine::GetProgramOffset() const
+    {
+        const std::chrono::microseconds end = myCurrentState == StateId::RUNNING ? myClock.Now() : myProgramStopped;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(end - myProgramStart);
+    }
+
+    std::chrono::microseconds StateMachine::GetProgramStart() const
+    {
+        return myProgramStart;
+    }
+
+    Program::SetpointSample StateMachine::GetSetpoint(std::chrono::milliseconds aLead) const
+    {
+        if (!myLoadedTimeline)
+        {
+            return {};
+        }
+        return myLoadedTimeline->SetpointAt(GetProgramOffset() + aLead, myStartPosition);
+    }
+
+    size_t StateMachine::GetSegment() const
+    {
+        if (!myLoadedTimeline)
+        {
+            return 0;
+        }
+        return myLoadedTimeline->SegmentAt(GetProgramOffset(), myStartPosition);
+    }
+
+    bool StateMachine::CompleteIfFinished()
+    {
+        if (myCurrentState != StateId::RUNNING || GetProgramOffset() < myLoadedTimeline->TotalDuration())
+        {
+            return false;
+        }
+        return TransitionTo(StateId::COMPLETED);
+    }
+
+    Control::FloatGainScheduledPid& StateMachine::GetPid()
+    {
+        return myPid;
+    }
+
+    Control::ThermalEstimator& StateMachine::GetThermalEstimator()
+    {
+        return myThermalEstimator;
+    }
+
+    Control::TemperatureFilter& StateMachine::GetTemperatureFilter()
+    {
+        return myTemperatureFilter;
+    }
+
+    void StateMachine::PublishState(StateSnapshot aSnapshot)
+    {
+        aSnapshot.state = myCurrentState;
+        aSnapshot.SetProgramName(myLoadedProfile ? std::string_view(myLoadedProfile->Name()) : std::string_view());
+        myStateSnapshot.Publish(aSnapshot);
+    }
+
+    const Sync::Snapshot<StateSnapshot>& StateMachine::GetStateSnapshot() const
+    {
+        return myStateSnapshot;
+    }
+
+    bool StateMachine::PrivResetsPid(StateId aState)
+    {
+        // Stopped, finished or errored: the heater is off and the kiln cools, so stale integral must not carry over.
+        // Autotuning drives the heater itself and leaves the kiln wherever the relay was.
+        return aState == StateId::CANCELLED || aState == StateId::COMPLETED || aState == StateId::ERROR || aState == StateId::AUTOTUNING;
+    }
+
     bool StateMachine::TransitionTo(StateId aToState)
     {
+        const StateId fromState = myCurrentState;
         StateName fromStateName = myStates.at(myCurrentState).Name();
         StateName toStateName = myStates.at(aToState).Name();
         //Safety reset on ERROR, so always allow the transition
         if (aToState == StateId::ERROR)
         {
+            myPid.Reset();
             auto result = myStates.at(StateId::ERROR).OnEnter();
             DISCARD(result);
+            myCurrentState = StateId::ERROR;
+            PrivTimeProgram(fromState, StateId::ERROR);
 
             Log(Log::LogLevel::Debug, "Transitioned to ERROR from {}", fromStateName);
             return true;
@@ -105,6 +366,25 @@ namespace HeatTreatFurnace::Furnace
             return false;
         }
         myCurrentState = aToState;
+        PrivTimeProgram(fromState, aToState);
+        myErrorMessage.clear();
+        if (PrivResetsPid(aToState))
+        {
+            myPid.Reset();
+        }
         return true;
     }
+
+    void StateMachine::PrivTimeProgram(StateId aFrom, StateId aTo)
+    {
+        if (aFrom == StateId::RUNNING && aTo != StateId::RUNNING)
+        {
+            myProgramStopped = myClock.Now();
+        }
+        else if (aTo == StateId::RUNNING && (aFrom == StateId::PAUSED || aFrom == StateId::WAITING_FOR_TEMP))
+        {
+            // The program holds where it was: move its start on by the time it was stopped
+            myProgramStart += myClock.Now() - myProgramStopped;
+        }
+    }
 } //HeatTreatFurnace::Furnace
@@ -2,9 +2,20 @@
 #define HEAT_TREAT_FURNACE_STATE_MACHINE_HPP
 
 #include "etl/set.h"
+#include "Preferences.hpp"
 #include "Profile.hpp"
 #include "State.hpp"
+#include "StateSnapshot.hpp"
+#include "Control/GainSchedule.hpp"
+#include "Control/RelayAutotuner.hpp"
+#include "Control/TemperatureFilter.hpp"
+#include "Control/ThermalEstimator.hpp"
 #include "Log/LogService.hpp"
+#include "Program/ProfileTimeline.hpp"
+#include "Program/ProgramValidator.hpp"
+#include "Safety/SafetyRules.hpp"
+#include "Sync/Snapshot.hpp"
+#include "Time/Clock.hpp"
 
 namespace HeatTreatFurnace::Furnace
 {
@@ -18,15 +29,90 @@ namespace HeatTreatFurnace::Furnace
 
         /** @brief State Machine dependencies:
          * StateMap will be moved to myState
+         * aClock times the running program, so a Time::VirtualClock fires a profile in simulated time
          */
-        explicit StateMachine(FurnaceState& aFurnace, Log::LogService& aLog);
+        StateMachine(FurnaceState& aFurnace, Time::Clock& aClock, Log::LogService& aLog);
+
+        /** @brief As above, with each state in aStates standing in for the built in one it is keyed by; a state whose State() doesn't match its key is ignored */
+        StateMachine(FurnaceState& aFurnace, StateMap&& aStates, Time::Clock& aClock, Log::LogService& aLog);
         ~StateMachine() override = default;
         [[nodiscard]] StateId GetState() const;
         [[nodiscard]] bool CanTransition(const StateId& aToState);
         bool TransitionTo(StateId aToState);
 
+        void ApplyPreferences(const Preferences& aPreferences);
+
         //Actions
 
+        /** @brief LOAD_PROFILE: rejected with every validation failure in the message if the profile can't be fired
+         * @param aKilnTemperature Current kiln temperature, which the first segment ramps from
+         */
+        Result LoadProfile(std::unique_ptr<Profile> aProfile, float aKilnTemperature);
+
+        /** @brief START_PROFILE, from the beginning or a StartCommand segment/minute
+         * @param aKilnTemperature Current kiln temperature, the ramp in progress is re-anchored at it
+         */
+        Result StartProfile(int32_t aSegment, int32_t aMinute, float aKilnTemperature);
+
+        /** @brief Where the last StartProfile() entered the loaded profile */
+        [[nodiscard]] const Program::TimelinePosition& GetStartPosition() const;
+
+        /** @brief Segment timing of the loaded profile, for the control loop's setpoint; nullptr if none is loaded */
+        [[nodiscard]] const Program::ProfileTimeline* GetTimeline() const;
+
+        /** @brief The loaded profile, for State.step; nullptr if none is loaded */
+        [[nodiscard]] const Profile* GetProfile() const;
+
+        /** @brief How far into the loaded profile the program is by the clock, not counting time PAUSED; held once it stops */
+        [[nodiscard]] std::chrono::milliseconds GetProgramOffset() const;
+
+        /** @brief Clock time the program would have started at to reach GetProgramOffset() without pausing, for State.prog_start */
+        [[nodiscard]] std::chrono::microseconds GetProgramStart() const;
+
+        /** @brief Programmed setpoint aLead past GetProgramOffset(), the ramp in progress at StartProfile() re-anchored at the kiln temperature */
+        [[nodiscard]] Program::SetpointSample GetSetpoint(std::chrono::milliseconds aLead = std::chrono::milliseconds(0)) const;
+
+        /** @brief 0-indexed segment at GetProgramOffset(), for State.segment */
+        [[nodiscard]] size_t GetSegment() const;
+
+        /** @brief Control loop, while RUNNING: goes to COMPLETED once the clock is past the end of the profile; returns whether it did */
+        bool CompleteIfFinished();
+
+        /** @brief Heater PID, gain scheduled by PID_Schedule and reset by the transitions listed in SPECIFICATION.md §3.4 */
+        [[nodiscard]] Control::FloatGainScheduledPid& GetPid();
+
+        /** @brief Kiln model for the PID feedforward, restarted from the Kiln_* preferences when they change */
+        [[nodiscard]] Control::ThermalEstimator& GetThermalEstimator();
+
+        /** @brief Filtered kiln temperature and rate, for the PID, State.temp_change and limit checks */
+        [[nodiscard]] Control::TemperatureFilter& GetTemperatureFilter();
+
+        /** @brief START_AUTOTUNE: relay autotune around aSetpoint, within MAX_Temperature and Thermal_Runaway */
+        Result StartAutotune(float aSetpoint);
+
+        /** @brief Feed the autotune a reading; returns the heat percent, 0 outside AUTOTUNING.
+         * Goes back to IDLE when the gains are ready and to ERROR if the autotune fails.
+         */
+        float UpdateAutotune(float aKilnTemperature, std::chrono::milliseconds aElapsed);
+
+        /** @brief Status, and after a successful autotune the proposed gains */
+        [[nodiscard]] const Control::RelayAutotuner& GetAutotuner() const;
+
+        /** @brief Control loop, once a sample: aSnapshot with the current state and program name filled in, for the broadcast task */
+        void PublishState(StateSnapshot aSnapshot);
+
+        /** @brief The last PublishState(), readable from any task without a lock */
+        [[nodiscard]] const Sync::Snapshot<StateSnapshot>& GetStateSnapshot() const;
+
+        /** @brief Control::LoopScheduler safety miss handler: a late safety stage means the heater is unsupervised */
+        void OnSafetyDeadlineMissed(etl::string_view aStage);
+
+        /** @brief Safety::SafetyMonitor trip handler: the monitor has already forced the heater off; aReport becomes the error message */
+        void OnSafetyTrip(const Safety::FaultReport& aReport);
+
+        /** @brief State.error_message: why the furnace went to ERROR, empty in any other state */
+        [[nodiscard]] const Log::LogMessage& GetErrorMessage() const;
+
     protected:
         [[nodiscard]] const etl::string_view& GetLogDomain() override
         {
@@ -34,14 +120,33 @@ namespace HeatTreatFurnace::Furnace
         };
 
     private:
+        [[nodiscard]] static bool PrivResetsPid(StateId aState);
+
+        /** @brief Keep the program offset still outside RUNNING */
+        void PrivTimeProgram(StateId aFrom, StateId aTo);
+
         etl::map<StateId, BaseState&, NUM_STATES> myStates;
+        StateMap myOwnedStates;
 
         // static StateMap CreateDefaultStates(Furnace* furnace);
         StateId myCurrentState;
         std::unique_ptr<Profile> myLoadedProfile;
+        std::unique_ptr<Program::ProfileTimeline> myLoadedTimeline;
+        Program::TimelinePosition myStartPosition; // the setpoint follows its re-anchored ramp for the whole run
+        Time::Clock& myClock;
+        std::chrono::microseconds myProgramStart{0}; // Clock time at offset 0, moved on by each pause
+        std::chrono::microseconds myProgramStopped{0}; // Clock time the program last left RUNNING
 
         //The Action would have asked that the loaded profile be replaced with this, which will happen when the Load() transition happens.
         std::unique_ptr<Profile> myProfileToLoad;
+        Program::ProgramValidator myProfileValidator;
+        Control::FloatGainScheduledPid myPid;
+        Control::RelayAutotuner myAutotuner;
+        Control::ThermalEstimator myThermalEstimator;
+        Control::TemperatureFilter myTemperatureFilter;
+        Preferences myPreferences;
+        Sync::Snapshot<StateSnapshot> myStateSnapshot;
+        Log::LogMessage myErrorMessage;
         Log::LogService& myLog;
 
         FurnaceState& myFurnace;
@@ -55,20 +160,22 @@ namespace HeatTreatFurnace::Furnace
         CancelledState myCancelledState;
         ErrorState myErrorState;
         WaitingForTempState myWaitingForTempState;
+        AutotuningState myAutotuningState;
 
         static constexpr etl::string_view myDomain = "StateMachine";
 
         const etl::map<StateId, etl::set<StateId, NUM_STATES>, NUM_STATES> myValidTransitions = {
-            {StateId::IDLE, {StateId::LOADED, StateId::ERROR}},
+            {StateId::IDLE, {StateId::LOADED, StateId::AUTOTUNING, StateId::ERROR}},
             {StateId::LOADED, {StateId::IDLE, StateId::RUNNING, StateId::ERROR}},
             {StateId::RUNNING,
-             {StateId::PAUSED, StateId::COMPLETED, StateId::CANCELLED, StateId::ERROR}},
+             {StateId::PAUSED, StateId::COMPLETED, StateId::CANCELLED, StateId::ERROR, StateId::WAITING_FOR_TEMP}},
             {StateId::PAUSED, {StateId::RUNNING, StateId::CANCELLED, StateId::ERROR}},
             {StateId::COMPLETED, {StateId::IDLE, StateId::LOADED, StateId::ERROR}},
             {StateId::CANCELLED, {StateId::IDLE, StateId::LOADED, StateId::ERROR}},
             {StateId::ERROR, {StateId::IDLE, StateId::LOADED}},
             {StateId::WAITING_FOR_TEMP,
-             {StateId::RUNNING, StateId::PAUSED, StateId::ERROR}}
+             {StateId::RUNNING, StateId::PAUSED, StateId::ERROR}},
+            {StateId::AUTOTUNING, {StateId::IDLE, StateId::ERROR}}
         };
     };
 } //namespace HeatTreatFurnace::Furnace
@@ -0,0 +1,55 @@
+#ifndef HEAT_TREAT_FURNACE_STATE_SNAPSHOT_HPP
+#define HEAT_TREAT_FURNACE_STATE_SNAPSHOT_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include "State.hpp"
+
+namespace HeatTreatFurnace::Furnace
+{
+    /**
+     * @brief What a State broadcast reports, as of one control loop sample (SPECIFICATION.md §9.2).
+     *
+     * Fixed size and trivially copyable, so the control loop can publish it through a Sync::Snapshot
+     * for the broadcast task to encode. The error message isn't here; it changes on a transition,
+     * not every sample, and is read from the state machine then.
+     */
+    struct StateSnapshot
+    {
+        static constexpr size_t MAX_PROGRAM_NAME_LENGTH = 31;
+
+        StateId state = StateId::IDLE;
+        std::array<char, MAX_PROGRAM_NAME_LENGTH + 1> programName{}; // NUL terminated
+        float kilnTemp = 0.0f;
+        float setTemp = 0.0f;
+        float envTemp = 0.0f;
+        float caseTemp = 0.0f;
+        uint8_t heatPercent = 0;
+        float tempChange = 0.0f; // °C/hour
+        int32_t segment = -1; // 0-based, -1 when no program is running
+        int64_t progStartMs = 0;
+        int64_t progEndMs = 0;
+        int64_t currTimeMs = 0;
+
+        /** @brief Truncated to MAX_PROGRAM_NAME_LENGTH */
+        void SetProgramName(std::string_view aName)
+        {
+            const size_t length = std::min(aName.size(), MAX_PROGRAM_NAME_LENGTH);
+            std::copy_n(aName.begin(), length, programName.begin());
+            programName[length] = '\0';
+        }
+
+        [[nodiscard]] std::string_view ProgramName() const
+        {
+            return programName.data();
+        }
+    };
+
+    static_assert(std::is_trivially_copyable_v<StateSnapshot>, "published through a Sync::Snapshot");
+} //namespace HeatTreatFurnace::Furnace
+
+#endif //HEAT_TREAT_FURNACE_STATE_SNAPSHOT_HPP
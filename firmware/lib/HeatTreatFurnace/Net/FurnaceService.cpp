@@ -0,0 +1,519 @@
+#include "FurnaceService.hpp"
+
+#include <algorithm>
+#include <format>
+#include <memory>
+#include <vector>
+
+#include "Furnace/Profile.hpp"
+#include "Program/ProfileSampler.hpp"
+
+namespace HeatTreatFurnace::Net
+{
+    namespace
+    {
+        // The verifier passes an envelope with a message type but no message table
+        constexpr std::string_view MISSING_BODY = "Message has no body";
+
+        ::Furnace::ProgramStatus Status(Furnace::StateId aState)
+        {
+            switch (aState)
+            {
+            case Furnace::StateId::LOADED:
+                return ::Furnace::ProgramStatus::Ready;
+            case Furnace::StateId::RUNNING:
+                return ::Furnace::ProgramStatus::Running;
+            case Furnace::StateId::PAUSED:
+                return ::Furnace::ProgramStatus::Paused;
+            case Furnace::StateId::CANCELLED:
+                return ::Furnace::ProgramStatus::Stopped;
+            case Furnace::StateId::ERROR:
+                return ::Furnace::ProgramStatus::Error;
+            case Furnace::StateId::WAITING_FOR_TEMP:
+                return ::Furnace::ProgramStatus::WaitingThreshold;
+            case Furnace::StateId::COMPLETED:
+                return ::Furnace::ProgramStatus::Finished;
+            case Furnace::StateId::AUTOTUNING:
+                return ::Furnace::ProgramStatus::Autotuning;
+            default:
+                return ::Furnace::ProgramStatus::None;
+            }
+        }
+
+        std::string_view ThermocoupleLetter(Sensor::ThermocoupleType aType)
+        {
+            switch (aType)
+            {
+            case Sensor::ThermocoupleType::N:
+                return "N";
+            case Sensor::ThermocoupleType::S:
+                return "S";
+            case Sensor::ThermocoupleType::R:
+                return "R";
+            default:
+                return "K";
+            }
+        }
+
+        std::string_view Text(const flatbuffers::String* aString)
+        {
+            return aString != nullptr ? std::string_view(aString->c_str(), aString->size()) : std::string_view();
+        }
+
+        std::string_view Text(const Log::LogMessage& aMessage)
+        {
+            return {aMessage.data(), aMessage.size()};
+        }
+    }
+
+    FurnaceService::FurnaceService(Furnace::StateMachine& aStateMachine, Program::ProgramStore& aPrograms, const Sensor::SensorPublisher& aSensors,
+                                   Safety::SafetyMonitor& aSafety, Log::LogService& aLog) :
+        Loggable(aLog),
+        myStateMachine(aStateMachine),
+        myPrograms(aPrograms),
+        mySensors(aSensors),
+        mySafety(aSafety)
+    {
+    }
+
+    void FurnaceService::SetPreferences(const Furnace::Preferences& aPreferences)
+    {
+        myPreferences = aPreferences;
+    }
+
+    void FurnaceService::SetEpoch(std::chrono::milliseconds aUnixTime)
+    {
+        myEpoch = aUnixTime;
+    }
+
+    void FurnaceService::SetTimeScaleHandler(TimeScaleHandler aHandler)
+    {
+        myTimeScaleHandler = aHandler;
+    }
+
+    void FurnaceService::Handle(std::span<const uint8_t> aMessage, flatbuffers::FlatBufferBuilder& aBuilder)
+    {
+        aBuilder.Clear();
+        flatbuffers::Verifier verifier(aMessage.data(), aMessage.size());
+        if (!verifier.VerifyBuffer<::Furnace::ClientEnvelope>(nullptr))
+        {
+            PrivError(0, ERROR_BAD_REQUEST, "Malformed message", aBuilder);
+            return;
+        }
+
+        const ::Furnace::ClientEnvelope* envelope = flatbuffers::GetRoot<::Furnace::ClientEnvelope>(aMessage.data());
+        const uint32_t id = envelope->request_id();
+        switch (envelope->message_type())
+        {
+        case ::Furnace::ClientMessage::StartCommand:
+        {
+            const ::Furnace::StartCommand* command = envelope->message_as_StartCommand();
+            if (command == nullptr)
+            {
+                PrivError(id, ERROR_BAD_REQUEST, MISSING_BODY, aBuilder);
+                return;
+            }
+            PrivAck(id, PrivStart(*command), aBuilder);
+            return;
+        }
+        case ::Furnace::ClientMessage::PauseCommand:
+            PrivAck(id, PrivTransition(Furnace::StateId::PAUSED, "pause"), aBuilder);
+            return;
+        case ::Furnace::ClientMessage::ResumeCommand:
+            // RUNNING is also where a loaded program starts, which only StartCommand should do
+            PrivAck(id, myStateMachine.GetState() == Furnace::StateId::PAUSED ? PrivTransition(Furnace::StateId::RUNNING, "resume")
+                                                                               : Furnace::Result{false, "Nothing is paused"}, aBuilder);
+            return;
+        case ::Furnace::ClientMessage::StopCommand:
+            PrivAck(id, PrivStop(), aBuilder);
+            return;
+        case ::Furnace::ClientMessage::LoadCommand:
+        {
+            const ::Furnace::LoadCommand* command = envelope->message_as_LoadCommand();
+            if (command == nullptr || command->program() == nullptr)
+            {
+                PrivError(id, ERROR_BAD_REQUEST, "Missing program", aBuilder);
+                return;
+            }
+            PrivAck(id, PrivLoad(Text(command->program())), aBuilder);
+            return;
+        }
+        case ::Furnace::ClientMessage::UnloadCommand:
+            PrivAck(id, PrivTransition(Furnace::StateId::IDLE, "unload"), aBuilder);
+            return;
+        case ::Furnace::ClientMessage::SetTempCommand:
+            // §7's manual hold has no state in the firmware's state machine yet
+            PrivAck(id, {false, "Manual temperature control isn't supported"}, aBuilder);
+            return;
+        case ::Furnace::ClientMessage::ClearErrorCommand:
+            PrivAck(id, PrivClearError(), aBuilder);
+            return;
+        case ::Furnace::ClientMessage::SetTimeScaleCommand:
+        {
+            if (!myTimeScaleHandler.is_valid())
+            {
+                PrivAck(id, {false, "Time scale is simulator only"}, aBuilder);
+                return;
+            }
+            const ::Furnace::SetTimeScaleCommand* command = envelope->message_as_SetTimeScaleCommand();
+            if (command == nullptr)
+            {
+                PrivError(id, ERROR_BAD_REQUEST, MISSING_BODY, aBuilder);
+                return;
+            }
+            const float timeScale = command->time_scale();
+            const Furnace::Result res = myTimeScaleHandler(timeScale);
+            if (res)
+            {
+                myTimeScale = timeScale;
+            }
+            PrivAck(id, res, aBuilder);
+            return;
+        }
+        case ::Furnace::ClientMessage::AutotuneCommand:
+        {
+            const ::Furnace::AutotuneCommand* command = envelope->message_as_AutotuneCommand();
+            if (command == nullptr)
+            {
+                PrivError(id, ERROR_BAD_REQUEST, MISSING_BODY, aBuilder);
+                return;
+            }
+            PrivAck(id, myStateMachine.StartAutotune(command->setpoint()), aBuilder);
+            return;
+        }
+        case ::Furnace::ClientMessage::HistoryRequest:
+        {
+            // No history is kept yet, so there are no points to give
+            const auto history = ::Furnace::CreateHistoryResponse(aBuilder, myPreferences.logWindowS * 1000);
+            ::Furnace::FinishServerEnvelopeBuffer(aBuilder, ::Furnace::CreateServerEnvelope(aBuilder, id, ::Furnace::ServerMessage::HistoryResponse, history.Union()));
+            return;
+        }
+        case ::Furnace::ClientMessage::ListProgramsRequest:
+            PrivListPrograms(id, aBuilder);
+            return;
+        case ::Furnace::ClientMessage::GetProgramRequest:
+        {
+            const ::Furnace::GetProgramRequest* request = envelope->message_as_GetProgramRequest();
+            if (request == nullptr || request->name() == nullptr)
+            {
+                PrivError(id, ERROR_BAD_REQUEST, "Missing program name", aBuilder);
+                return;
+            }
+            PrivGetProgram(id, *request, aBuilder);
+            return;
+        }
+        case ::Furnace::ClientMessage::SaveProgramRequest:
+        {
+            const ::Furnace::SaveProgramRequest* request = envelope->message_as_SaveProgramRequest();
+            if (request == nullptr || request->name() == nullptr || request->content() == nullptr)
+            {
+                PrivError(id, ERROR_BAD_REQUEST, "Missing program name or content", aBuilder);
+                return;
+            }
+            PrivAck(id, myPrograms.Save(Text(request->name()), Text(request->content())), aBuilder);
+            return;
+        }
+        case ::Furnace::ClientMessage::DeleteProgramRequest:
+        {
+            const ::Furnace::DeleteProgramRequest* request = envelope->message_as_DeleteProgramRequest();
+            if (request == nullptr || request->name() == nullptr)
+            {
+                PrivError(id, ERROR_BAD_REQUEST, "Missing program name", aBuilder);
+                return;
+            }
+            const Furnace::Result res = myPrograms.Remove(Text(request->name()));
+            if (res)
+            {
+                PrivAck(id, res, aBuilder);
+            }
+            else
+            {
+                PrivError(id, ERROR_NOT_FOUND, Text(res.message), aBuilder);
+            }
+            return;
+        }
+        case ::Furnace::ClientMessage::GetPreferencesRequest:
+        {
+            const auto preferences = ::Furnace::CreatePreferencesResponse(aBuilder, aBuilder.CreateString(PrivPreferencesJson()));
+            ::Furnace::FinishServerEnvelopeBuffer(aBuilder, ::Furnace::CreateServerEnvelope(aBuilder, id, ::Furnace::ServerMessage::PreferencesResponse, preferences.Union()));
+            return;
+        }
+        case ::Furnace::ClientMessage::SavePreferencesRequest:
+            PrivAck(id, {false, "Preferences can't be changed from here"}, aBuilder);
+            return;
+        case ::Furnace::ClientMessage::GetDebugInfoRequest:
+        {
+            const auto debugInfo = ::Furnace::CreateDebugInfoResponse(aBuilder, aBuilder.CreateString(PrivDebugInfoJson()));
+            ::Furnace::FinishServerEnvelopeBuffer(aBuilder, ::Furnace::CreateServerEnvelope(aBuilder, id, ::Furnace::ServerMessage::DebugInfoResponse, debugInfo.Union()));
+            return;
+        }
+        case ::Furnace::ClientMessage::ListLogsRequest:
+        {
+            const auto logs = ::Furnace::CreateLogListResponse(aBuilder);
+            ::Furnace::FinishServerEnvelopeBuffer(aBuilder, ::Furnace::CreateServerEnvelope(aBuilder, id, ::Furnace::ServerMessage::LogListResponse, logs.Union()));
+            return;
+        }
+        case ::Furnace::ClientMessage::GetLogRequest:
+            PrivError(id, ERROR_NOT_FOUND, "Log not found", aBuilder);
+            return;
+        case ::Furnace::ClientMessage::GetProgramPreviewRequest:
+        {
+            const ::Furnace::GetProgramPreviewRequest* request = envelope->message_as_GetProgramPreviewRequest();
+            if (request == nullptr || request->name() == nullptr)
+            {
+                PrivError(id, ERROR_BAD_REQUEST, "Missing program name", aBuilder);
+                return;
+            }
+            PrivPreviewProgram(id, *request, aBuilder);
+            return;
+        }
+        default:
+            PrivError(id, ERROR_BAD_REQUEST, "Unknown message type", aBuilder);
+            return;
+        }
+    }
+
+    void FurnaceService::EncodeState(flatbuffers::FlatBufferBuilder& aBuilder) const
+    {
+        aBuilder.Clear();
+        // The state and program from the state machine itself, which a command may have just changed;
+        // the readings and times from the control loop's last publish
+        const Furnace::StateSnapshot snapshot = myStateMachine.GetStateSnapshot().Read();
+        const Furnace::StateId current = myStateMachine.GetState();
+        const Furnace::Profile* profile = myStateMachine.GetProfile();
+
+        flatbuffers::Offset<flatbuffers::String> programName;
+        flatbuffers::Offset<flatbuffers::String> step;
+        if (profile != nullptr)
+        {
+            programName = aBuilder.CreateString(profile->Name());
+            step = aBuilder.CreateString(std::format("{} of {}", std::max(snapshot.segment + 1, 0), profile->SegmentCount()));
+        }
+        flatbuffers::Offset<flatbuffers::String> errorMessage;
+        if (current == Furnace::StateId::ERROR)
+        {
+            errorMessage = aBuilder.CreateString(Text(myStateMachine.GetErrorMessage()));
+        }
+
+        // Program times are 0 until there is a program to time
+        const auto unixTime = [this](int64_t aClockMs)
+        {
+            return aClockMs != 0 ? aClockMs + myEpoch.count() : 0;
+        };
+        const auto state = ::Furnace::CreateState(aBuilder, Status(current), programName, snapshot.kilnTemp, snapshot.setTemp,
+            snapshot.envTemp, snapshot.caseTemp, snapshot.heatPercent, snapshot.tempChange, step, unixTime(snapshot.progStartMs),
+            unixTime(snapshot.progEndMs), snapshot.currTimeMs + myEpoch.count(), errorMessage, myTimeScaleHandler.is_valid(), myTimeScale);
+        ::Furnace::FinishServerEnvelopeBuffer(aBuilder, ::Furnace::CreateServerEnvelope(aBuilder, 0, ::Furnace::ServerMessage::State, state.Union()));
+    }
+
+    Furnace::Result FurnaceService::PrivStart(const ::Furnace::StartCommand& aCommand)
+    {
+        float kilnTemperature = 0.0f;
+        Furnace::Result res = PrivKilnTemperature(kilnTemperature);
+        if (!res)
+        {
+            return res;
+        }
+
+        // A finished or stopped program is still loaded, and starts again from where the command says
+        const Furnace::StateId state = myStateMachine.GetState();
+        if ((state == Furnace::StateId::COMPLETED || state == Furnace::StateId::CANCELLED) && myStateMachine.GetTimeline() != nullptr)
+        {
+            res = PrivTransition(Furnace::StateId::LOADED, "start");
+            if (!res)
+            {
+                return res;
+            }
+        }
+        return myStateMachine.StartProfile(aCommand.segment(), aCommand.minute(), kilnTemperature);
+    }
+
+    Furnace::Result FurnaceService::PrivLoad(std::string_view aName)
+    {
+        float kilnTemperature = 0.0f;
+        Furnace::Result res = PrivKilnTemperature(kilnTemperature);
+        if (!res)
+        {
+            return res;
+        }
+        if (myStateMachine.GetState() == Furnace::StateId::ERROR)
+        {
+            return {false, "Clear the error first"};
+        }
+
+        auto profile = std::make_unique<Furnace::Profile>();
+        res = myPrograms.Load(aName, *profile);
+        if (!res)
+        {
+            return res;
+        }
+        // Loading over a loaded program replaces it
+        if (myStateMachine.GetState() == Furnace::StateId::LOADED)
+        {
+            res = PrivTransition(Furnace::StateId::IDLE, "load");
+            if (!res)
+            {
+                return res;
+            }
+        }
+        return myStateMachine.LoadProfile(std::move(profile), kilnTemperature);
+    }
+
+    Furnace::Result FurnaceService::PrivStop()
+    {
+        switch (myStateMachine.GetState())
+        {
+        case Furnace::StateId::AUTOTUNING:
+            return PrivTransition(Furnace::StateId::IDLE, "stop");
+        case Furnace::StateId::RUNNING:
+        case Furnace::StateId::PAUSED:
+        case Furnace::StateId::WAITING_FOR_TEMP:
+            return PrivTransition(Furnace::StateId::CANCELLED, "stop");
+        default:
+            return {false, "Nothing is running"};
+        }
+    }
+
+    Furnace::Result FurnaceService::PrivClearError()
+    {
+        if (myStateMachine.GetState() != Furnace::StateId::ERROR)
+        {
+            return {true, ""};
+        }
+        // The heater stays off until the monitor agrees the fault has gone
+        const Furnace::Result res = mySafety.Reset();
+        if (!res)
+        {
+            return res;
+        }
+        return PrivTransition(myStateMachine.GetTimeline() != nullptr ? Furnace::StateId::LOADED : Furnace::StateId::IDLE, "clear the error");
+    }
+
+    Furnace::Result FurnaceService::PrivTransition(Furnace::StateId aTo, std::string_view aAction)
+    {
+        if (!myStateMachine.TransitionTo(aTo))
+        {
+            Log::LogMessage message = std::format("Can't {} in this state", aAction);
+            return {false, message};
+        }
+        return {true, ""};
+    }
+
+    Furnace::Result FurnaceService::PrivKilnTemperature(float& aTemperatureOut) const
+    {
+        const Sensor::SensorReadings readings = mySensors.Latest();
+        if (readings.sequence == 0 || !readings.IsKilnValid())
+        {
+            return {false, "No kiln reading to start from"};
+        }
+        aTemperatureOut = readings.kilnTemperature;
+        return {true, ""};
+    }
+
+    void FurnaceService::PrivListPrograms(uint32_t aRequestId, flatbuffers::FlatBufferBuilder& aBuilder)
+    {
+        std::vector<Program::StoredProgram> programs;
+        const Furnace::Result res = myPrograms.List(programs);
+        if (!res)
+        {
+            PrivError(aRequestId, ERROR_NOT_FOUND, Text(res.message), aBuilder);
+            return;
+        }
+
+        std::vector<flatbuffers::Offset<::Furnace::ProgramInfo>> infos;
+        infos.reserve(programs.size());
+        std::string description;
+        for (const Program::StoredProgram& program : programs)
+        {
+            description.clear();
+            myPrograms.Describe(program.name, description);
+            infos.push_back(::Furnace::CreateProgramInfo(aBuilder, aBuilder.CreateString(program.name), static_cast<uint32_t>(program.size),
+                aBuilder.CreateString(description)));
+        }
+        const auto list = ::Furnace::CreateProgramListResponse(aBuilder, aBuilder.CreateVector(infos));
+        ::Furnace::FinishServerEnvelopeBuffer(aBuilder, ::Furnace::CreateServerEnvelope(aBuilder, aRequestId, ::Furnace::ServerMessage::ProgramListResponse, list.Union()));
+    }
+
+    void FurnaceService::PrivGetProgram(uint32_t aRequestId, const ::Furnace::GetProgramRequest& aRequest, flatbuffers::FlatBufferBuilder& aBuilder)
+    {
+        const std::string_view name = Text(aRequest.name());
+        std::string json;
+        const Furnace::Result res = myPrograms.Read(name, json);
+        if (!res)
+        {
+            PrivError(aRequestId, ERROR_NOT_FOUND, Text(res.message), aBuilder);
+            return;
+        }
+        const auto content = ::Furnace::CreateProgramContentResponse(aBuilder, aBuilder.CreateString(name.data(), name.size()), aBuilder.CreateString(json));
+        ::Furnace::FinishServerEnvelopeBuffer(aBuilder, ::Furnace::CreateServerEnvelope(aBuilder, aRequestId, ::Furnace::ServerMessage::ProgramContentResponse, content.Union()));
+    }
+
+    void FurnaceService::PrivPreviewProgram(uint32_t aRequestId, const ::Furnace::GetProgramPreviewRequest& aRequest, flatbuffers::FlatBufferBuilder& aBuilder)
+    {
+        const std::string_view name = Text(aRequest.name());
+        Furnace::Profile profile;
+        const Furnace::Result res = myPrograms.Load(name, profile);
+        if (!res)
+        {
+            PrivError(aRequestId, ERROR_NOT_FOUND, Text(res.message), aBuilder);
+            return;
+        }
+
+        // Drawn from where the kiln is now, as it would fire; ambient if there's no reading
+        float startTemperature = myPreferences.ambientTemperature;
+        PrivKilnTemperature(startTemperature);
+        std::vector<float> points;
+        Program::ProfileSampler::Sample(profile, startTemperature, aRequest.max_points(), points);
+        const auto preview = Program::ProfileSampler::Encode(aBuilder, name, points);
+        ::Furnace::FinishServerEnvelopeBuffer(aBuilder, ::Furnace::CreateServerEnvelope(aBuilder, aRequestId, ::Furnace::ServerMessage::ProgramPreviewResponse, preview.Union()));
+    }
+
+    std::string FurnaceService::PrivPreferencesJson() const
+    {
+        const Furnace::Preferences& p = myPreferences;
+        std::string schedule;
+        for (const Furnace::PidBreakpoint& breakpoint : p.pidSchedule)
+        {
+            schedule += std::format("{}{}:{}:{}:{}", schedule.empty() ? "" : ",", breakpoint.temperature, breakpoint.kp, breakpoint.ki, breakpoint.kd);
+        }
+
+        // Appendix A's names, as the frontend's preferences page edits them
+        std::string json = std::format(R"({{"PID_Kp":{},"PID_Ki":{},"PID_Kd":{},"PID_Schedule":"{}","PID_Window":{},"SSR_Min_On":{},"SSR_Min_Off":{},)",
+            p.pidKp, p.pidKi, p.pidKd, schedule, p.pidWindowMs, p.ssrMinOnMs, p.ssrMinOffMs);
+        json += std::format(R"("MIN_Temperature":{},"MAX_Temperature":{},"MAX_Housing_Temperature":{},)",
+            p.minTemperature, p.maxTemperature, p.maxHousingTemperature);
+        json += std::format(R"("Thermal_Runaway":{},"LOG_Window":{},"MAX31855_Error_Grace_Count":{},"Thermocouple_Type":"{}",)",
+            p.thermalRunaway, p.logWindowS, p.max31855ErrorGraceCount, ThermocoupleLetter(p.thermocoupleType));
+        json += std::format(R"("MAX_Heating_Rate":{},"MAX_Program_Hours":{},"MAX_Program_Energy":{},)",
+            p.maxHeatingRate, p.maxProgramHours, p.maxProgramEnergyKWh);
+        json += std::format(R"("Kiln_Heater_Power":{},"Kiln_Thermal_Mass":{},"Kiln_Loss_Coefficient":{},"Kiln_Ambient_Temperature":{}}})",
+            p.heaterPowerW, p.thermalMassJPerC, p.lossWPerC, p.ambientTemperature);
+        return json;
+    }
+
+    std::string FurnaceService::PrivDebugInfoJson() const
+    {
+        const Program::ProgramCache::Stats& cache = myPrograms.GetCacheStats();
+        return std::format(R"({{"VERSION":"Furnace host build{}","PROGRAM_CACHE_HITS":"{}","PROGRAM_CACHE_MISSES":"{}","PROGRAM_CACHE_EVICTIONS":"{}",)"
+            R"("PROGRAM_CACHE_ENTRIES":"{}","PROGRAM_CACHE_BYTES":"{}","SAFETY_FAULTS":"{}"}})",
+            myTimeScaleHandler.is_valid() ? " (Simulator)" : "", cache.hits, cache.misses, cache.evictions, cache.entries, cache.bytes,
+            mySafety.Faults().value<uint32_t>());
+    }
+
+    void FurnaceService::PrivAck(uint32_t aRequestId, const Furnace::Result& aResult, flatbuffers::FlatBufferBuilder& aBuilder)
+    {
+        flatbuffers::Offset<flatbuffers::String> error;
+        if (!aResult.success)
+        {
+            error = aBuilder.CreateString(aResult.message.data(), aResult.message.size());
+        }
+        const auto ack = ::Furnace::CreateAck(aBuilder, aResult.success, aRequestId, error);
+        ::Furnace::FinishServerEnvelopeBuffer(aBuilder, ::Furnace::CreateServerEnvelope(aBuilder, aRequestId, ::Furnace::ServerMessage::Ack, ack.Union()));
+    }
+
+    void FurnaceService::PrivError(uint32_t aRequestId, int32_t aCode, std::string_view aMessage, flatbuffers::FlatBufferBuilder& aBuilder)
+    {
+        const auto error = ::Furnace::CreateError(aBuilder, aCode, aBuilder.CreateString(aMessage.data(), aMessage.size()));
+        ::Furnace::FinishServerEnvelopeBuffer(aBuilder, ::Furnace::CreateServerEnvelope(aBuilder, aRequestId, ::Furnace::ServerMessage::Error, error.Union()));
+    }
+} //namespace HeatTreatFurnace::Net
@@ -0,0 +1,97 @@
+#ifndef HEAT_TREAT_FURNACE_FURNACE_SERVICE_HPP
+#define HEAT_TREAT_FURNACE_FURNACE_SERVICE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include <flatbuffers/flatbuffers.h>
+#include "furnace_generated.h"
+#include "etl/delegate.h"
+#include "Furnace/Preferences.hpp"
+#include "Furnace/Result.hpp"
+#include "Furnace/StateMachine.hpp"
+#include "Log/LogService.hpp"
+#include "Program/ProgramStore.hpp"
+#include "Safety/SafetyMonitor.hpp"
+#include "Sensor/SensorPublisher.hpp"
+
+namespace HeatTreatFurnace::Net
+{
+    /**
+     * @brief The controller's side of proto/furnace.fbs: ClientEnvelope in, ServerEnvelope out (SPECIFICATION.md §9).
+     *
+     * Knows nothing of the transport, so the same code answers the frontend over the ESP32's WebSocket
+     * and the host build's. Every request gets exactly one reply carrying its request_id: an Ack for a
+     * command, the matching response for a request, or an Error (400 for a message it can't read, 404
+     * for a program that isn't there). State broadcasts have request_id 0.
+     *
+     * Commands go straight to the state machine, so Handle() must run on the task that owns it.
+     */
+    class FurnaceService : public Log::Loggable
+    {
+    public:
+        /** @brief SetTimeScaleCommand, simulator only: speed the clock up by aTimeScale, or refuse */
+        using TimeScaleHandler = etl::delegate<Furnace::Result(float aTimeScale)>;
+
+        static constexpr int32_t ERROR_BAD_REQUEST = 400;
+        static constexpr int32_t ERROR_NOT_FOUND = 404;
+
+        FurnaceService(Furnace::StateMachine& aStateMachine, Program::ProgramStore& aPrograms, const Sensor::SensorPublisher& aSensors,
+                       Safety::SafetyMonitor& aSafety, Log::LogService& aLog);
+        ~FurnaceService() override = default;
+
+        /** @brief What GetPreferencesRequest reports */
+        void SetPreferences(const Furnace::Preferences& aPreferences);
+
+        /** @brief Unix time at clock 0, added to the State times, which are clock times */
+        void SetEpoch(std::chrono::milliseconds aUnixTime);
+
+        /** @brief Marks State as from a simulator, and accepts SetTimeScaleCommand */
+        void SetTimeScaleHandler(TimeScaleHandler aHandler);
+
+        /** @brief One ClientEnvelope, replied to as a finished ServerEnvelope in aBuilder */
+        void Handle(std::span<const uint8_t> aMessage, flatbuffers::FlatBufferBuilder& aBuilder);
+
+        /** @brief The State broadcast, as a finished ServerEnvelope in aBuilder */
+        void EncodeState(flatbuffers::FlatBufferBuilder& aBuilder) const;
+
+    protected:
+        [[nodiscard]] const etl::string_view& GetLogDomain() override
+        {
+            return myDomain;
+        };
+
+    private:
+        Furnace::Result PrivStart(const ::Furnace::StartCommand& aCommand);
+        Furnace::Result PrivLoad(std::string_view aName);
+        Furnace::Result PrivStop();
+        Furnace::Result PrivClearError();
+        Furnace::Result PrivTransition(Furnace::StateId aTo, std::string_view aAction);
+        Furnace::Result PrivKilnTemperature(float& aTemperatureOut) const;
+
+        void PrivListPrograms(uint32_t aRequestId, flatbuffers::FlatBufferBuilder& aBuilder);
+        void PrivGetProgram(uint32_t aRequestId, const ::Furnace::GetProgramRequest& aRequest, flatbuffers::FlatBufferBuilder& aBuilder);
+        void PrivPreviewProgram(uint32_t aRequestId, const ::Furnace::GetProgramPreviewRequest& aRequest, flatbuffers::FlatBufferBuilder& aBuilder);
+
+        [[nodiscard]] std::string PrivPreferencesJson() const;
+        [[nodiscard]] std::string PrivDebugInfoJson() const;
+
+        static void PrivAck(uint32_t aRequestId, const Furnace::Result& aResult, flatbuffers::FlatBufferBuilder& aBuilder);
+        static void PrivError(uint32_t aRequestId, int32_t aCode, std::string_view aMessage, flatbuffers::FlatBufferBuilder& aBuilder);
+
+        Furnace::StateMachine& myStateMachine;
+        Program::ProgramStore& myPrograms;
+        const Sensor::SensorPublisher& mySensors;
+        Safety::SafetyMonitor& mySafety;
+        Furnace::Preferences myPreferences;
+        std::chrono::milliseconds myEpoch{0};
+        TimeScaleHandler myTimeScaleHandler;
+        float myTimeScale = 1.0f;
+
+        static constexpr etl::string_view myDomain = "FurnaceService";
+    };
+} //namespace HeatTreatFurnace::Net
+
+#endif //HEAT_TREAT_FURNACE_FURNACE_SERVICE_HPP
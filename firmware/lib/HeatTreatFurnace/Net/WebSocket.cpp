@@ -0,0 +1,799 @@
+#include "WebSocket.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace HeatTreatFurnace::Net
+{
+    namespace
+    {
+        constexpr std::string_view WEB_SOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        constexpr size_t READ_CHUNK = 64 * 1024;
+
+        bool EqualsIgnoreCase(std::string_view aLeft, std::string_view aRight)
+        {
+            return std::ranges::equal(aLeft, aRight, [](char aL, char aR)
+            {
+                return std::tolower(static_cast<unsigned char>(aL)) == std::tolower(static_cast<unsigned char>(aR));
+            });
+        }
+
+        bool ContainsToken(std::string_view aList, std::string_view aToken)
+        {
+            // "keep-alive, Upgrade"
+            while (!aList.empty())
+            {
+                const size_t comma = aList.find(',');
+                std::string_view item = aList.substr(0, comma);
+                while (!item.empty() && item.front() == ' ')
+                {
+                    item.remove_prefix(1);
+                }
+                while (!item.empty() && item.back() == ' ')
+                {
+                    item.remove_suffix(1);
+                }
+                if (EqualsIgnoreCase(item, aToken))
+                {
+                    return true;
+                }
+                aList = comma == std::string_view::npos ? std::string_view() : aList.substr(comma + 1);
+            }
+            return false;
+        }
+
+        std::string_view ContentType(const std::filesystem::path& aFile)
+        {
+            const std::string extension = aFile.extension().string();
+            if (extension == ".html")
+            {
+                return "text/html; charset=utf-8";
+            }
+            if (extension == ".js")
+            {
+                return "text/javascript";
+            }
+            if (extension == ".css")
+            {
+                return "text/css";
+            }
+            if (extension == ".json")
+            {
+                return "application/json";
+            }
+            if (extension == ".svg")
+            {
+                return "image/svg+xml";
+            }
+            if (extension == ".png")
+            {
+                return "image/png";
+            }
+            if (extension == ".ico")
+            {
+                return "image/x-icon";
+            }
+            if (extension == ".woff2")
+            {
+                return "font/woff2";
+            }
+            return "application/octet-stream";
+        }
+    }
+
+    std::string WebSocketCodec::AcceptKey(std::string_view aClientKey)
+    {
+        std::string key(aClientKey);
+        key += WEB_SOCKET_GUID;
+        const std::array<uint8_t, 20> digest = Sha1({reinterpret_cast<const uint8_t*>(key.data()), key.size()});
+        return Base64(digest);
+    }
+
+    void WebSocketCodec::AppendFrame(std::vector<uint8_t>& aOut, Opcode anOpcode, std::span<const uint8_t> aPayload, std::optional<uint32_t> aMask)
+    {
+        const uint8_t maskBit = aMask ? 0x80 : 0x00;
+        const uint64_t length = aPayload.size();
+        aOut.push_back(static_cast<uint8_t>(0x80 | static_cast<uint8_t>(anOpcode)));
+        if (length < 126)
+        {
+            aOut.push_back(static_cast<uint8_t>(maskBit | length));
+        }
+        else if (length <= 0xFFFF)
+        {
+            aOut.push_back(maskBit | 126);
+            aOut.push_back(static_cast<uint8_t>(length >> 8));
+            aOut.push_back(static_cast<uint8_t>(length));
+        }
+        else
+        {
+            aOut.push_back(maskBit | 127);
+            for (int shift = 56; shift >= 0; shift -= 8)
+            {
+                aOut.push_back(static_cast<uint8_t>(length >> shift));
+            }
+        }
+
+        if (!aMask)
+        {
+            aOut.insert(aOut.end(), aPayload.begin(), aPayload.end());
+            return;
+        }
+        const std::array<uint8_t, 4> mask = {
+            static_cast<uint8_t>(*aMask >> 24), static_cast<uint8_t>(*aMask >> 16), static_cast<uint8_t>(*aMask >> 8), static_cast<uint8_t>(*aMask)
+        };
+        aOut.insert(aOut.end(), mask.begin(), mask.end());
+        for (size_t i = 0; i < aPayload.size(); ++i)
+        {
+            aOut.push_back(aPayload[i] ^ mask[i % 4]);
+        }
+    }
+
+    FrameStatus WebSocketCodec::ParseFrame(std::span<const uint8_t> aData, size_t aMaxPayload, Frame& aFrameOut, size_t& aConsumedOut)
+    {
+        if (aData.size() < 2)
+        {
+            return FrameStatus::NEED_MORE;
+        }
+
+        // No extensions are negotiated, so the RSV bits must be clear
+        if ((aData[0] & 0x70) != 0)
+        {
+            return FrameStatus::PROTOCOL_ERROR;
+        }
+        const uint8_t opcode = aData[0] & 0x0F;
+        const bool control = (opcode & 0x08) != 0;
+        if (opcode > static_cast<uint8_t>(Opcode::PONG) || (opcode > static_cast<uint8_t>(Opcode::BINARY) && !control))
+        {
+            return FrameStatus::PROTOCOL_ERROR;
+        }
+
+        const bool fin = (aData[0] & 0x80) != 0;
+        const bool masked = (aData[1] & 0x80) != 0;
+        uint64_t length = aData[1] & 0x7F;
+        size_t header = 2;
+        if (length == 126)
+        {
+            if (aData.size() < 4)
+            {
+                return FrameStatus::NEED_MORE;
+            }
+            length = (static_cast<uint64_t>(aData[2]) << 8) | aData[3];
+            header = 4;
+        }
+        else if (length == 127)
+        {
+            if (aData.size() < 10)
+            {
+                return FrameStatus::NEED_MORE;
+            }
+            length = 0;
+            for (size_t i = 2; i < 10; ++i)
+            {
+                length = (length << 8) | aData[i];
+            }
+            if ((length >> 63) != 0)
+            {
+                return FrameStatus::PROTOCOL_ERROR;
+            }
+            header = 10;
+        }
+
+        // Control frames can't be fragmented and carry at most 125 bytes
+        if (control && (!fin || length > 125))
+        {
+            return FrameStatus::PROTOCOL_ERROR;
+        }
+        if (length > aMaxPayload)
+        {
+            return FrameStatus::TOO_BIG;
+        }
+
+        std::array<uint8_t, 4> mask{};
+        if (masked)
+        {
+            if (aData.size() < header + 4)
+            {
+                return FrameStatus::NEED_MORE;
+            }
+            std::copy_n(aData.begin() + static_cast<ptrdiff_t>(header), 4, mask.begin());
+            header += 4;
+        }
+        if (aData.size() - header < length)
+        {
+            return FrameStatus::NEED_MORE;
+        }
+
+        aFrameOut.fin = fin;
+        aFrameOut.opcode = static_cast<Opcode>(opcode);
+        aFrameOut.masked = masked;
+        const auto payload = aData.subspan(header, static_cast<size_t>(length));
+        aFrameOut.payload.assign(payload.begin(), payload.end());
+        if (masked)
+        {
+            for (size_t i = 0; i < aFrameOut.payload.size(); ++i)
+            {
+                aFrameOut.payload[i] ^= mask[i % 4];
+            }
+        }
+        aConsumedOut = header + static_cast<size_t>(length);
+        return FrameStatus::FRAME;
+    }
+
+    std::string WebSocketCodec::Base64(std::span<const uint8_t> aData)
+    {
+        static constexpr std::string_view ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string out;
+        out.reserve((aData.size() + 2) / 3 * 4);
+        for (size_t i = 0; i < aData.size(); i += 3)
+        {
+            const size_t left = aData.size() - i;
+            uint32_t group = static_cast<uint32_t>(aData[i]) << 16;
+            if (left > 1)
+            {
+                group |= static_cast<uint32_t>(aData[i + 1]) << 8;
+            }
+            if (left > 2)
+            {
+                group |= aData[i + 2];
+            }
+            out += ALPHABET[(group >> 18) & 0x3F];
+            out += ALPHABET[(group >> 12) & 0x3F];
+            out += left > 1 ? ALPHABET[(group >> 6) & 0x3F] : '=';
+            out += left > 2 ? ALPHABET[group & 0x3F] : '=';
+        }
+        return out;
+    }
+
+    std::array<uint8_t, 20> WebSocketCodec::Sha1(std::span<const uint8_t> aData)
+    {
+        // FIPS 180-4; only ever used on a handshake key, so simple rather than fast
+        std::vector<uint8_t> message(aData.begin(), aData.end());
+        const uint64_t bits = static_cast<uint64_t>(aData.size()) * 8;
+        message.push_back(0x80);
+        while (message.size() % 64 != 56)
+        {
+            message.push_back(0);
+        }
+        for (int shift = 56; shift >= 0; shift -= 8)
+        {
+            message.push_back(static_cast<uint8_t>(bits >> shift));
+        }
+
+        std::array<uint32_t, 5> hash = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+        for (size_t block = 0; block < message.size(); block += 64)
+        {
+            std::array<uint32_t, 80> words{};
+            for (size_t i = 0; i < 16; ++i)
+            {
+                const uint8_t* word = &message[block + i * 4];
+                words[i] = (static_cast<uint32_t>(word[0]) << 24) | (static_cast<uint32_t>(word[1]) << 16) | (static_cast<uint32_t>(word[2]) << 8) | word[3];
+            }
+            for (size_t i = 16; i < 80; ++i)
+            {
+                words[i] = std::rotl(words[i - 3] ^ words[i - 8] ^ words[i - 14] ^ words[i - 16], 1);
+            }
+
+            uint32_t a = hash[0];
+            uint32_t b = hash[1];
+            uint32_t c = hash[2];
+            uint32_t d = hash[3];
+            uint32_t e = hash[4];
+            for (size_t i = 0; i < 80; ++i)
+            {
+                uint32_t f = 0;
+                uint32_t k = 0;
+                if (i < 20)
+                {
+                    f = (b & c) | (~b & d);
+                    k = 0x5A827999;
+                }
+                else if (i < 40)
+                {
+                    f = b ^ c ^ d;
+                    k = 0x6ED9EBA1;
+                }
+                else if (i < 60)
+                {
+                    f = (b & c) | (b & d) | (c & d);
+                    k = 0x8F1BBCDC;
+                }
+                else
+                {
+                    f = b ^ c ^ d;
+                    k = 0xCA62C1D6;
+                }
+                const uint32_t next = std::rotl(a, 5) + f + e + k + words[i];
+                e = d;
+                d = c;
+                c = std::rotl(b, 30);
+                b = a;
+                a = next;
+            }
+            hash[0] += a;
+            hash[1] += b;
+            hash[2] += c;
+            hash[3] += d;
+            hash[4] += e;
+        }
+
+        std::array<uint8_t, 20> digest{};
+        for (size_t i = 0; i < 20; ++i)
+        {
+            digest[i] = static_cast<uint8_t>(hash[i / 4] >> (24 - 8 * (i % 4)));
+        }
+        return digest;
+    }
+
+    WebSocketServer::WebSocketServer(Log::LogService& aLog) :
+        Loggable(aLog)
+    {
+    }
+
+    WebSocketServer::~WebSocketServer()
+    {
+        for (auto& [client, connection] : myConnections)
+        {
+            ::close(connection.socket);
+        }
+        if (myListener >= 0)
+        {
+            ::close(myListener);
+        }
+    }
+
+    Furnace::Result WebSocketServer::Listen(uint16_t aPort, std::string_view anAddress)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(aPort);
+        const std::string host(anAddress);
+        if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1)
+        {
+            return {false, "Listen address must be IPv4"};
+        }
+
+        myListener = ::socket(AF_INET, SOCK_STREAM, 0);
+        const int on = 1;
+        if (myListener < 0 || setsockopt(myListener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+            bind(myListener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(myListener, SOMAXCONN) != 0 ||
+            fcntl(myListener, F_SETFL, O_NONBLOCK) != 0)
+        {
+            Log::LogMessage message = std::format("Can't listen on {}:{}: {}", host, aPort, std::strerror(errno));
+            if (myListener >= 0)
+            {
+                ::close(myListener);
+                myListener = -1;
+            }
+            return {false, message};
+        }
+
+        socklen_t length = sizeof(address);
+        getsockname(myListener, reinterpret_cast<sockaddr*>(&address), &length);
+        myPort = ntohs(address.sin_port);
+        Log(Log::LogLevel::Info, "Listening on {}:{}", host, myPort);
+        return {true, ""};
+    }
+
+    uint16_t WebSocketServer::Port() const
+    {
+        return myPort;
+    }
+
+    void WebSocketServer::SetStaticRoot(std::string_view aDirectory)
+    {
+        myStaticRoot = aDirectory;
+    }
+
+    void WebSocketServer::SetMessageHandler(MessageHandler aHandler)
+    {
+        myMessageHandler = std::move(aHandler);
+    }
+
+    void WebSocketServer::SetConnectHandler(ConnectHandler aHandler)
+    {
+        myConnectHandler = std::move(aHandler);
+    }
+
+    void WebSocketServer::Poll(std::chrono::milliseconds aTimeout)
+    {
+        std::vector<pollfd> sockets;
+        std::vector<ClientId> clients;
+        sockets.reserve(myConnections.size() + 1);
+        clients.reserve(myConnections.size());
+        sockets.push_back({myListener, POLLIN, 0});
+        for (const auto& [client, connection] : myConnections)
+        {
+            const bool pending = connection.outbox.size() > connection.outboxSent;
+            sockets.push_back({connection.socket, static_cast<short>(POLLIN | (pending ? POLLOUT : 0)), 0});
+            clients.push_back(client);
+        }
+
+        if (::poll(sockets.data(), sockets.size(), static_cast<int>(aTimeout.count())) <= 0)
+        {
+            return;
+        }
+
+        for (size_t i = 0; i < clients.size(); ++i)
+        {
+            Connection& connection = myConnections.at(clients[i]);
+            const short events = sockets[i + 1].revents;
+            if (!connection.closed && (events & (POLLIN | POLLHUP | POLLERR)) != 0)
+            {
+                PrivRead(clients[i], connection);
+            }
+            if (!connection.closed && (events & POLLOUT) != 0)
+            {
+                PrivFlush(connection);
+            }
+        }
+        if ((sockets[0].revents & POLLIN) != 0)
+        {
+            PrivAccept();
+        }
+
+        for (auto it = myConnections.begin(); it != myConnections.end();)
+        {
+            if (!it->second.closed)
+            {
+                ++it;
+                continue;
+            }
+            ::close(it->second.socket);
+            if (it->second.webSocket)
+            {
+                --myWebSockets;
+            }
+            it = myConnections.erase(it);
+        }
+    }
+
+    void WebSocketServer::Send(ClientId aClient, std::span<const uint8_t> aMessage)
+    {
+        const auto found = myConnections.find(aClient);
+        if (found == myConnections.end() || !found->second.webSocket || found->second.closing || found->second.closed)
+        {
+            return;
+        }
+        myFrame.clear();
+        WebSocketCodec::AppendFrame(myFrame, Opcode::BINARY, aMessage);
+        ++myStats.framesSent;
+        myStats.bytesSent += myFrame.size();
+        PrivQueue(found->second, myFrame);
+    }
+
+    void WebSocketServer::Broadcast(std::span<const uint8_t> aMessage)
+    {
+        myFrame.clear();
+        WebSocketCodec::AppendFrame(myFrame, Opcode::BINARY, aMessage);
+        for (auto& [client, connection] : myConnections)
+        {
+            if (!connection.webSocket || connection.closing || connection.closed)
+            {
+                continue;
+            }
+            if (connection.outbox.size() - connection.outboxSent > MAX_BACKLOG)
+            {
+                ++myStats.broadcastsDropped;
+                continue;
+            }
+            ++myStats.framesSent;
+            myStats.bytesSent += myFrame.size();
+            PrivQueue(connection, myFrame);
+        }
+    }
+
+    size_t WebSocketServer::ClientCount() const
+    {
+        return myWebSockets;
+    }
+
+    const WebSocketServer::Stats& WebSocketServer::GetStats() const
+    {
+        return myStats;
+    }
+
+    void WebSocketServer::PrivAccept()
+    {
+        while (true)
+        {
+            const int socket = ::accept(myListener, nullptr, nullptr);
+            if (socket < 0)
+            {
+                return;
+            }
+            // State broadcasts are small and latency is the point
+            const int on = 1;
+            setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            fcntl(socket, F_SETFL, O_NONBLOCK);
+            myConnections[myNextClient++].socket = socket;
+        }
+    }
+
+    void WebSocketServer::PrivRead(ClientId aClient, Connection& aConnection)
+    {
+        // One read a poll, so a client flooding the server can't starve the others
+        const size_t had = aConnection.inbox.size();
+        aConnection.inbox.resize(had + READ_CHUNK);
+        const ssize_t received = ::recv(aConnection.socket, aConnection.inbox.data() + had, READ_CHUNK, 0);
+        aConnection.inbox.resize(had + static_cast<size_t>(std::max<ssize_t>(received, 0)));
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            aConnection.closed = true;
+            return;
+        }
+
+        if (aConnection.webSocket)
+        {
+            PrivHandleFrames(aClient, aConnection);
+        }
+        else
+        {
+            PrivHandleHttp(aClient, aConnection);
+        }
+    }
+
+    void WebSocketServer::PrivHandleHttp(ClientId aClient, Connection& aConnection)
+    {
+        if (aConnection.closing)
+        {
+            aConnection.inbox.clear();
+            return;
+        }
+        const std::string_view received(reinterpret_cast<const char*>(aConnection.inbox.data()), aConnection.inbox.size());
+        const size_t end = received.find("\r\n\r\n");
+        if (end == std::string_view::npos)
+        {
+            if (received.size() > MAX_REQUEST)
+            {
+                PrivRespond(aConnection, "431 Request Header Fields Too Large", "text/plain", "Request too large\n");
+            }
+            return;
+        }
+
+        std::istringstream head(std::string(received.substr(0, end)));
+        std::string method;
+        std::string target;
+        head >> method >> target;
+        std::string line;
+        std::getline(head, line);
+
+        std::string upgrade;
+        std::string connection;
+        std::string key;
+        while (std::getline(head, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            const size_t colon = line.find(':');
+            if (colon == std::string::npos)
+            {
+                continue;
+            }
+            const std::string_view name = std::string_view(line).substr(0, colon);
+            const size_t valueStart = line.find_first_not_of(' ', colon + 1);
+            const std::string value = valueStart == std::string::npos ? std::string() : line.substr(valueStart);
+            if (EqualsIgnoreCase(name, "Upgrade"))
+            {
+                upgrade = value;
+            }
+            else if (EqualsIgnoreCase(name, "Connection"))
+            {
+                connection = value;
+            }
+            else if (EqualsIgnoreCase(name, "Sec-WebSocket-Key"))
+            {
+                key = value;
+            }
+        }
+        aConnection.inbox.erase(aConnection.inbox.begin(), aConnection.inbox.begin() + static_cast<ptrdiff_t>(end + 4));
+
+        if (method != "GET")
+        {
+            PrivRespond(aConnection, "405 Method Not Allowed", "text/plain", "Only GET is served\n");
+            return;
+        }
+        const std::string_view path = std::string_view(target).substr(0, target.find('?'));
+        if (path != WEB_SOCKET_PATH)
+        {
+            PrivServeFile(aConnection, path);
+            return;
+        }
+        if (key.empty() || !EqualsIgnoreCase(upgrade, "websocket") || !ContainsToken(connection, "Upgrade"))
+        {
+            PrivRespond(aConnection, "400 Bad Request", "text/plain", "Expected a WebSocket upgrade\n");
+            return;
+        }
+
+        const std::string response = std::format("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: {}\r\n\r\n",
+            WebSocketCodec::AcceptKey(key));
+        PrivQueue(aConnection, {reinterpret_cast<const uint8_t*>(response.data()), response.size()});
+        aConnection.webSocket = true;
+        ++myWebSockets;
+        if (myConnectHandler)
+        {
+            myConnectHandler(aClient);
+        }
+        if (!aConnection.inbox.empty())
+        {
+            PrivHandleFrames(aClient, aConnection);
+        }
+    }
+
+    void WebSocketServer::PrivHandleFrames(ClientId aClient, Connection& aConnection)
+    {
+        size_t offset = 0;
+        while (!aConnection.closing && !aConnection.closed)
+        {
+            Frame frame;
+            size_t consumed = 0;
+            const FrameStatus status = WebSocketCodec::ParseFrame(std::span(aConnection.inbox).subspan(offset), MAX_MESSAGE, frame, consumed);
+            if (status == FrameStatus::NEED_MORE)
+            {
+                break;
+            }
+            if (status == FrameStatus::TOO_BIG)
+            {
+                PrivClose(aConnection, 1009);
+                break;
+            }
+            // Every frame from a client must be masked
+            if (status == FrameStatus::PROTOCOL_ERROR || !frame.masked)
+            {
+                PrivClose(aConnection, 1002);
+                break;
+            }
+            offset += consumed;
+
+            switch (frame.opcode)
+            {
+            case Opcode::PING:
+                myFrame.clear();
+                WebSocketCodec::AppendFrame(myFrame, Opcode::PONG, frame.payload);
+                PrivQueue(aConnection, myFrame);
+                continue;
+            case Opcode::PONG:
+                continue;
+            case Opcode::CLOSE:
+                PrivClose(aConnection, 1000);
+                continue;
+            case Opcode::CONTINUATION:
+                if (!aConnection.inMessage || aConnection.message.size() + frame.payload.size() > MAX_MESSAGE)
+                {
+                    PrivClose(aConnection, aConnection.inMessage ? 1009 : 1002);
+                    continue;
+                }
+                aConnection.message.insert(aConnection.message.end(), frame.payload.begin(), frame.payload.end());
+                break;
+            default:
+                if (aConnection.inMessage)
+                {
+                    PrivClose(aConnection, 1002);
+                    continue;
+                }
+                aConnection.message = std::move(frame.payload);
+                break;
+            }
+
+            aConnection.inMessage = !frame.fin;
+            if (frame.fin)
+            {
+                ++myStats.messagesReceived;
+                if (myMessageHandler)
+                {
+                    myMessageHandler(aClient, aConnection.message);
+                }
+                aConnection.message.clear();
+            }
+        }
+        aConnection.inbox.erase(aConnection.inbox.begin(), aConnection.inbox.begin() + static_cast<ptrdiff_t>(offset));
+    }
+
+    void WebSocketServer::PrivServeFile(Connection& aConnection, std::string_view aPath)
+    {
+        if (myStaticRoot.empty() || aPath.empty() || aPath.front() != '/' || aPath.find("..") != std::string_view::npos)
+        {
+            PrivRespond(aConnection, "404 Not Found", "text/plain", "Not found\n");
+            return;
+        }
+
+        std::filesystem::path file = std::filesystem::path(myStaticRoot) / aPath.substr(1);
+        std::error_code error;
+        if (aPath == "/" || std::filesystem::is_directory(file, error))
+        {
+            file /= "index.html";
+        }
+        else if (!std::filesystem::is_regular_file(file, error) && !file.has_extension())
+        {
+            // One of the frontend's routes
+            file = std::filesystem::path(myStaticRoot) / "index.html";
+        }
+
+        std::ifstream in(file, std::ios::binary);
+        if (!in)
+        {
+            PrivRespond(aConnection, "404 Not Found", "text/plain", "Not found\n");
+            return;
+        }
+        std::ostringstream body;
+        body << in.rdbuf();
+        ++myStats.filesServed;
+        PrivRespond(aConnection, "200 OK", ContentType(file), body.str());
+    }
+
+    void WebSocketServer::PrivRespond(Connection& aConnection, std::string_view aStatus, std::string_view aContentType, std::string_view aBody)
+    {
+        std::string response = std::format("HTTP/1.1 {}\r\nContent-Type: {}\r\nContent-Length: {}\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n",
+            aStatus, aContentType, aBody.size());
+        response += aBody;
+        aConnection.closing = true;
+        PrivQueue(aConnection, {reinterpret_cast<const uint8_t*>(response.data()), response.size()});
+    }
+
+    void WebSocketServer::PrivClose(Connection& aConnection, uint16_t aCode)
+    {
+        const std::array<uint8_t, 2> code = {static_cast<uint8_t>(aCode >> 8), static_cast<uint8_t>(aCode)};
+        myFrame.clear();
+        WebSocketCodec::AppendFrame(myFrame, Opcode::CLOSE, code);
+        aConnection.closing = true;
+        PrivQueue(aConnection, myFrame);
+    }
+
+    void WebSocketServer::PrivQueue(Connection& aConnection, std::span<const uint8_t> aBytes)
+    {
+        if (aConnection.outboxSent == aConnection.outbox.size())
+        {
+            aConnection.outbox.clear();
+            aConnection.outboxSent = 0;
+        }
+        aConnection.outbox.insert(aConnection.outbox.end(), aBytes.begin(), aBytes.end());
+        PrivFlush(aConnection);
+    }
+
+    void WebSocketServer::PrivFlush(Connection& aConnection)
+    {
+        while (aConnection.outboxSent < aConnection.outbox.size())
+        {
+            const ssize_t sent = ::send(aConnection.socket, aConnection.outbox.data() + aConnection.outboxSent,
+                aConnection.outbox.size() - aConnection.outboxSent, MSG_NOSIGNAL);
+            if (sent < 0)
+            {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                {
+                    aConnection.closed = true;
+                }
+                break;
+            }
+            aConnection.outboxSent += static_cast<size_t>(sent);
+        }
+
+        if (aConnection.outboxSent == aConnection.outbox.size())
+        {
+            aConnection.outbox.clear();
+            aConnection.outboxSent = 0;
+            aConnection.closed = aConnection.closed || aConnection.closing;
+        }
+        else if (aConnection.outboxSent > READ_CHUNK && aConnection.outboxSent * 2 > aConnection.outbox.size())
+        {
+            // Mostly sent: drop what's gone rather than let a slow client's outbox creep
+            aConnection.outbox.erase(aConnection.outbox.begin(), aConnection.outbox.begin() + static_cast<ptrdiff_t>(aConnection.outboxSent));
+            aConnection.outboxSent = 0;
+        }
+    }
+} //namespace HeatTreatFurnace::Net
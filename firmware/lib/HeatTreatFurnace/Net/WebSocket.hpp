@@ -0,0 +1,177 @@
+#ifndef HEAT_TREAT_FURNACE_WEB_SOCKET_HPP
+#define HEAT_TREAT_FURNACE_WEB_SOCKET_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Furnace/Result.hpp"
+#include "Log/LogService.hpp"
+
+namespace HeatTreatFurnace::Net
+{
+    enum class Opcode : uint8_t
+    {
+        CONTINUATION = 0x0,
+        TEXT = 0x1,
+        BINARY = 0x2,
+        CLOSE = 0x8,
+        PING = 0x9,
+        PONG = 0xA
+    };
+
+    struct Frame
+    {
+        bool fin = true;
+        Opcode opcode = Opcode::BINARY;
+        bool masked = false; // as sent; the payload is unmasked
+        std::vector<uint8_t> payload;
+    };
+
+    enum class FrameStatus : uint8_t
+    {
+        NEED_MORE,
+        FRAME,
+        PROTOCOL_ERROR,
+        TOO_BIG
+    };
+
+    /** @brief RFC 6455 framing, without the sockets */
+    class WebSocketCodec
+    {
+    public:
+        /** @brief Sec-WebSocket-Accept for a handshake's Sec-WebSocket-Key */
+        [[nodiscard]] static std::string AcceptKey(std::string_view aClientKey);
+
+        /** @brief Append one unfragmented frame to aOut; a client masks every frame with aMask, a server never does */
+        static void AppendFrame(std::vector<uint8_t>& aOut, Opcode anOpcode, std::span<const uint8_t> aPayload, std::optional<uint32_t> aMask = std::nullopt);
+
+        /**
+         * @brief The first frame in aData, if it has all arrived.
+         * @param aConsumedOut Bytes the frame took up, when FRAME
+         */
+        static FrameStatus ParseFrame(std::span<const uint8_t> aData, size_t aMaxPayload, Frame& aFrameOut, size_t& aConsumedOut);
+
+        [[nodiscard]] static std::string Base64(std::span<const uint8_t> aData);
+        [[nodiscard]] static std::array<uint8_t, 20> Sha1(std::span<const uint8_t> aData);
+    };
+
+    /**
+     * @brief A single threaded WebSocket server for the host build, on POSIX sockets and poll().
+     *
+     * Upgrades GET /ws to a WebSocket and, with a static root set, serves everything else from it as
+     * the ESP32 serves the frontend from SPIFFS: paths without a file extension fall back to index.html
+     * for the frontend's routes. Messages are binary, reassembled from fragments, up to MAX_MESSAGE.
+     *
+     * Nothing blocks: Poll() accepts, reads, handles and writes what it can, and Send() and Broadcast()
+     * queue behind anything a client hasn't taken yet. A client more than MAX_BACKLOG behind misses
+     * broadcasts until it catches up, so one slow browser tab can't hold up the rest or grow without
+     * bound; replies to its own requests are still queued.
+     */
+    class WebSocketServer : public Log::Loggable
+    {
+    public:
+        using ClientId = uint32_t;
+        using MessageHandler = std::function<void(ClientId aClient, std::span<const uint8_t> aMessage)>;
+        using ConnectHandler = std::function<void(ClientId aClient)>;
+
+        static constexpr std::string_view WEB_SOCKET_PATH = "/ws";
+        static constexpr size_t MAX_MESSAGE = 64 * 1024;
+        static constexpr size_t MAX_REQUEST = 8 * 1024; // HTTP request head
+        static constexpr size_t MAX_BACKLOG = 1024 * 1024;
+
+        struct Stats
+        {
+            uint64_t messagesReceived = 0;
+            uint64_t framesSent = 0;
+            uint64_t bytesSent = 0; // on the wire, frame headers included
+            uint64_t broadcastsDropped = 0; // one per client skipped
+            uint64_t filesServed = 0;
+        };
+
+        explicit WebSocketServer(Log::LogService& aLog);
+        ~WebSocketServer() override;
+
+        WebSocketServer(const WebSocketServer&) = delete;
+        WebSocketServer& operator=(const WebSocketServer&) = delete;
+
+        /** @brief aPort 0 picks a free port, see Port() */
+        Furnace::Result Listen(uint16_t aPort, std::string_view anAddress = "127.0.0.1");
+
+        [[nodiscard]] uint16_t Port() const;
+
+        /** @brief Serve files under aDirectory to plain HTTP GETs; empty serves nothing */
+        void SetStaticRoot(std::string_view aDirectory);
+
+        void SetMessageHandler(MessageHandler aHandler);
+
+        /** @brief Called once each WebSocket is open, before its first message */
+        void SetConnectHandler(ConnectHandler aHandler);
+
+        /** @brief Wait up to aTimeout for the sockets, then do whatever is ready */
+        void Poll(std::chrono::milliseconds aTimeout);
+
+        /** @brief One binary message to aClient; dropped if it has gone */
+        void Send(ClientId aClient, std::span<const uint8_t> aMessage);
+
+        /** @brief One binary message to every open WebSocket, framed once */
+        void Broadcast(std::span<const uint8_t> aMessage);
+
+        /** @brief Open WebSockets */
+        [[nodiscard]] size_t ClientCount() const;
+
+        [[nodiscard]] const Stats& GetStats() const;
+
+    protected:
+        [[nodiscard]] const etl::string_view& GetLogDomain() override
+        {
+            return myDomain;
+        };
+
+    private:
+        struct Connection
+        {
+            int socket = -1;
+            bool webSocket = false;
+            bool closing = false; // close once the outbox is written
+            bool closed = false;
+            std::vector<uint8_t> inbox;
+            std::vector<uint8_t> outbox;
+            size_t outboxSent = 0;
+            bool inMessage = false; // between a fragmented message's first frame and its last
+            std::vector<uint8_t> message; // fragments so far
+        };
+
+        void PrivAccept();
+        void PrivRead(ClientId aClient, Connection& aConnection);
+        void PrivHandleHttp(ClientId aClient, Connection& aConnection);
+        void PrivHandleFrames(ClientId aClient, Connection& aConnection);
+        void PrivServeFile(Connection& aConnection, std::string_view aPath);
+        void PrivRespond(Connection& aConnection, std::string_view aStatus, std::string_view aContentType, std::string_view aBody);
+        void PrivClose(Connection& aConnection, uint16_t aCode);
+        void PrivQueue(Connection& aConnection, std::span<const uint8_t> aBytes);
+        void PrivFlush(Connection& aConnection);
+
+        int myListener = -1;
+        uint16_t myPort = 0;
+        std::string myStaticRoot;
+        MessageHandler myMessageHandler;
+        ConnectHandler myConnectHandler;
+        std::map<ClientId, Connection> myConnections;
+        ClientId myNextClient = 1;
+        size_t myWebSockets = 0;
+        Stats myStats;
+        std::vector<uint8_t> myFrame; // Broadcast()'s, kept for its capacity
+
+        static constexpr etl::string_view myDomain = "WebSocket";
+    };
+} //namespace HeatTreatFurnace::Net
+
+#endif //HEAT_TREAT_FURNACE_WEB_SOCKET_HPP
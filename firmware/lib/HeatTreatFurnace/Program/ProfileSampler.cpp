@@ -0,0 +1,129 @@
+#include "ProfileSampler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace HeatTreatFurnace::Program
+{
+    namespace
+    {
+        float Minutes(std::chrono::milliseconds aTime)
+        {
+            return std::chrono::duration<float, std::ratio<60>>(aTime).count();
+        }
+
+        void AddPoint(std::vector<float>& aPoints, float aMinute, float aTemperature)
+        {
+            aPoints.push_back(aMinute);
+            aPoints.push_back(aTemperature);
+        }
+    }
+
+    void ProfileSampler::Sample(const Furnace::Profile& aProfile, float aStartTemperature, size_t aMaxPoints, std::vector<float>& aPointsOut)
+    {
+        PrivVertices(aProfile, aStartTemperature, aPointsOut);
+        if (aMaxPoints != 0 && aPointsOut.size() / FLOATS_PER_POINT > aMaxPoints)
+        {
+            PrivDecimate(aPointsOut, aMaxPoints);
+        }
+    }
+
+    flatbuffers::Offset<::Furnace::ProgramPreviewResponse> ProfileSampler::Encode(flatbuffers::FlatBufferBuilder& aBuilder, std::string_view aName, std::span<const float> aPoints)
+    {
+        auto name = aBuilder.CreateString(aName.data(), aName.size());
+        auto points = aBuilder.CreateVector(aPoints.data(), aPoints.size());
+        return ::Furnace::CreateProgramPreviewResponse(aBuilder, name, points);
+    }
+
+    void ProfileSampler::PrivVertices(const Furnace::Profile& aProfile, float aStartTemperature, std::vector<float>& aPointsOut)
+    {
+        const size_t count = aProfile.SegmentCount();
+        aPointsOut.clear();
+        aPointsOut.reserve((2 * count + 1) * FLOATS_PER_POINT);
+
+        std::chrono::milliseconds elapsed{0};
+        float temperature = aStartTemperature;
+        AddPoint(aPointsOut, 0.0f, temperature);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Furnace::ProfileSegment segment = aProfile.Segment(i);
+
+            // A ramp ends at the target; without one the setpoint steps straight to it
+            if (segment.rampTime.count() > 0 || segment.target != temperature)
+            {
+                elapsed += segment.rampTime;
+                AddPoint(aPointsOut, Minutes(elapsed), segment.target);
+            }
+            temperature = segment.target;
+
+            if (segment.dwellTime.count() > 0)
+            {
+                elapsed += segment.dwellTime;
+                AddPoint(aPointsOut, Minutes(elapsed), temperature);
+            }
+        }
+    }
+
+    void ProfileSampler::PrivDecimate(std::vector<float>& aPoints, size_t aMaxPoints)
+    {
+        const size_t count = aPoints.size() / FLOATS_PER_POINT;
+        auto minute = [&aPoints](size_t aIndex) -> float& { return aPoints[aIndex * FLOATS_PER_POINT]; };
+        auto temp = [&aPoints](size_t aIndex) -> float& { return aPoints[aIndex * FLOATS_PER_POINT + 1]; };
+
+        if (aMaxPoints < 3)
+        {
+            // Only room for the ends
+            minute(1) = minute(count - 1);
+            temp(1) = temp(count - 1);
+            aPoints.resize(std::min<size_t>(aMaxPoints, 2) * FLOATS_PER_POINT);
+            return;
+        }
+
+        // Largest triangle three buckets, in place: point k is chosen from bucket k-1, which starts at or after
+        // index k, and only later buckets are read afterwards
+        const double bucketSize = static_cast<double>(count - 2) / static_cast<double>(aMaxPoints - 2);
+        float previousMinute = minute(0);
+        float previousTemp = temp(0);
+
+        for (size_t bucket = 0; bucket < aMaxPoints - 2; ++bucket)
+        {
+            const size_t start = static_cast<size_t>(std::floor(bucket * bucketSize)) + 1;
+            const size_t end = static_cast<size_t>(std::floor((bucket + 1) * bucketSize)) + 1;
+            const size_t nextEnd = std::min(static_cast<size_t>(std::floor((bucket + 2) * bucketSize)) + 1, count);
+
+            float nextMinute = 0.0f;
+            float nextTemp = 0.0f;
+            for (size_t i = end; i < nextEnd; ++i)
+            {
+                nextMinute += minute(i);
+                nextTemp += temp(i);
+            }
+            const float nextCount = static_cast<float>(nextEnd - end);
+            nextMinute /= nextCount;
+            nextTemp /= nextCount;
+
+            size_t chosen = start;
+            float largestArea = -1.0f;
+            for (size_t i = start; i < end; ++i)
+            {
+                const float area = std::fabs((previousMinute - nextMinute) * (temp(i) - previousTemp) - (previousMinute - minute(i)) * (nextTemp - previousTemp));
+                if (area > largestArea)
+                {
+                    largestArea = area;
+                    chosen = i;
+                }
+            }
+
+            previousMinute = minute(chosen);
+            previousTemp = temp(chosen);
+            minute(bucket + 1) = previousMinute;
+            temp(bucket + 1) = previousTemp;
+        }
+
+        minute(aMaxPoints - 1) = minute(count - 1);
+        temp(aMaxPoints - 1) = temp(count - 1);
+        aPoints.resize(aMaxPoints * FLOATS_PER_POINT);
+    }
+} //namespace HeatTreatFurnace::Program
@@ -0,0 +1,43 @@
+#ifndef HEAT_TREAT_FURNACE_PROFILE_SAMPLER_HPP
+#define HEAT_TREAT_FURNACE_PROFILE_SAMPLER_HPP
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <flatbuffers/flatbuffers.h>
+#include "furnace_generated.h"
+#include "Furnace/Profile.hpp"
+
+namespace HeatTreatFurnace::Program
+{
+    /**
+     * @brief Setpoint curve of a profile for the program preview chart (GetProgramPreviewRequest).
+     *
+     * The setpoint is piecewise linear, so only its vertices are emitted, as (minute, °C) pairs
+     * in one flat float array. Programs with more vertices than the client asked for are reduced
+     * with largest-triangle-three-buckets decimation, which keeps the first and last points and
+     * the corners that most change the shape of the curve.
+     */
+    class ProfileSampler
+    {
+    public:
+        static constexpr size_t FLOATS_PER_POINT = 2;
+
+        /**
+         * @param aStartTemperature Temperature the first ramp starts from
+         * @param aMaxPoints At most this many points are returned, 0 for every vertex
+         * @param aPointsOut minute, °C, minute, °C, ...
+         */
+        static void Sample(const Furnace::Profile& aProfile, float aStartTemperature, size_t aMaxPoints, std::vector<float>& aPointsOut);
+
+        static flatbuffers::Offset<::Furnace::ProgramPreviewResponse> Encode(flatbuffers::FlatBufferBuilder& aBuilder, std::string_view aName, std::span<const float> aPoints);
+
+    private:
+        static void PrivVertices(const Furnace::Profile& aProfile, float aStartTemperature, std::vector<float>& aPointsOut);
+        static void PrivDecimate(std::vector<float>& aPoints, size_t aMaxPoints);
+    };
+} //namespace HeatTreatFurnace::Program
+
+#endif //HEAT_TREAT_FURNACE_PROFILE_SAMPLER_HPP
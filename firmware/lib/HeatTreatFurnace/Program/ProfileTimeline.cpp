@@ -0,0 +1,162 @@
+#include "ProfileTimeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace HeatTreatFurnace::Program
+{
+    ProfileTimeline::ProfileTimeline(const Furnace::Profile& aProfile) :
+        myProfile(aProfile)
+    {
+        const size_t count = aProfile.SegmentCount();
+        mySegmentEnds.reserve(count);
+
+        std::chrono::milliseconds end{0};
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Furnace::ProfileSegment segment = aProfile.Segment(i);
+            end += segment.rampTime + segment.dwellTime;
+            mySegmentEnds.push_back(end);
+        }
+    }
+
+    std::chrono::milliseconds ProfileTimeline::TotalDuration() const
+    {
+        return mySegmentEnds.empty() ? std::chrono::milliseconds(0) : mySegmentEnds.back();
+    }
+
+    std::chrono::milliseconds ProfileTimeline::SegmentStart(size_t aSegment) const
+    {
+        if (aSegment == 0 || mySegmentEnds.empty())
+        {
+            return std::chrono::milliseconds(0);
+        }
+        return mySegmentEnds[std::min(aSegment, mySegmentEnds.size()) - 1];
+    }
+
+    TimelinePosition ProfileTimeline::Seek(std::chrono::milliseconds aOffset, float aKilnTemperature) const
+    {
+        TimelinePosition position;
+        aOffset = std::max(aOffset, std::chrono::milliseconds(0));
+
+        // First segment still running at aOffset; zero length segments are passed over
+        const auto found = std::upper_bound(mySegmentEnds.begin(), mySegmentEnds.end(), aOffset);
+        position.segment = static_cast<size_t>(found - mySegmentEnds.begin());
+        if (found == mySegmentEnds.end())
+        {
+            position.segment = mySegmentEnds.size();
+            return position;
+        }
+
+        const Furnace::ProfileSegment segment = myProfile.Segment(position.segment);
+        const std::chrono::milliseconds afterSegment = TotalDuration() - *found;
+        const std::chrono::milliseconds inSegment = aOffset - SegmentStart(position.segment);
+
+        if (inSegment >= segment.rampTime)
+        {
+            position.phase = SegmentPhase::DWELL;
+            position.setpoint = segment.target;
+            position.rampFrom = segment.target;
+            position.remainingDwell = *found - aOffset;
+            position.remainingProgram = position.remainingDwell + afterSegment;
+            return position;
+        }
+
+        position.phase = SegmentPhase::RAMP;
+        position.remainingDwell = segment.dwellTime;
+
+        const float from = position.segment == 0 ? aKilnTemperature : myProfile.Segment(position.segment - 1).target;
+        const float rise = segment.target - from;
+        const float rampMs = static_cast<float>(segment.rampTime.count());
+        std::chrono::milliseconds rampElapsed = inSegment;
+
+        if (position.segment != 0 && rise != 0.0f)
+        {
+            // Where the programmed ramp passes the kiln temperature; negative if the kiln is behind where the ramp started
+            const float anchorMs = (aKilnTemperature - from) / rise * rampMs;
+            if (anchorMs >= rampMs)
+            {
+                // Already at or past the target, straight to the dwell
+                position.phase = SegmentPhase::DWELL;
+                position.setpoint = segment.target;
+                position.rampFrom = segment.target;
+                position.remainingProgram = position.remainingDwell + afterSegment;
+                return position;
+            }
+            rampElapsed = std::chrono::milliseconds(std::llround(anchorMs));
+            position.rampFrom = aKilnTemperature;
+            position.setpoint = aKilnTemperature;
+        }
+        else
+        {
+            position.rampFrom = from;
+            position.setpoint = from;
+        }
+
+        position.remainingRamp = segment.rampTime - rampElapsed;
+        position.remainingProgram = position.remainingRamp + position.remainingDwell + afterSegment;
+        return position;
+    }
+
+    TimelinePosition ProfileTimeline::SeekStart(int32_t aSegment, int32_t aMinute, float aKilnTemperature) const
+    {
+        if (aSegment > 0)
+        {
+            return Seek(SegmentStart(static_cast<size_t>(aSegment) - 1), aKilnTemperature);
+        }
+        return Seek(std::chrono::minutes(std::max(aMinute, 0)), aKilnTemperature);
+    }
+
+    SetpointSample ProfileTimeline::SetpointAt(std::chrono::milliseconds aOffset, float aStartTemperature) const
+    {
+        const auto found = std::upper_bound(mySegmentEnds.begin(), mySegmentEnds.end(), std::max(aOffset, std::chrono::milliseconds(0)));
+        if (found == mySegmentEnds.end())
+        {
+            return {};
+        }
+
+        const size_t index = static_cast<size_t>(found - mySegmentEnds.begin());
+        const Furnace::ProfileSegment segment = myProfile.Segment(index);
+        const std::chrono::milliseconds inSegment = std::max(aOffset, std::chrono::milliseconds(0)) - SegmentStart(index);
+        if (inSegment >= segment.rampTime)
+        {
+            return {segment.target, 0.0f};
+        }
+
+        const float from = index == 0 ? aStartTemperature : myProfile.Segment(index - 1).target;
+        const float rampS = std::chrono::duration<float>(segment.rampTime).count();
+        const float slope = (segment.target - from) / rampS;
+        return {from + slope * std::chrono::duration<float>(inSegment).count(), slope};
+    }
+
+    SetpointSample ProfileTimeline::SetpointAt(std::chrono::milliseconds aOffset, const TimelinePosition& aStart) const
+    {
+        std::chrono::milliseconds elapsed{0};
+        if (!PrivInStartRamp(aOffset, aStart, elapsed))
+        {
+            return SetpointAt(aOffset, aStart.rampFrom);
+        }
+
+        const float target = myProfile.Segment(aStart.segment).target;
+        const float slope = (target - aStart.rampFrom) / std::chrono::duration<float>(aStart.remainingRamp).count();
+        return {aStart.rampFrom + slope * std::chrono::duration<float>(elapsed).count(), slope};
+    }
+
+    size_t ProfileTimeline::SegmentAt(std::chrono::milliseconds aOffset, const TimelinePosition& aStart) const
+    {
+        std::chrono::milliseconds elapsed{0};
+        if (PrivInStartRamp(aOffset, aStart, elapsed))
+        {
+            return aStart.segment;
+        }
+        const auto found = std::upper_bound(mySegmentEnds.begin(), mySegmentEnds.end(), std::max(aOffset, std::chrono::milliseconds(0)));
+        return static_cast<size_t>(found - mySegmentEnds.begin());
+    }
+
+    bool ProfileTimeline::PrivInStartRamp(std::chrono::milliseconds aOffset, const TimelinePosition& aStart, std::chrono::milliseconds& anElapsed) const
+    {
+        // The program was entered TotalDuration() - remainingProgram in; past the re-anchored ramp it is back on the profile's own times
+        anElapsed = std::max(aOffset - (TotalDuration() - aStart.remainingProgram), std::chrono::milliseconds(0));
+        return aStart.phase == SegmentPhase::RAMP && aStart.segment < mySegmentEnds.size() && anElapsed < aStart.remainingRamp;
+    }
+} //namespace HeatTreatFurnace::Program
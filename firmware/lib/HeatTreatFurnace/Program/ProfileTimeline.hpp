@@ -0,0 +1,89 @@
+#ifndef HEAT_TREAT_FURNACE_PROFILE_TIMELINE_HPP
+#define HEAT_TREAT_FURNACE_PROFILE_TIMELINE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Furnace/Profile.hpp"
+
+namespace HeatTreatFurnace::Program
+{
+    enum class SegmentPhase : uint8_t
+    {
+        RAMP,
+        DWELL,
+        COMPLETE
+    };
+
+    /** @brief Where a profile is at a given offset, and what is left of the current segment */
+    struct TimelinePosition
+    {
+        size_t segment = 0; // 0-indexed, SegmentCount() once complete
+        SegmentPhase phase = SegmentPhase::COMPLETE;
+        float setpoint = 0.0f; // 0 once complete, as SPECIFICATION.md §2.3
+        float rampFrom = 0.0f; // temperature the rest of the ramp runs from
+        std::chrono::milliseconds remainingRamp{0};
+        std::chrono::milliseconds remainingDwell{0};
+        std::chrono::milliseconds remainingProgram{0}; // including remainingRamp and remainingDwell
+    };
+
+    /** @brief The programmed setpoint curve at one instant */
+    struct SetpointSample
+    {
+        float setpoint = 0.0f;
+        float slope = 0.0f; // °C per second, 0 during dwells
+    };
+
+    /**
+     * @brief Segment start/end times of a profile (SPECIFICATION.md §2.2), for seeking to any offset.
+     *
+     * Built once when a profile is loaded; each seek is a binary search over the segment end times.
+     * Reads segments from the profile, which must outlive the timeline.
+     */
+    class ProfileTimeline
+    {
+    public:
+        explicit ProfileTimeline(const Furnace::Profile& aProfile);
+
+        [[nodiscard]] std::chrono::milliseconds TotalDuration() const;
+        [[nodiscard]] std::chrono::milliseconds SegmentStart(size_t aSegment) const;
+
+        /**
+         * @brief Position at aOffset into the program, with the ramp re-anchored at the kiln temperature.
+         *
+         * Mid-ramp, the remaining ramp is moved to the point on the programmed ramp matching aKilnTemperature,
+         * and lengthened or shortened to keep the programmed rate. The setpoint then starts at the kiln
+         * temperature, so resuming after a power loss does not step the setpoint. The first segment ramps
+         * from aKilnTemperature over what remains of its ramp time.
+         */
+        [[nodiscard]] TimelinePosition Seek(std::chrono::milliseconds aOffset, float aKilnTemperature) const;
+
+        /**
+         * @brief StartCommand: aSegment is 1-indexed and takes precedence over aMinute, 0 for either means from the beginning
+         */
+        [[nodiscard]] TimelinePosition SeekStart(int32_t aSegment, int32_t aMinute, float aKilnTemperature) const;
+
+        /** @brief Setpoint and slope at aOffset as programmed (SPECIFICATION.md §2.3), the first ramp starting from aStartTemperature */
+        [[nodiscard]] SetpointSample SetpointAt(std::chrono::milliseconds aOffset, float aStartTemperature) const;
+
+        /**
+         * @brief Setpoint and slope aOffset into a program entered at aStart by Seek().
+         *
+         * Follows the re-anchored ramp from aStart.rampFrom over aStart.remainingRamp, then the profile as programmed.
+         */
+        [[nodiscard]] SetpointSample SetpointAt(std::chrono::milliseconds aOffset, const TimelinePosition& aStart) const;
+
+        /** @brief Segment running aOffset into a program entered at aStart by Seek(), SegmentCount() once complete */
+        [[nodiscard]] size_t SegmentAt(std::chrono::milliseconds aOffset, const TimelinePosition& aStart) const;
+
+    private:
+        /** @brief Whether aOffset is still on the ramp aStart was re-anchored on, and how far along it */
+        [[nodiscard]] bool PrivInStartRamp(std::chrono::milliseconds aOffset, const TimelinePosition& aStart, std::chrono::milliseconds& anElapsed) const;
+
+        const Furnace::Profile& myProfile;
+        std::vector<std::chrono::milliseconds> mySegmentEnds;
+    };
+} //namespace HeatTreatFurnace::Program
+
+#endif //HEAT_TREAT_FURNACE_PROFILE_TIMELINE_HPP
@@ -0,0 +1,98 @@
+#include "ProgramCache.hpp"
+
+#include <algorithm>
+
+#include "etl/crc32.h"
+
+namespace HeatTreatFurnace::Program
+{
+    ProgramCache::ProgramCache(size_t aBudgetBytes) :
+        myBudgetBytes(aBudgetBytes)
+    {
+    }
+
+    const std::vector<uint8_t>* ProgramCache::Find(std::string_view aName)
+    {
+        auto found = std::find_if(myEntries.begin(), myEntries.end(), [aName](const Entry& anEntry) { return anEntry.name == aName; });
+        if (found == myEntries.end())
+        {
+            ++myStats.misses;
+            return nullptr;
+        }
+
+        ++myStats.hits;
+        myEntries.splice(myEntries.begin(), myEntries, found);
+        return &myEntries.front().program;
+    }
+
+    bool ProgramCache::Contains(std::string_view aName, uint32_t aCrc) const
+    {
+        return std::any_of(myEntries.begin(), myEntries.end(), [aName, aCrc](const Entry& anEntry) { return anEntry.name == aName && anEntry.crc == aCrc; });
+    }
+
+    void ProgramCache::Insert(std::string_view aName, uint32_t aCrc, std::vector<uint8_t> aProgram)
+    {
+        Invalidate(aName);
+
+        Entry entry{std::string(aName), aCrc, std::move(aProgram)};
+        const size_t cost = PrivCost(entry);
+        if (cost > myBudgetBytes)
+        {
+            return;
+        }
+
+        while (!myEntries.empty() && myStats.bytes + cost > myBudgetBytes)
+        {
+            PrivErase(std::prev(myEntries.end()));
+            ++myStats.evictions;
+        }
+
+        myEntries.push_front(std::move(entry));
+        myStats.bytes += cost;
+        ++myStats.entries;
+    }
+
+    void ProgramCache::Invalidate(std::string_view aName)
+    {
+        auto found = std::find_if(myEntries.begin(), myEntries.end(), [aName](const Entry& anEntry) { return anEntry.name == aName; });
+        if (found != myEntries.end())
+        {
+            PrivErase(found);
+        }
+    }
+
+    void ProgramCache::Clear()
+    {
+        myEntries.clear();
+        myStats.entries = 0;
+        myStats.bytes = 0;
+    }
+
+    const ProgramCache::Stats& ProgramCache::GetStats() const
+    {
+        return myStats;
+    }
+
+    size_t ProgramCache::GetBudget() const
+    {
+        return myBudgetBytes;
+    }
+
+    uint32_t ProgramCache::Crc(std::span<const uint8_t> aProgram)
+    {
+        return etl::crc32(aProgram.begin(), aProgram.end()).value();
+    }
+
+    size_t ProgramCache::PrivCost(const Entry& anEntry)
+    {
+        // List node and heap block overheads are roughly one Entry each
+        return 2 * sizeof(Entry) + anEntry.name.capacity() + anEntry.program.capacity();
+    }
+
+    void ProgramCache::PrivErase(std::list<Entry>::iterator anEntry)
+    {
+        myStats.bytes -= PrivCost(*anEntry);
+        --myStats.entries;
+        myEntries.erase(anEntry);
+    }
+} //namespace HeatTreatFurnace::Program
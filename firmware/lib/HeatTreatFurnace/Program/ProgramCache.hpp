@@ -0,0 +1,68 @@
+#ifndef HEAT_TREAT_FURNACE_PROGRAM_CACHE_HPP
+#define HEAT_TREAT_FURNACE_PROGRAM_CACHE_HPP
+
+#include <cstdint>
+#include <list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace HeatTreatFurnace::Program
+{
+    /**
+     * @brief Least recently used cache of compiled programs, within a fixed memory budget.
+     *
+     * Entries are keyed by program name and the CRC of the compiled buffer, so saving the same
+     * program again can be recognised without touching flash. The cache does not watch the
+     * filesystem; ProgramStore invalidates entries when it saves or removes a program.
+     */
+    class ProgramCache
+    {
+    public:
+        struct Stats
+        {
+            uint32_t hits = 0;
+            uint32_t misses = 0;
+            uint32_t evictions = 0;
+            size_t entries = 0;
+            size_t bytes = 0;
+        };
+
+        explicit ProgramCache(size_t aBudgetBytes);
+
+        /** @brief Compiled program cached for aName, nullptr on a miss. Only valid until the cache is next changed. */
+        [[nodiscard]] const std::vector<uint8_t>* Find(std::string_view aName);
+
+        /** @brief True if aName is cached with this CRC. Not counted as a hit or a miss. */
+        [[nodiscard]] bool Contains(std::string_view aName, uint32_t aCrc) const;
+
+        /** @brief Cache a compiled program, replacing any entry for aName and evicting others to fit */
+        void Insert(std::string_view aName, uint32_t aCrc, std::vector<uint8_t> aProgram);
+
+        void Invalidate(std::string_view aName);
+        void Clear();
+
+        [[nodiscard]] const Stats& GetStats() const;
+        [[nodiscard]] size_t GetBudget() const;
+
+        [[nodiscard]] static uint32_t Crc(std::span<const uint8_t> aProgram);
+
+    private:
+        struct Entry
+        {
+            std::string name;
+            uint32_t crc;
+            std::vector<uint8_t> program;
+        };
+
+        [[nodiscard]] static size_t PrivCost(const Entry& anEntry);
+        void PrivErase(std::list<Entry>::iterator anEntry);
+
+        std::list<Entry> myEntries; // most recently used first
+        size_t myBudgetBytes;
+        Stats myStats;
+    };
+} //namespace HeatTreatFurnace::Program
+
+#endif //HEAT_TREAT_FURNACE_PROGRAM_CACHE_HPP
@@ -0,0 +1,541 @@
+#include "ProgramJson.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <limits>
+
+#include <flatbuffers/flatbuffers.h>
+#include "furnace_generated.h"
+
+namespace HeatTreatFurnace::Program
+{
+    namespace
+    {
+        constexpr size_t MAX_NESTING_DEPTH = 16;
+        constexpr uint32_t SECONDS_PER_HOUR = 3600;
+        constexpr uint32_t SECONDS_PER_MINUTE = 60;
+
+        /**
+         * @brief Minimal pull reader for the subset of JSON the program format needs.
+         * Unknown members are skipped so the editor can carry extra fields.
+         */
+        class JsonReader
+        {
+        public:
+            explicit JsonReader(std::string_view aText) :
+                myText(aText)
+            {
+            }
+
+            bool Consume(char aToken)
+            {
+                PrivSkipWhitespace();
+                if (myPos < myText.size() && myText[myPos] == aToken)
+                {
+                    ++myPos;
+                    return true;
+                }
+                return false;
+            }
+
+            bool AtEnd()
+            {
+                PrivSkipWhitespace();
+                return myPos == myText.size();
+            }
+
+            bool ReadNumber(double& aOut)
+            {
+                PrivSkipWhitespace();
+                const char* begin = myText.data() + myPos;
+                const char* end = myText.data() + myText.size();
+                auto [ptr, ec] = std::from_chars(begin, end, aOut);
+                // from_chars also reads "inf" and "nan", which aren't JSON
+                if (ec != std::errc() || !std::isfinite(aOut))
+                {
+                    return false;
+                }
+                myPos += static_cast<size_t>(ptr - begin);
+                return true;
+            }
+
+            bool ReadString(std::string& aOut)
+            {
+                if (!Consume('"'))
+                {
+                    return false;
+                }
+
+                aOut.clear();
+                while (myPos < myText.size())
+                {
+                    char c = myText[myPos++];
+                    if (c == '"')
+                    {
+                        return true;
+                    }
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        return false;
+                    }
+                    if (c != '\\')
+                    {
+                        aOut.push_back(c);
+                        continue;
+                    }
+                    if (!PrivReadEscape(aOut))
+                    {
+                        return false;
+                    }
+                }
+                return false;
+            }
+
+            template <typename OnMember>
+            bool ReadObject(OnMember&& aOnMember)
+            {
+                if (!Consume('{'))
+                {
+                    return false;
+                }
+                if (Consume('}'))
+                {
+                    return true;
+                }
+
+                std::string key;
+                do
+                {
+                    if (!ReadString(key) || !Consume(':') || !aOnMember(key))
+                    {
+                        return false;
+                    }
+                }
+                while (Consume(','));
+
+                return Consume('}');
+            }
+
+            template <typename OnElement>
+            bool ReadArray(OnElement&& aOnElement)
+            {
+                if (!Consume('['))
+                {
+                    return false;
+                }
+                if (Consume(']'))
+                {
+                    return true;
+                }
+
+                do
+                {
+                    if (!aOnElement())
+                    {
+                        return false;
+                    }
+                }
+                while (Consume(','));
+
+                return Consume(']');
+            }
+
+            bool SkipValue(size_t aDepth = 0)
+            {
+                if (aDepth > MAX_NESTING_DEPTH)
+                {
+                    return false;
+                }
+
+                PrivSkipWhitespace();
+                if (myPos >= myText.size())
+                {
+                    return false;
+                }
+
+                switch (myText[myPos])
+                {
+                case '{':
+                    return ReadObject([this, aDepth](const std::string&) { return SkipValue(aDepth + 1); });
+                case '[':
+                    return ReadArray([this, aDepth]() { return SkipValue(aDepth + 1); });
+                case '"':
+                    {
+                        std::string ignored;
+                        return ReadString(ignored);
+                    }
+                case 't':
+                    return PrivReadLiteral("true");
+                case 'f':
+                    return PrivReadLiteral("false");
+                case 'n':
+                    return PrivReadLiteral("null");
+                default:
+                    {
+                        double ignored = 0.0;
+                        return ReadNumber(ignored);
+                    }
+                }
+            }
+
+        private:
+            void PrivSkipWhitespace()
+            {
+                while (myPos < myText.size() && (myText[myPos] == ' ' || myText[myPos] == '\n' || myText[myPos] == '\r' || myText[myPos] == '\t'))
+                {
+                    ++myPos;
+                }
+            }
+
+            bool PrivReadLiteral(std::string_view aLiteral)
+            {
+                if (myText.substr(myPos, aLiteral.size()) != aLiteral)
+                {
+                    return false;
+                }
+                myPos += aLiteral.size();
+                return true;
+            }
+
+            bool PrivReadHex4(uint32_t& aOut)
+            {
+                if (myPos + 4 > myText.size())
+                {
+                    return false;
+                }
+                const char* begin = myText.data() + myPos;
+                auto [ptr, ec] = std::from_chars(begin, begin + 4, aOut, 16);
+                if (ec != std::errc() || ptr != begin + 4)
+                {
+                    return false;
+                }
+                myPos += 4;
+                return true;
+            }
+
+            bool PrivReadEscape(std::string& aOut)
+            {
+                if (myPos >= myText.size())
+                {
+                    return false;
+                }
+
+                char escape = myText[myPos++];
+                switch (escape)
+                {
+                case '"':
+                case '\\':
+                case '/':
+                    aOut.push_back(escape);
+                    return true;
+                case 'b':
+                    aOut.push_back('\b');
+                    return true;
+                case 'f':
+                    aOut.push_back('\f');
+                    return true;
+                case 'n':
+                    aOut.push_back('\n');
+                    return true;
+                case 'r':
+                    aOut.push_back('\r');
+                    return true;
+                case 't':
+                    aOut.push_back('\t');
+                    return true;
+                case 'u':
+                    return PrivReadCodePoint(aOut);
+                default:
+                    return false;
+                }
+            }
+
+            bool PrivReadCodePoint(std::string& aOut)
+            {
+                uint32_t code = 0;
+                if (!PrivReadHex4(code))
+                {
+                    return false;
+                }
+
+                if (code >= 0xD800 && code <= 0xDBFF)
+                {
+                    uint32_t low = 0;
+                    if (!PrivReadLiteral("\\u") || !PrivReadHex4(low) || low < 0xDC00 || low > 0xDFFF)
+                    {
+                        return false;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                if (code < 0x80)
+                {
+                    aOut.push_back(static_cast<char>(code));
+                }
+                else if (code < 0x800)
+                {
+                    aOut.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                    aOut.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+                else if (code < 0x10000)
+                {
+                    aOut.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                    aOut.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                    aOut.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+                else
+                {
+                    aOut.push_back(static_cast<char>(0xF0 | (code >> 18)));
+                    aOut.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                    aOut.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                    aOut.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                }
+                return true;
+            }
+
+            std::string_view myText;
+            size_t myPos = 0;
+        };
+
+        class ProgramParser
+        {
+        public:
+            explicit ProgramParser(std::string_view aJson) :
+                myReader(aJson)
+            {
+            }
+
+            Furnace::Result Parse(std::string& aDescriptionOut, std::vector<::Furnace::ProgramSegment>& aSegmentsOut)
+            {
+                bool hasSegments = false;
+                bool ok = myReader.ReadObject([&](const std::string& aKey)
+                {
+                    if (aKey == "description")
+                    {
+                        return myReader.ReadString(aDescriptionOut);
+                    }
+                    if (aKey == "segments")
+                    {
+                        hasSegments = true;
+                        return myReader.ReadArray([&]() { return PrivParseSegment(aSegmentsOut); });
+                    }
+                    return myReader.SkipValue();
+                });
+
+                if (!ok || !myReader.AtEnd())
+                {
+                    if (myError.empty())
+                    {
+                        return {false, "Program is not valid JSON"};
+                    }
+                    return {false, myError};
+                }
+                if (!hasSegments)
+                {
+                    return {false, "Program is missing the segments array"};
+                }
+                return {true, ""};
+            }
+
+        private:
+            bool PrivParseSegment(std::vector<::Furnace::ProgramSegment>& aSegmentsOut)
+            {
+                double target = 0.0;
+                uint32_t rampSeconds = 0;
+                uint32_t dwellSeconds = 0;
+                bool hasTarget = false;
+                bool hasRamp = false;
+                bool hasDwell = false;
+
+                bool ok = myReader.ReadObject([&](const std::string& aKey)
+                {
+                    if (aKey == "target")
+                    {
+                        hasTarget = true;
+                        return myReader.ReadNumber(target);
+                    }
+                    if (aKey == "ramp_time")
+                    {
+                        hasRamp = true;
+                        return PrivParseDuration(rampSeconds);
+                    }
+                    if (aKey == "dwell_time")
+                    {
+                        hasDwell = true;
+                        return PrivParseDuration(dwellSeconds);
+                    }
+                    return myReader.SkipValue();
+                });
+
+                if (!ok)
+                {
+                    return false;
+                }
+                if (!hasTarget || !hasRamp || !hasDwell)
+                {
+                    myError = "Segment requires target, ramp_time and dwell_time";
+                    return false;
+                }
+                if (!std::isfinite(target))
+                {
+                    myError = "Segment target is not a number";
+                    return false;
+                }
+
+                aSegmentsOut.emplace_back(static_cast<float>(target), rampSeconds, dwellSeconds);
+                return true;
+            }
+
+            bool PrivParseDuration(uint32_t& aSecondsOut)
+            {
+                double total = 0.0;
+                bool ok = myReader.ReadObject([&](const std::string& aKey)
+                {
+                    double scale = 0.0;
+                    if (aKey == "hours")
+                    {
+                        scale = SECONDS_PER_HOUR;
+                    }
+                    else if (aKey == "minutes")
+                    {
+                        scale = SECONDS_PER_MINUTE;
+                    }
+                    else if (aKey == "seconds")
+                    {
+                        scale = 1.0;
+                    }
+                    else
+                    {
+                        return myReader.SkipValue();
+                    }
+
+                    double value = 0.0;
+                    if (!myReader.ReadNumber(value))
+                    {
+                        return false;
+                    }
+                    if (!std::isfinite(value) || value < 0.0)
+                    {
+                        myError = "Time values must be non-negative numbers";
+                        return false;
+                    }
+                    total += value * scale;
+                    return true;
+                });
+
+                if (!ok)
+                {
+                    return false;
+                }
+                if (total > static_cast<double>(std::numeric_limits<uint32_t>::max()))
+                {
+                    myError = "Time value is too large";
+                    return false;
+                }
+
+                // long is 32 bits on the ESP32, too small for the larger uint32_t values
+                aSecondsOut = static_cast<uint32_t>(std::llround(total));
+                return true;
+            }
+
+            JsonReader myReader;
+            Log::LogMessage myError;
+        };
+
+        void AppendEscaped(std::string& aOut, std::string_view aText)
+        {
+            for (char c : aText)
+            {
+                switch (c)
+                {
+                case '"':
+                    aOut += "\\\"";
+                    break;
+                case '\\':
+                    aOut += "\\\\";
+                    break;
+                case '\n':
+                    aOut += "\\n";
+                    break;
+                case '\r':
+                    aOut += "\\r";
+                    break;
+                case '\t':
+                    aOut += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        aOut += std::format("\\u{:04x}", static_cast<unsigned>(c));
+                    }
+                    else
+                    {
+                        aOut.push_back(c);
+                    }
+                    break;
+                }
+            }
+        }
+
+        void AppendDuration(std::string& aOut, std::chrono::milliseconds aDuration)
+        {
+            auto totalSeconds = std::chrono::duration_cast<std::chrono::seconds>(aDuration).count();
+            aOut += std::format("{{ \"hours\": {}, \"minutes\": {}, \"seconds\": {} }}",
+                                totalSeconds / SECONDS_PER_HOUR,
+                                (totalSeconds % SECONDS_PER_HOUR) / SECONDS_PER_MINUTE,
+                                totalSeconds % SECONDS_PER_MINUTE);
+        }
+    }
+
+    Furnace::Result ProgramJson::Import(std::string_view aJson, std::vector<uint8_t>& aProgramOut)
+    {
+        if (aJson.size() > MAX_JSON_SIZE)
+        {
+            return {false, "Program exceeds 10KB"};
+        }
+
+        std::string description;
+        std::vector<::Furnace::ProgramSegment> segments;
+        ProgramParser parser(aJson);
+        Furnace::Result res = parser.Parse(description, segments);
+        if (!res)
+        {
+            return res;
+        }
+
+        flatbuffers::FlatBufferBuilder builder(aJson.size());
+        auto descriptionOffset = builder.CreateString(description);
+        auto segmentsOffset = builder.CreateVectorOfStructs(segments);
+        builder.Finish(::Furnace::CreateProgram(builder, descriptionOffset, segmentsOffset));
+
+        aProgramOut.assign(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
+        return {true, ""};
+    }
+
+    Furnace::Result ProgramJson::Export(const Furnace::Profile& aProfile, std::string& aJsonOut)
+    {
+        if (!aProfile.IsLoaded())
+        {
+            return {false, "No program loaded"};
+        }
+
+        aJsonOut.clear();
+        aJsonOut += "{\n  \"description\": \"";
+        AppendEscaped(aJsonOut, aProfile.Description());
+        aJsonOut += "\",\n  \"segments\": [\n";
+
+        for (size_t i = 0; i < aProfile.SegmentCount(); ++i)
+        {
+            Furnace::ProfileSegment segment = aProfile.Segment(i);
+            aJsonOut += std::format("    {{\n      \"target\": {},\n      \"ramp_time\": ", segment.target);
+            AppendDuration(aJsonOut, segment.rampTime);
+            aJsonOut += ",\n      \"dwell_time\": ";
+            AppendDuration(aJsonOut, segment.dwellTime);
+            aJsonOut += (i + 1 < aProfile.SegmentCount()) ? "\n    },\n" : "\n    }\n";
+        }
+
+        aJsonOut += "  ]\n}\n";
+        return {true, ""};
+    }
+} //namespace HeatTreatFurnace::Program
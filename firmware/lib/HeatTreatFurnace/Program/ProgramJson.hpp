@@ -0,0 +1,33 @@
+#ifndef HEAT_TREAT_FURNACE_PROGRAM_JSON_HPP
+#define HEAT_TREAT_FURNACE_PROGRAM_JSON_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Furnace/Profile.hpp"
+#include "Furnace/Result.hpp"
+
+namespace HeatTreatFurnace::Program
+{
+    /**
+     * @brief Converts between the editor's JSON program format (API.md "Program File Format")
+     * and the compiled Program buffer stored on flash.
+     *
+     * Only used at the edges: when the frontend saves a program, and when it asks for one back.
+     */
+    class ProgramJson
+    {
+    public:
+        static constexpr size_t MAX_JSON_SIZE = 10 * 1024;
+
+        /** @brief Compile editor JSON into a Program buffer */
+        static Furnace::Result Import(std::string_view aJson, std::vector<uint8_t>& aProgramOut);
+
+        /** @brief Render a loaded profile back into editor JSON */
+        static Furnace::Result Export(const Furnace::Profile& aProfile, std::string& aJsonOut);
+    };
+} //namespace HeatTreatFurnace::Program
+
+#endif //HEAT_TREAT_FURNACE_PROGRAM_JSON_HPP
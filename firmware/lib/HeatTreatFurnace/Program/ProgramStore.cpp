@@ -0,0 +1,345 @@
+#include "ProgramStore.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "ProgramJson.hpp"
+
+namespace HeatTreatFurnace::Program
+{
+    namespace
+    {
+        struct FileCloser
+        {
+            void operator()(std::FILE* aFile) const
+            {
+                std::fclose(aFile);
+            }
+        };
+
+        using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+        bool ReadFile(const std::string& aPath, std::vector<uint8_t>& aBufferOut)
+        {
+            FilePtr file(std::fopen(aPath.c_str(), "rb"));
+            if (!file || std::fseek(file.get(), 0, SEEK_END) != 0)
+            {
+                return false;
+            }
+            long size = std::ftell(file.get());
+            if (size <= 0 || std::fseek(file.get(), 0, SEEK_SET) != 0)
+            {
+                return false;
+            }
+
+            aBufferOut.resize(static_cast<size_t>(size));
+            return std::fread(aBufferOut.data(), 1, aBufferOut.size(), file.get()) == aBufferOut.size();
+        }
+    }
+
+    ProgramStore::ProgramStore(std::string_view aDirectory, Log::LogService& aLog, size_t aCacheBudgetBytes) :
+        Loggable(aLog), myDirectory(aDirectory), myCache(aCacheBudgetBytes)
+    {
+        PrivRecoverInterruptedWrites();
+    }
+
+    Furnace::Result ProgramStore::Save(std::string_view aName, std::string_view aJson)
+    {
+        if (!IsValidName(aName))
+        {
+            return {false, "Invalid program name"};
+        }
+
+        std::vector<uint8_t> compiled;
+        Furnace::Result res = ProgramJson::Import(aJson, compiled);
+        if (!res)
+        {
+            return res;
+        }
+
+        Furnace::Profile profile;
+        res = profile.Map(aName, compiled);
+        if (!res)
+        {
+            return res;
+        }
+
+        const ValidationReport report = myValidator.Validate(profile);
+        if (!report.IsValid())
+        {
+            res.success = false;
+            report.Describe(res.message);
+            return res;
+        }
+
+        // The editor saves as the user types, so don't rewrite flash if nothing changed
+        const uint32_t crc = ProgramCache::Crc(compiled);
+        if (myCache.Contains(aName, crc))
+        {
+            return {true, ""};
+        }
+
+        myCache.Invalidate(aName);
+        res = PrivWriteFile(aName, compiled);
+        if (res)
+        {
+            myCache.Insert(aName, crc, std::move(compiled));
+        }
+        return res;
+    }
+
+    void ProgramStore::SetPreferences(const Furnace::Preferences& aPreferences)
+    {
+        myValidator.SetPreferences(aPreferences);
+    }
+
+    Furnace::Result ProgramStore::Load(std::string_view aName, Furnace::Profile& aProfileOut)
+    {
+        std::vector<uint8_t> scratch;
+        std::span<const uint8_t> compiled;
+        Furnace::Result res = PrivReadCached(aName, scratch, compiled);
+        if (!res)
+        {
+            return res;
+        }
+
+        // The profile outlives any cache entry, so it gets its own copy
+        return aProfileOut.Load(aName, std::vector<uint8_t>(compiled.begin(), compiled.end()));
+    }
+
+    Furnace::Result ProgramStore::Read(std::string_view aName, std::string& aJsonOut)
+    {
+        std::vector<uint8_t> scratch;
+        std::span<const uint8_t> compiled;
+        Furnace::Result res = PrivReadCached(aName, scratch, compiled);
+        if (!res)
+        {
+            return res;
+        }
+
+        Furnace::Profile profile;
+        res = profile.Map(aName, compiled);
+        if (!res)
+        {
+            return res;
+        }
+        return ProgramJson::Export(profile, aJsonOut);
+    }
+
+    Furnace::Result ProgramStore::Describe(std::string_view aName, std::string& aDescriptionOut)
+    {
+        std::vector<uint8_t> scratch;
+        std::span<const uint8_t> compiled;
+        Furnace::Result res = PrivReadCached(aName, scratch, compiled);
+        if (!res)
+        {
+            return res;
+        }
+
+        Furnace::Profile profile;
+        res = profile.Map(aName, compiled);
+        if (!res)
+        {
+            return res;
+        }
+        aDescriptionOut = profile.Description();
+        return {true, ""};
+    }
+
+    Furnace::Result ProgramStore::List(std::vector<StoredProgram>& aProgramsOut) const
+    {
+        aProgramsOut.clear();
+        std::unique_ptr<DIR, int (*)(DIR*)> directory(opendir(myDirectory.c_str()), closedir);
+        if (!directory)
+        {
+            return {false, "Failed to read programs"};
+        }
+
+        while (const dirent* entry = readdir(directory.get()))
+        {
+            const std::string_view file = entry->d_name;
+            if (!file.ends_with(COMPILED_EXTENSION))
+            {
+                continue;
+            }
+            std::string name(file.substr(0, file.size() - COMPILED_EXTENSION.size()));
+            name += PROGRAM_EXTENSION;
+            struct stat info{};
+            if (!IsValidName(name) || stat(PrivPath(name).c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+            {
+                continue;
+            }
+            aProgramsOut.push_back({std::move(name), static_cast<size_t>(info.st_size)});
+        }
+
+        std::ranges::sort(aProgramsOut, {}, &StoredProgram::name);
+        return {true, ""};
+    }
+
+    Furnace::Result ProgramStore::Remove(std::string_view aName)
+    {
+        if (!IsValidName(aName))
+        {
+            return {false, "Invalid program name"};
+        }
+
+        myCache.Invalidate(aName);
+        if (std::remove(PrivPath(aName).c_str()) != 0)
+        {
+            return {false, "Program not found"};
+        }
+        return {true, ""};
+    }
+
+    const ProgramCache::Stats& ProgramStore::GetCacheStats() const
+    {
+        return myCache.GetStats();
+    }
+
+    bool ProgramStore::IsValidName(std::string_view aName)
+    {
+        if (aName.size() > MAX_NAME_LENGTH || aName.size() <= PROGRAM_EXTENSION.size() || !aName.ends_with(PROGRAM_EXTENSION))
+        {
+            return false;
+        }
+
+        for (char c : aName)
+        {
+            bool allowed = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '.' || c == '_';
+            if (!allowed)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string ProgramStore::PrivPath(std::string_view aName) const
+    {
+        std::string path = myDirectory;
+        path += '/';
+        path += aName.substr(0, aName.size() - PROGRAM_EXTENSION.size());
+        path += COMPILED_EXTENSION;
+        return path;
+    }
+
+    Furnace::Result ProgramStore::PrivReadFile(std::string_view aName, std::vector<uint8_t>& aBufferOut) const
+    {
+        const std::string path = PrivPath(aName);
+        struct stat info{};
+        if (stat(path.c_str(), &info) != 0)
+        {
+            return {false, "Program not found"};
+        }
+        if (!ReadFile(path, aBufferOut))
+        {
+            return {false, "Failed to read program"};
+        }
+        return {true, ""};
+    }
+
+    Furnace::Result ProgramStore::PrivReadCached(std::string_view aName, std::vector<uint8_t>& aScratch, std::span<const uint8_t>& aBufferOut)
+    {
+        if (!IsValidName(aName))
+        {
+            return {false, "Invalid program name"};
+        }
+
+        if (const std::vector<uint8_t>* cached = myCache.Find(aName))
+        {
+            aBufferOut = *cached;
+            return {true, ""};
+        }
+
+        Furnace::Result res = PrivReadFile(aName, aScratch);
+        if (!res)
+        {
+            return res;
+        }
+
+        myCache.Insert(aName, ProgramCache::Crc(aScratch), aScratch);
+        aBufferOut = aScratch;
+        return {true, ""};
+    }
+
+    Furnace::Result ProgramStore::PrivWriteFile(std::string_view aName, const std::vector<uint8_t>& aBuffer)
+    {
+        // Write beside the old file and swap, so a power cut never leaves a half written program
+        const std::string path = PrivPath(aName);
+        const std::string tempPath = path + std::string(TEMP_EXTENSION);
+
+        FilePtr file(std::fopen(tempPath.c_str(), "wb"));
+        if (!file)
+        {
+            Log(Log::LogLevel::Error, "Unable to open {} for writing", tempPath);
+            return {false, "Failed to write program"};
+        }
+        const bool written = std::fwrite(aBuffer.data(), 1, aBuffer.size(), file.get()) == aBuffer.size();
+        // Buffered data only reaches flash on close, which can fail too
+        if (std::fclose(file.release()) != 0 || !written)
+        {
+            Log(Log::LogLevel::Error, "Short write to {}", tempPath);
+            std::remove(tempPath.c_str());
+            return {false, "Failed to write program"};
+        }
+
+        if (std::rename(tempPath.c_str(), path.c_str()) != 0)
+        {
+            // SPIFFS won't rename over a file; if the power goes now, the .tmp is recovered at startup
+            std::remove(path.c_str());
+            if (std::rename(tempPath.c_str(), path.c_str()) != 0)
+            {
+                Log(Log::LogLevel::Error, "Unable to rename {} to {}", tempPath, path);
+                std::remove(tempPath.c_str());
+                return {false, "Failed to write program"};
+            }
+        }
+        return {true, ""};
+    }
+
+    void ProgramStore::PrivRecoverInterruptedWrites()
+    {
+        std::unique_ptr<DIR, int (*)(DIR*)> directory(opendir(myDirectory.c_str()), closedir);
+        if (!directory)
+        {
+            return;
+        }
+
+        std::vector<std::string> tempFiles;
+        while (const dirent* entry = readdir(directory.get()))
+        {
+            const std::string_view file = entry->d_name;
+            if (file.ends_with(TEMP_EXTENSION) && file.substr(0, file.size() - TEMP_EXTENSION.size()).ends_with(COMPILED_EXTENSION))
+            {
+                tempFiles.emplace_back(myDirectory + '/' + std::string(file));
+            }
+        }
+        directory.reset();
+
+        for (const std::string& tempPath : tempFiles)
+        {
+            const std::string path = tempPath.substr(0, tempPath.size() - TEMP_EXTENSION.size());
+            struct stat info{};
+            std::vector<uint8_t> buffer;
+            Furnace::Profile profile;
+            // The old program is still there, or the .tmp was never finished: the save didn't happen
+            if (stat(path.c_str(), &info) == 0 || !ReadFile(tempPath, buffer) || !profile.Map(path, buffer))
+            {
+                Log(Log::LogLevel::Warn, "Removing {} left by an interrupted save", tempPath);
+                std::remove(tempPath.c_str());
+                continue;
+            }
+
+            if (std::rename(tempPath.c_str(), path.c_str()) != 0)
+            {
+                Log(Log::LogLevel::Error, "Unable to recover {}", tempPath);
+                continue;
+            }
+            Log(Log::LogLevel::Warn, "Recovered {} from an interrupted save", path);
+        }
+    }
+} //namespace HeatTreatFurnace::Program
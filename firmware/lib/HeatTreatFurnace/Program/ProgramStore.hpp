@@ -0,0 +1,102 @@
+#ifndef HEAT_TREAT_FURNACE_PROGRAM_STORE_HPP
+#define HEAT_TREAT_FURNACE_PROGRAM_STORE_HPP
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ProgramCache.hpp"
+#include "ProgramValidator.hpp"
+#include "Furnace/Preferences.hpp"
+#include "Furnace/Profile.hpp"
+#include "Furnace/Result.hpp"
+#include "Log/LogService.hpp"
+
+namespace HeatTreatFurnace::Program
+{
+    /** @brief A program as ListProgramsRequest reports it */
+    struct StoredProgram
+    {
+        std::string name; // "program1.json"
+        size_t size = 0; // bytes on flash, compiled
+    };
+
+    /**
+     * @brief Firing programs on flash (SPIFFS on the ESP32, any directory on the host).
+     *
+     * Programs are named as the frontend knows them ("program1.json") but are stored compiled,
+     * so loading one for a firing is a file read and a buffer verify, with no JSON parsing.
+     */
+    class ProgramStore : public Log::Loggable
+    {
+    public:
+        static constexpr std::string_view PROGRAM_EXTENSION = ".json";
+        static constexpr std::string_view COMPILED_EXTENSION = ".fbp";
+        static constexpr std::string_view TEMP_EXTENSION = ".tmp";
+        static constexpr size_t MAX_NAME_LENGTH = 20;
+        static constexpr size_t DEFAULT_CACHE_BUDGET = 16 * 1024;
+
+        /** @param aCacheBudgetBytes Memory for compiled programs kept after they are read or saved, 0 disables caching
+         * Finishes or discards any save a power cut interrupted, see PrivWriteFile()
+         */
+        ProgramStore(std::string_view aDirectory, Log::LogService& aLog, size_t aCacheBudgetBytes = DEFAULT_CACHE_BUDGET);
+        ~ProgramStore() override = default;
+
+        /** @brief Limits and kiln characteristics programs are validated against on save */
+        void SetPreferences(const Furnace::Preferences& aPreferences);
+
+        /** @brief SaveProgramRequest: compile and validate editor JSON and store it.
+         * A program that fails validation is not stored; every violation is listed in the message.
+         */
+        Furnace::Result Save(std::string_view aName, std::string_view aJson);
+
+        /** @brief LoadCommand: read the compiled program into aProfileOut */
+        Furnace::Result Load(std::string_view aName, Furnace::Profile& aProfileOut);
+
+        /** @brief GetProgramRequest: read the compiled program back as editor JSON */
+        Furnace::Result Read(std::string_view aName, std::string& aJsonOut);
+
+        /** @brief ListProgramsRequest: the program's description */
+        Furnace::Result Describe(std::string_view aName, std::string& aDescriptionOut);
+
+        /** @brief ListProgramsRequest: every stored program, sorted by name */
+        Furnace::Result List(std::vector<StoredProgram>& aProgramsOut) const;
+
+        /** @brief DeleteProgramRequest */
+        Furnace::Result Remove(std::string_view aName);
+
+        /** @brief Cache hit/miss counters for GetDebugInfoRequest */
+        [[nodiscard]] const ProgramCache::Stats& GetCacheStats() const;
+
+        [[nodiscard]] static bool IsValidName(std::string_view aName);
+
+    protected:
+        [[nodiscard]] const etl::string_view& GetLogDomain() override
+        {
+            return myDomain;
+        };
+
+    private:
+        [[nodiscard]] std::string PrivPath(std::string_view aName) const;
+        Furnace::Result PrivReadFile(std::string_view aName, std::vector<uint8_t>& aBufferOut) const;
+        /** @brief aBufferOut points into the cache, or into aScratch if the program was read from flash */
+        Furnace::Result PrivReadCached(std::string_view aName, std::vector<uint8_t>& aScratch, std::span<const uint8_t>& aBufferOut);
+        /** @brief Write to a .tmp beside the program and rename it over the old one.
+         * SPIFFS can't rename over a file, so there the old one is removed first and
+         * PrivRecoverInterruptedWrites() finishes the rename if the power goes in between.
+         */
+        Furnace::Result PrivWriteFile(std::string_view aName, const std::vector<uint8_t>& aBuffer);
+        /** @brief A .tmp whose program is missing and which verifies is renamed into place, any other .tmp is removed */
+        void PrivRecoverInterruptedWrites();
+
+        std::string myDirectory;
+        ProgramValidator myValidator;
+        ProgramCache myCache;
+
+        static constexpr etl::string_view myDomain = "ProgramStore";
+    };
+} //namespace HeatTreatFurnace::Program
+
+#endif //HEAT_TREAT_FURNACE_PROGRAM_STORE_HPP
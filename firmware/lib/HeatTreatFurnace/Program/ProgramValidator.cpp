@@ -0,0 +1,200 @@
+#include "ProgramValidator.hpp"
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+
+namespace HeatTreatFurnace::Program
+{
+    namespace
+    {
+        constexpr float SECONDS_PER_HOUR = 3600.0f;
+        constexpr double JOULES_PER_KWH = 3.6e6;
+
+        void AddViolation(ValidationReport& aReport, ViolationCode aCode, size_t aSegment, float aValue, float aLimit)
+        {
+            if (aReport.violations.full())
+            {
+                ++aReport.droppedViolations;
+                return;
+            }
+            aReport.violations.push_back({aCode, static_cast<uint16_t>(aSegment), aValue, aLimit});
+        }
+
+        const char* DescribeCode(ViolationCode aCode)
+        {
+            switch (aCode)
+            {
+            case ViolationCode::NO_SEGMENTS:
+                return "program has no segments";
+            case ViolationCode::TARGET_ABOVE_MAX:
+                return "target {:.0f}°C is above MAX_Temperature {:.0f}°C";
+            case ViolationCode::TARGET_BELOW_MIN:
+                return "target {:.0f}°C is below MIN_Temperature {:.0f}°C";
+            case ViolationCode::RAMP_TOO_FAST:
+                return "ramp of {:.0f}°C/h exceeds MAX_Heating_Rate {:.0f}°C/h";
+            case ViolationCode::RAMP_EXCEEDS_HEATER:
+                return "ramp needs {:.0f}W, heater provides {:.0f}W";
+            case ViolationCode::COOLING_TOO_FAST:
+                return "cooling at {:.0f}°C/h is faster than natural cooling of {:.0f}°C/h";
+            case ViolationCode::TARGET_UNSUSTAINABLE:
+                return "holding target needs {:.0f}W, heater provides {:.0f}W";
+            case ViolationCode::DURATION_TOO_LONG:
+                return "program runs {:.1f}h, MAX_Program_Hours is {:.0f}h";
+            case ViolationCode::ENERGY_TOO_HIGH:
+                return "program needs an estimated {:.1f}kWh, MAX_Program_Energy is {:.1f}kWh";
+            }
+            return "unknown violation";
+        }
+
+        bool IsProgramWide(ViolationCode aCode)
+        {
+            return aCode == ViolationCode::NO_SEGMENTS || aCode == ViolationCode::DURATION_TOO_LONG || aCode == ViolationCode::ENERGY_TOO_HIGH;
+        }
+    }
+
+    void ValidationReport::Describe(Log::LogMessage& aOut) const
+    {
+        // Room kept for the "...and N more" line whenever more follows, so nothing is left out unannounced
+        constexpr size_t MORE_LENGTH = 24;
+
+        aOut.clear();
+        size_t omitted = droppedViolations;
+        for (size_t i = 0; i < violations.size(); ++i)
+        {
+            const Violation& violation = violations[i];
+            Log::LogMessage line;
+            if (!aOut.empty())
+            {
+                line.push_back('\n');
+            }
+            auto out = std::back_inserter(line);
+            if (!IsProgramWide(violation.code))
+            {
+                out = std::format_to(out, "Segment {}: ", violation.segment + 1);
+            }
+            std::vformat_to(out, DescribeCode(violation.code), std::make_format_args(violation.value, violation.limit));
+
+            const bool moreFollow = i + 1 < violations.size() || droppedViolations > 0;
+            if (aOut.size() + line.size() + (moreFollow ? MORE_LENGTH : 0) > aOut.capacity())
+            {
+                omitted += violations.size() - i;
+                break;
+            }
+            aOut.append(line);
+        }
+
+        if (omitted > 0)
+        {
+            std::format_to(std::back_inserter(aOut), "\n...and {} more", omitted);
+        }
+    }
+
+    ProgramValidator::ProgramValidator(const Furnace::Preferences& aPreferences) :
+        myPreferences(aPreferences)
+    {
+    }
+
+    void ProgramValidator::SetPreferences(const Furnace::Preferences& aPreferences)
+    {
+        myPreferences = aPreferences;
+    }
+
+    ValidationReport ProgramValidator::Validate(const Furnace::Profile& aProfile) const
+    {
+        return Validate(aProfile, myPreferences.ambientTemperature);
+    }
+
+    ValidationReport ProgramValidator::Validate(const Furnace::Profile& aProfile, float aStartTemperature) const
+    {
+        ValidationReport report;
+        const Furnace::Preferences& prefs = myPreferences;
+        const size_t count = aProfile.SegmentCount();
+
+        if (count == 0)
+        {
+            AddViolation(report, ViolationCode::NO_SEGMENTS, 0, 0.0f, 0.0f);
+            return report;
+        }
+
+        const float ambient = prefs.ambientTemperature;
+        float previousTarget = aStartTemperature;
+        double energyJ = 0.0;
+        std::chrono::milliseconds duration{0};
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Furnace::ProfileSegment segment = aProfile.Segment(i);
+            const float rampS = std::chrono::duration<float>(segment.rampTime).count();
+            const float dwellS = std::chrono::duration<float>(segment.dwellTime).count();
+            const float delta = segment.target - previousTarget;
+            const float holdPowerW = prefs.lossWPerC * (segment.target - ambient);
+
+            if (segment.target > prefs.maxTemperature)
+            {
+                AddViolation(report, ViolationCode::TARGET_ABOVE_MAX, i, segment.target, prefs.maxTemperature);
+            }
+            else if (segment.target < prefs.minTemperature)
+            {
+                AddViolation(report, ViolationCode::TARGET_BELOW_MIN, i, segment.target, prefs.minTemperature);
+            }
+
+            if (holdPowerW > prefs.heaterPowerW)
+            {
+                AddViolation(report, ViolationCode::TARGET_UNSUSTAINABLE, i, holdPowerW, prefs.heaterPowerW);
+            }
+
+            if (rampS > 0.0f && delta > 0.0f)
+            {
+                const float rateCPerS = delta / rampS;
+                if (prefs.maxHeatingRate > 0.0f && rateCPerS * SECONDS_PER_HOUR > prefs.maxHeatingRate)
+                {
+                    AddViolation(report, ViolationCode::RAMP_TOO_FAST, i, rateCPerS * SECONDS_PER_HOUR, prefs.maxHeatingRate);
+                }
+
+                // Worst case is the top of the ramp, where losses are highest
+                const float rampPowerW = prefs.thermalMassJPerC * rateCPerS + holdPowerW;
+                if (rampPowerW > prefs.heaterPowerW)
+                {
+                    AddViolation(report, ViolationCode::RAMP_EXCEEDS_HEATER, i, rampPowerW, prefs.heaterPowerW);
+                }
+            }
+
+            if (rampS > 0.0f && delta < 0.0f && prefs.thermalMassJPerC > 0.0f)
+            {
+                // Passive cooling at the ramp's mean temperature, as for its losses below. Passive cooling only
+                // approaches ambient, so a ramp that is mostly at or below ambient just lags and isn't rejected.
+                const float requestedCPerS = -delta / rampS;
+                const float naturalCPerS = prefs.lossWPerC * ((previousTarget + segment.target) * 0.5f - ambient) / prefs.thermalMassJPerC;
+                if (naturalCPerS > 0.0f && requestedCPerS > naturalCPerS)
+                {
+                    AddViolation(report, ViolationCode::COOLING_TOO_FAST, i, requestedCPerS * SECONDS_PER_HOUR, naturalCPerS * SECONDS_PER_HOUR);
+                }
+            }
+
+            // Heater energy: raise the load, then cover losses for the ramp (at its mean temperature) and the dwell
+            const double rampLossJ = prefs.lossWPerC * ((previousTarget + segment.target) * 0.5 - ambient) * rampS;
+            const double storedJ = static_cast<double>(prefs.thermalMassJPerC) * delta;
+            energyJ += std::max(0.0, storedJ + rampLossJ);
+            energyJ += std::max(0.0, static_cast<double>(holdPowerW) * dwellS);
+
+            duration += segment.rampTime + segment.dwellTime;
+            previousTarget = segment.target;
+        }
+
+        report.totalDuration = std::chrono::duration_cast<std::chrono::seconds>(duration);
+        report.estimatedEnergyKWh = static_cast<float>(energyJ / JOULES_PER_KWH);
+
+        const float hours = std::chrono::duration<float, std::ratio<3600>>(duration).count();
+        if (prefs.maxProgramHours > 0 && hours > static_cast<float>(prefs.maxProgramHours))
+        {
+            AddViolation(report, ViolationCode::DURATION_TOO_LONG, 0, hours, static_cast<float>(prefs.maxProgramHours));
+        }
+        if (prefs.maxProgramEnergyKWh > 0.0f && report.estimatedEnergyKWh > prefs.maxProgramEnergyKWh)
+        {
+            AddViolation(report, ViolationCode::ENERGY_TOO_HIGH, 0, report.estimatedEnergyKWh, prefs.maxProgramEnergyKWh);
+        }
+
+        return report;
+    }
+} //namespace HeatTreatFurnace::Program
@@ -0,0 +1,78 @@
+#ifndef HEAT_TREAT_FURNACE_PROGRAM_VALIDATOR_HPP
+#define HEAT_TREAT_FURNACE_PROGRAM_VALIDATOR_HPP
+
+#include <chrono>
+#include <cstdint>
+
+#include "etl/vector.h"
+#include "Furnace/Preferences.hpp"
+#include "Furnace/Profile.hpp"
+#include "Log/LogService.hpp"
+
+namespace HeatTreatFurnace::Program
+{
+    enum class ViolationCode : uint8_t
+    {
+        NO_SEGMENTS,
+        TARGET_ABOVE_MAX, // value = target, limit = MAX_Temperature
+        TARGET_BELOW_MIN, // value = target, limit = MIN_Temperature
+        RAMP_TOO_FAST, // value = requested °C/h, limit = MAX_Heating_Rate
+        RAMP_EXCEEDS_HEATER, // value = W needed, limit = heater W
+        COOLING_TOO_FAST, // value = requested °C/h, limit = natural cooling °C/h
+        TARGET_UNSUSTAINABLE, // value = W needed to hold, limit = heater W
+        DURATION_TOO_LONG, // value = hours, limit = MAX_Program_Hours
+        ENERGY_TOO_HIGH // value = kWh, limit = MAX_Program_Energy
+    };
+
+    struct Violation
+    {
+        ViolationCode code;
+        uint16_t segment; // 0-indexed, 0 for whole-program violations
+        float value;
+        float limit;
+    };
+
+    constexpr size_t MAX_VIOLATIONS = 16;
+
+    struct ValidationReport
+    {
+        etl::vector<Violation, MAX_VIOLATIONS> violations;
+        uint16_t droppedViolations = 0; // found after violations filled up
+        std::chrono::seconds totalDuration{0};
+        float estimatedEnergyKWh = 0.0f;
+
+        [[nodiscard]] bool IsValid() const
+        {
+            return violations.empty();
+        }
+
+        /** @brief One line per violation, for Ack.error and the log; those that don't fit end in "...and N more" */
+        void Describe(Log::LogMessage& aOut) const;
+    };
+
+    /**
+     * @brief Checks a profile is allowed by the preferences and achievable by the kiln.
+     *
+     * One pass over the segments with no allocation, so it is cheap enough to run on every save
+     * from the editor as well as before a profile is loaded. Uses the first order thermal model
+     * from SPECIFICATION.md §4 with the nominal kiln characteristics from Preferences.
+     */
+    class ProgramValidator
+    {
+    public:
+        explicit ProgramValidator(const Furnace::Preferences& aPreferences = {});
+
+        void SetPreferences(const Furnace::Preferences& aPreferences);
+
+        /** @param aStartTemperature Kiln temperature the first segment ramps from */
+        [[nodiscard]] ValidationReport Validate(const Furnace::Profile& aProfile, float aStartTemperature) const;
+
+        /** @brief Validate assuming the first segment ramps from ambient */
+        [[nodiscard]] ValidationReport Validate(const Furnace::Profile& aProfile) const;
+
+    private:
+        Furnace::Preferences myPreferences;
+    };
+} //namespace HeatTreatFurnace::Program
+
+#endif //HEAT_TREAT_FURNACE_PROGRAM_VALIDATOR_HPP
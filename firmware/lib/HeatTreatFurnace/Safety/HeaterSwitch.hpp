@@ -0,0 +1,24 @@
+#ifndef HEAT_TREAT_FURNACE_HEATER_SWITCH_HPP
+#define HEAT_TREAT_FURNACE_HEATER_SWITCH_HPP
+
+namespace HeatTreatFurnace::Safety
+{
+    /**
+     * @brief The heater SSRs, as the safety monitor sees them: it can only turn them off.
+     *
+     * On the ESP32 ForceOff() drives the SSR pins low and holds them there, whatever the control loop's
+     * SsrScheduler asks for, until Release(). Both are a few register writes and safe from any task.
+     */
+    class HeaterSwitch
+    {
+    public:
+        virtual ~HeaterSwitch() = default;
+
+        virtual void ForceOff() = 0;
+
+        /** @brief Hand the SSRs back to the control loop */
+        virtual void Release() = 0;
+    };
+} //namespace HeatTreatFurnace::Safety
+
+#endif //HEAT_TREAT_FURNACE_HEATER_SWITCH_HPP
@@ -0,0 +1,91 @@
+#include "RunawayDetector.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace HeatTreatFurnace::Safety
+{
+    namespace
+    {
+        float LagFraction(float aDt, float aLag)
+        {
+            return aLag <= 0.0f ? 1.0f : std::min(1.0f, aDt / aLag);
+        }
+
+        // A reading can't move more than twice as fast as the kiln can heat or cool, plus a few degrees of noise.
+        // Anything bigger is a sensor fault, like a reconnected thermocouple, so only that much counts as a change.
+        constexpr float MAX_RATE_FACTOR = 2.0f;
+        constexpr float NOISE_STEP = 2.0f; // °C
+    }
+
+    RunawayDetector::RunawayDetector(const RunawayModel& aModel) :
+        myModel(aModel)
+    {
+    }
+
+    void RunawayDetector::Configure(const RunawayModel& aModel)
+    {
+        myModel = aModel;
+        Reset();
+    }
+
+    void RunawayDetector::Reset()
+    {
+        myHasLast = false;
+        myExcess = 0.0f;
+        myDeficit = 0.0f;
+    }
+
+    void RunawayDetector::Update(float aTemperature, float aHeatPercent, std::chrono::microseconds aElapsed)
+    {
+        const float heat = std::clamp(aHeatPercent, 0.0f, 100.0f) / 100.0f;
+        const float dt = std::chrono::duration<float>(aElapsed).count();
+        if (!myHasLast || dt <= 0.0f)
+        {
+            // Nothing known about what came before: take the kiln as settled at this heat
+            myPower = heat;
+            myExpectedRate = PrivKilnRate(heat, aTemperature);
+            myLastTemperature = aTemperature;
+            myHasLast = true;
+            return;
+        }
+
+        myPower += (heat - myPower) * LagFraction(dt, myModel.elementLagS);
+        myExpectedRate += (PrivKilnRate(myPower, myLastTemperature) - myExpectedRate) * LagFraction(dt, myModel.sensorLagS);
+
+        const float maxRate = myModel.heatingRate + myModel.lossRate * std::abs(myLastTemperature - myModel.ambientTemperature);
+        const float maxStep = NOISE_STEP + MAX_RATE_FACTOR * maxRate * dt;
+        const float step = std::clamp(aTemperature - myLastTemperature, -maxStep, maxStep);
+        myLastTemperature = aTemperature;
+
+        const float residual = step - myExpectedRate * dt;
+        const float allowance = myModel.slack * dt;
+        myExcess = std::max(0.0f, myExcess + residual - allowance);
+        myDeficit = std::max(0.0f, myDeficit - residual - allowance);
+    }
+
+    float RunawayDetector::Excess() const
+    {
+        return myExcess;
+    }
+
+    float RunawayDetector::Deficit() const
+    {
+        return myDeficit;
+    }
+
+    float RunawayDetector::ExpectedRate() const
+    {
+        return myExpectedRate;
+    }
+
+    const RunawayModel& RunawayDetector::GetModel() const
+    {
+        return myModel;
+    }
+
+    float RunawayDetector::PrivKilnRate(float aPower, float aTemperature) const
+    {
+        return myModel.heatingRate * aPower - myModel.lossRate * (aTemperature - myModel.ambientTemperature);
+    }
+} //namespace HeatTreatFurnace::Safety
@@ -0,0 +1,83 @@
+#ifndef HEAT_TREAT_FURNACE_RUNAWAY_DETECTOR_HPP
+#define HEAT_TREAT_FURNACE_RUNAWAY_DETECTOR_HPP
+
+#include <chrono>
+
+#include "Furnace/Preferences.hpp"
+
+namespace HeatTreatFurnace::Safety
+{
+    /** @brief The kiln as RunawayDetector expects it to respond, SPECIFICATION.md §4 plus the element and thermocouple lags */
+    struct RunawayModel
+    {
+        float heatingRate = 0.075f; // °C/s at full power
+        float lossRate = 3.75e-5f; // 1/s
+        float ambientTemperature = 20.0f; // °C
+        float elementLagS = 40.0f; // the elements heating up before the kiln sees a power change
+        float sensorLagS = 20.0f; // the thermocouple and its sheath
+        float slack = 0.02f; // °C/s of model error ignored, a quarter of full power on the default kiln
+
+        /** @brief Kiln_Heater_Power, Kiln_Thermal_Mass, Kiln_Loss_Coefficient, Kiln_Ambient_Temperature */
+        static RunawayModel FromPreferences(const Furnace::Preferences& aPreferences)
+        {
+            RunawayModel model;
+            model.heatingRate = aPreferences.heaterPowerW / aPreferences.thermalMassJPerC;
+            model.lossRate = aPreferences.lossWPerC / aPreferences.thermalMassJPerC;
+            model.ambientTemperature = aPreferences.ambientTemperature;
+            return model;
+        }
+    };
+
+    /**
+     * @brief Catches a kiln that isn't heating the way its heater says it should (SPECIFICATION.md §8.2).
+     *
+     * Each reading, the heat percent the control loop asked for is passed through the element and
+     * thermocouple lags and the first-order model to get the rate the reading should be rising at.
+     * The difference from the rate it did rise at, less RunawayModel::slack, is summed two ways
+     * (a CUSUM), neither going below zero:
+     * - Excess(): °C the kiln has heated that the heater doesn't explain, e.g. an SSR stuck on
+     * - Deficit(): °C the reading has fallen behind the heater, e.g. a thermocouple out of the kiln
+     *
+     * Both grow from the first minute of a fault, where kilnTemp > setTemp + Thermal_Runaway waits for
+     * the overshoot; and a thermocouple out of the kiln never reads an overshoot at all. Update() is a
+     * fixed handful of multiply-adds, with no history kept.
+     */
+    class RunawayDetector
+    {
+    public:
+        explicit RunawayDetector(const RunawayModel& aModel = {});
+
+        /** @brief Also Reset(), since the sums were against the old model */
+        void Configure(const RunawayModel& aModel);
+
+        /** @brief Start again from the next reading, e.g. after a thermocouple fault */
+        void Reset();
+
+        /** @brief One reading: aTemperature now, with aHeatPercent asked for over the aElapsed before it */
+        void Update(float aTemperature, float aHeatPercent, std::chrono::microseconds aElapsed);
+
+        /** @brief °C of heating the heater doesn't explain */
+        [[nodiscard]] float Excess() const;
+
+        /** @brief °C of heating the heater should have done but the reading doesn't show */
+        [[nodiscard]] float Deficit() const;
+
+        /** @brief °C/s the reading should be changing at */
+        [[nodiscard]] float ExpectedRate() const;
+
+        [[nodiscard]] const RunawayModel& GetModel() const;
+
+    private:
+        [[nodiscard]] float PrivKilnRate(float aPower, float aTemperature) const;
+
+        RunawayModel myModel;
+        float myPower = 0.0f; // heat fraction, through the element lag
+        float myExpectedRate = 0.0f; // °C/s, through the thermocouple lag
+        float myLastTemperature = 0.0f;
+        bool myHasLast = false;
+        float myExcess = 0.0f;
+        float myDeficit = 0.0f;
+    };
+} //namespace HeatTreatFurnace::Safety
+
+#endif //HEAT_TREAT_FURNACE_RUNAWAY_DETECTOR_HPP
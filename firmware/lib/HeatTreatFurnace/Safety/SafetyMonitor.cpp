@@ -0,0 +1,162 @@
+#include "SafetyMonitor.hpp"
+
+#include <format>
+#include <string_view>
+
+namespace HeatTreatFurnace::Safety
+{
+    SafetyMonitor::SafetyMonitor(const Time::Clock& aClock, const Sync::Snapshot<Sensor::SensorReadings>& aSensors,
+                                 const Sync::Snapshot<Furnace::StateSnapshot>& aState, HeaterSwitch& aHeater, Watchdog& aWatchdog,
+                                 Log::LogService& aLog) :
+        Loggable(aLog), myClock(aClock), mySensors(aSensors), myState(aState), myHeater(aHeater), myWatchdog(aWatchdog)
+    {
+        myRules.Configure(myConfig);
+        myRunawayDetector.Configure(myConfig.runawayModel);
+        Start();
+    }
+
+    void SafetyMonitor::Configure(const SafetyConfig& aConfig)
+    {
+        myConfig = aConfig;
+        myRules.Configure(myConfig);
+        myRunawayDetector.Configure(myConfig.runawayModel);
+    }
+
+    void SafetyMonitor::SetTripHandler(TripHandler aHandler)
+    {
+        myTripHandler = aHandler;
+    }
+
+    void SafetyMonitor::Start()
+    {
+        const std::chrono::microseconds now = myClock.Now();
+        mySensorVersion = mySensors.Version();
+        mySensorSeen = now;
+        myHeartbeatCount = myHeartbeats.load(std::memory_order_relaxed);
+        myHeartbeatSeen = now;
+    }
+
+    SafetyFaults SafetyMonitor::Poll()
+    {
+        const std::chrono::microseconds now = myClock.Now();
+        RuleInputs inputs;
+        uint32_t version;
+        inputs.readings = mySensors.Read(version);
+        inputs.state = myState.Read();
+
+        if (version != mySensorVersion)
+        {
+            PrivTrackHeating(inputs.readings, inputs.state, now - mySensorSeen);
+            mySensorVersion = version;
+            mySensorSeen = now;
+        }
+        const uint32_t heartbeats = myHeartbeats.load(std::memory_order_relaxed);
+        if (heartbeats != myHeartbeatCount)
+        {
+            myHeartbeatCount = heartbeats;
+            myHeartbeatSeen = now;
+        }
+
+        inputs.sensorAge = std::chrono::duration<float>(now - mySensorSeen).count();
+        inputs.heartbeatAge = std::chrono::duration<float>(now - myHeartbeatSeen).count();
+        inputs.unexplainedHeating = myRunawayDetector.Excess();
+        inputs.missingHeating = myRunawayDetector.Deficit();
+        const SafetyFaults active = myRules.Evaluate(inputs, now);
+
+        const uint32_t faults = myRules.Report().faults.value<uint32_t>();
+        const uint32_t latched = myFaults.exchange(faults, std::memory_order_relaxed);
+        if (latched == 0 && faults != 0)
+        {
+            myTripTime = now;
+        }
+        if ((faults & ~latched) != 0)
+        {
+            PrivTrip(SafetyFaults(faults & ~latched));
+        }
+        else if (faults != 0)
+        {
+            // Latched: whatever the control loop does, the heater stays off until Reset()
+            myHeater.ForceOff();
+        }
+        myAlarm.store(faults != 0 && now - myTripTime < myConfig.alarmTimeout, std::memory_order_relaxed);
+
+        if (!active.test(static_cast<size_t>(SafetyFault::HeartbeatLost)))
+        {
+            myWatchdog.Feed();
+        }
+        return active;
+    }
+
+    void SafetyMonitor::Heartbeat()
+    {
+        myHeartbeats.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    SafetyFaults SafetyMonitor::Faults() const
+    {
+        return SafetyFaults(myFaults.load(std::memory_order_relaxed));
+    }
+
+    bool SafetyMonitor::IsTripped() const
+    {
+        return myFaults.load(std::memory_order_relaxed) != 0;
+    }
+
+    bool SafetyMonitor::IsAlarmOn() const
+    {
+        return myAlarm.load(std::memory_order_relaxed);
+    }
+
+    Furnace::Result SafetyMonitor::Reset()
+    {
+        const SafetyFaults active = myRules.Reset();
+        myFaults.store(myRules.Report().faults.value<uint32_t>(), std::memory_order_relaxed);
+        if (active.any())
+        {
+            const etl::string_view name = SafetyFaultName(static_cast<SafetyFault>(active.find_first(true)));
+            Log::LogMessage message = std::format("Safety fault still present: {}", std::string_view(name.data(), name.size()));
+            return {false, message};
+        }
+        myAlarm.store(false, std::memory_order_relaxed);
+        myHeater.Release();
+        return {true, ""};
+    }
+
+    const SafetyConfig& SafetyMonitor::GetConfig() const
+    {
+        return myConfig;
+    }
+
+    void SafetyMonitor::PrivTrackHeating(const Sensor::SensorReadings& aReadings, const Furnace::StateSnapshot& aState,
+                                         std::chrono::microseconds anElapsed)
+    {
+        if (aReadings.sequence == 0 || !aReadings.IsKilnValid())
+        {
+            // Start again once the readings are back; the thermocouple rule covers the gap
+            myRunawayDetector.Reset();
+            return;
+        }
+        // Once tripped the heater is held off, whatever the control loop last asked for
+        const float heat = IsTripped() ? 0.0f : static_cast<float>(aState.heatPercent);
+        myRunawayDetector.Update(aReadings.kilnTemperature, heat, anElapsed);
+    }
+
+    void SafetyMonitor::PrivTrip(SafetyFaults anAdded)
+    {
+        // The heater first: logging and the handler can wait, it can't
+        myHeater.ForceOff();
+
+        for (size_t i = 0; i < SAFETY_FAULT_COUNT; ++i)
+        {
+            if (anAdded.test(i))
+            {
+                const etl::string_view name = SafetyFaultName(static_cast<SafetyFault>(i));
+                Log(Log::LogLevel::Error, "Safety trip: {}", std::string_view(name.data(), name.size()));
+            }
+        }
+        if (myTripHandler.is_valid())
+        {
+            myTripHandler(myRules.Report());
+        }
+    }
+} //namespace HeatTreatFurnace::Safety
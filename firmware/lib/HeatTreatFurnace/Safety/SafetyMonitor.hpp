@@ -0,0 +1,118 @@
+#ifndef HEAT_TREAT_FURNACE_SAFETY_MONITOR_HPP
+#define HEAT_TREAT_FURNACE_SAFETY_MONITOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "HeaterSwitch.hpp"
+#include "RunawayDetector.hpp"
+#include "SafetyRules.hpp"
+#include "Watchdog.hpp"
+#include "etl/delegate.h"
+#include "etl/string_view.h"
+#include "Furnace/Result.hpp"
+#include "Furnace/StateSnapshot.hpp"
+#include "Log/LogService.hpp"
+#include "Sensor/SensorPublisher.hpp"
+#include "Sync/Snapshot.hpp"
+#include "Time/Clock.hpp"
+
+namespace HeatTreatFurnace::Safety
+{
+    /**
+     * @brief Watches the furnace from its own high-priority task, independently of the control loop (SPECIFICATION.md §8).
+     *
+     * Poll() runs every SafetyConfig::period. It reads the sensor readings and the control loop's state
+     * through their Sync::Snapshots, without a lock, and checks every rule in FurnaceRules on them. When
+     * one is broken it forces the heater off itself, then calls the trip handler, which the furnace binds
+     * to StateMachine::OnSafetyTrip to go to ERROR with the FaultReport as State.error_message. The faults
+     * stay latched, and the heater held off on every Poll() after, until Reset(); the alarm sounds for
+     * SafetyConfig::alarmTimeout from the first.
+     *
+     * The control loop calls Heartbeat() once a sample. The watchdog is fed only while it does, so if
+     * the control loop hangs the controller resets even if this task is still alive; and if this task
+     * hangs, nothing feeds it at all.
+     *
+     * Each new kiln reading also goes to a RunawayDetector with the heat percent the control loop last
+     * published, for the rules that compare the kiln's heating with its heater's.
+     *
+     * Worst case from a rule being broken to the heater off is one period for a reading already
+     * published, the sample pipeline's latency on top for a thermocouple, and the timeout plus one
+     * period for a stale sensor or a lost heartbeat.
+     */
+    class SafetyMonitor : public Log::Loggable
+    {
+    public:
+        /** @brief Called on the monitor's task with every fault latched so far, when a new one is */
+        using TripHandler = etl::delegate<void(const FaultReport& aReport)>;
+
+        SafetyMonitor(const Time::Clock& aClock, const Sync::Snapshot<Sensor::SensorReadings>& aSensors,
+                      const Sync::Snapshot<Furnace::StateSnapshot>& aState, HeaterSwitch& aHeater, Watchdog& aWatchdog,
+                      Log::LogService& aLog);
+        ~SafetyMonitor() override = default;
+
+        /** @brief On the monitor's task, between Poll() calls */
+        void Configure(const SafetyConfig& aConfig);
+
+        void SetTripHandler(TripHandler aHandler);
+
+        /** @brief Timeouts run from now; call when the monitor's task starts */
+        void Start();
+
+        /** @brief Check every rule once; the monitor's task only. Returns the faults active now */
+        SafetyFaults Poll();
+
+        /** @brief From the control loop, once a sample; any task */
+        void Heartbeat();
+
+        /** @brief Faults latched since the last Reset(); any task */
+        [[nodiscard]] SafetyFaults Faults() const;
+
+        [[nodiscard]] bool IsTripped() const;
+
+        /** @brief Whether ALARM_PIN should be high: for Alarm_Timeout after a trip; any task */
+        [[nodiscard]] bool IsAlarmOn() const;
+
+        /** @brief Clear the latch and release the heater, e.g. when ERROR is acknowledged; the monitor's task only.
+         * Refused while a rule is still active, which for a latched limit means back below it by its hysteresis.
+         */
+        Furnace::Result Reset();
+
+        [[nodiscard]] const SafetyConfig& GetConfig() const;
+
+    protected:
+        [[nodiscard]] const etl::string_view& GetLogDomain() override
+        {
+            return myDomain;
+        };
+
+    private:
+        void PrivTrackHeating(const Sensor::SensorReadings& aReadings, const Furnace::StateSnapshot& aState, std::chrono::microseconds anElapsed);
+        void PrivTrip(SafetyFaults anAdded);
+
+        const Time::Clock& myClock;
+        const Sync::Snapshot<Sensor::SensorReadings>& mySensors;
+        const Sync::Snapshot<Furnace::StateSnapshot>& myState;
+        HeaterSwitch& myHeater;
+        Watchdog& myWatchdog;
+        SafetyConfig myConfig;
+        FurnaceRules myRules;
+        RunawayDetector myRunawayDetector;
+        TripHandler myTripHandler;
+
+        uint32_t mySensorVersion = 0;
+        std::chrono::microseconds mySensorSeen{0};
+        uint32_t myHeartbeatCount = 0;
+        std::chrono::microseconds myHeartbeatSeen{0};
+        std::chrono::microseconds myTripTime{0};
+
+        std::atomic<uint32_t> myHeartbeats{0};
+        std::atomic<uint32_t> myFaults{0}; // SafetyFaults bits, for reading from other tasks
+        std::atomic<bool> myAlarm{false};
+
+        static constexpr etl::string_view myDomain = "Safety";
+    };
+} //namespace HeatTreatFurnace::Safety
+
+#endif //HEAT_TREAT_FURNACE_SAFETY_MONITOR_HPP
@@ -0,0 +1,66 @@
+#include "SafetyRules.hpp"
+
+#include <format>
+#include <string_view>
+
+namespace HeatTreatFurnace::Safety
+{
+    etl::string_view SafetyFaultName(SafetyFault aFault)
+    {
+        switch (aFault)
+        {
+        case SafetyFault::ThermocoupleFailure:
+            return "thermocouple failure";
+        case SafetyFault::ThermalRunaway:
+            return "thermal runaway";
+        case SafetyFault::UnexplainedHeating:
+            return "kiln heating faster than the heater explains";
+        case SafetyFault::MissingHeating:
+            return "kiln reading not following the heater";
+        case SafetyFault::CaseOverTemperature:
+            return "case over MAX_Housing_Temperature";
+        case SafetyFault::OverTemperature:
+            return "kiln over MAX_Temperature";
+        case SafetyFault::SensorStale:
+            return "no new sensor readings";
+        case SafetyFault::HeartbeatLost:
+            return "control loop heartbeat lost";
+        default:
+            return "none";
+        }
+    }
+
+    Log::LogMessage FaultReport::Describe() const
+    {
+        Log::LogMessage message;
+        SafetyFaults listed;
+        std::chrono::microseconds first{0};
+        // At most SAFETY_FAULT_COUNT faults, so pick the earliest left each time rather than sort
+        while (listed != faults)
+        {
+            size_t next = SAFETY_FAULT_COUNT;
+            for (size_t i = 0; i < SAFETY_FAULT_COUNT; ++i)
+            {
+                if (faults.test(i) && !listed.test(i) && (next == SAFETY_FAULT_COUNT || firstSeen[i] < firstSeen[next]))
+                {
+                    next = i;
+                }
+            }
+            listed.set(next);
+
+            const etl::string_view name = SafetyFaultName(static_cast<SafetyFault>(next));
+            if (message.empty())
+            {
+                first = firstSeen[next];
+                message.append(name.data(), name.size());
+            }
+            else
+            {
+                const float later = std::chrono::duration<float>(firstSeen[next] - first).count();
+                Log::LogMessage part = std::format(", then {} {:.2f} s later", std::string_view(name.data(), name.size()), later);
+                message.append(part);
+            }
+        }
+        return message;
+    }
+} //namespace HeatTreatFurnace::Safety
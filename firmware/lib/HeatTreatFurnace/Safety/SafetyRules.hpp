@@ -0,0 +1,378 @@
+#ifndef HEAT_TREAT_FURNACE_SAFETY_RULES_HPP
+#define HEAT_TREAT_FURNACE_SAFETY_RULES_HPP
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "RunawayDetector.hpp"
+#include "etl/bitset.h"
+#include "etl/string_view.h"
+#include "Furnace/Preferences.hpp"
+#include "Furnace/StateSnapshot.hpp"
+#include "Log/LogService.hpp"
+#include "Sensor/SensorPublisher.hpp"
+
+namespace HeatTreatFurnace::Safety
+{
+    /** @brief One per rule in SPECIFICATION.md §8, by its position in SafetyFaults */
+    enum class SafetyFault : uint8_t
+    {
+        ThermocoupleFailure, // §8.1, kiln or case, once the grace count has run out
+        ThermalRunaway, // §8.2
+        UnexplainedHeating, // §8.2, RunawayDetector: e.g. an SSR stuck on
+        MissingHeating, // §8.2, RunawayDetector: e.g. a thermocouple out of the kiln
+        CaseOverTemperature, // §8.3
+        OverTemperature, // §8.4, MAX_Temperature
+        SensorStale, // §8.5, no new readings from the sensor task
+        HeartbeatLost, // §8.5, the control loop stopped
+        COUNT
+    };
+
+    constexpr size_t SAFETY_FAULT_COUNT = static_cast<size_t>(SafetyFault::COUNT);
+
+    /** @brief A set of faults, bit n for SafetyFault n */
+    using SafetyFaults = etl::bitset<SAFETY_FAULT_COUNT>;
+
+    [[nodiscard]] etl::string_view SafetyFaultName(SafetyFault aFault);
+
+    struct SafetyConfig
+    {
+        std::chrono::milliseconds period{50}; // how often Poll() runs; detection takes at most this once a rule is broken
+        float maxTemperature = 1350.0f; // °C
+        float maxHousingTemperature = 130.0f; // °C
+        float thermalRunaway = 0.0f; // °C above setpoint, 0 = disabled
+        std::chrono::milliseconds sensorTimeout{2000}; // five of the sample pipeline's 400 ms readings
+        std::chrono::milliseconds heartbeatTimeout{10000};
+        std::chrono::seconds alarmTimeout{5}; // how long the alarm sounds after a trip, 0 = disabled
+        RunawayModel runawayModel;
+        float unexplainedHeating = 10.0f; // °C the kiln may heat beyond what its heater explains, RunawayDetector::Excess()
+        float missingHeating = 20.0f; // °C the reading may fall behind what its heater should do, RunawayDetector::Deficit()
+
+        /** @brief MAX_Temperature, MAX_Housing_Temperature, Thermal_Runaway, Alarm_Timeout and the Kiln_* model; the control loop beats once per PID_Window, so two windows */
+        static SafetyConfig FromPreferences(const Furnace::Preferences& aPreferences)
+        {
+            SafetyConfig config;
+            config.maxTemperature = aPreferences.maxTemperature;
+            config.maxHousingTemperature = aPreferences.maxHousingTemperature;
+            config.thermalRunaway = aPreferences.thermalRunaway;
+            config.heartbeatTimeout = std::chrono::milliseconds(2 * aPreferences.pidWindowMs);
+            config.alarmTimeout = std::chrono::seconds(aPreferences.alarmTimeoutS);
+            config.runawayModel = RunawayModel::FromPreferences(aPreferences);
+            return config;
+        }
+    };
+
+    /** @brief Everything a rule looks at, read once per Poll() */
+    struct RuleInputs
+    {
+        Sensor::SensorReadings readings;
+        Furnace::StateSnapshot state;
+        float sensorAge = 0.0f; // s since the sensor readings last changed
+        float heartbeatAge = 0.0f; // s since the control loop's last heartbeat
+        float unexplainedHeating = 0.0f; // °C, RunawayDetector::Excess()
+        float missingHeating = 0.0f; // °C, RunawayDetector::Deficit()
+    };
+
+    enum class LatchPolicy : uint8_t
+    {
+        SelfClearing, // active while the rule is broken, and for its hysteresis after
+        UntilReset, // active from the first time the rule is broken until a Reset() with the value back out of its hysteresis
+    };
+
+    /**
+     * @brief One safety rule, as a type: broken while Value() > Limit().
+     *
+     * Value() and Limit() are static, so a rule has no state and costs a compare in RulePack. A rule
+     * that doesn't apply right now, e.g. a temperature limit on a faulty reading, returns -infinity
+     * from Value(); a preference that disables it returns +infinity from Limit(). Once broken, the
+     * rule stays active until Value() drops to Limit() - HYSTERESIS, so a reading that hovers at the
+     * limit doesn't make it flicker; LATCH says whether it then clears on its own or waits for Reset().
+     */
+    template <typename T>
+    concept SafetyRule = requires(const RuleInputs& aInputs, const SafetyConfig& aConfig)
+    {
+        { T::FAULT } -> std::convertible_to<SafetyFault>;
+        { T::LATCH } -> std::convertible_to<LatchPolicy>;
+        { T::HYSTERESIS } -> std::convertible_to<float>;
+        { T::Value(aInputs) } -> std::same_as<float>;
+        { T::Limit(aConfig) } -> std::same_as<float>;
+    };
+
+    namespace Rules
+    {
+        constexpr float NOT_APPLICABLE = -std::numeric_limits<float>::infinity();
+        constexpr float DISABLED = std::numeric_limits<float>::infinity();
+
+        /** @brief States in which the heater follows setTemp, so overshooting it means the heater is out of control */
+        constexpr uint32_t HEATING_STATES = 1u << static_cast<uint8_t>(Furnace::StateId::RUNNING) |
+            1u << static_cast<uint8_t>(Furnace::StateId::PAUSED) |
+            1u << static_cast<uint8_t>(Furnace::StateId::WAITING_FOR_TEMP) |
+            1u << static_cast<uint8_t>(Furnace::StateId::AUTOTUNING);
+
+        constexpr bool IsHeating(Furnace::StateId aState)
+        {
+            return ((HEATING_STATES >> static_cast<uint8_t>(aState)) & 1u) != 0;
+        }
+
+        /** @brief Nothing published yet reads as no fault; SensorStale covers a sensor task that never starts */
+        struct ThermocoupleFailure
+        {
+            static constexpr SafetyFault FAULT = SafetyFault::ThermocoupleFailure;
+            static constexpr LatchPolicy LATCH = LatchPolicy::SelfClearing;
+            static constexpr float HYSTERESIS = 0.0f;
+
+            static float Value(const RuleInputs& aInputs)
+            {
+                const bool failed = aInputs.readings.sequence != 0 && (aInputs.readings.kilnFaults | aInputs.readings.caseFaults) != 0;
+                return failed ? 1.0f : 0.0f;
+            }
+
+            static float Limit(const SafetyConfig&)
+            {
+                return 0.5f;
+            }
+        };
+
+        struct ThermalRunaway
+        {
+            static constexpr SafetyFault FAULT = SafetyFault::ThermalRunaway;
+            static constexpr LatchPolicy LATCH = LatchPolicy::UntilReset;
+            static constexpr float HYSTERESIS = 5.0f; // °C
+
+            /** @brief °C above setTemp */
+            static float Value(const RuleInputs& aInputs)
+            {
+                const bool applies = aInputs.readings.sequence != 0 && aInputs.readings.IsKilnValid() && IsHeating(aInputs.state.state);
+                return applies ? aInputs.readings.kilnTemperature - aInputs.state.setTemp : NOT_APPLICABLE;
+            }
+
+            static float Limit(const SafetyConfig& aConfig)
+            {
+                return aConfig.thermalRunaway > 0.0f ? aConfig.thermalRunaway : DISABLED;
+            }
+        };
+
+        /** @brief With Thermal_Runaway, since it is the same hazard found sooner */
+        struct UnexplainedHeating
+        {
+            static constexpr SafetyFault FAULT = SafetyFault::UnexplainedHeating;
+            static constexpr LatchPolicy LATCH = LatchPolicy::UntilReset;
+            static constexpr float HYSTERESIS = 5.0f; // °C
+
+            static float Value(const RuleInputs& aInputs)
+            {
+                return aInputs.unexplainedHeating;
+            }
+
+            static float Limit(const SafetyConfig& aConfig)
+            {
+                return aConfig.thermalRunaway > 0.0f ? aConfig.unexplainedHeating : DISABLED;
+            }
+        };
+
+        struct MissingHeating
+        {
+            static constexpr SafetyFault FAULT = SafetyFault::MissingHeating;
+            static constexpr LatchPolicy LATCH = LatchPolicy::UntilReset;
+            static constexpr float HYSTERESIS = 10.0f; // °C
+
+            static float Value(const RuleInputs& aInputs)
+            {
+                return aInputs.missingHeating;
+            }
+
+            static float Limit(const SafetyConfig& aConfig)
+            {
+                return aConfig.thermalRunaway > 0.0f ? aConfig.missingHeating : DISABLED;
+            }
+        };
+
+        struct CaseOverTemperature
+        {
+            static constexpr SafetyFault FAULT = SafetyFault::CaseOverTemperature;
+            static constexpr LatchPolicy LATCH = LatchPolicy::UntilReset;
+            static constexpr float HYSTERESIS = 5.0f; // °C
+
+            static float Value(const RuleInputs& aInputs)
+            {
+                const bool applies = aInputs.readings.sequence != 0 && aInputs.readings.caseFaults == 0;
+                return applies ? aInputs.readings.caseTemperature : NOT_APPLICABLE;
+            }
+
+            static float Limit(const SafetyConfig& aConfig)
+            {
+                return aConfig.maxHousingTemperature;
+            }
+        };
+
+        struct OverTemperature
+        {
+            static constexpr SafetyFault FAULT = SafetyFault::OverTemperature;
+            static constexpr LatchPolicy LATCH = LatchPolicy::UntilReset;
+            static constexpr float HYSTERESIS = 10.0f; // °C
+
+            static float Value(const RuleInputs& aInputs)
+            {
+                const bool applies = aInputs.readings.sequence != 0 && aInputs.readings.IsKilnValid();
+                return applies ? aInputs.readings.kilnTemperature : NOT_APPLICABLE;
+            }
+
+            static float Limit(const SafetyConfig& aConfig)
+            {
+                return aConfig.maxTemperature;
+            }
+        };
+
+        struct SensorStale
+        {
+            static constexpr SafetyFault FAULT = SafetyFault::SensorStale;
+            static constexpr LatchPolicy LATCH = LatchPolicy::SelfClearing;
+            static constexpr float HYSTERESIS = 0.0f;
+
+            static float Value(const RuleInputs& aInputs)
+            {
+                return aInputs.sensorAge;
+            }
+
+            static float Limit(const SafetyConfig& aConfig)
+            {
+                return std::chrono::duration<float>(aConfig.sensorTimeout).count();
+            }
+        };
+
+        struct HeartbeatLost
+        {
+            static constexpr SafetyFault FAULT = SafetyFault::HeartbeatLost;
+            static constexpr LatchPolicy LATCH = LatchPolicy::SelfClearing;
+            static constexpr float HYSTERESIS = 0.0f;
+
+            static float Value(const RuleInputs& aInputs)
+            {
+                return aInputs.heartbeatAge;
+            }
+
+            static float Limit(const SafetyConfig& aConfig)
+            {
+                return std::chrono::duration<float>(aConfig.heartbeatTimeout).count();
+            }
+        };
+    } //namespace Rules
+
+    /** @brief Faults since the last RulePack::Reset(), for State.error_message */
+    struct FaultReport
+    {
+        SafetyFaults faults; // whether or not they are still active
+        std::array<std::chrono::microseconds, SAFETY_FAULT_COUNT> firstSeen{}; // Clock time each fault in faults was first found
+
+        /** @brief The faults in the order they were found, each after the first with how much later */
+        [[nodiscard]] Log::LogMessage Describe() const;
+    };
+
+    /**
+     * @brief A fixed set of SafetyRules, checked together (SPECIFICATION.md §8.5).
+     *
+     * Configure() works each rule's limits out of the preferences once. Evaluate() is then a fold
+     * over the rules, each of which computes its value and ORs two compares into a broken and a
+     * still-held mask; the latch policies are masks applied to the result, so the pass has no
+     * per-rule branch. A rule left out of the pack costs nothing at all.
+     */
+    template <SafetyRule... RuleTypes>
+    class RulePack
+    {
+        template <SafetyRule Rule>
+        static constexpr uint32_t BIT = 1u << static_cast<uint8_t>(Rule::FAULT);
+
+        static constexpr uint32_t LATCHED = ((RuleTypes::LATCH == LatchPolicy::UntilReset ? BIT<RuleTypes> : 0u) | ... | 0u);
+
+    public:
+        static_assert(std::popcount((BIT<RuleTypes> | ... | 0u)) == sizeof...(RuleTypes), "Each fault can have only one rule");
+
+        void Configure(const SafetyConfig& aConfig)
+        {
+            PrivConfigure(aConfig, std::index_sequence_for<RuleTypes...>{});
+        }
+
+        /** @brief Check every rule on aInputs, found at aNow; returns the faults active now */
+        SafetyFaults Evaluate(const RuleInputs& aInputs, std::chrono::microseconds aNow)
+        {
+            uint32_t broken = 0;
+            uint32_t held = 0;
+            PrivEvaluate(aInputs, broken, held, std::index_sequence_for<RuleTypes...>{});
+
+            myHeld = held;
+            myActive = broken | (myActive & (held | LATCHED));
+            const uint32_t added = myActive & ~mySeen;
+            if (added != 0)
+            {
+                PrivRecord(added, aNow);
+            }
+            return SafetyFaults(myActive);
+        }
+
+        /** @brief Clear every fault whose rule has let go, including latched ones; returns those still active */
+        SafetyFaults Reset()
+        {
+            myActive &= myHeld;
+            mySeen = myActive;
+            myReport.faults = SafetyFaults(mySeen);
+            return SafetyFaults(myActive);
+        }
+
+        [[nodiscard]] SafetyFaults Active() const
+        {
+            return SafetyFaults(myActive);
+        }
+
+        [[nodiscard]] const FaultReport& Report() const
+        {
+            return myReport;
+        }
+
+    private:
+        template <size_t... I>
+        void PrivConfigure(const SafetyConfig& aConfig, std::index_sequence<I...>)
+        {
+            ((myLimits[I] = RuleTypes::Limit(aConfig), myClearLimits[I] = myLimits[I] - RuleTypes::HYSTERESIS), ...);
+        }
+
+        template <size_t... I>
+        void PrivEvaluate(const RuleInputs& aInputs, uint32_t& aBroken, uint32_t& aHeld, std::index_sequence<I...>) const
+        {
+            ([&]
+            {
+                const float value = RuleTypes::Value(aInputs);
+                aBroken |= static_cast<uint32_t>(value > myLimits[I]) << static_cast<uint8_t>(RuleTypes::FAULT);
+                aHeld |= static_cast<uint32_t>(value > myClearLimits[I]) << static_cast<uint8_t>(RuleTypes::FAULT);
+            }(), ...);
+        }
+
+        void PrivRecord(uint32_t anAdded, std::chrono::microseconds aNow)
+        {
+            for (uint32_t bits = anAdded; bits != 0; bits &= bits - 1)
+            {
+                myReport.firstSeen[std::countr_zero(bits)] = aNow;
+            }
+            mySeen |= anAdded;
+            myReport.faults = SafetyFaults(mySeen);
+        }
+
+        std::array<float, sizeof...(RuleTypes)> myLimits{};
+        std::array<float, sizeof...(RuleTypes)> myClearLimits{};
+        uint32_t myActive = 0;
+        uint32_t myHeld = 0;
+        uint32_t mySeen = 0;
+        FaultReport myReport;
+    };
+
+    /** @brief Every rule in SPECIFICATION.md §8 */
+    using FurnaceRules = RulePack<Rules::ThermocoupleFailure, Rules::ThermalRunaway, Rules::UnexplainedHeating, Rules::MissingHeating,
+                                  Rules::CaseOverTemperature, Rules::OverTemperature, Rules::SensorStale, Rules::HeartbeatLost>;
+} //namespace HeatTreatFurnace::Safety
+
+#endif //HEAT_TREAT_FURNACE_SAFETY_RULES_HPP
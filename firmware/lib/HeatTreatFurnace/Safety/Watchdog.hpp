@@ -0,0 +1,21 @@
+#ifndef HEAT_TREAT_FURNACE_WATCHDOG_HPP
+#define HEAT_TREAT_FURNACE_WATCHDOG_HPP
+
+namespace HeatTreatFurnace::Safety
+{
+    /**
+     * @brief Hardware watchdog that resets the controller unless fed in time.
+     *
+     * On the ESP32 this is the task watchdog with the safety monitor's task subscribed. A reset
+     * leaves every GPIO, the SSR's included, at its off default.
+     */
+    class Watchdog
+    {
+    public:
+        virtual ~Watchdog() = default;
+
+        virtual void Feed() = 0;
+    };
+} //namespace HeatTreatFurnace::Safety
+
+#endif //HEAT_TREAT_FURNACE_WATCHDOG_HPP
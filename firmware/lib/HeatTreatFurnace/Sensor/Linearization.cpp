@@ -0,0 +1,135 @@
+#include "Linearization.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "Nist.hpp"
+
+namespace HeatTreatFurnace::Sensor::Linearization
+{
+    namespace
+    {
+        constexpr double COLD_JUNCTION_MIN = -64.0;
+        constexpr double COLD_JUNCTION_MAX = 128.0;
+
+        /** @brief A function sampled at CELLS + 1 evenly spaced points, interpolated linearly */
+        template <size_t CELLS>
+        struct UniformTable
+        {
+            float start;
+            float cellsPerUnit;
+            std::array<float, CELLS + 1> values;
+
+            [[nodiscard]] float At(float aX) const
+            {
+                const float position = std::clamp((aX - start) * cellsPerUnit, 0.0f, static_cast<float>(CELLS));
+                const size_t cell = std::min(static_cast<size_t>(position), CELLS - 1);
+                const float fraction = position - static_cast<float>(cell);
+                return values[cell] + (values[cell + 1] - values[cell]) * fraction;
+            }
+        };
+
+        /**
+         * @brief As UniformTable, with the slope at each point too, interpolated as a cubic Hermite spline.
+         *
+         * The error goes as the fourth power of the cell width rather than the square, which the
+         * inverse needs near the bottom of S and R, where the Seebeck coefficient is small and
+         * changing fast.
+         */
+        template <size_t CELLS>
+        struct HermiteTable
+        {
+            float start;
+            float cellsPerUnit;
+            std::array<float, CELLS + 1> values;
+            std::array<float, CELLS + 1> slopes; // per cell width
+
+            [[nodiscard]] float At(float aX) const
+            {
+                const float position = std::clamp((aX - start) * cellsPerUnit, 0.0f, static_cast<float>(CELLS));
+                const size_t cell = std::min(static_cast<size_t>(position), CELLS - 1);
+                const float t = position - static_cast<float>(cell);
+                const float y0 = values[cell];
+                const float y1 = values[cell + 1];
+                const float m0 = slopes[cell];
+                const float m1 = slopes[cell + 1];
+
+                // y0 + t·(m0 + t·(3Δ - 2m0 - m1 + t·(m0 + m1 - 2Δ))), Δ = y1 - y0
+                const float delta = y1 - y0;
+                return y0 + t * (m0 + t * (3.0f * delta - 2.0f * m0 - m1 + t * (m0 + m1 - 2.0f * delta)));
+            }
+        };
+
+        struct TypeTables
+        {
+            float max31855Sensitivity; // mV/°C
+            UniformTable<COLD_JUNCTION_CELLS> coldJunctionVoltage; // °C to mV
+            HermiteTable<TEMPERATURE_CELLS> temperature; // mV to °C
+        };
+
+        template <size_t CELLS, typename Function>
+        constexpr UniformTable<CELLS> Sample(double aFrom, double aTo, Function aFunction)
+        {
+            UniformTable<CELLS> table{};
+            table.start = static_cast<float>(aFrom);
+            table.cellsPerUnit = static_cast<float>(CELLS / (aTo - aFrom));
+            for (size_t i = 0; i <= CELLS; ++i)
+            {
+                table.values[i] = static_cast<float>(aFunction(aFrom + (aTo - aFrom) * static_cast<double>(i) / CELLS));
+            }
+            return table;
+        }
+
+        /** @brief Temperature against mV, with dT/dV = 1 / Seebeck coefficient for the slopes */
+        constexpr HermiteTable<TEMPERATURE_CELLS> SampleInverse(ThermocoupleType aType, double aFrom, double aTo)
+        {
+            HermiteTable<TEMPERATURE_CELLS> table{};
+            const double width = (aTo - aFrom) / TEMPERATURE_CELLS;
+            table.start = static_cast<float>(aFrom);
+            table.cellsPerUnit = static_cast<float>(1.0 / width);
+            for (size_t i = 0; i <= TEMPERATURE_CELLS; ++i)
+            {
+                const double temperature = Nist::ExactTemperature(aType, aFrom + width * static_cast<double>(i));
+                table.values[i] = static_cast<float>(temperature);
+                table.slopes[i] = static_cast<float>(width / Nist::Seebeck(aType, temperature));
+            }
+            return table;
+        }
+
+        constexpr TypeTables Build(ThermocoupleType aType)
+        {
+            const Nist::ThermocoupleData& data = Nist::Data(aType);
+            return {
+                static_cast<float>(data.max31855Sensitivity),
+                Sample<COLD_JUNCTION_CELLS>(COLD_JUNCTION_MIN, COLD_JUNCTION_MAX, [aType](double aTemperature)
+                {
+                    return Nist::Voltage(aType, aTemperature);
+                }),
+                SampleInverse(aType, Nist::Voltage(aType, data.minTemperature), Nist::Voltage(aType, data.maxTemperature))
+            };
+        }
+
+        // About 2.4KB of flash per type
+        constexpr std::array<TypeTables, static_cast<size_t>(ThermocoupleType::COUNT)> TABLES{
+            Build(ThermocoupleType::K), Build(ThermocoupleType::N), Build(ThermocoupleType::S), Build(ThermocoupleType::R)
+        };
+
+        const TypeTables& Tables(ThermocoupleType aType)
+        {
+            return TABLES[std::min(static_cast<size_t>(aType), TABLES.size() - 1)];
+        }
+    }
+
+    float HotJunction(ThermocoupleType aType, float aReported, float aColdJunction)
+    {
+        const TypeTables& tables = Tables(aType);
+        const float millivolts = (aReported - aColdJunction) * tables.max31855Sensitivity + tables.coldJunctionVoltage.At(aColdJunction);
+        return tables.temperature.At(millivolts);
+    }
+
+    float Reported(ThermocoupleType aType, float aTemperature, float aColdJunction)
+    {
+        const double millivolts = Nist::Voltage(aType, aTemperature) - Nist::Voltage(aType, aColdJunction);
+        return static_cast<float>(aColdJunction + millivolts / Nist::Data(aType).max31855Sensitivity);
+    }
+} //namespace HeatTreatFurnace::Sensor::Linearization
@@ -0,0 +1,31 @@
+#ifndef HEAT_TREAT_FURNACE_LINEARIZATION_HPP
+#define HEAT_TREAT_FURNACE_LINEARIZATION_HPP
+
+#include <cstddef>
+
+#include "ThermocoupleType.hpp"
+
+/**
+ * @brief Correcting the MAX31855's linear approximation to the NIST reference functions.
+ *
+ * The chip reports cold junction + thermocouple voltage / a fixed µV/°C, which for type K is 16 °C
+ * low at 1200 °C. HotJunction() undoes that: it recovers the voltage, adds the voltage the cold
+ * junction takes away (SPECIFICATION.md §3.11), and looks the temperature up. Both steps use
+ * tables generated at compile time from the NIST ITS-90 coefficients (Nist.hpp), so a lookup is the
+ * same dozen or so multiply-adds and six loads whatever the reading, with no branch on it. Over
+ * each type's range it is within 0.01 °C of the reference function, closer than NIST's own
+ * inverse polynomials.
+ */
+namespace HeatTreatFurnace::Sensor::Linearization
+{
+    constexpr size_t TEMPERATURE_CELLS = 256; // over each type's whole voltage range
+    constexpr size_t COLD_JUNCTION_CELLS = 96; // 2 °C each, over the chip's -55 to 125 °C and then some
+
+    /** @brief °C at the hot junction, from what a MAX31855 of aType reports and its cold junction reading; clamped to the type's range */
+    [[nodiscard]] float HotJunction(ThermocoupleType aType, float aReported, float aColdJunction);
+
+    /** @brief What a MAX31855 of aType reports for a hot junction at aTemperature, for host stand-ins; not table driven */
+    [[nodiscard]] float Reported(ThermocoupleType aType, float aTemperature, float aColdJunction);
+} //namespace HeatTreatFurnace::Sensor::Linearization
+
+#endif //HEAT_TREAT_FURNACE_LINEARIZATION_HPP
@@ -0,0 +1,65 @@
+#include "Max31855Driver.hpp"
+
+namespace HeatTreatFurnace::Sensor
+{
+    Max31855Driver::Max31855Driver(SpiBus& aBus, size_t aChannels) :
+        ThermocoupleDriver(aChannels), myBus(aBus)
+    {
+    }
+
+    void Max31855Driver::Poll()
+    {
+        if (myReading)
+        {
+            switch (myBus.Poll())
+            {
+            case SpiStatus::Busy:
+                return;
+            case SpiStatus::Done:
+                PrivPublishFrames();
+                break;
+            case SpiStatus::Idle:
+            case SpiStatus::Failed:
+                ++myBusErrors;
+                PrivPublishNoResponse();
+                break;
+            }
+            myReading = false;
+        }
+
+        const size_t bytes = 4 * ChannelCount();
+        myReading = myBus.StartRead({myReceive.data(), bytes}, ChannelCount());
+        if (!myReading)
+        {
+            ++myBusErrors;
+            PrivPublishNoResponse();
+        }
+    }
+
+    uint32_t Max31855Driver::BusErrorCount() const
+    {
+        return myBusErrors;
+    }
+
+    void Max31855Driver::PrivPublishFrames()
+    {
+        for (size_t channel = 0; channel < ChannelCount(); ++channel)
+        {
+            // Most significant byte first on the wire
+            const uint8_t* bytes = &myReceive[4 * channel];
+            const uint32_t frame = (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16)
+                | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+            Publish(channel, frame);
+        }
+        EndBatch();
+    }
+
+    void Max31855Driver::PrivPublishNoResponse()
+    {
+        for (size_t channel = 0; channel < ChannelCount(); ++channel)
+        {
+            Publish(channel, Max31855Frame::NO_RESPONSE);
+        }
+        EndBatch();
+    }
+} //namespace HeatTreatFurnace::Sensor
@@ -0,0 +1,42 @@
+#ifndef HEAT_TREAT_FURNACE_MAX31855_DRIVER_HPP
+#define HEAT_TREAT_FURNACE_MAX31855_DRIVER_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "SpiBus.hpp"
+#include "Thermocouple.hpp"
+
+namespace HeatTreatFurnace::Sensor
+{
+    /**
+     * @brief MAX31855 chips on one SPI bus, all read in one batch.
+     *
+     * Each Poll() collects the batch started by the previous one, if it has finished, and starts the
+     * next. A batch is 4 bytes from every chip into one buffer, so the bus is set up and its
+     * interrupt taken once per batch rather than once per chip. A failed batch publishes NoResponse
+     * for every channel. If the bus is still busy the last readings stand; the chips convert
+     * only every 100 ms anyway.
+     */
+    class Max31855Driver : public ThermocoupleDriver
+    {
+    public:
+        Max31855Driver(SpiBus& aBus, size_t aChannels);
+
+        void Poll() override;
+
+        /** @brief Batches that failed or couldn't start */
+        [[nodiscard]] uint32_t BusErrorCount() const;
+
+    private:
+        void PrivPublishFrames();
+        void PrivPublishNoResponse();
+
+        SpiBus& myBus;
+        bool myReading = false;
+        uint32_t myBusErrors = 0;
+        alignas(4) std::array<uint8_t, 4 * MAX_THERMOCOUPLES> myReceive{}; // DMA target
+    };
+} //namespace HeatTreatFurnace::Sensor
+
+#endif //HEAT_TREAT_FURNACE_MAX31855_DRIVER_HPP
@@ -0,0 +1,253 @@
+#ifndef HEAT_TREAT_FURNACE_NIST_HPP
+#define HEAT_TREAT_FURNACE_NIST_HPP
+
+#include <array>
+#include <cstddef>
+
+#include "ThermocoupleType.hpp"
+
+/**
+ * @brief NIST ITS-90 thermocouple reference functions (NIST Monograph 175), usable at compile time.
+ *
+ * Voltage() is the reference function itself, °C to mV. ExactTemperature() inverts it by Newton's
+ * method, which is what Linearization's tables are built from. InverseTemperature() is the
+ * inverse polynomial NIST publishes alongside, which is only good to a few hundredths of a degree;
+ * it is here as the usual way to do this at run time, to compare against.
+ */
+namespace HeatTreatFurnace::Sensor::Nist
+{
+    /** @brief One range of a piecewise polynomial; unused coefficients are 0 */
+    struct Polynomial
+    {
+        double to; // upper end of the range, °C for Voltage(), mV for InverseTemperature()
+        std::array<double, 11> c;
+    };
+
+    struct ThermocoupleData
+    {
+        double minTemperature; // °C, the range NIST's inverse covers
+        double maxTemperature; // °C
+        double max31855Sensitivity; // mV/°C the MAX31855 variant assumes (datasheet table 1)
+        std::array<Polynomial, 3> voltage;
+        size_t voltageRanges;
+        std::array<Polynomial, 4> inverse;
+        size_t inverseRanges;
+        bool kExponential; // type K adds a0·exp(a1·(t - a2)²) above 0 °C
+    };
+
+    constexpr ThermocoupleData TYPE_K{
+        -200.0, 1372.0, 0.041276,
+        {{
+            {0.0, {0.0, 0.394501280250E-01, 0.236223735980E-04, -0.328589067840E-06, -0.499048287770E-08, -0.675090591730E-10,
+                   -0.574103274280E-12, -0.310888728940E-14, -0.104516093650E-16, -0.198892668780E-19, -0.163226974860E-22}},
+            {1372.0, {-0.176004136860E-01, 0.389212049750E-01, 0.185587700320E-04, -0.994575928740E-07, 0.318409457190E-09,
+                      -0.560728448890E-12, 0.560750590590E-15, -0.320207200030E-18, 0.971511471520E-22, -0.121047212750E-25, 0.0}},
+        }},
+        2,
+        {{
+            {0.0, {0.0, 2.5173462E+01, -1.1662878E+00, -1.0833638E+00, -8.9773540E-01, -3.7342377E-01, -8.6632643E-02,
+                   -1.0450598E-02, -5.1920577E-04, 0.0, 0.0}},
+            {20.644, {0.0, 2.508355E+01, 7.860106E-02, -2.503131E-01, 8.315270E-02, -1.228034E-02, 9.804036E-04, -4.413030E-05,
+                      1.057734E-06, -1.052755E-08, 0.0}},
+            {54.886, {-1.318058E+02, 4.830222E+01, -1.646031E+00, 5.464731E-02, -9.650715E-04, 8.802193E-06, -3.110810E-08, 0.0,
+                      0.0, 0.0, 0.0}},
+        }},
+        3,
+        true
+    };
+
+    constexpr ThermocoupleData TYPE_N{
+        -200.0, 1300.0, 0.036256,
+        {{
+            {0.0, {0.0, 0.261591059620E-01, 0.109574842280E-04, -0.938411115540E-07, -0.464120397590E-10, -0.263033577160E-11,
+                   -0.226534380030E-13, -0.760893007910E-16, -0.934196678350E-19, 0.0, 0.0}},
+            {1300.0, {0.0, 0.259293946010E-01, 0.157101418800E-04, 0.438256272370E-07, -0.252611697940E-09, 0.643118193390E-12,
+                      -0.100634715190E-14, 0.997453389920E-18, -0.608632456070E-21, 0.208492293390E-24, -0.306821961510E-28}},
+        }},
+        2,
+        {{
+            {0.0, {0.0, 3.8436847E+01, 1.1010485E+00, 5.2229312E+00, 7.2060525E+00, 5.8488586E+00, 2.7754916E+00, 7.7075166E-01,
+                   1.1582665E-01, 7.3138868E-03, 0.0}},
+            {20.613, {0.0, 3.86896E+01, -1.08267E+00, 4.70205E-02, -2.12169E-06, -1.17272E-04, 5.39280E-06, -7.98156E-08, 0.0, 0.0,
+                      0.0}},
+            {47.513, {1.972485E+01, 3.300943E+01, -3.915159E-01, 9.855391E-03, -1.274371E-04, 7.767022E-07, 0.0, 0.0, 0.0, 0.0,
+                      0.0}},
+        }},
+        3,
+        false
+    };
+
+    constexpr ThermocoupleData TYPE_S{
+        -50.0, 1768.1, 0.009587,
+        {{
+            {1064.18, {0.0, 0.540313308631E-02, 0.125934289740E-04, -0.232477968689E-07, 0.322028823036E-10,
+                       -0.331465196389E-13, 0.255744251786E-16, -0.125068871393E-19, 0.271443176145E-23, 0.0, 0.0}},
+            {1664.5, {0.132900444085E+01, 0.334509311344E-02, 0.654805192818E-05, -0.164856259209E-08, 0.129989605174E-13, 0.0,
+                      0.0, 0.0, 0.0, 0.0, 0.0}},
+            {1768.1, {0.146628232636E+03, -0.258430516752E+00, 0.163693574641E-03, -0.330439046987E-07, -0.943223690612E-14, 0.0,
+                      0.0, 0.0, 0.0, 0.0, 0.0}},
+        }},
+        3,
+        {{
+            {1.874, {0.0, 1.84949460E+02, -8.00504062E+01, 1.02237430E+02, -1.52248592E+02, 1.88821343E+02, -1.59085941E+02,
+                     8.23027880E+01, -2.34181944E+01, 2.79786260E+00, 0.0}},
+            {10.332, {1.291507177E+01, 1.466298863E+02, -1.534713402E+01, 3.145945973E+00, -4.163257839E-01, 3.187963771E-02,
+                      -1.291637500E-03, 2.183475087E-05, -1.447379511E-07, 8.211272125E-09, 0.0}},
+            {17.536, {-8.087801117E+01, 1.621573104E+02, -8.536869453E+00, 4.719686976E-01, -1.441693666E-02, 2.081618890E-04, 0.0,
+                      0.0, 0.0, 0.0, 0.0}},
+            {18.693, {5.333875126E+04, -1.235892298E+04, 1.092657613E+03, -4.265693686E+01, 6.247205420E-01, 0.0, 0.0, 0.0, 0.0,
+                      0.0, 0.0}},
+        }},
+        4,
+        false
+    };
+
+    constexpr ThermocoupleData TYPE_R{
+        -50.0, 1768.1, 0.010506,
+        {{
+            {1064.18, {0.0, 0.528961729765E-02, 0.139166589782E-04, -0.238855693017E-07, 0.356916001063E-10,
+                       -0.462347666298E-13, 0.500777441034E-16, -0.373105886191E-19, 0.157716482367E-22, -0.281038625251E-26,
+                       0.0}},
+            {1664.5, {0.295157925316E+01, -0.252061251332E-02, 0.159564501865E-04, -0.764085947576E-08, 0.205305291024E-11,
+                      -0.293359668173E-15, 0.0, 0.0, 0.0, 0.0, 0.0}},
+            {1768.1, {0.152232118209E+03, -0.268819888545E+00, 0.171280280471E-03, -0.345895706453E-07, -0.934633971046E-14, 0.0,
+                      0.0, 0.0, 0.0, 0.0, 0.0}},
+        }},
+        3,
+        {{
+            {1.923, {0.0, 1.8891380E+02, -9.3835290E+01, 1.3068619E+02, -2.2703580E+02, 3.5145659E+02, -3.8953900E+02,
+                     2.8239471E+02, -1.2607281E+02, 3.1353611E+01, -3.3187769E+00}},
+            {11.361, {1.334584505E+01, 1.472644573E+02, -1.844024844E+01, 4.031129726E+00, -6.249428360E-01, 6.468412046E-02,
+                      -4.458750426E-03, 1.994710149E-04, -5.313401790E-06, 6.481976217E-08, 0.0}},
+            {19.739, {-8.199599416E+01, 1.553962042E+02, -8.342197663E+00, 4.279433549E-01, -1.191577910E-02, 1.492290091E-04, 0.0,
+                      0.0, 0.0, 0.0, 0.0}},
+            {21.103, {3.406177836E+04, -7.023729171E+03, 5.582903813E+02, -1.952394635E+01, 2.560740231E-01, 0.0, 0.0, 0.0, 0.0,
+                      0.0, 0.0}},
+        }},
+        4,
+        false
+    };
+
+    constexpr const ThermocoupleData& Data(ThermocoupleType aType)
+    {
+        switch (aType)
+        {
+        case ThermocoupleType::N:
+            return TYPE_N;
+        case ThermocoupleType::S:
+            return TYPE_S;
+        case ThermocoupleType::R:
+            return TYPE_R;
+        default:
+            return TYPE_K;
+        }
+    }
+
+    /** @brief e^x for x <= 0, as std::exp isn't constexpr yet */
+    constexpr double Exp(double aX)
+    {
+        // Taylor series on x/1024, then square ten times
+        const double x = aX / 1024.0;
+        double term = 1.0;
+        double sum = 1.0;
+        for (int n = 1; n < 12; ++n)
+        {
+            term *= x / n;
+            sum += term;
+        }
+        for (int i = 0; i < 10; ++i)
+        {
+            sum *= sum;
+        }
+        return sum;
+    }
+
+    constexpr double Horner(const Polynomial& aPolynomial, double aX)
+    {
+        double result = 0.0;
+        for (size_t i = aPolynomial.c.size(); i-- > 0;)
+        {
+            result = result * aX + aPolynomial.c[i];
+        }
+        return result;
+    }
+
+    /** @brief Derivative of the polynomial */
+    constexpr double HornerSlope(const Polynomial& aPolynomial, double aX)
+    {
+        double result = 0.0;
+        for (size_t i = aPolynomial.c.size(); i-- > 1;)
+        {
+            result = result * aX + static_cast<double>(i) * aPolynomial.c[i];
+        }
+        return result;
+    }
+
+    constexpr const Polynomial& Range(const std::array<Polynomial, 3>& aRanges, size_t aCount, double aX)
+    {
+        size_t i = 0;
+        while (i + 1 < aCount && aX > aRanges[i].to)
+        {
+            ++i;
+        }
+        return aRanges[i];
+    }
+
+    constexpr double K_A0 = 0.118597600000E+00;
+    constexpr double K_A1 = -0.118343200000E-03;
+    constexpr double K_A2 = 0.126968600000E+03;
+
+    /** @brief Reference function: thermocouple mV with the cold junction at 0 °C */
+    constexpr double Voltage(ThermocoupleType aType, double aTemperature)
+    {
+        const ThermocoupleData& data = Data(aType);
+        double millivolts = Horner(Range(data.voltage, data.voltageRanges, aTemperature), aTemperature);
+        if (data.kExponential && aTemperature > 0.0)
+        {
+            const double offset = aTemperature - K_A2;
+            millivolts += K_A0 * Exp(K_A1 * offset * offset);
+        }
+        return millivolts;
+    }
+
+    /** @brief mV/°C, the derivative of Voltage() */
+    constexpr double Seebeck(ThermocoupleType aType, double aTemperature)
+    {
+        const ThermocoupleData& data = Data(aType);
+        double slope = HornerSlope(Range(data.voltage, data.voltageRanges, aTemperature), aTemperature);
+        if (data.kExponential && aTemperature > 0.0)
+        {
+            const double offset = aTemperature - K_A2;
+            slope += K_A0 * Exp(K_A1 * offset * offset) * 2.0 * K_A1 * offset;
+        }
+        return slope;
+    }
+
+    /** @brief NIST's published inverse polynomial, mV to °C */
+    constexpr double InverseTemperature(ThermocoupleType aType, double aMillivolts)
+    {
+        const ThermocoupleData& data = Data(aType);
+        size_t i = 0;
+        while (i + 1 < data.inverseRanges && aMillivolts > data.inverse[i].to)
+        {
+            ++i;
+        }
+        return Horner(data.inverse[i], aMillivolts);
+    }
+
+    /** @brief Voltage() inverted to within rounding, from the inverse polynomial and Newton's method */
+    constexpr double ExactTemperature(ThermocoupleType aType, double aMillivolts)
+    {
+        const ThermocoupleData& data = Data(aType);
+        double temperature = InverseTemperature(aType, aMillivolts);
+        temperature = temperature < data.minTemperature ? data.minTemperature : temperature;
+        temperature = temperature > data.maxTemperature ? data.maxTemperature : temperature;
+        for (int i = 0; i < 6; ++i)
+        {
+            temperature -= (Voltage(aType, temperature) - aMillivolts) / Seebeck(aType, temperature);
+        }
+        return temperature;
+    }
+} //namespace HeatTreatFurnace::Sensor::Nist
+
+#endif //HEAT_TREAT_FURNACE_NIST_HPP
@@ -0,0 +1,90 @@
+#include "ReplayThermocouple.hpp"
+
+#include "Linearization.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace HeatTreatFurnace::Sensor
+{
+    ReplayThermocouple::ReplayThermocouple(const Time::Clock& aClock, size_t aChannels, TemperatureSource aSource) :
+        ThermocoupleDriver(aChannels), myClock(aClock), mySource(std::move(aSource))
+    {
+    }
+
+    ReplayThermocouple::TemperatureSource ReplayThermocouple::Trace(std::span<const TracePoint> aTrace)
+    {
+        return [aTrace](size_t, std::chrono::microseconds aNow) -> float
+        {
+            if (aTrace.empty())
+            {
+                return 0.0f;
+            }
+            const auto after = std::ranges::upper_bound(aTrace, aNow, {}, [](const TracePoint& aPoint)
+            {
+                return std::chrono::microseconds(aPoint.time);
+            });
+            if (after == aTrace.begin())
+            {
+                return aTrace.front().temperature;
+            }
+            if (after == aTrace.end())
+            {
+                return aTrace.back().temperature;
+            }
+            const TracePoint& before = *(after - 1);
+            const float fraction = std::chrono::duration<float>(aNow - before.time) / std::chrono::duration<float>(after->time - before.time);
+            return before.temperature + (after->temperature - before.temperature) * fraction;
+        };
+    }
+
+    void ReplayThermocouple::Poll()
+    {
+        const std::chrono::microseconds now = myClock.Now();
+        for (size_t channel = 0; channel < ChannelCount(); ++channel)
+        {
+            const float temperature = mySource(channel, now);
+            const float reported = myType ? Linearization::Reported(*myType, temperature, myColdJunction) : temperature;
+            Publish(channel, Max31855Frame::Encode(reported, myColdJunction, PrivFaultsAt(channel, now)));
+        }
+        EndBatch();
+    }
+
+    bool ReplayThermocouple::InjectFault(const InjectedFault& aFault)
+    {
+        if (myFaults.full())
+        {
+            return false;
+        }
+        myFaults.push_back(aFault);
+        return true;
+    }
+
+    void ReplayThermocouple::ClearFaults()
+    {
+        myFaults.clear();
+    }
+
+    void ReplayThermocouple::SetColdJunction(float aTemperature)
+    {
+        myColdJunction = aTemperature;
+    }
+
+    void ReplayThermocouple::SetThermocoupleType(ThermocoupleType aType)
+    {
+        myType = aType;
+    }
+
+    uint8_t ReplayThermocouple::PrivFaultsAt(size_t aChannel, std::chrono::microseconds aNow) const
+    {
+        uint8_t faults = 0;
+        for (const InjectedFault& fault : myFaults)
+        {
+            if (fault.channel == aChannel && aNow >= fault.from && aNow < fault.until)
+            {
+                faults |= static_cast<uint8_t>(fault.fault);
+            }
+        }
+        return faults;
+    }
+} //namespace HeatTreatFurnace::Sensor
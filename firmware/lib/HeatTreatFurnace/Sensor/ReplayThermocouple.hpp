@@ -0,0 +1,76 @@
+#ifndef HEAT_TREAT_FURNACE_REPLAY_THERMOCOUPLE_HPP
+#define HEAT_TREAT_FURNACE_REPLAY_THERMOCOUPLE_HPP
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <span>
+
+#include "etl/vector.h"
+
+#include "Thermocouple.hpp"
+#include "ThermocoupleType.hpp"
+#include "Time/Clock.hpp"
+
+namespace HeatTreatFurnace::Sensor
+{
+    /** @brief One point of a recorded trace */
+    struct TracePoint
+    {
+        std::chrono::milliseconds time;
+        float temperature; // °C
+    };
+
+    /** @brief A fault on one channel for a while */
+    struct InjectedFault
+    {
+        size_t channel;
+        ThermocoupleFault fault;
+        std::chrono::microseconds from; // Clock time
+        std::chrono::microseconds until; // Clock time, exclusive
+    };
+
+    /**
+     * @brief Host stand-in for Max31855Driver: readings from a trace or a model, faults on demand.
+     *
+     * Every reading is encoded into the frame a MAX31855 would send and published the same way, so
+     * what the consumer sees, down to the 0.25 °C steps and the fault bits, is what it would see from
+     * the hardware.
+     */
+    class ReplayThermocouple : public ThermocoupleDriver
+    {
+    public:
+        static constexpr size_t MAX_INJECTED_FAULTS = 16;
+
+        /** @brief °C for a channel at a Clock time */
+        using TemperatureSource = std::function<float(size_t aChannel, std::chrono::microseconds aNow)>;
+
+        ReplayThermocouple(const Time::Clock& aClock, size_t aChannels, TemperatureSource aSource);
+
+        /** @brief A recorded trace for every channel, interpolated, held at either end; time 0 is Clock time 0, and aTrace must outlive the source */
+        static TemperatureSource Trace(std::span<const TracePoint> aTrace);
+
+        /** @brief Read the source for every channel now */
+        void Poll() override;
+
+        /** @brief Overrides the reading while Clock time is in [from, until); false if MAX_INJECTED_FAULTS are already set */
+        bool InjectFault(const InjectedFault& aFault);
+        void ClearFaults();
+
+        void SetColdJunction(float aTemperature);
+
+        /** @brief From now on report what a MAX31855 of aType would, its linear approximation, rather than the source's temperature as is */
+        void SetThermocoupleType(ThermocoupleType aType);
+
+    private:
+        [[nodiscard]] uint8_t PrivFaultsAt(size_t aChannel, std::chrono::microseconds aNow) const;
+
+        const Time::Clock& myClock;
+        TemperatureSource mySource;
+        float myColdJunction = 25.0f;
+        std::optional<ThermocoupleType> myType;
+        etl::vector<InjectedFault, MAX_INJECTED_FAULTS> myFaults;
+    };
+} //namespace HeatTreatFurnace::Sensor
+
+#endif //HEAT_TREAT_FURNACE_REPLAY_THERMOCOUPLE_HPP
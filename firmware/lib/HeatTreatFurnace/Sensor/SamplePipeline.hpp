@@ -0,0 +1,292 @@
+#ifndef HEAT_TREAT_FURNACE_SAMPLE_PIPELINE_HPP
+#define HEAT_TREAT_FURNACE_SAMPLE_PIPELINE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+
+#include "Thermocouple.hpp"
+
+namespace HeatTreatFurnace::Sensor
+{
+    /**
+     * @brief One step of a SamplePipeline.
+     *
+     * Process() may change the sample, e.g. replace its temperature or flag a fault, and returns
+     * false to swallow it, in which case the stages after it don't see it. Faulty samples are passed
+     * on, so a later stage can count them.
+     */
+    template <typename T>
+    concept SampleStage = requires(T aStage, ThermocoupleSample& aSample)
+    {
+        { aStage.Process(aSample) } -> std::same_as<bool>;
+        aStage.Reset();
+    };
+
+    /**
+     * @brief A thermocouple channel's samples, through Stages in order (SPECIFICATION.md §3.12).
+     *
+     * The stages are members, not pointers, and Process() is a fold over them, so the compiler sees
+     * the whole chain and inlines it: no virtual call and no allocation per sample, and a footprint
+     * fixed by the template arguments.
+     */
+    template <SampleStage... Stages>
+    class SamplePipeline
+    {
+    public:
+        /** @brief One sample in; true with the result in aSample if one comes out */
+        bool Process(ThermocoupleSample& aSample)
+        {
+            return std::apply([&aSample](Stages&... aStages)
+            {
+                return (aStages.Process(aSample) && ...);
+            }, myStages);
+        }
+
+        /** @brief Forget every stage's history */
+        void Reset()
+        {
+            std::apply([](Stages&... aStages)
+            {
+                (aStages.Reset(), ...);
+            }, myStages);
+        }
+
+        template <SampleStage Stage>
+        [[nodiscard]] Stage& GetStage()
+        {
+            return std::get<Stage>(myStages);
+        }
+
+    private:
+        std::tuple<Stages...> myStages;
+    };
+
+    /**
+     * @brief Flags a valid reading more than a step away from the last accepted one as an Outlier.
+     *
+     * An SSR switching can put a single wild reading on the line; the kiln itself can't move a few
+     * degrees in 100 ms. A real step, e.g. a thermocouple plugged back in, is accepted once CONFIRM
+     * readings in a row agree with each other.
+     */
+    template <uint8_t CONFIRM = 3>
+        requires (CONFIRM >= 1)
+    class OutlierRejection
+    {
+    public:
+        /** @brief °C between consecutive readings above which one is an outlier */
+        void SetMaxStep(float aMaxStep)
+        {
+            myMaxStep = aMaxStep;
+        }
+
+        bool Process(ThermocoupleSample& aSample)
+        {
+            if (!aSample.IsValid())
+            {
+                return true;
+            }
+            if (!myHasReference || std::abs(aSample.temperature - myReference) <= myMaxStep)
+            {
+                PrivAccept(aSample.temperature);
+                return true;
+            }
+
+            const bool agrees = myCandidates > 0 && std::abs(aSample.temperature - myCandidate) <= myMaxStep;
+            myCandidates = agrees ? myCandidates + 1 : 1;
+            myCandidate = aSample.temperature;
+            if (myCandidates >= CONFIRM)
+            {
+                PrivAccept(aSample.temperature);
+                return true;
+            }
+            aSample.faults |= static_cast<uint8_t>(ThermocoupleFault::Outlier);
+            return true;
+        }
+
+        void Reset()
+        {
+            myHasReference = false;
+            myCandidates = 0;
+        }
+
+    private:
+        void PrivAccept(float aTemperature)
+        {
+            myReference = aTemperature;
+            myHasReference = true;
+            myCandidates = 0;
+        }
+
+        float myMaxStep = 5.0f;
+        float myReference = 0.0f;
+        float myCandidate = 0.0f;
+        uint8_t myCandidates = 0;
+        bool myHasReference = false;
+    };
+
+    /**
+     * @brief Rides out faults up to MAX31855_Error_Grace_Count (SPECIFICATION.md §8.1).
+     *
+     * Each faulty sample adds one to an error count and each valid one takes one off. While the count
+     * is within the grace count a faulty sample is replaced by the last valid one, so the stages and
+     * consumers after it never see a sporadic fault; once it is over, faults are passed on. A sensor
+     * that fails more often than it reads therefore trips however the failures are spread out.
+     */
+    class GraceCounter
+    {
+    public:
+        void SetGraceCount(uint8_t aGraceCount)
+        {
+            myGraceCount = aGraceCount;
+        }
+
+        bool Process(ThermocoupleSample& aSample)
+        {
+            if (aSample.IsValid())
+            {
+                myErrors = myErrors > 0 ? myErrors - 1 : 0;
+                myLastValid = aSample;
+                myHasValid = true;
+                return true;
+            }
+
+            myErrors = myErrors < UINT8_MAX ? myErrors + 1 : UINT8_MAX;
+            if (myHasValid && myErrors <= myGraceCount)
+            {
+                aSample.temperature = myLastValid.temperature;
+                aSample.coldJunction = myLastValid.coldJunction;
+                aSample.faults = 0;
+            }
+            return true;
+        }
+
+        void Reset()
+        {
+            myErrors = 0;
+            myHasValid = false;
+        }
+
+        /** @brief Current error count, over the grace count while faults are passed on */
+        [[nodiscard]] uint8_t Errors() const
+        {
+            return myErrors;
+        }
+
+    private:
+        uint8_t myGraceCount = 5;
+        uint8_t myErrors = 0;
+        bool myHasValid = false;
+        ThermocoupleSample myLastValid;
+    };
+
+    /**
+     * @brief The mean of every N valid samples, as one sample.
+     *
+     * Averages away the chip's 0.25 °C steps and reading noise, at 1/N the rate. A fault is passed on
+     * at once, and the partial average dropped, so a fault isn't held back for up to N samples.
+     */
+    template <size_t N>
+        requires (N >= 1)
+    class Oversampler
+    {
+    public:
+        bool Process(ThermocoupleSample& aSample)
+        {
+            if (!aSample.IsValid())
+            {
+                Reset();
+                return true;
+            }
+            myTemperatureSum += aSample.temperature;
+            myColdJunctionSum += aSample.coldJunction;
+            if (++myCount < N)
+            {
+                return false;
+            }
+            aSample.temperature = myTemperatureSum / static_cast<float>(N);
+            aSample.coldJunction = myColdJunctionSum / static_cast<float>(N);
+            Reset();
+            return true;
+        }
+
+        void Reset()
+        {
+            myTemperatureSum = 0.0f;
+            myColdJunctionSum = 0.0f;
+            myCount = 0;
+        }
+
+    private:
+        float myTemperatureSum = 0.0f;
+        float myColdJunctionSum = 0.0f;
+        size_t myCount = 0;
+    };
+
+    /**
+     * @brief The median of the last N valid temperatures.
+     *
+     * Removes any spike shorter than half the window, where a mean would smear it, and adds
+     * (N - 1) / 2 samples of lag on a ramp. The window is kept sorted as well as in arrival order, so
+     * a sample costs one removal and one insertion of at most N floats, not a sort. A fault is passed
+     * on and empties the window, so readings from before it don't outvote those after.
+     */
+    template <size_t N>
+        requires (N % 2 == 1)
+    class RunningMedian
+    {
+    public:
+        bool Process(ThermocoupleSample& aSample)
+        {
+            if (!aSample.IsValid())
+            {
+                Reset();
+                return true;
+            }
+
+            if (myCount == N)
+            {
+                // Drop the oldest from the sorted window; the arrivals ring is full, so it is next to be overwritten
+                float* oldest = std::lower_bound(mySorted.data(), mySorted.data() + myCount, myArrivals[myNext]);
+                std::copy(oldest + 1, mySorted.data() + myCount, oldest);
+                --myCount;
+            }
+            float* position = std::upper_bound(mySorted.data(), mySorted.data() + myCount, aSample.temperature);
+            std::copy_backward(position, mySorted.data() + myCount, mySorted.data() + myCount + 1);
+            *position = aSample.temperature;
+            ++myCount;
+
+            myArrivals[myNext] = aSample.temperature;
+            myNext = (myNext + 1) % N;
+            aSample.temperature = mySorted[myCount / 2];
+            return true;
+        }
+
+        void Reset()
+        {
+            myCount = 0;
+            myNext = 0;
+        }
+
+    private:
+        std::array<float, N> myArrivals{};
+        std::array<float, N> mySorted{};
+        size_t myCount = 0;
+        size_t myNext = 0;
+    };
+
+    /**
+     * @brief What SensorPublisher runs on the kiln and case channels, at the MAX31855's 100 ms.
+     *
+     * Spikes are flagged first, while they are still single readings, then ridden out with real
+     * faults by the grace count; four readings are averaged, and the median of five averages taken.
+     * A reading every 400 ms, about a second behind on a ramp, against a 5 s PID window.
+     */
+    using SensorPipeline = SamplePipeline<OutlierRejection<>, GraceCounter, Oversampler<4>, RunningMedian<5>>;
+} //namespace HeatTreatFurnace::Sensor
+
+#endif //HEAT_TREAT_FURNACE_SAMPLE_PIPELINE_HPP
@@ -0,0 +1,70 @@
+#include "SensorPublisher.hpp"
+
+#include "Linearization.hpp"
+
+namespace HeatTreatFurnace::Sensor
+{
+    SensorPublisher::SensorPublisher(const ThermocoupleDriver& aDriver, ThermocoupleType aType, size_t aKilnChannel, size_t aCaseChannel) :
+        myDriver(aDriver), myType(aType), myKilnChannel(aKilnChannel), myCaseChannel(aCaseChannel)
+    {
+    }
+
+    void SensorPublisher::ApplyPreferences(const Furnace::Preferences& aPreferences)
+    {
+        myType = aPreferences.thermocoupleType;
+        myKilnPipeline.GetStage<GraceCounter>().SetGraceCount(aPreferences.max31855ErrorGraceCount);
+        myCasePipeline.GetStage<GraceCounter>().SetGraceCount(aPreferences.max31855ErrorGraceCount);
+    }
+
+    void SensorPublisher::Poll()
+    {
+        const uint32_t sequence = myDriver.Sequence();
+        if (sequence == myPolledSequence)
+        {
+            return;
+        }
+        myPolledSequence = sequence;
+
+        // Both channels every batch, so neither pipeline skips a reading when the other has nothing to publish
+        const bool kiln = PrivProcess(myKilnChannel, myKilnPipeline, myKiln);
+        const bool housing = PrivProcess(myCaseChannel, myCasePipeline, myCase);
+        if (!kiln && !housing)
+        {
+            return;
+        }
+
+        SensorReadings readings;
+        readings.kilnTemperature = myKiln.temperature;
+        readings.envTemperature = myKiln.coldJunction;
+        readings.caseTemperature = myCase.temperature;
+        readings.kilnFaults = myKiln.faults;
+        readings.caseFaults = myCase.faults;
+        readings.sequence = sequence;
+        mySnapshot.Publish(readings);
+    }
+
+    SensorReadings SensorPublisher::Latest() const
+    {
+        return mySnapshot.Read();
+    }
+
+    const Sync::Snapshot<SensorReadings>& SensorPublisher::GetSnapshot() const
+    {
+        return mySnapshot;
+    }
+
+    bool SensorPublisher::PrivProcess(size_t aChannel, SensorPipeline& aPipeline, ThermocoupleSample& anOutput) const
+    {
+        ThermocoupleSample sample = myDriver.Latest(aChannel);
+        if (sample.IsValid())
+        {
+            sample.temperature = Linearization::HotJunction(myType, sample.temperature, sample.coldJunction);
+        }
+        if (!aPipeline.Process(sample))
+        {
+            return false;
+        }
+        anOutput = sample;
+        return true;
+    }
+} //namespace HeatTreatFurnace::Sensor
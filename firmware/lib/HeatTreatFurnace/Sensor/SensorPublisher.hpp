@@ -0,0 +1,78 @@
+#ifndef HEAT_TREAT_FURNACE_SENSOR_PUBLISHER_HPP
+#define HEAT_TREAT_FURNACE_SENSOR_PUBLISHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "SamplePipeline.hpp"
+#include "Thermocouple.hpp"
+#include "ThermocoupleType.hpp"
+#include "Furnace/Preferences.hpp"
+#include "Sync/Snapshot.hpp"
+
+namespace HeatTreatFurnace::Sensor
+{
+    /** @brief The readings every task needs, from one batch */
+    struct SensorReadings
+    {
+        float kilnTemperature = 0.0f; // °C, linearized
+        float envTemperature = 0.0f; // °C at the controller board: the kiln MAX31855's cold junction
+        float caseTemperature = 0.0f; // °C, linearized
+        uint8_t kilnFaults = static_cast<uint8_t>(ThermocoupleFault::NoResponse); // ThermocoupleFault flags
+        uint8_t caseFaults = static_cast<uint8_t>(ThermocoupleFault::NoResponse);
+        uint32_t sequence = 0; // ThermocoupleDriver::Sequence() of the latest batch in these readings, 0 before the first
+
+        [[nodiscard]] bool IsKilnValid() const
+        {
+            return kilnFaults == 0;
+        }
+    };
+
+    static_assert(std::is_trivially_copyable_v<SensorReadings>, "published through a Sync::Snapshot");
+
+    /**
+     * @brief Publishes a ThermocoupleDriver's readings to the control loop, broadcast and history tasks.
+     *
+     * Poll() runs in the sensor task, right after the driver's; every other task calls Latest(), and
+     * gets kiln, environment and case from the same batch without taking a lock (Sync::Snapshot).
+     * Thermocouple readings are corrected from the chip's linear approximation (Linearization), then
+     * go through a SensorPipeline per channel, so readings come out at the pipeline's rate rather than
+     * every batch, and a fault only once MAX31855_Error_Grace_Count has run out.
+     */
+    class SensorPublisher
+    {
+    public:
+        explicit SensorPublisher(const ThermocoupleDriver& aDriver, ThermocoupleType aType = ThermocoupleType::K, size_t aKilnChannel = 0,
+                                 size_t aCaseChannel = 1);
+
+        /** @brief Thermocouple_Type and MAX31855_Error_Grace_Count; the sensor task only, between Poll() calls */
+        void ApplyPreferences(const Furnace::Preferences& aPreferences);
+
+        /** @brief Run the driver's batch through the pipelines if it is a new one, and publish what comes out; the sensor task only */
+        void Poll();
+
+        /** @brief From any task */
+        [[nodiscard]] SensorReadings Latest() const;
+
+        /** @brief For a reader that wants to skip work when nothing changed, with Version() */
+        [[nodiscard]] const Sync::Snapshot<SensorReadings>& GetSnapshot() const;
+
+    private:
+        /** @brief aChannel's latest reading through aPipeline into anOutput; true if one came out */
+        bool PrivProcess(size_t aChannel, SensorPipeline& aPipeline, ThermocoupleSample& anOutput) const;
+
+        const ThermocoupleDriver& myDriver;
+        ThermocoupleType myType;
+        size_t myKilnChannel;
+        size_t myCaseChannel;
+        uint32_t myPolledSequence = 0;
+        SensorPipeline myKilnPipeline;
+        SensorPipeline myCasePipeline;
+        ThermocoupleSample myKiln{.faults = static_cast<uint8_t>(ThermocoupleFault::NoResponse)};
+        ThermocoupleSample myCase{.faults = static_cast<uint8_t>(ThermocoupleFault::NoResponse)};
+        Sync::Snapshot<SensorReadings> mySnapshot;
+    };
+} //namespace HeatTreatFurnace::Sensor
+
+#endif //HEAT_TREAT_FURNACE_SENSOR_PUBLISHER_HPP
@@ -0,0 +1,40 @@
+#ifndef HEAT_TREAT_FURNACE_SPI_BUS_HPP
+#define HEAT_TREAT_FURNACE_SPI_BUS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace HeatTreatFurnace::Sensor
+{
+    enum class SpiStatus : uint8_t
+    {
+        Idle,
+        Busy,
+        Done,
+        Failed
+    };
+
+    /**
+     * @brief Read-only SPI bus with a chip select per device, driven without waiting.
+     *
+     * On the ESP32 this is a set of queued DMA transactions, one per chip select, submitted together
+     * and collected with a zero timeout.
+     */
+    class SpiBus
+    {
+    public:
+        virtual ~SpiBus() = default;
+
+        /**
+         * @brief Start reading aReceive.size() / aDeviceCount bytes from each device, one after the other, into aReceive
+         * @return false if the bus is busy or can't start, and nothing was started
+         */
+        virtual bool StartRead(std::span<uint8_t> aReceive, size_t aDeviceCount) = 0;
+
+        /** @brief How the read started last is going; once Done or Failed it is reported once, then Idle */
+        virtual SpiStatus Poll() = 0;
+    };
+} //namespace HeatTreatFurnace::Sensor
+
+#endif //HEAT_TREAT_FURNACE_SPI_BUS_HPP
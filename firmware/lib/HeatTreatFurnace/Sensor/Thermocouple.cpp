@@ -0,0 +1,95 @@
+#include "Thermocouple.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace HeatTreatFurnace::Sensor
+{
+    namespace
+    {
+        constexpr uint32_t RESERVED_BITS = (1u << 17) | (1u << 3);
+        constexpr uint32_t FAULT_BIT = 1u << 16;
+        constexpr uint32_t FAULT_MASK = 0x7;
+    }
+
+    namespace Max31855Frame
+    {
+        ThermocoupleSample Decode(uint32_t aFrame)
+        {
+            ThermocoupleSample sample;
+            if ((aFrame & RESERVED_BITS) != 0)
+            {
+                sample.faults = static_cast<uint8_t>(ThermocoupleFault::NoResponse);
+                return sample;
+            }
+
+            // Arithmetic shifts sign-extend the two fields
+            sample.temperature = static_cast<float>(static_cast<int32_t>(aFrame) >> 18) * 0.25f;
+            sample.coldJunction = static_cast<float>(static_cast<int32_t>(aFrame << 16) >> 20) * 0.0625f;
+            if ((aFrame & FAULT_BIT) != 0)
+            {
+                // The summary bit with no cause is still a fault
+                const uint32_t faults = aFrame & FAULT_MASK;
+                sample.faults = static_cast<uint8_t>(faults != 0 ? faults : static_cast<uint32_t>(ThermocoupleFault::NoResponse));
+            }
+            return sample;
+        }
+
+        uint32_t Encode(float aTemperature, float aColdJunction, uint8_t aFaults)
+        {
+            if ((aFaults & static_cast<uint8_t>(ThermocoupleFault::NoResponse)) != 0)
+            {
+                return NO_RESPONSE;
+            }
+            const auto temperature = static_cast<int32_t>(std::lround(std::clamp(aTemperature, -2048.0f, 2047.75f) * 4.0f));
+            const auto coldJunction = static_cast<int32_t>(std::lround(std::clamp(aColdJunction, -128.0f, 127.9375f) * 16.0f));
+            const uint32_t faults = aFaults & FAULT_MASK;
+            return ((static_cast<uint32_t>(temperature) & 0x3FFF) << 18)
+                | (faults != 0 ? FAULT_BIT : 0)
+                | ((static_cast<uint32_t>(coldJunction) & 0xFFF) << 4)
+                | faults;
+        }
+    }
+
+    ThermocoupleDriver::ThermocoupleDriver(size_t aChannels) :
+        myChannels(std::min(aChannels, MAX_THERMOCOUPLES))
+    {
+        for (std::atomic<uint32_t>& frame : myFrames)
+        {
+            frame.store(Max31855Frame::NO_RESPONSE, std::memory_order_relaxed);
+        }
+    }
+
+    size_t ThermocoupleDriver::ChannelCount() const
+    {
+        return myChannels;
+    }
+
+    ThermocoupleSample ThermocoupleDriver::Latest(size_t aChannel) const
+    {
+        // Sequence first: acquire pairs with EndBatch(), so the frame is at least that batch's
+        const uint32_t sequence = mySequence.load(std::memory_order_acquire);
+        const uint32_t frame = aChannel < myChannels ? myFrames[aChannel].load(std::memory_order_relaxed) : Max31855Frame::NO_RESPONSE;
+        ThermocoupleSample sample = Max31855Frame::Decode(frame);
+        sample.sequence = sequence;
+        return sample;
+    }
+
+    uint32_t ThermocoupleDriver::Sequence() const
+    {
+        return mySequence.load(std::memory_order_acquire);
+    }
+
+    void ThermocoupleDriver::Publish(size_t aChannel, uint32_t aFrame)
+    {
+        if (aChannel < myChannels)
+        {
+            myFrames[aChannel].store(aFrame, std::memory_order_relaxed);
+        }
+    }
+
+    void ThermocoupleDriver::EndBatch()
+    {
+        mySequence.fetch_add(1, std::memory_order_release);
+    }
+} //namespace HeatTreatFurnace::Sensor
@@ -0,0 +1,105 @@
+#ifndef HEAT_TREAT_FURNACE_THERMOCOUPLE_HPP
+#define HEAT_TREAT_FURNACE_THERMOCOUPLE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Control/ZoneEngine.hpp"
+
+namespace HeatTreatFurnace::Sensor
+{
+    constexpr size_t MAX_THERMOCOUPLES = Control::MAX_ZONES + 1; // one per zone, and the case
+
+    /** @brief Bit flags, as the MAX31855 reports them, plus one for a chip that didn't answer and one for a rejected reading */
+    enum class ThermocoupleFault : uint8_t
+    {
+        None = 0,
+        OpenCircuit = 0x01,
+        ShortToGround = 0x02,
+        ShortToVcc = 0x04,
+        NoResponse = 0x08, // bus error, or a frame no MAX31855 could send
+        Outlier = 0x10, // too far from the readings before it, see OutlierRejection; never from a frame
+    };
+
+    /** @brief One decoded MAX31855 frame */
+    struct ThermocoupleSample
+    {
+        float temperature = 0.0f; // °C at the hot junction, 0.25 °C steps; not to be used if faults is set
+        float coldJunction = 0.0f; // °C inside the chip, 0.0625 °C steps
+        uint8_t faults = 0; // ThermocoupleFault flags
+        uint32_t sequence = 0; // ThermocoupleDriver::Sequence() when read; unchanged means no new reading
+
+        [[nodiscard]] bool IsValid() const
+        {
+            return faults == 0;
+        }
+
+        [[nodiscard]] bool Has(ThermocoupleFault aFault) const
+        {
+            return (faults & static_cast<uint8_t>(aFault)) != 0;
+        }
+    };
+
+    /**
+     * @brief The MAX31855's 32-bit frame.
+     *
+     * D31-18 thermocouple °C × 4 and D15-4 cold junction °C × 16, both two's complement; D16 any
+     * fault; D2-0 short to VCC, short to GND, open circuit. D17 and D3 always read 0, so a frame with
+     * either set came from no chip at all, e.g. MISO floating high.
+     */
+    namespace Max31855Frame
+    {
+        constexpr uint32_t NO_RESPONSE = 0xFFFFFFFF;
+
+        [[nodiscard]] ThermocoupleSample Decode(uint32_t aFrame);
+
+        /** @brief What a chip would send, for host stand-ins; temperatures are rounded and clamped to the frame's range */
+        [[nodiscard]] uint32_t Encode(float aTemperature, float aColdJunction, uint8_t aFaults = 0);
+    }
+
+    /**
+     * @brief Thermocouple readings for the control loop, from hardware or a host stand-in.
+     *
+     * Poll() is driven by one task (the sensor task, or the control loop itself); it never blocks, so
+     * a slow or stuck bus costs the caller nothing. Latest() may be called from any task. Each
+     * channel is published as the raw 32-bit frame in one atomic word, so a reader never sees half of
+     * one reading and half of another, and neither side ever takes a lock. Sequence() moves on once a
+     * whole batch has been published.
+     */
+    class ThermocoupleDriver
+    {
+    public:
+        virtual ~ThermocoupleDriver() = default;
+
+        ThermocoupleDriver(const ThermocoupleDriver&) = delete;
+        ThermocoupleDriver& operator=(const ThermocoupleDriver&) = delete;
+
+        /** @brief Collect any reading that has finished and start the next; never waits */
+        virtual void Poll() = 0;
+
+        [[nodiscard]] size_t ChannelCount() const;
+
+        /** @brief Most recent reading of aChannel; NoResponse before the first, or for a channel out of range */
+        [[nodiscard]] ThermocoupleSample Latest(size_t aChannel) const;
+
+        /** @brief Batches published so far */
+        [[nodiscard]] uint32_t Sequence() const;
+
+    protected:
+        explicit ThermocoupleDriver(size_t aChannels);
+
+        void Publish(size_t aChannel, uint32_t aFrame);
+        void EndBatch();
+
+    private:
+        static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+        size_t myChannels;
+        std::array<std::atomic<uint32_t>, MAX_THERMOCOUPLES> myFrames;
+        std::atomic<uint32_t> mySequence{0};
+    };
+} //namespace HeatTreatFurnace::Sensor
+
+#endif //HEAT_TREAT_FURNACE_THERMOCOUPLE_HPP
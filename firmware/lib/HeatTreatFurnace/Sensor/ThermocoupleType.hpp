@@ -0,0 +1,19 @@
+#ifndef HEAT_TREAT_FURNACE_THERMOCOUPLE_TYPE_HPP
+#define HEAT_TREAT_FURNACE_THERMOCOUPLE_TYPE_HPP
+
+#include <cstdint>
+
+namespace HeatTreatFurnace::Sensor
+{
+    /** @brief Thermocouple_Type; each needs the MAX31855 variant of the same letter */
+    enum class ThermocoupleType : uint8_t
+    {
+        K,
+        N,
+        S,
+        R,
+        COUNT
+    };
+} //namespace HeatTreatFurnace::Sensor
+
+#endif //HEAT_TREAT_FURNACE_THERMOCOUPLE_TYPE_HPP
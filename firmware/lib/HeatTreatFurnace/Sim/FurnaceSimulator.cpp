@@ -0,0 +1,276 @@
+#include "FurnaceSimulator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace HeatTreatFurnace::Sim
+{
+    namespace
+    {
+        constexpr size_t KILN_CHANNEL = 0;
+        constexpr size_t CASE_CHANNEL = 1;
+
+        /** @brief Whether the furnace is still doing something RunUntilDone() should wait for */
+        bool IsBusy(Furnace::StateId aState)
+        {
+            switch (aState)
+            {
+            case Furnace::StateId::RUNNING:
+            case Furnace::StateId::PAUSED:
+            case Furnace::StateId::WAITING_FOR_TEMP:
+            case Furnace::StateId::AUTOTUNING:
+            case Furnace::StateId::TRANSITIONING:
+                return true;
+            default:
+                return false;
+            }
+        }
+    }
+
+    FurnaceSimulator::FurnaceSimulator(const Furnace::Preferences& aPreferences, const ThermalParameters& aKiln, Log::LogService& aLog) :
+        myKiln(aKiln),
+        myThermocouples(myClock, 2, [this](size_t aChannel, std::chrono::microseconds aNow)
+        {
+            return PrivRead(aChannel, aNow);
+        }),
+        myPublisher(myThermocouples, aPreferences.thermocoupleType, KILN_CHANNEL, CASE_CHANNEL),
+        myStateMachine(myFurnaceState, myClock, aLog),
+        mySsr(Control::SsrConfig::FromPreferences(aPreferences)),
+        myMonitor(myClock, myPublisher.GetSnapshot(), myStateMachine.GetStateSnapshot(), myHeater, myWatchdog, aLog),
+        myScheduler(myClock, aLog),
+        myControlPeriod(aPreferences.pidWindowMs)
+    {
+        myThermocouples.SetThermocoupleType(aPreferences.thermocoupleType);
+        myPublisher.ApplyPreferences(aPreferences);
+        myStateMachine.ApplyPreferences(aPreferences);
+
+        const Safety::SafetyConfig safety = Safety::SafetyConfig::FromPreferences(aPreferences);
+        myMonitor.Configure(safety);
+        myMonitor.SetTripHandler(Safety::SafetyMonitor::TripHandler::create<Furnace::StateMachine, &Furnace::StateMachine::OnSafetyTrip>(myStateMachine));
+        myScheduler.SetSafetyMissHandler(Control::LoopScheduler::SafetyMissHandler::create<Furnace::StateMachine, &Furnace::StateMachine::OnSafetyDeadlineMissed>(myStateMachine));
+
+        // Can't fail: four stages fit in MAX_STAGES, and every period is positive
+        myScheduler.AddStage("sensor", SENSOR_PERIOD, SENSOR_PERIOD, Control::LoopScheduler::StageFunction::create<FurnaceSimulator, &FurnaceSimulator::PrivSensor>(*this));
+        myScheduler.AddStage("ssr", SSR_PERIOD, SSR_PERIOD, Control::LoopScheduler::StageFunction::create<FurnaceSimulator, &FurnaceSimulator::PrivSsr>(*this));
+        myScheduler.AddStage("control", myControlPeriod, myControlPeriod, Control::LoopScheduler::StageFunction::create<FurnaceSimulator, &FurnaceSimulator::PrivControl>(*this));
+        myScheduler.AddStage("safety", safety.period, safety.period, Control::LoopScheduler::StageFunction::create<FurnaceSimulator, &FurnaceSimulator::PrivSafety>(*this), true);
+        myScheduler.Start();
+        myMonitor.Start();
+    }
+
+    Furnace::Result FurnaceSimulator::Fire(std::unique_ptr<Furnace::Profile> aProfile)
+    {
+        const Sensor::SensorReadings readings = myPublisher.Latest();
+        if (readings.sequence == 0 || !readings.IsKilnValid())
+        {
+            return {false, "No kiln reading to start from"};
+        }
+
+        const size_t segments = aProfile ? aProfile->SegmentCount() : 0;
+        Furnace::Result res = myStateMachine.LoadProfile(std::move(aProfile), readings.kilnTemperature);
+        if (!res)
+        {
+            return res;
+        }
+        res = myStateMachine.StartProfile(0, 0, readings.kilnTemperature);
+        if (!res)
+        {
+            return res;
+        }
+
+        myStats = {};
+        myTrackingErrorSum = 0.0;
+        myTrackingSamples = 0;
+        myFireEnergyKWh = myKiln.EnergyKWh();
+        myFireSwitches = mySsr.SwitchCount();
+        myStats.segments.assign(segments, {});
+        mySegmentErrorSums.assign(segments, 0.0);
+        mySegmentSamples.assign(segments, 0);
+        return {true, ""};
+    }
+
+    void FurnaceSimulator::RunFor(std::chrono::microseconds aDuration)
+    {
+        myScheduler.RunUntil(myClock.Now() + aDuration);
+    }
+
+    Furnace::StateId FurnaceSimulator::RunUntilDone(std::chrono::microseconds aLimit)
+    {
+        const std::chrono::microseconds end = myClock.Now() + aLimit;
+        while (myClock.Now() < end && IsBusy(myStateMachine.GetState()))
+        {
+            myClock.SleepUntil(std::min(myScheduler.Tick(), end));
+        }
+        return myStateMachine.GetState();
+    }
+
+    void FurnaceSimulator::SetSensorNoise(float aStdDev, uint32_t aSeed)
+    {
+        myNoisy = aStdDev > 0.0f;
+        myNoiseSource.seed(aSeed);
+        myNoise = std::normal_distribution<float>(0.0f, std::max(aStdDev, 0.0f));
+    }
+
+    const FiringStats& FurnaceSimulator::GetStats() const
+    {
+        return myStats;
+    }
+
+    const ThermalModel& FurnaceSimulator::GetKiln() const
+    {
+        return myKiln;
+    }
+
+    Furnace::StateMachine& FurnaceSimulator::GetStateMachine()
+    {
+        return myStateMachine;
+    }
+
+    Safety::SafetyMonitor& FurnaceSimulator::GetSafetyMonitor()
+    {
+        return myMonitor;
+    }
+
+    const Sensor::SensorPublisher& FurnaceSimulator::GetPublisher() const
+    {
+        return myPublisher;
+    }
+
+    Sensor::ReplayThermocouple& FurnaceSimulator::GetThermocouples()
+    {
+        return myThermocouples;
+    }
+
+    Time::VirtualClock& FurnaceSimulator::GetClock()
+    {
+        return myClock;
+    }
+
+    void FurnaceSimulator::PrivSensor()
+    {
+        myThermocouples.Poll();
+        myPublisher.Poll();
+    }
+
+    void FurnaceSimulator::PrivSsr()
+    {
+        PrivAdvance(myClock.Now());
+        myHeaterOn = mySsr.Update(SSR_PERIOD);
+        myStats.relaySwitches = mySsr.SwitchCount() - myFireSwitches;
+    }
+
+    void FurnaceSimulator::PrivControl()
+    {
+        myMonitor.Heartbeat();
+
+        const Sensor::SensorReadings readings = myPublisher.Latest();
+        Furnace::StateSnapshot snapshot;
+        snapshot.envTemp = readings.envTemperature;
+        snapshot.caseTemp = readings.caseTemperature;
+        snapshot.currTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(myClock.Now()).count();
+
+        float heat = 0.0f;
+        if (readings.sequence != 0 && readings.IsKilnValid())
+        {
+            myStateMachine.GetThermalEstimator().Update(readings.kilnTemperature, myHeatPercent, myControlPeriod);
+            const Control::TemperatureEstimate& estimate = myStateMachine.GetTemperatureFilter().Update(readings.kilnTemperature, myControlPeriod);
+            snapshot.kilnTemp = estimate.temperature;
+            snapshot.tempChange = estimate.RatePerHour();
+
+            switch (myStateMachine.GetState())
+            {
+            case Furnace::StateId::RUNNING:
+            case Furnace::StateId::PAUSED:
+                heat = PrivRunProgram(estimate.temperature, snapshot);
+                break;
+            case Furnace::StateId::AUTOTUNING:
+                // The safety monitor's thermal runaway check follows setTemp while autotuning too
+                snapshot.setTemp = myStateMachine.GetAutotuner().Setpoint();
+                heat = myStateMachine.UpdateAutotune(readings.kilnTemperature, myControlPeriod);
+                break;
+            default:
+                break;
+            }
+        }
+        else
+        {
+            myStateMachine.GetTemperatureFilter().Reset();
+        }
+
+        myHeatPercent = heat;
+        mySsr.SetDuty(heat);
+        snapshot.heatPercent = static_cast<uint8_t>(std::lround(heat));
+        myStateMachine.PublishState(snapshot);
+    }
+
+    void FurnaceSimulator::PrivSafety()
+    {
+        myMonitor.Poll();
+    }
+
+    float FurnaceSimulator::PrivRunProgram(float aTemperature, Furnace::StateSnapshot& aSnapshot)
+    {
+        if (myStateMachine.CompleteIfFinished())
+        {
+            myStats.finished = myClock.Now();
+            return 0.0f;
+        }
+
+        const Program::ProfileTimeline& timeline = *myStateMachine.GetTimeline();
+
+        // Paused, the program's clock has stopped and the setpoint holds where it was
+        const bool running = myStateMachine.GetState() == Furnace::StateId::RUNNING;
+        const Program::SetpointSample setpoint = myStateMachine.GetSetpoint();
+        const Program::SetpointSample ahead = running ? myStateMachine.GetSetpoint(FEEDFORWARD_LEAD) : Program::SetpointSample{setpoint.setpoint, 0.0f};
+        const float feedforward = myStateMachine.GetThermalEstimator().FeedforwardPercent(ahead.setpoint, ahead.slope);
+
+        const int64_t startMs = std::chrono::duration_cast<std::chrono::milliseconds>(myStateMachine.GetProgramStart()).count();
+        aSnapshot.setTemp = setpoint.setpoint;
+        const size_t segment = myStateMachine.GetSegment();
+        aSnapshot.segment = static_cast<int32_t>(segment);
+        aSnapshot.progStartMs = startMs;
+        aSnapshot.progEndMs = startMs + timeline.TotalDuration().count();
+
+        if (running)
+        {
+            const float error = aTemperature - setpoint.setpoint;
+            myStats.maxTrackingError = std::max(myStats.maxTrackingError, std::abs(error));
+            myStats.maxOvershoot = std::max(myStats.maxOvershoot, error);
+            myTrackingErrorSum += std::abs(error);
+            ++myTrackingSamples;
+            myStats.meanTrackingError = static_cast<float>(myTrackingErrorSum / myTrackingSamples);
+
+            if (segment < myStats.segments.size())
+            {
+                SegmentStats& stats = myStats.segments[segment];
+                stats.maxTrackingError = std::max(stats.maxTrackingError, std::abs(error));
+                stats.maxOvershoot = std::max(stats.maxOvershoot, error);
+                mySegmentErrorSums[segment] += std::abs(error);
+                ++mySegmentSamples[segment];
+                stats.meanTrackingError = static_cast<float>(mySegmentErrorSums[segment] / mySegmentSamples[segment]);
+            }
+        }
+
+        return myStateMachine.GetPid().Update(setpoint.setpoint, aTemperature, feedforward);
+    }
+
+    void FurnaceSimulator::PrivAdvance(std::chrono::microseconds aNow)
+    {
+        if (aNow <= myKilnTime)
+        {
+            return;
+        }
+        myKiln.Step(myHeaterOn && !myHeater.myForcedOff ? 100.0f : 0.0f, aNow - myKilnTime);
+        myKilnTime = aNow;
+        myStats.maxKilnTemperature = std::max(myStats.maxKilnTemperature, myKiln.KilnTemperature());
+        myStats.maxCaseTemperature = std::max(myStats.maxCaseTemperature, myKiln.CaseTemperature());
+        myStats.energyKWh = myKiln.EnergyKWh() - myFireEnergyKWh;
+    }
+
+    float FurnaceSimulator::PrivRead(size_t aChannel, std::chrono::microseconds aNow)
+    {
+        PrivAdvance(aNow);
+        const float temperature = aChannel == CASE_CHANNEL ? myKiln.CaseTemperature() : myKiln.SensorTemperature();
+        return myNoisy ? temperature + myNoise(myNoiseSource) : temperature;
+    }
+} //namespace HeatTreatFurnace::Sim
@@ -0,0 +1,160 @@
+#ifndef HEAT_TREAT_FURNACE_FURNACE_SIMULATOR_HPP
+#define HEAT_TREAT_FURNACE_FURNACE_SIMULATOR_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "ThermalModel.hpp"
+#include "Control/LoopScheduler.hpp"
+#include "Control/SsrScheduler.hpp"
+#include "Furnace/Furnace.hpp"
+#include "Furnace/Preferences.hpp"
+#include "Furnace/Profile.hpp"
+#include "Furnace/Result.hpp"
+#include "Furnace/StateMachine.hpp"
+#include "Log/LogService.hpp"
+#include "Safety/SafetyMonitor.hpp"
+#include "Sensor/ReplayThermocouple.hpp"
+#include "Sensor/SensorPublisher.hpp"
+#include "Time/Clock.hpp"
+
+namespace HeatTreatFurnace::Sim
+{
+    /** @brief Tracking while RUNNING in one segment, ramp and dwell */
+    struct SegmentStats
+    {
+        float maxTrackingError = 0.0f; // °C
+        float meanTrackingError = 0.0f; // °C
+        float maxOvershoot = 0.0f; // °C
+    };
+
+    /** @brief How a simulated firing went */
+    struct FiringStats
+    {
+        float maxTrackingError = 0.0f; // worst |kilnTemp - setTemp| while RUNNING, °C
+        float meanTrackingError = 0.0f; // mean |kilnTemp - setTemp| over the control loop runs while RUNNING, °C
+        float maxOvershoot = 0.0f; // worst kilnTemp over setTemp while RUNNING, °C
+        float maxKilnTemperature = 0.0f; // of the kiln itself, not the lagging reading
+        float maxCaseTemperature = 0.0f;
+        float energyKWh = 0.0f; // into the elements since Fire()
+        uint32_t relaySwitches = 0; // SSR on/off changes since Fire()
+        std::chrono::microseconds finished{0}; // Clock time the program completed, 0 if it hasn't
+        std::vector<SegmentStats> segments; // one per segment of the program Fire() started
+    };
+
+    /**
+     * @brief The furnace's control, sensor and safety code against a ThermalModel, on a Time::VirtualClock.
+     *
+     * The stages run on a Control::LoopScheduler as they would on the controller: the thermocouples and
+     * SensorPublisher every 100 ms, the SSR every 100 ms, the safety monitor every SafetyConfig::period
+     * and the control loop every PID_Window. The control loop filters the reading, follows the loaded
+     * profile's setpoint with the state machine's PID and feedforward, holds it while PAUSED, completes
+     * the program at its end, runs the relay autotune while AUTOTUNING, and publishes the state the
+     * safety monitor checks, with the autotune setpoint as setTemp while it runs. A trip goes to
+     * StateMachine::OnSafetyTrip and holds the heater off, as on the controller.
+     *
+     * The kiln is only stepped when something reads it or the SSR switches, so simulated time costs
+     * the stage runs and nothing else; sleeps are instant. A 20 hour firing is well under a second.
+     * Timers set on GetClock() run at their time in the middle of a RunFor(), for scripting a firing.
+     */
+    class FurnaceSimulator
+    {
+    public:
+        static constexpr std::chrono::milliseconds SENSOR_PERIOD{100};
+        static constexpr std::chrono::milliseconds SSR_PERIOD{100};
+        static constexpr std::chrono::seconds FEEDFORWARD_LEAD{60}; // §3.7, about the element and thermocouple lags
+
+        FurnaceSimulator(const Furnace::Preferences& aPreferences, const ThermalParameters& aKiln, Log::LogService& aLog);
+
+        /** @brief LOAD_PROFILE and START_PROFILE from the beginning, at the kiln's current reading */
+        Furnace::Result Fire(std::unique_ptr<Furnace::Profile> aProfile);
+
+        void RunFor(std::chrono::microseconds aDuration);
+
+        /** @brief Run until the program completes or the furnace goes to ERROR, or for at most aLimit; returns the state */
+        Furnace::StateId RunUntilDone(std::chrono::microseconds aLimit);
+
+        /** @brief Add Gaussian noise of aStdDev °C to every thermocouple reading from now on, repeatable for a given aSeed; 0 turns it off */
+        void SetSensorNoise(float aStdDev, uint32_t aSeed);
+
+        [[nodiscard]] const FiringStats& GetStats() const;
+        [[nodiscard]] const ThermalModel& GetKiln() const;
+        [[nodiscard]] Furnace::StateMachine& GetStateMachine();
+        [[nodiscard]] Safety::SafetyMonitor& GetSafetyMonitor();
+        [[nodiscard]] const Sensor::SensorPublisher& GetPublisher() const;
+
+        /** @brief For InjectFault() */
+        [[nodiscard]] Sensor::ReplayThermocouple& GetThermocouples();
+
+        /** @brief For CallAt() */
+        [[nodiscard]] Time::VirtualClock& GetClock();
+
+    private:
+        /** @brief The SSRs as the safety monitor sees them */
+        class SimHeater : public Safety::HeaterSwitch
+        {
+        public:
+            void ForceOff() override
+            {
+                myForcedOff = true;
+            }
+
+            void Release() override
+            {
+                myForcedOff = false;
+            }
+
+            bool myForcedOff = false;
+        };
+
+        class SimWatchdog : public Safety::Watchdog
+        {
+        public:
+            void Feed() override
+            {
+            }
+        };
+
+        void PrivSensor();
+        void PrivSsr();
+        void PrivControl();
+        void PrivSafety();
+        [[nodiscard]] float PrivRunProgram(float aTemperature, Furnace::StateSnapshot& aSnapshot);
+
+        /** @brief Step the kiln to aNow with the heater as it has been since the last step */
+        void PrivAdvance(std::chrono::microseconds aNow);
+        [[nodiscard]] float PrivRead(size_t aChannel, std::chrono::microseconds aNow);
+
+        Time::VirtualClock myClock;
+        ThermalModel myKiln;
+        std::chrono::microseconds myKilnTime{0};
+        bool myHeaterOn = false;
+        Sensor::ReplayThermocouple myThermocouples;
+        Sensor::SensorPublisher myPublisher;
+        Furnace::FurnaceState myFurnaceState;
+        Furnace::StateMachine myStateMachine;
+        Control::SsrScheduler mySsr;
+        SimHeater myHeater;
+        SimWatchdog myWatchdog;
+        Safety::SafetyMonitor myMonitor;
+        Control::LoopScheduler myScheduler;
+
+        std::chrono::milliseconds myControlPeriod;
+        float myHeatPercent = 0.0f;
+        FiringStats myStats;
+        double myTrackingErrorSum = 0.0; // for meanTrackingError
+        uint32_t myTrackingSamples = 0;
+        float myFireEnergyKWh = 0.0f; // the kiln's and SSR's counts at Fire()
+        uint32_t myFireSwitches = 0;
+        std::vector<double> mySegmentErrorSums; // for each segment's meanTrackingError
+        std::vector<uint32_t> mySegmentSamples;
+        std::mt19937 myNoiseSource;
+        std::normal_distribution<float> myNoise{0.0f, 0.0f};
+        bool myNoisy = false;
+    };
+} //namespace HeatTreatFurnace::Sim
+
+#endif //HEAT_TREAT_FURNACE_FURNACE_SIMULATOR_HPP
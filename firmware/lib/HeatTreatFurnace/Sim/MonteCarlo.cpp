@@ -0,0 +1,255 @@
+#include "MonteCarlo.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "Furnace/Profile.hpp"
+#include "Log/LogBackend.hpp"
+#include "Log/LogService.hpp"
+#include "Program/ProgramValidator.hpp"
+
+namespace HeatTreatFurnace::Sim
+{
+    namespace
+    {
+        /** @brief What each worker keeps between runs; the log isn't shared so nothing needs a lock */
+        struct MonteCarloWorker
+        {
+            Log::NullLogBackend logBackend;
+            Log::LogService log{&logBackend};
+            std::optional<FurnaceSimulator> simulator;
+        };
+
+        std::string_view StateText(Furnace::StateId aState)
+        {
+            switch (aState)
+            {
+            case Furnace::StateId::COMPLETED:
+                return "completed";
+            case Furnace::StateId::ERROR:
+                return "error";
+            default:
+                return "overran";
+            }
+        }
+    }
+
+    Distribution Distribution::Fixed(float aValue)
+    {
+        return {DistributionKind::FIXED, aValue, 0.0f};
+    }
+
+    Distribution Distribution::Uniform(float aLow, float aHigh)
+    {
+        return {DistributionKind::UNIFORM, std::min(aLow, aHigh), std::max(aLow, aHigh)};
+    }
+
+    Distribution Distribution::Normal(float aMean, float aStdDev)
+    {
+        return {DistributionKind::NORMAL, aMean, std::max(aStdDev, 0.0f)};
+    }
+
+    float Distribution::Sample(std::mt19937& aRandom) const
+    {
+        switch (kind)
+        {
+        case DistributionKind::UNIFORM:
+            return std::uniform_real_distribution<float>(a, b)(aRandom);
+        case DistributionKind::NORMAL:
+            return b > 0.0f ? std::normal_distribution<float>(a, b)(aRandom) : a;
+        default:
+            return a;
+        }
+    }
+
+    void ErrorHistogram::Add(float anError)
+    {
+        const float error = std::max(anError, 0.0f);
+        const size_t bin = error < MAX_ERROR ? std::min(static_cast<size_t>(error / BIN_WIDTH), BINS - 1) : BINS;
+        ++myBins[bin];
+        ++myCount;
+        myMax = std::max(myMax, error);
+    }
+
+    float ErrorHistogram::Percentile(float aPercentile) const
+    {
+        if (myCount == 0)
+        {
+            return 0.0f;
+        }
+        const double share = std::clamp(aPercentile, 0.0f, 100.0f) / 100.0;
+        const size_t rank = std::max<size_t>(1, static_cast<size_t>(std::ceil(share * static_cast<double>(myCount))));
+        size_t seen = 0;
+        for (size_t bin = 0; bin < BINS; ++bin)
+        {
+            seen += myBins[bin];
+            if (seen >= rank)
+            {
+                return std::min(static_cast<float>(bin + 1) * BIN_WIDTH, myMax);
+            }
+        }
+        return myMax;
+    }
+
+    ErrorBand ErrorHistogram::Band() const
+    {
+        return {Percentile(5.0f), Percentile(50.0f), Percentile(95.0f), myMax};
+    }
+
+    size_t ErrorHistogram::Count() const
+    {
+        return myCount;
+    }
+
+    MonteCarloRunner::MonteCarloRunner(const Furnace::Preferences& aPreferences, const ThermalParameters& aKiln, const PlantVariation& aVariation, uint32_t aSeed) :
+        myPreferences(aPreferences),
+        myKiln(aKiln),
+        myVariation(aVariation),
+        mySeed(aSeed)
+    {
+    }
+
+    Furnace::Result MonteCarloRunner::Run(std::span<const uint8_t> aProgram, size_t aRuns, WorkStealingPool& aPool, const RunSink& aSink, MonteCarloReport& aReportOut) const
+    {
+        Furnace::Profile check;
+        Furnace::Result res = check.Map("monte-carlo", aProgram);
+        if (!res)
+        {
+            return res;
+        }
+        const Program::ValidationReport validation = Program::ProgramValidator(myPreferences).Validate(check);
+        if (!validation.IsValid())
+        {
+            res = {false, ""};
+            validation.Describe(res.message);
+            return res;
+        }
+        const size_t segments = check.SegmentCount();
+
+        aReportOut = {};
+        aReportOut.runs = aRuns;
+        aReportOut.segments.resize(segments);
+        std::vector<ErrorHistogram> meanErrors(segments);
+        std::vector<ErrorHistogram> maxErrors(segments);
+        std::mutex resultMutex;
+        std::vector<std::unique_ptr<MonteCarloWorker>> workers;
+        for (size_t i = 0; i < aPool.WorkerCount(); ++i)
+        {
+            workers.push_back(std::make_unique<MonteCarloWorker>());
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        aPool.Run(aRuns, [&](size_t aWorker, size_t aJob)
+        {
+            MonteCarloWorker& worker = *workers[aWorker];
+            MonteCarloRun run;
+            run.index = aJob;
+            run.plant = Sample(aJob);
+
+            FurnaceSimulator& simulator = worker.simulator.emplace(myPreferences, Plant(run.plant), worker.log);
+            simulator.SetSensorNoise(run.plant.sensorNoise, run.plant.noiseSeed);
+            simulator.RunFor(SETTLE_TIME);
+            auto profile = std::make_unique<Furnace::Profile>();
+            const std::chrono::microseconds fired = simulator.GetClock().Now();
+            // Checked above; Fire() only fails on a bad program or no reading
+            if (profile->Map("monte-carlo", aProgram) && simulator.Fire(std::move(profile)))
+            {
+                run.state = simulator.RunUntilDone(simulator.GetStateMachine().GetTimeline()->TotalDuration() + OVERRUN);
+                run.stats = simulator.GetStats();
+            }
+            else
+            {
+                run.state = simulator.GetStateMachine().GetState();
+                run.stats.segments.assign(segments, {});
+            }
+            const double hours = std::chrono::duration<double, std::ratio<3600>>(simulator.GetClock().Now() - fired).count();
+
+            const std::scoped_lock lock(resultMutex);
+            aReportOut.simulatedHours += hours;
+            if (run.state == Furnace::StateId::COMPLETED)
+            {
+                ++aReportOut.completed;
+                for (size_t segment = 0; segment < segments; ++segment)
+                {
+                    meanErrors[segment].Add(run.stats.segments[segment].meanTrackingError);
+                    maxErrors[segment].Add(run.stats.segments[segment].maxTrackingError);
+                }
+            }
+            else if (run.state == Furnace::StateId::ERROR)
+            {
+                ++aReportOut.errors;
+            }
+            if (aSink)
+            {
+                aSink(run);
+            }
+        });
+        aReportOut.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (size_t segment = 0; segment < segments; ++segment)
+        {
+            aReportOut.segments[segment] = {meanErrors[segment].Band(), maxErrors[segment].Band()};
+        }
+        return {true, ""};
+    }
+
+    PlantSample MonteCarloRunner::Sample(size_t aIndex) const
+    {
+        // A stream of its own for each parameter, so giving one a spread doesn't change what the others draw
+        const auto stream = [this, aIndex](uint32_t aParameter)
+        {
+            std::seed_seq seed{mySeed, static_cast<uint32_t>(aIndex), static_cast<uint32_t>(static_cast<uint64_t>(aIndex) >> 32), aParameter};
+            return std::mt19937(seed);
+        };
+        const auto draw = [&stream](uint32_t aParameter, const Distribution& aDistribution)
+        {
+            std::mt19937 random = stream(aParameter);
+            return aDistribution.Sample(random);
+        };
+
+        PlantSample sample;
+        sample.loadJPerC = std::max(draw(0, myVariation.loadJPerC), 0.0f);
+        sample.elementAging = std::clamp(draw(1, myVariation.elementAging), 0.0f, 0.9f);
+        sample.ambientTemperature = myKiln.ambientTemperature + draw(2, myVariation.ambientShift);
+        sample.sensorNoise = std::max(draw(3, myVariation.sensorNoise), 0.0f);
+        sample.noiseSeed = stream(4)();
+        return sample;
+    }
+
+    ThermalParameters MonteCarloRunner::Plant(const PlantSample& aSample) const
+    {
+        ThermalParameters plant = myKiln;
+        plant.thermalMassJPerC += aSample.loadJPerC;
+        plant.heaterPowerW *= 1.0f - aSample.elementAging;
+        plant.ambientTemperature = aSample.ambientTemperature;
+        return plant;
+    }
+
+    std::string MonteCarloRunner::CsvHeader(size_t aSegments)
+    {
+        std::string header = "run,load_j_per_c,element_aging,ambient_c,sensor_noise_c,state,energy_kwh,max_overshoot_c,mean_error_c,max_error_c";
+        for (size_t segment = 1; segment <= aSegments; ++segment)
+        {
+            header += std::format(",s{}_mean_error_c,s{}_max_error_c,s{}_overshoot_c", segment, segment, segment);
+        }
+        return header + "\n";
+    }
+
+    std::string MonteCarloRunner::CsvRow(const MonteCarloRun& aRun)
+    {
+        const PlantSample& plant = aRun.plant;
+        const FiringStats& stats = aRun.stats;
+        std::string row = std::format("{},{:.0f},{:.4f},{:.2f},{:.3f},{},{:.3f},{:.3f},{:.3f},{:.3f}",
+            aRun.index, plant.loadJPerC, plant.elementAging, plant.ambientTemperature, plant.sensorNoise, StateText(aRun.state),
+            stats.energyKWh, std::max(stats.maxOvershoot, 0.0f), stats.meanTrackingError, stats.maxTrackingError);
+        for (const SegmentStats& segment : stats.segments)
+        {
+            row += std::format(",{:.3f},{:.3f},{:.3f}", segment.meanTrackingError, segment.maxTrackingError, std::max(segment.maxOvershoot, 0.0f));
+        }
+        return row + "\n";
+    }
+} //namespace HeatTreatFurnace::Sim
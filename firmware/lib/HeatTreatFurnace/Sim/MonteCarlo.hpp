@@ -0,0 +1,167 @@
+#ifndef HEAT_TREAT_FURNACE_MONTE_CARLO_HPP
+#define HEAT_TREAT_FURNACE_MONTE_CARLO_HPP
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "FurnaceSimulator.hpp"
+#include "ThermalModel.hpp"
+#include "WorkStealingPool.hpp"
+#include "Furnace/Preferences.hpp"
+#include "Furnace/Result.hpp"
+#include "Furnace/State.hpp"
+
+namespace HeatTreatFurnace::Sim
+{
+    enum class DistributionKind : uint8_t
+    {
+        FIXED,
+        UNIFORM,
+        NORMAL
+    };
+
+    /** @brief One plant parameter's spread from run to run */
+    struct Distribution
+    {
+        DistributionKind kind = DistributionKind::FIXED;
+        float a = 0.0f; // the value, the low end, or the mean
+        float b = 0.0f; // the high end, or the standard deviation
+
+        static Distribution Fixed(float aValue);
+        static Distribution Uniform(float aLow, float aHigh);
+        static Distribution Normal(float aMean, float aStdDev);
+
+        [[nodiscard]] float Sample(std::mt19937& aRandom) const;
+    };
+
+    /** @brief How the kiln differs from the nominal ThermalParameters from one run to the next */
+    struct PlantVariation
+    {
+        Distribution loadJPerC = Distribution::Fixed(0.0f); // ware and furniture, on top of the kiln's thermal mass
+        Distribution elementAging = Distribution::Fixed(0.0f); // share of rated power the elements have lost, 0.1 = 10 %
+        Distribution ambientShift = Distribution::Fixed(0.0f); // °C from the nominal ambient
+        Distribution sensorNoise = Distribution::Fixed(0.0f); // °C, standard deviation of each thermocouple reading
+    };
+
+    /** @brief The plant one run fired on */
+    struct PlantSample
+    {
+        float loadJPerC = 0.0f;
+        float elementAging = 0.0f;
+        float ambientTemperature = 0.0f; // °C
+        float sensorNoise = 0.0f; // °C
+        uint32_t noiseSeed = 0;
+    };
+
+    struct MonteCarloRun
+    {
+        size_t index = 0;
+        PlantSample plant;
+        FiringStats stats;
+        Furnace::StateId state = Furnace::StateId::IDLE; // where the firing ended up
+    };
+
+    /** @brief A spread of errors across runs, °C */
+    struct ErrorBand
+    {
+        float p5 = 0.0f;
+        float p50 = 0.0f;
+        float p95 = 0.0f;
+        float max = 0.0f;
+    };
+
+    struct SegmentBands
+    {
+        ErrorBand meanError; // of each run's mean |kilnTemp - setTemp| in the segment
+        ErrorBand maxError; // of each run's worst |kilnTemp - setTemp| in the segment
+    };
+
+    struct MonteCarloReport
+    {
+        size_t runs = 0;
+        size_t completed = 0;
+        size_t errors = 0; // ended in ERROR; the rest of the runs overran
+        std::vector<SegmentBands> segments; // over the runs that completed
+        double simulatedHours = 0.0; // from Fire() to the end of each run, summed
+        double wallSeconds = 0.0;
+    };
+
+    /**
+     * @brief Errors folded into fixed bins, for percentiles over any number of runs in constant memory.
+     *
+     * Bins are BIN_WIDTH wide up to MAX_ERROR, with one more for everything above. A percentile is the
+     * top of the bin it falls in, so it overstates the error by less than a bin and never understates it.
+     */
+    class ErrorHistogram
+    {
+    public:
+        static constexpr float BIN_WIDTH = 0.05f; // °C
+        static constexpr float MAX_ERROR = 100.0f; // °C
+        static constexpr size_t BINS = 2000;
+
+        void Add(float anError);
+
+        /** @brief aPercentile in [0, 100]; 0 if nothing was added */
+        [[nodiscard]] float Percentile(float aPercentile) const;
+
+        [[nodiscard]] ErrorBand Band() const;
+        [[nodiscard]] size_t Count() const;
+
+    private:
+        std::array<uint32_t, BINS + 1> myBins{};
+        size_t myCount = 0;
+        float myMax = 0.0f;
+    };
+
+    /**
+     * @brief Fires one program on many randomly varied kilns and reports how the tracking error spreads.
+     *
+     * Each run samples a plant from PlantVariation: extra load, aged elements, a different room and a
+     * noisy thermocouple. The controller keeps the nominal preferences throughout, as a real controller
+     * would after its kiln had drifted. Run n's plant depends only on the seed and n, so a run can be
+     * repeated on its own whatever the thread count.
+     *
+     * Runs are spread over a WorkStealingPool, one simulator per worker as in PidSweep. Each finished
+     * run goes to the sink and into per-segment histograms, then is dropped, so memory stays the same
+     * for a thousand runs or a million.
+     */
+    class MonteCarloRunner
+    {
+    public:
+        /** @brief Called for each run as it finishes, in finishing order, one at a time */
+        using RunSink = std::function<void(const MonteCarloRun& aRun)>;
+
+        MonteCarloRunner(const Furnace::Preferences& aPreferences, const ThermalParameters& aKiln, const PlantVariation& aVariation, uint32_t aSeed = 1);
+
+        /** @brief Fire the compiled aProgram aRuns times; fails, before anything runs, if the nominal preferences don't allow it */
+        Furnace::Result Run(std::span<const uint8_t> aProgram, size_t aRuns, WorkStealingPool& aPool, const RunSink& aSink, MonteCarloReport& aReportOut) const;
+
+        /** @brief The plant run aIndex fires on */
+        [[nodiscard]] PlantSample Sample(size_t aIndex) const;
+
+        /** @brief The nominal kiln changed to aSample */
+        [[nodiscard]] ThermalParameters Plant(const PlantSample& aSample) const;
+
+        /** @brief Column names for CsvRow(), for a program of aSegments segments */
+        [[nodiscard]] static std::string CsvHeader(size_t aSegments);
+
+        /** @brief One line, with its newline */
+        [[nodiscard]] static std::string CsvRow(const MonteCarloRun& aRun);
+
+        static constexpr std::chrono::seconds SETTLE_TIME{10}; // before Fire(), for the sample pipeline to publish
+        static constexpr std::chrono::hours OVERRUN{1}; // past the program's length before a run is given up on
+
+    private:
+        Furnace::Preferences myPreferences;
+        ThermalParameters myKiln;
+        PlantVariation myVariation;
+        uint32_t mySeed;
+    };
+} //namespace HeatTreatFurnace::Sim
+
+#endif //HEAT_TREAT_FURNACE_MONTE_CARLO_HPP
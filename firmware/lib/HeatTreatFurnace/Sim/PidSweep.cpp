@@ -0,0 +1,152 @@
+#include "PidSweep.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <optional>
+
+#include "Furnace/Profile.hpp"
+#include "Log/LogBackend.hpp"
+#include "Log/LogService.hpp"
+#include "Program/ProgramValidator.hpp"
+
+namespace HeatTreatFurnace::Sim
+{
+    namespace
+    {
+        /** @brief What each worker keeps between runs; the log isn't shared so nothing needs a lock */
+        struct SweepWorker
+        {
+            Log::NullLogBackend logBackend;
+            Log::LogService log{&logBackend};
+            std::optional<FurnaceSimulator> simulator;
+            double simulatedHours = 0.0;
+        };
+    }
+
+    double SweepReport::FiringHoursPerSecond() const
+    {
+        return wallSeconds > 0.0 ? simulatedHours / wallSeconds : 0.0;
+    }
+
+    PidSweep::PidSweep(const Furnace::Preferences& aBase, const ThermalParameters& aKiln, const SweepWeights& aWeights) :
+        myBase(aBase),
+        myKiln(aKiln),
+        myWeights(aWeights)
+    {
+    }
+
+    void PidSweep::Add(const SweepCandidate& aCandidate)
+    {
+        myCandidates.push_back(aCandidate);
+    }
+
+    void PidSweep::AddGrid(std::span<const float> aKp, std::span<const float> aKi, std::span<const float> aKd)
+    {
+        for (const float kp : aKp)
+        {
+            for (const float ki : aKi)
+            {
+                for (const float kd : aKd)
+                {
+                    Add({{kp, ki, kd}, {}});
+                }
+            }
+        }
+    }
+
+    size_t PidSweep::CandidateCount() const
+    {
+        return myCandidates.size();
+    }
+
+    Furnace::Result PidSweep::Run(std::span<const uint8_t> aProgram, WorkStealingPool& aPool, SweepReport& aReportOut) const
+    {
+        Furnace::Profile check;
+        Furnace::Result res = check.Map("sweep", aProgram);
+        if (!res)
+        {
+            return res;
+        }
+        const Program::ValidationReport validation = Program::ProgramValidator(myBase).Validate(check);
+        if (!validation.IsValid())
+        {
+            res = {false, ""};
+            validation.Describe(res.message);
+            return res;
+        }
+        for (const SweepCandidate& candidate : myCandidates)
+        {
+            Control::GainSchedule schedule;
+            res = schedule.Configure(candidate.schedule, candidate.gains);
+            if (!res)
+            {
+                return res;
+            }
+        }
+
+        aReportOut = {};
+        aReportOut.runs.resize(myCandidates.size());
+        std::vector<std::unique_ptr<SweepWorker>> workers;
+        for (size_t i = 0; i < aPool.WorkerCount(); ++i)
+        {
+            workers.push_back(std::make_unique<SweepWorker>());
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        aPool.Run(myCandidates.size(), [&](size_t aWorker, size_t aJob)
+        {
+            SweepWorker& worker = *workers[aWorker];
+            SweepRun& run = aReportOut.runs[aJob];
+            run.candidate = myCandidates[aJob];
+
+            FurnaceSimulator& simulator = worker.simulator.emplace(PrivPreferences(run.candidate), myKiln, worker.log);
+            simulator.RunFor(SETTLE_TIME);
+            auto profile = std::make_unique<Furnace::Profile>();
+            // Checked above; Fire() only fails on a bad program or no reading
+            if (!profile->Map("sweep", aProgram) || !simulator.Fire(std::move(profile)))
+            {
+                run.state = simulator.GetStateMachine().GetState();
+                run.score = std::numeric_limits<float>::infinity();
+                return;
+            }
+
+            const std::chrono::microseconds fired = simulator.GetClock().Now();
+            run.state = simulator.RunUntilDone(simulator.GetStateMachine().GetTimeline()->TotalDuration() + OVERRUN);
+            run.stats = simulator.GetStats();
+            run.score = Score(run.stats, run.state, myWeights);
+            worker.simulatedHours += std::chrono::duration<double, std::ratio<3600>>(simulator.GetClock().Now() - fired).count();
+        });
+        aReportOut.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        aReportOut.steals = aPool.StealCount();
+        for (const std::unique_ptr<SweepWorker>& worker : workers)
+        {
+            aReportOut.simulatedHours += worker->simulatedHours;
+        }
+
+        std::ranges::stable_sort(aReportOut.runs, {}, &SweepRun::score);
+        return {true, ""};
+    }
+
+    float PidSweep::Score(const FiringStats& aStats, Furnace::StateId aState, const SweepWeights& aWeights)
+    {
+        if (aState != Furnace::StateId::COMPLETED)
+        {
+            return std::numeric_limits<float>::infinity();
+        }
+        return aWeights.overshoot * std::max(aStats.maxOvershoot, 0.0f)
+            + aWeights.tracking * aStats.meanTrackingError
+            + aWeights.energy * aStats.energyKWh
+            + aWeights.switches * static_cast<float>(aStats.relaySwitches);
+    }
+
+    Furnace::Preferences PidSweep::PrivPreferences(const SweepCandidate& aCandidate) const
+    {
+        Furnace::Preferences preferences = myBase;
+        preferences.pidKp = aCandidate.gains.kp;
+        preferences.pidKi = aCandidate.gains.ki;
+        preferences.pidKd = aCandidate.gains.kd;
+        preferences.pidSchedule = aCandidate.schedule;
+        return preferences;
+    }
+} //namespace HeatTreatFurnace::Sim
@@ -0,0 +1,91 @@
+#ifndef HEAT_TREAT_FURNACE_PID_SWEEP_HPP
+#define HEAT_TREAT_FURNACE_PID_SWEEP_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "FurnaceSimulator.hpp"
+#include "ThermalModel.hpp"
+#include "WorkStealingPool.hpp"
+#include "Control/GainSchedule.hpp"
+#include "Furnace/State.hpp"
+#include "Furnace/Preferences.hpp"
+#include "Furnace/Result.hpp"
+
+namespace HeatTreatFurnace::Sim
+{
+    /** @brief One set of gains to fire with: PID_Kp/Ki/Kd, and a PID_Schedule if it isn't empty */
+    struct SweepCandidate
+    {
+        Control::PidGains gains;
+        Furnace::PidSchedule schedule;
+    };
+
+    /** @brief What a run's score charges for; lower scores rank higher */
+    struct SweepWeights
+    {
+        float overshoot = 1.0f; // per °C of the worst overshoot
+        float tracking = 2.0f; // per °C of mean tracking error
+        float energy = 0.05f; // per kWh
+        float switches = 0.0001f; // per SSR switch, for relay wear; a 1 s window switches about 2000 times an hour
+    };
+
+    struct SweepRun
+    {
+        SweepCandidate candidate;
+        FiringStats stats;
+        Furnace::StateId state = Furnace::StateId::IDLE; // where the firing ended up
+        float score = 0.0f; // infinity if the program didn't complete
+    };
+
+    struct SweepReport
+    {
+        std::vector<SweepRun> runs; // best first
+        double simulatedHours = 0.0; // from Fire() to the end of each run, summed
+        double wallSeconds = 0.0;
+        size_t steals = 0;
+
+        [[nodiscard]] double FiringHoursPerSecond() const;
+    };
+
+    /**
+     * @brief Fires one program with each of a set of candidate gains on FurnaceSimulator and ranks them.
+     *
+     * The kiln is a ThermalParameters, typically the model ThermalEstimator identified on the real kiln.
+     * The runs are spread over a WorkStealingPool. Each worker keeps one simulator, with its own log,
+     * and rebuilds it in place for each run, so workers share nothing but the program buffer, which
+     * every run maps read-only.
+     */
+    class PidSweep
+    {
+    public:
+        /** @brief aBase supplies every preference the candidates don't set */
+        PidSweep(const Furnace::Preferences& aBase, const ThermalParameters& aKiln, const SweepWeights& aWeights = {});
+
+        void Add(const SweepCandidate& aCandidate);
+
+        /** @brief Every combination of aKp, aKi and aKd, with no schedule */
+        void AddGrid(std::span<const float> aKp, std::span<const float> aKi, std::span<const float> aKd);
+
+        [[nodiscard]] size_t CandidateCount() const;
+
+        /** @brief Fire the compiled aProgram once per candidate; fails if a schedule is invalid or the base preferences don't allow the program */
+        Furnace::Result Run(std::span<const uint8_t> aProgram, WorkStealingPool& aPool, SweepReport& aReportOut) const;
+
+        [[nodiscard]] static float Score(const FiringStats& aStats, Furnace::StateId aState, const SweepWeights& aWeights);
+
+        static constexpr std::chrono::seconds SETTLE_TIME{10}; // before Fire(), for the sample pipeline to publish
+        static constexpr std::chrono::hours OVERRUN{1}; // past the program's length before a run is given up on
+
+    private:
+        [[nodiscard]] Furnace::Preferences PrivPreferences(const SweepCandidate& aCandidate) const;
+
+        Furnace::Preferences myBase;
+        ThermalParameters myKiln;
+        SweepWeights myWeights;
+        std::vector<SweepCandidate> myCandidates;
+    };
+} //namespace HeatTreatFurnace::Sim
+
+#endif //HEAT_TREAT_FURNACE_PID_SWEEP_HPP
@@ -0,0 +1,162 @@
+#ifndef HEAT_TREAT_FURNACE_THERMAL_MODEL_HPP
+#define HEAT_TREAT_FURNACE_THERMAL_MODEL_HPP
+
+#include <algorithm>
+#include <chrono>
+
+#include "Furnace/Preferences.hpp"
+
+namespace HeatTreatFurnace::Sim
+{
+    struct ThermalParameters
+    {
+        float heaterPowerW = 3000.0f;
+        float thermalMassJPerC = 40000.0f;
+        float lossWPerC = 1.5f;
+        float ambientTemperature = 20.0f;
+        float elementLagS = 40.0f; // time for the elements to heat up or cool down and pass on a power change
+        float sensorLagS = 20.0f; // thermocouple and its sheath
+        float caseHeatTransfer = 0.03f; // share of the kiln's rise over ambient the case settles at, §4.3
+        float caseBaseTemperature = 25.0f; // the case with the kiln cold, warmed by the controller
+        float caseThermalMassJPerC = 8000.0f; // steel shell; 0 = the case follows §4.3 with no lag
+        float caseLossWPerC = 20.0f; // case to the room
+        // Element power curve: elements lose power as their resistance rises with temperature,
+        // P = heaterPowerW × supplyVoltage² / (1 + elementResistanceCoefficient × (T - ambient)).
+        // 0 is §4's constant power; Kanthal A1 is about 4e-5, nichrome 1e-4.
+        float elementResistanceCoefficient = 0.0f; // 1/°C
+        float supplyVoltage = 1.0f; // of the rated voltage heaterPowerW is at
+
+        /** @brief Kiln_Heater_Power, Kiln_Thermal_Mass, Kiln_Loss_Coefficient, Kiln_Ambient_Temperature */
+        static ThermalParameters FromPreferences(const Furnace::Preferences& aPreferences)
+        {
+            ThermalParameters parameters;
+            parameters.heaterPowerW = aPreferences.heaterPowerW;
+            parameters.thermalMassJPerC = aPreferences.thermalMassJPerC;
+            parameters.lossWPerC = aPreferences.lossWPerC;
+            parameters.ambientTemperature = aPreferences.ambientTemperature;
+            return parameters;
+        }
+    };
+
+    /**
+     * @brief Host-side kiln for testing control code, SPECIFICATION.md §4 in physical units.
+     *
+     * The kiln itself is the first-order model of §4.1. The element and thermocouple lags on either
+     * side of it are what make a real kiln overshoot and what a relay autotune measures; without them
+     * any controller looks perfect.
+     *
+     * Heat flows from the elements into the kiln, from the kiln to the room (lossWPerC) and, as part
+     * of that, through the walls into the case, which loses it to the room in turn. The case settles
+     * where §4.3 puts it, but a thermal mass behind it means it keeps warming after the kiln peaks.
+     */
+    class ThermalModel
+    {
+    public:
+        explicit ThermalModel(const ThermalParameters& aParameters = {}) :
+            ThermalModel(aParameters, aParameters.ambientTemperature)
+        {
+        }
+
+        ThermalModel(const ThermalParameters& aParameters, float aStartTemperature) :
+            myParameters(aParameters), myKiln(aStartTemperature), mySensor(aStartTemperature),
+            myCase(PrivSettledCase(aStartTemperature))
+        {
+        }
+
+        /** @brief Advance by aDuration with the heater at aHeatPercent */
+        void Step(float aHeatPercent, std::chrono::duration<float> aDuration)
+        {
+            const float heat = std::clamp(aHeatPercent, 0.0f, 100.0f) / 100.0f;
+            const float rated = myParameters.heaterPowerW * myParameters.supplyVoltage * myParameters.supplyVoltage;
+            const float caseLagS = PrivCaseLagS();
+
+            // Explicit Euler is stable while the step is well under the shortest lag
+            float shortestLag = std::min(myParameters.elementLagS, myParameters.sensorLagS);
+            if (caseLagS > 0.0f)
+            {
+                shortestLag = std::min(shortestLag, caseLagS);
+            }
+            const float maxStep = std::max(0.01f, shortestLag / 10.0f);
+            float remaining = aDuration.count();
+            while (remaining > 0.0f)
+            {
+                const float dt = std::min(remaining, maxStep);
+                const float command = heat * rated / (1.0f + myParameters.elementResistanceCoefficient * (myKiln - myParameters.ambientTemperature));
+                myPowerW += (command - myPowerW) * PrivLagFraction(dt, myParameters.elementLagS);
+                const float loss = myParameters.lossWPerC * (myKiln - myParameters.ambientTemperature);
+                myKiln += (myPowerW - loss) * dt / myParameters.thermalMassJPerC;
+                mySensor += (myKiln - mySensor) * PrivLagFraction(dt, myParameters.sensorLagS);
+                // The walls into the case and the case into the room, as one lag towards where they balance
+                myCase += (PrivSettledCase(myKiln) - myCase) * PrivLagFraction(dt, caseLagS);
+                myEnergyJ += myPowerW * dt;
+                remaining -= dt;
+            }
+        }
+
+        /** @brief What the thermocouple reads, which lags the kiln */
+        [[nodiscard]] float SensorTemperature() const
+        {
+            return mySensor;
+        }
+
+        [[nodiscard]] float KilnTemperature() const
+        {
+            return myKiln;
+        }
+
+        /** @brief §4.3 once settled, lagging the kiln by the case's thermal mass until then */
+        [[nodiscard]] float CaseTemperature() const
+        {
+            return myCase;
+        }
+
+        /** @brief Power the elements are putting into the kiln right now */
+        [[nodiscard]] float HeaterPowerW() const
+        {
+            return myPowerW;
+        }
+
+        /** @brief Energy the elements have put into the kiln since construction */
+        [[nodiscard]] float EnergyKWh() const
+        {
+            return myEnergyJ / 3.6e6f;
+        }
+
+        [[nodiscard]] const ThermalParameters& GetParameters() const
+        {
+            return myParameters;
+        }
+
+    private:
+        static float PrivLagFraction(float aDt, float aLag)
+        {
+            return aLag <= 0.0f ? 1.0f : std::min(1.0f, aDt / aLag);
+        }
+
+        [[nodiscard]] float PrivSettledCase(float aKiln) const
+        {
+            return myParameters.caseBaseTemperature + (aKiln - myParameters.ambientTemperature) * myParameters.caseHeatTransfer;
+        }
+
+        /** @brief caseThermalMassJPerC over the kiln-to-case and case-to-room conductances, the first sized so the case settles at caseHeatTransfer */
+        [[nodiscard]] float PrivCaseLagS() const
+        {
+            const float share = std::clamp(myParameters.caseHeatTransfer, 0.0f, 0.99f);
+            const float conductance = myParameters.caseLossWPerC / (1.0f - share);
+            if (myParameters.caseThermalMassJPerC <= 0.0f || conductance <= 0.0f)
+            {
+                return 0.0f;
+            }
+            return myParameters.caseThermalMassJPerC / conductance;
+        }
+
+        ThermalParameters myParameters;
+        float myPowerW = 0.0f;
+        float myKiln;
+        float mySensor;
+        float myCase;
+        float myEnergyJ = 0.0f;
+    };
+} //namespace HeatTreatFurnace::Sim
+
+#endif //HEAT_TREAT_FURNACE_THERMAL_MODEL_HPP
@@ -0,0 +1,96 @@
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace HeatTreatFurnace::Sim
+{
+    WorkStealingPool::WorkStealingPool(size_t aWorkers)
+    {
+        if (aWorkers == 0)
+        {
+            aWorkers = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < aWorkers; ++i)
+        {
+            myQueues.push_back(std::make_unique<WorkerQueue>());
+        }
+    }
+
+    size_t WorkStealingPool::WorkerCount() const
+    {
+        return myQueues.size();
+    }
+
+    void WorkStealingPool::Run(size_t aCount, const Job& aJob)
+    {
+        mySteals = 0;
+        const size_t workers = myQueues.size();
+        for (size_t worker = 0; worker < workers; ++worker)
+        {
+            WorkerQueue& queue = *myQueues[worker];
+            const std::lock_guard lock(queue.mutex);
+            queue.jobs.clear();
+            for (size_t job = aCount * worker / workers; job < aCount * (worker + 1) / workers; ++job)
+            {
+                queue.jobs.push_back(job);
+            }
+        }
+
+        std::vector<std::jthread> threads;
+        for (size_t worker = 1; worker < workers; ++worker)
+        {
+            threads.emplace_back([this, worker, &aJob]
+            {
+                PrivWork(worker, aJob);
+            });
+        }
+        PrivWork(0, aJob);
+    }
+
+    size_t WorkStealingPool::StealCount() const
+    {
+        return mySteals;
+    }
+
+    void WorkStealingPool::PrivWork(size_t aWorker, const Job& aJob)
+    {
+        // Jobs never add jobs, so once nothing is left to steal the batch is done
+        size_t job = 0;
+        while (PrivPop(aWorker, job) || PrivSteal(aWorker, job))
+        {
+            aJob(aWorker, job);
+        }
+    }
+
+    bool WorkStealingPool::PrivPop(size_t aWorker, size_t& aJobOut)
+    {
+        WorkerQueue& queue = *myQueues[aWorker];
+        const std::lock_guard lock(queue.mutex);
+        if (queue.jobs.empty())
+        {
+            return false;
+        }
+        aJobOut = queue.jobs.back();
+        queue.jobs.pop_back();
+        return true;
+    }
+
+    bool WorkStealingPool::PrivSteal(size_t aWorker, size_t& aJobOut)
+    {
+        const size_t workers = myQueues.size();
+        for (size_t i = 1; i < workers; ++i)
+        {
+            WorkerQueue& victim = *myQueues[(aWorker + i) % workers];
+            const std::lock_guard lock(victim.mutex);
+            if (!victim.jobs.empty())
+            {
+                aJobOut = victim.jobs.front();
+                victim.jobs.pop_front();
+                ++mySteals;
+                return true;
+            }
+        }
+        return false;
+    }
+} //namespace HeatTreatFurnace::Sim
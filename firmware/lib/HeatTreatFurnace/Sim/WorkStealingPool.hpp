@@ -0,0 +1,57 @@
+#ifndef HEAT_TREAT_FURNACE_WORK_STEALING_POOL_HPP
+#define HEAT_TREAT_FURNACE_WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace HeatTreatFurnace::Sim
+{
+    /**
+     * @brief Runs a batch of independent jobs across host threads, for sweeps of simulated firings.
+     *
+     * Run() deals the jobs out in contiguous blocks, one queue per worker. A worker takes its own jobs
+     * from the back and, once it runs out, steals from the front of the others'. Simulated firings
+     * vary a lot in cost, a badly tuned one trips in minutes where a good one runs the whole program,
+     * so a static split would leave most of the cores idle waiting on the unlucky one.
+     *
+     * Host only: it starts std::threads.
+     */
+    class WorkStealingPool
+    {
+    public:
+        /** @brief aWorker is the index of the worker running the job, for per-worker state; jobs mustn't throw */
+        using Job = std::function<void(size_t aWorker, size_t aJob)>;
+
+        /** @brief aWorkers workers, or one per hardware thread if 0 */
+        explicit WorkStealingPool(size_t aWorkers = 0);
+
+        [[nodiscard]] size_t WorkerCount() const;
+
+        /** @brief Run jobs 0 to aCount - 1 and return once they've all finished; the calling thread is worker 0 */
+        void Run(size_t aCount, const Job& aJob);
+
+        /** @brief Jobs taken from another worker's queue during the last Run() */
+        [[nodiscard]] size_t StealCount() const;
+
+    private:
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<size_t> jobs;
+        };
+
+        void PrivWork(size_t aWorker, const Job& aJob);
+        [[nodiscard]] bool PrivPop(size_t aWorker, size_t& aJobOut);
+        [[nodiscard]] bool PrivSteal(size_t aWorker, size_t& aJobOut);
+
+        std::vector<std::unique_ptr<WorkerQueue>> myQueues;
+        std::atomic<size_t> mySteals{0};
+    };
+} //namespace HeatTreatFurnace::Sim
+
+#endif //HEAT_TREAT_FURNACE_WORK_STEALING_POOL_HPP
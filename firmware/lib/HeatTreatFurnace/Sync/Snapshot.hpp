@@ -0,0 +1,156 @@
+#ifndef HEAT_TREAT_FURNACE_SNAPSHOT_HPP
+#define HEAT_TREAT_FURNACE_SNAPSHOT_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace HeatTreatFurnace::Sync
+{
+    /**
+     * @brief Latest value of a struct, written by one task and read by any number, with no lock on either side.
+     *
+     * A seqlock over a ring of SLOTS copies. Publish() writes the slot after the current one and then
+     * points readers at it, so a reader copies a slot no one is writing unless the writer has lapped
+     * the whole ring during the copy; the slot's sequence number, odd while it is being written,
+     * catches that and the reader tries again. A writer preempted mid-write therefore never holds a
+     * reader up, which is what rules out a mutex on the control path: a high-priority reader waiting on
+     * a low-priority writer is priority inversion, and a plain seqlock reader spinning on it would
+     * never let the writer finish on a single core.
+     *
+     * The value is copied in and out as atomic 32-bit words, so T must be trivially copyable: plain
+     * numbers and fixed arrays, no etl::string or pointers into itself. Publish() must only ever be
+     * called from one task at a time.
+     */
+    template <typename T, size_t SLOTS = 4>
+        requires std::is_trivially_copyable_v<T> && (SLOTS >= 2)
+    class Snapshot
+    {
+    public:
+        explicit Snapshot(const T& anInitial = T{})
+        {
+            for (Slot& slot : mySlots)
+            {
+                PrivStoreWords(slot, anInitial);
+            }
+        }
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        /** @brief Replace the value; one writer only */
+        void Publish(const T& aValue)
+        {
+            const uint32_t version = myVersion.load(std::memory_order_relaxed) + 1;
+            Slot& slot = mySlots[version % SLOTS];
+            const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+            slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            PrivStoreWords(slot, aValue);
+            slot.version.store(version, std::memory_order_relaxed);
+            slot.sequence.store(sequence + 2, std::memory_order_release);
+            myVersion.store(version, std::memory_order_release);
+        }
+
+        /** @brief One attempt; false only if the writer lapped the ring while this copied */
+        bool TryRead(T& aValue) const
+        {
+            uint32_t version;
+            return TryRead(aValue, version);
+        }
+
+        /** @brief As TryRead(), also giving the Version() that published the value read */
+        bool TryRead(T& aValue, uint32_t& aVersionOut) const
+        {
+            const Slot& slot = mySlots[myVersion.load(std::memory_order_acquire) % SLOTS];
+            const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+            if ((before & 1) != 0)
+            {
+                return false;
+            }
+            std::array<uint32_t, WORDS> words;
+            for (size_t i = 0; i < WORDS; ++i)
+            {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            const uint32_t version = slot.version.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != before)
+            {
+                return false;
+            }
+            // Into bytes and bit_cast from those, rather than memcpy over a T whose default member initializers
+            // make it non-trivial to the compiler even though it's trivially copyable
+            std::array<std::byte, sizeof(T)> bytes;
+            std::memcpy(bytes.data(), words.data(), sizeof(T));
+            aValue = std::bit_cast<T>(bytes);
+            aVersionOut = version;
+            return true;
+        }
+
+        /** @brief The latest value, whole */
+        [[nodiscard]] T Read() const
+        {
+            T value;
+            while (!TryRead(value))
+            {
+            }
+            return value;
+        }
+
+        /**
+         * @brief The latest value, whole, and the Version() that published it.
+         *
+         * Taken from the same read, so a reader tracking versions can't pair a value with a later
+         * Publish() that happened between reading one and asking for the other.
+         */
+        [[nodiscard]] T Read(uint32_t& aVersionOut) const
+        {
+            T value;
+            while (!TryRead(value, aVersionOut))
+            {
+            }
+            return value;
+        }
+
+        /** @brief Publish() calls so far; a reader that saw this version before has nothing new to read */
+        [[nodiscard]] uint32_t Version() const
+        {
+            return myVersion.load(std::memory_order_acquire);
+        }
+
+    private:
+        static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+        static_assert(std::is_trivially_copyable_v<T>, "Snapshot copies T as raw words");
+        static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+        // A cache line each, so a reader of one slot doesn't share a line with the slot being written
+        struct alignas(64) Slot
+        {
+            std::atomic<uint32_t> sequence{0};
+            std::atomic<uint32_t> version{0}; // the Publish() that wrote the words
+            std::array<std::atomic<uint32_t>, WORDS> words;
+        };
+
+        static void PrivStoreWords(Slot& aSlot, const T& aValue)
+        {
+            std::array<uint32_t, WORDS> words{};
+            std::memcpy(words.data(), &aValue, sizeof(T));
+            for (size_t i = 0; i < WORDS; ++i)
+            {
+                aSlot.words[i].store(words[i], std::memory_order_relaxed);
+            }
+        }
+
+        std::array<Slot, SLOTS> mySlots;
+        alignas(64) std::atomic<uint32_t> myVersion{0};
+    };
+} //namespace HeatTreatFurnace::Sync
+
+#endif //HEAT_TREAT_FURNACE_SNAPSHOT_HPP
@@ -0,0 +1,158 @@
+#ifndef HEAT_TREAT_FURNACE_CLOCK_HPP
+#define HEAT_TREAT_FURNACE_CLOCK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include "etl/vector.h"
+
+namespace HeatTreatFurnace::Time
+{
+    /**
+     * @brief Monotonic time source for anything that runs on a schedule.
+     *
+     * Injected rather than read from std::chrono directly, so host tests can run control loops
+     * against a clock they move by hand.
+     */
+    class Clock
+    {
+    public:
+        virtual ~Clock() = default;
+
+        /** @brief Time since an arbitrary fixed epoch */
+        [[nodiscard]] virtual std::chrono::microseconds Now() const = 0;
+
+        /** @brief Block until Now() >= aTime; returns immediately if it already is */
+        virtual void SleepUntil(std::chrono::microseconds aTime) = 0;
+    };
+
+    /** @brief std::chrono::steady_clock, which is esp_timer on the ESP32 */
+    class SteadyClock : public Clock
+    {
+    public:
+        [[nodiscard]] std::chrono::microseconds Now() const override
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch());
+        }
+
+        void SleepUntil(std::chrono::microseconds aTime) override
+        {
+            std::this_thread::sleep_until(std::chrono::steady_clock::time_point(aTime));
+        }
+    };
+
+    /** @brief Clock for tests: only moves when told to, and sleeping jumps straight to the wake time */
+    class ManualClock : public Clock
+    {
+    public:
+        explicit ManualClock(std::chrono::microseconds aStart = std::chrono::microseconds(0)) :
+            myNow(aStart)
+        {
+        }
+
+        [[nodiscard]] std::chrono::microseconds Now() const override
+        {
+            return myNow;
+        }
+
+        void SleepUntil(std::chrono::microseconds aTime) override
+        {
+            myNow = std::max(myNow, aTime);
+        }
+
+        void Advance(std::chrono::microseconds aDuration)
+        {
+            myNow += aDuration;
+        }
+
+    private:
+        std::chrono::microseconds myNow;
+    };
+
+    /**
+     * @brief ManualClock with timers, for scenario tests: a sleep stops at each timer due on the way,
+     * and calls it at its own time.
+     *
+     * The events of a firing, the user pausing two hours in or a thermocouple failing, go in as timers,
+     * and the control loop's LoopScheduler sleeping through them still sees each happen on time. An
+     * hours-long scenario is then as fast as the stage runs in it.
+     */
+    class VirtualClock : public Clock
+    {
+    public:
+        static constexpr size_t MAX_TIMERS = 16;
+        using TimerFunction = std::function<void()>;
+
+        explicit VirtualClock(std::chrono::microseconds aStart = std::chrono::microseconds(0)) :
+            myNow(aStart)
+        {
+        }
+
+        [[nodiscard]] std::chrono::microseconds Now() const override
+        {
+            return myNow;
+        }
+
+        /** @brief Jump to aTime, running the timers due by then in time order, ties in the order they were set */
+        void SleepUntil(std::chrono::microseconds aTime) override
+        {
+            while (true)
+            {
+                auto next = myTimers.end();
+                for (auto timer = myTimers.begin(); timer != myTimers.end(); ++timer)
+                {
+                    if (timer->time <= aTime && (next == myTimers.end() || timer->time < next->time))
+                    {
+                        next = timer;
+                    }
+                }
+                if (next == myTimers.end())
+                {
+                    break;
+                }
+
+                // Off the list first: the timer may set more timers
+                const TimerFunction function = std::move(next->function);
+                myNow = std::max(myNow, next->time);
+                myTimers.erase(next);
+                function();
+            }
+            myNow = std::max(myNow, aTime);
+        }
+
+        void Advance(std::chrono::microseconds aDuration)
+        {
+            SleepUntil(myNow + aDuration);
+        }
+
+        /** @brief Call aFunction when the clock reaches aTime, or on the next sleep if it already has; false if MAX_TIMERS are set */
+        bool CallAt(std::chrono::microseconds aTime, TimerFunction aFunction)
+        {
+            if (myTimers.full())
+            {
+                return false;
+            }
+            myTimers.push_back({aTime, std::move(aFunction)});
+            return true;
+        }
+
+        [[nodiscard]] size_t PendingTimers() const
+        {
+            return myTimers.size();
+        }
+
+    private:
+        struct Timer
+        {
+            std::chrono::microseconds time;
+            TimerFunction function;
+        };
+
+        std::chrono::microseconds myNow;
+        etl::vector<Timer, MAX_TIMERS> myTimers;
+    };
+} //namespace HeatTreatFurnace::Time
+
+#endif //HEAT_TREAT_FURNACE_CLOCK_HPP
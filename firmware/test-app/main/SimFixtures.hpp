@@ -0,0 +1,47 @@
+#ifndef HEAT_TREAT_FURNACE_TEST_SIM_FIXTURES_HPP
+#define HEAT_TREAT_FURNACE_TEST_SIM_FIXTURES_HPP
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "Furnace/Preferences.hpp"
+#include "Furnace/Profile.hpp"
+#include "Program/ProgramJson.hpp"
+
+// Shared by the tests that fire programs on the simulated kiln: FurnaceSimulator, ProgramControl, MonteCarlo and PidSweep
+namespace HeatTreatFurnace::Test
+{
+    /** @brief Gains of the order the autotuner proposes for the default kiln, with feedforward doing most of the work */
+    inline Furnace::Preferences SimPreferences()
+    {
+        Furnace::Preferences preferences;
+        preferences.pidKp = 3.0f;
+        preferences.pidKi = 0.01f;
+        preferences.pidKd = 0.0f;
+        preferences.pidWindowMs = 1000;
+        preferences.thermalRunaway = 50.0f;
+        return preferences;
+    }
+
+    /** @brief aJson compiled, as the Monte Carlo runner and PID sweep take it */
+    inline std::vector<uint8_t> CompileProgram(std::string_view aJson)
+    {
+        std::vector<uint8_t> compiled;
+        REQUIRE(Program::ProgramJson::Import(aJson, compiled));
+        return compiled;
+    }
+
+    /** @brief aJson compiled and loaded as aName, for FurnaceSimulator::Fire() and StateMachine::LoadProfile() */
+    inline std::unique_ptr<Furnace::Profile> MakeProfile(std::string_view aName, std::string_view aJson)
+    {
+        auto profile = std::make_unique<Furnace::Profile>();
+        REQUIRE(profile->Load(aName, CompileProgram(aJson)));
+        return profile;
+    }
+} //namespace HeatTreatFurnace::Test
+
+#endif //HEAT_TREAT_FURNACE_TEST_SIM_FIXTURES_HPP
@@ -0,0 +1,213 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <filesystem>
+#include <memory>
+
+#include "Log/LogBackend.hpp"
+#include "Log/LogService.hpp"
+#include "Net/FurnaceService.hpp"
+#include "Program/ProfileSampler.hpp"
+#include "Program/ProgramStore.hpp"
+#include "Sim/FurnaceSimulator.hpp"
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Net;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        constexpr std::string_view CANDLE_JSON = R"({ "description": "Candle and bisque", "segments": [
+            { "target": 100, "ramp_time": { "hours": 1 }, "dwell_time": { "hours": 2 } },
+            { "target": 950, "ramp_time": { "hours": 6 }, "dwell_time": { "minutes": 10 } }
+        ] })";
+
+        class FurnaceServiceFixture
+        {
+        public:
+            FurnaceServiceFixture() :
+                myDirectory(std::filesystem::temp_directory_path() / "furnace_service"),
+                myLog(&myNullLogBackend),
+                mySimulator(Furnace::Preferences(), Sim::ThermalParameters(), myLog)
+            {
+                std::filesystem::remove_all(myDirectory);
+                std::filesystem::create_directories(myDirectory);
+                myPrograms = std::make_unique<Program::ProgramStore>(myDirectory.string(), myLog);
+                myService = std::make_unique<FurnaceService>(mySimulator.GetStateMachine(), *myPrograms, mySimulator.GetPublisher(),
+                                                             mySimulator.GetSafetyMonitor(), myLog);
+            }
+
+            ~FurnaceServiceFixture()
+            {
+                std::filesystem::remove_all(myDirectory);
+            }
+
+            // Handle aMessage as request aRequestId, and the reply
+            template <typename T>
+            const ::Furnace::ServerEnvelope& Send(uint32_t aRequestId, ::Furnace::ClientMessage aType, flatbuffers::Offset<T> aMessage)
+            {
+                myRequest.Finish(::Furnace::CreateClientEnvelope(myRequest, aRequestId, aType, aMessage.Union()));
+                myService->Handle({myRequest.GetBufferPointer(), myRequest.GetSize()}, myReply);
+                myRequest.Clear();
+                return *::Furnace::GetServerEnvelope(myReply.GetBufferPointer());
+            }
+
+            bool Acked(const ::Furnace::ServerEnvelope& aReply, uint32_t aRequestId)
+            {
+                REQUIRE(aReply.request_id() == aRequestId);
+                REQUIRE(aReply.message_type() == ::Furnace::ServerMessage::Ack);
+                REQUIRE(aReply.message_as_Ack()->request_id() == aRequestId);
+                return aReply.message_as_Ack()->success();
+            }
+
+            const ::Furnace::State& State()
+            {
+                myService->EncodeState(myReply);
+                const ::Furnace::ServerEnvelope* envelope = ::Furnace::GetServerEnvelope(myReply.GetBufferPointer());
+                REQUIRE(envelope->request_id() == 0);
+                REQUIRE(envelope->message_type() == ::Furnace::ServerMessage::State);
+                return *envelope->message_as_State();
+            }
+
+            std::filesystem::path myDirectory;
+            Log::NullLogBackend myNullLogBackend;
+            Log::LogService myLog;
+            Sim::FurnaceSimulator mySimulator;
+            std::unique_ptr<Program::ProgramStore> myPrograms;
+            std::unique_ptr<FurnaceService> myService;
+            flatbuffers::FlatBufferBuilder myRequest;
+            flatbuffers::FlatBufferBuilder myReply;
+        };
+    }
+
+    TEST_CASE_METHOD(FurnaceServiceFixture, "FurnaceService: commands drive the state machine, each acked with its request_id")
+    {
+        mySimulator.RunFor(10s);
+        auto& b = myRequest;
+        REQUIRE(Acked(Send(1, ::Furnace::ClientMessage::SaveProgramRequest,
+            ::Furnace::CreateSaveProgramRequest(b, b.CreateString("candle.json"), b.CreateString(CANDLE_JSON.data(), CANDLE_JSON.size()))), 1));
+        REQUIRE(Acked(Send(2, ::Furnace::ClientMessage::LoadCommand, ::Furnace::CreateLoadCommand(b, b.CreateString("candle.json"))), 2));
+        REQUIRE(mySimulator.GetStateMachine().GetState() == Furnace::StateId::LOADED);
+
+        // Loading again replaces the program
+        REQUIRE(Acked(Send(3, ::Furnace::ClientMessage::LoadCommand, ::Furnace::CreateLoadCommand(b, b.CreateString("candle.json"))), 3));
+        REQUIRE_FALSE(Acked(Send(4, ::Furnace::ClientMessage::LoadCommand, ::Furnace::CreateLoadCommand(b, b.CreateString("none.json"))), 4));
+        REQUIRE_FALSE(Acked(Send(5, ::Furnace::ClientMessage::ResumeCommand, ::Furnace::CreateResumeCommand(b)), 5));
+
+        REQUIRE(Acked(Send(6, ::Furnace::ClientMessage::StartCommand, ::Furnace::CreateStartCommand(b)), 6));
+        mySimulator.RunFor(10min);
+        REQUIRE(mySimulator.GetStateMachine().GetState() == Furnace::StateId::RUNNING);
+        REQUIRE(Acked(Send(7, ::Furnace::ClientMessage::PauseCommand, ::Furnace::CreatePauseCommand(b)), 7));
+        REQUIRE(Acked(Send(8, ::Furnace::ClientMessage::ResumeCommand, ::Furnace::CreateResumeCommand(b)), 8));
+        REQUIRE(Acked(Send(9, ::Furnace::ClientMessage::StopCommand, ::Furnace::CreateStopCommand(b)), 9));
+        REQUIRE(mySimulator.GetStateMachine().GetState() == Furnace::StateId::CANCELLED);
+        REQUIRE_FALSE(Acked(Send(10, ::Furnace::ClientMessage::StopCommand, ::Furnace::CreateStopCommand(b)), 10));
+
+        // A stopped program starts again without loading it again
+        REQUIRE(Acked(Send(11, ::Furnace::ClientMessage::StartCommand, ::Furnace::CreateStartCommand(b, 1)), 11));
+        REQUIRE(mySimulator.GetStateMachine().GetState() == Furnace::StateId::RUNNING);
+
+        const ::Furnace::ServerEnvelope& setTemp = Send(12, ::Furnace::ClientMessage::SetTempCommand, ::Furnace::CreateSetTempCommand(b, 500.0f));
+        REQUIRE_FALSE(Acked(setTemp, 12));
+        REQUIRE(setTemp.message_as_Ack()->error() != nullptr);
+        REQUIRE_FALSE(Acked(Send(13, ::Furnace::ClientMessage::SetTimeScaleCommand, ::Furnace::CreateSetTimeScaleCommand(b, 10.0f)), 13));
+    }
+
+    TEST_CASE_METHOD(FurnaceServiceFixture, "FurnaceService: requests get their response, or an Error with its code")
+    {
+        auto& b = myRequest;
+        REQUIRE(myPrograms->Save("candle.json", CANDLE_JSON));
+
+        const ::Furnace::ServerEnvelope& list = Send(1, ::Furnace::ClientMessage::ListProgramsRequest, ::Furnace::CreateListProgramsRequest(b));
+        REQUIRE(list.request_id() == 1);
+        const auto* programs = list.message_as_ProgramListResponse()->programs();
+        REQUIRE(programs->size() == 1);
+        REQUIRE(programs->Get(0)->name()->str() == "candle.json");
+        REQUIRE(programs->Get(0)->description()->str() == "Candle and bisque");
+        REQUIRE(programs->Get(0)->size() > 0);
+
+        const ::Furnace::ServerEnvelope& content = Send(2, ::Furnace::ClientMessage::GetProgramRequest, ::Furnace::CreateGetProgramRequest(b, b.CreateString("candle.json")));
+        REQUIRE(content.message_as_ProgramContentResponse()->content()->str().find("\"target\": 950") != std::string::npos);
+
+        const ::Furnace::ServerEnvelope& preview = Send(3, ::Furnace::ClientMessage::GetProgramPreviewRequest,
+            ::Furnace::CreateGetProgramPreviewRequest(b, b.CreateString("candle.json")));
+        REQUIRE(preview.message_as_ProgramPreviewResponse()->points()->size() == 5 * Program::ProfileSampler::FLOATS_PER_POINT);
+
+        const ::Furnace::ServerEnvelope& missing = Send(4, ::Furnace::ClientMessage::GetProgramRequest, ::Furnace::CreateGetProgramRequest(b, b.CreateString("none.json")));
+        REQUIRE(missing.request_id() == 4);
+        REQUIRE(missing.message_as_Error()->code() == FurnaceService::ERROR_NOT_FOUND);
+        REQUIRE(Send(5, ::Furnace::ClientMessage::GetLogRequest, ::Furnace::CreateGetLogRequest(b, b.CreateString("a.csv"))).message_as_Error()->code() ==
+            FurnaceService::ERROR_NOT_FOUND);
+
+        REQUIRE(Acked(Send(6, ::Furnace::ClientMessage::DeleteProgramRequest, ::Furnace::CreateDeleteProgramRequest(b, b.CreateString("candle.json"))), 6));
+        REQUIRE(Send(7, ::Furnace::ClientMessage::ListProgramsRequest, ::Furnace::CreateListProgramsRequest(b)).message_as_ProgramListResponse()->programs()->size() == 0);
+
+        const std::string preferences = Send(8, ::Furnace::ClientMessage::GetPreferencesRequest, ::Furnace::CreateGetPreferencesRequest(b))
+            .message_as_PreferencesResponse()->json()->str();
+        REQUIRE(preferences.find("\"PID_Kp\":20,") != std::string::npos);
+        REQUIRE(preferences.find("\"Thermocouple_Type\":\"K\"") != std::string::npos);
+        REQUIRE(preferences.back() == '}');
+
+        const std::string debugInfo = Send(9, ::Furnace::ClientMessage::GetDebugInfoRequest, ::Furnace::CreateGetDebugInfoRequest(b))
+            .message_as_DebugInfoResponse()->json()->str();
+        REQUIRE(debugInfo.find("\"PROGRAM_CACHE_ENTRIES\":\"") != std::string::npos);
+
+        // Not a ClientEnvelope
+        const std::array<uint8_t, 3> junk{1, 2, 3};
+        myService->Handle(junk, myReply);
+        const ::Furnace::ServerEnvelope* malformed = ::Furnace::GetServerEnvelope(myReply.GetBufferPointer());
+        REQUIRE(malformed->request_id() == 0);
+        REQUIRE(malformed->message_as_Error()->code() == FurnaceService::ERROR_BAD_REQUEST);
+
+        // A message type with no message passes the verifier
+        REQUIRE(Send(10, ::Furnace::ClientMessage::StartCommand, flatbuffers::Offset<::Furnace::StartCommand>()).message_as_Error()->code() ==
+            FurnaceService::ERROR_BAD_REQUEST);
+        REQUIRE(Send(11, ::Furnace::ClientMessage::LoadCommand, flatbuffers::Offset<::Furnace::LoadCommand>()).message_as_Error()->code() ==
+            FurnaceService::ERROR_BAD_REQUEST);
+        REQUIRE(Send(12, ::Furnace::ClientMessage::SaveProgramRequest, flatbuffers::Offset<::Furnace::SaveProgramRequest>()).message_as_Error()->code() ==
+            FurnaceService::ERROR_BAD_REQUEST);
+        REQUIRE(Send(13, ::Furnace::ClientMessage::GetProgramPreviewRequest, flatbuffers::Offset<::Furnace::GetProgramPreviewRequest>())
+            .message_as_Error()->code() == FurnaceService::ERROR_BAD_REQUEST);
+        REQUIRE(mySimulator.GetStateMachine().GetState() == Furnace::StateId::IDLE);
+    }
+
+    TEST_CASE_METHOD(FurnaceServiceFixture, "FurnaceService: State in Unix time, with the step and the simulator's time scale")
+    {
+        constexpr std::chrono::milliseconds EPOCH{1'700'000'000'000};
+        myService->SetEpoch(EPOCH);
+        REQUIRE(State().program_status() == ::Furnace::ProgramStatus::None);
+        REQUIRE(State().prog_start_ms() == 0);
+        REQUIRE_FALSE(State().is_simulator());
+
+        float requested = 0.0f;
+        auto timeScale = [&requested](float aTimeScale)
+        {
+            requested = aTimeScale;
+            return Furnace::Result{aTimeScale <= 100.0f, "Time scale is 1 to 100"};
+        };
+        myService->SetTimeScaleHandler(FurnaceService::TimeScaleHandler(timeScale));
+
+        auto& b = myRequest;
+        REQUIRE_FALSE(Acked(Send(1, ::Furnace::ClientMessage::SetTimeScaleCommand, ::Furnace::CreateSetTimeScaleCommand(b, 500.0f)), 1));
+        REQUIRE(Acked(Send(2, ::Furnace::ClientMessage::SetTimeScaleCommand, ::Furnace::CreateSetTimeScaleCommand(b, 50.0f)), 2));
+        REQUIRE(requested == 50.0f);
+
+        mySimulator.RunFor(10s);
+        REQUIRE(myPrograms->Save("candle.json", CANDLE_JSON));
+        REQUIRE(Acked(Send(3, ::Furnace::ClientMessage::LoadCommand, ::Furnace::CreateLoadCommand(b, b.CreateString("candle.json"))), 3));
+        REQUIRE(State().program_status() == ::Furnace::ProgramStatus::Ready);
+        REQUIRE(Acked(Send(4, ::Furnace::ClientMessage::StartCommand, ::Furnace::CreateStartCommand(b)), 4));
+        mySimulator.RunFor(4h);
+
+        const ::Furnace::State& state = State();
+        REQUIRE(state.program_status() == ::Furnace::ProgramStatus::Running);
+        REQUIRE(state.program_name()->str() == "candle.json");
+        REQUIRE(state.step()->str() == "2 of 2");
+        REQUIRE(state.prog_start_ms() >= EPOCH.count() + 10'000);
+        REQUIRE(state.curr_time_ms() >= EPOCH.count() + 4 * 3'600'000);
+        REQUIRE(state.error_message() == nullptr);
+        REQUIRE(state.is_simulator());
+        REQUIRE(state.time_scale() == 50.0f);
+    }
+} //namespace HeatTreatFurnace::Test
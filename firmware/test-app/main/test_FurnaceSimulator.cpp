@@ -0,0 +1,185 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Log/LogBackend.hpp"
+#include "Log/LogService.hpp"
+#include "Sim/FurnaceSimulator.hpp"
+#include "Sim/ThermalModel.hpp"
+#include "SimFixtures.hpp"
+#include <cmath>
+#include <string_view>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Sim;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        // 20 hours: up to a bisque, on to a glaze, then a controlled cool and a hold
+        constexpr std::string_view LONG_FIRING = R"({ "segments": [
+            { "target": 600, "ramp_time": { "hours": 4 }, "dwell_time": { "hours": 2 } },
+            { "target": 1050, "ramp_time": { "hours": 5 }, "dwell_time": { "hours": 1 } },
+            { "target": 700, "ramp_time": { "hours": 5 }, "dwell_time": { "hours": 3 } }
+        ] })";
+
+        // The default kiln with Kanthal elements, which give 4% less power at 1050 °C
+        ThermalParameters SimKiln()
+        {
+            ThermalParameters kiln;
+            kiln.elementResistanceCoefficient = 4e-5f;
+            return kiln;
+        }
+    }
+
+    TEST_CASE("ThermalModel: the case lags the kiln and settles where §4.3 puts it")
+    {
+        ThermalParameters parameters;
+        ThermalModel kiln(parameters);
+        REQUIRE(kiln.CaseTemperature() == parameters.caseBaseTemperature);
+
+        kiln.Step(100.0f, 3600s);
+        const float settled = parameters.caseBaseTemperature + (kiln.KilnTemperature() - parameters.ambientTemperature) * parameters.caseHeatTransfer;
+        REQUIRE(kiln.CaseTemperature() < settled);
+        REQUIRE(kiln.CaseTemperature() > settled - 10.0f);
+
+        // Heater off: the case peaks after the kiln does
+        std::chrono::seconds kilnPeak{0};
+        std::chrono::seconds casePeak{0};
+        float kilnMax = kiln.KilnTemperature();
+        float caseMax = kiln.CaseTemperature();
+        for (std::chrono::seconds t{10}; t <= 2h; t += 10s)
+        {
+            kiln.Step(0.0f, 10s);
+            if (kiln.KilnTemperature() > kilnMax)
+            {
+                kilnMax = kiln.KilnTemperature();
+                kilnPeak = t;
+            }
+            if (kiln.CaseTemperature() > caseMax)
+            {
+                caseMax = kiln.CaseTemperature();
+                casePeak = t;
+            }
+        }
+        REQUIRE(casePeak > kilnPeak + 2min);
+
+        SECTION("No case mass: §4.3 exactly")
+        {
+            parameters.caseThermalMassJPerC = 0.0f;
+            ThermalModel massless(parameters, 800.0f);
+            massless.Step(50.0f, 10s);
+            REQUIRE(std::abs(massless.CaseTemperature() - (parameters.caseBaseTemperature + (massless.KilnTemperature() - parameters.ambientTemperature) * parameters.caseHeatTransfer)) < 0.001f);
+        }
+    }
+
+    TEST_CASE("ThermalModel: element power falls with temperature and supply voltage")
+    {
+        ThermalParameters parameters;
+        parameters.elementResistanceCoefficient = 4e-5f;
+        ThermalModel cold(parameters);
+        ThermalModel hot(parameters, 1020.0f);
+        cold.Step(100.0f, 600s);
+        hot.Step(100.0f, 600s);
+        REQUIRE(hot.HeaterPowerW() < cold.HeaterPowerW() * 0.97f);
+        REQUIRE(std::abs(cold.HeaterPowerW() / parameters.heaterPowerW - 1.0f) < 0.01f);
+
+        parameters.elementResistanceCoefficient = 0.0f;
+        parameters.supplyVoltage = 0.9f;
+        ThermalModel brownout(parameters);
+        brownout.Step(100.0f, 600s);
+        REQUIRE(std::abs(brownout.HeaterPowerW() / parameters.heaterPowerW - 0.81f) < 0.01f);
+        REQUIRE(brownout.EnergyKWh() > 0.0f);
+        REQUIRE(brownout.EnergyKWh() < parameters.heaterPowerW * 0.81f * 600.0f / 3.6e6f);
+    }
+
+    TEST_CASE("FurnaceSimulator: a 20 hour firing on the real control and safety code")
+    {
+        Log::NullLogBackend nullLogBackend;
+        Log::LogService log(&nullLogBackend);
+        FurnaceSimulator simulator(SimPreferences(), SimKiln(), log);
+
+        // Nothing to fire from until the sample pipeline has published
+        REQUIRE_FALSE(simulator.Fire(MakeProfile("long.json", LONG_FIRING)).success);
+        simulator.RunFor(10s);
+        REQUIRE(simulator.Fire(MakeProfile("long.json", LONG_FIRING)).success);
+        const std::chrono::microseconds start = simulator.GetClock().Now();
+
+        REQUIRE(simulator.RunUntilDone(21h) == Furnace::StateId::COMPLETED);
+        const FiringStats& stats = simulator.GetStats();
+        REQUIRE(stats.finished - start >= 20h);
+        REQUIRE(stats.finished - start < 20h + 2s);
+        REQUIRE(stats.maxTrackingError < 10.0f);
+        REQUIRE(stats.maxOvershoot < 5.0f);
+        REQUIRE(stats.maxKilnTemperature < 1060.0f);
+        REQUIRE(stats.maxCaseTemperature < 60.0f);
+        REQUIRE_FALSE(simulator.GetSafetyMonitor().IsTripped());
+        REQUIRE(simulator.GetStateMachine().GetErrorMessage().empty());
+
+        // Heater off once complete
+        simulator.RunFor(1h);
+        REQUIRE(simulator.GetKiln().HeaterPowerW() < 1.0f);
+        REQUIRE(simulator.GetKiln().KilnTemperature() < 700.0f);
+    }
+
+    TEST_CASE("FurnaceSimulator: a thermocouple fault mid-firing trips the safety monitor and stops the heater")
+    {
+        Log::NullLogBackend nullLogBackend;
+        Log::LogService log(&nullLogBackend);
+        FurnaceSimulator simulator(SimPreferences(), SimKiln(), log);
+        simulator.RunFor(10s);
+        REQUIRE(simulator.Fire(MakeProfile("long.json", LONG_FIRING)).success);
+        simulator.RunFor(3h);
+
+        const std::chrono::microseconds now = simulator.GetClock().Now();
+        REQUIRE(simulator.GetThermocouples().InjectFault({0, Sensor::ThermocoupleFault::OpenCircuit, now, now + 24h}));
+        REQUIRE(simulator.RunUntilDone(1min) == Furnace::StateId::ERROR);
+        REQUIRE(simulator.GetSafetyMonitor().IsTripped());
+        REQUIRE(std::string_view(simulator.GetStateMachine().GetErrorMessage().c_str()) == "thermocouple failure");
+
+        const float tripped = simulator.GetKiln().KilnTemperature();
+        simulator.RunFor(30min);
+        REQUIRE(simulator.GetKiln().HeaterPowerW() < 1.0f);
+        REQUIRE(simulator.GetKiln().KilnTemperature() < tripped);
+    }
+
+    TEST_CASE("FurnaceSimulator: an autotune runs to completion with thermal runaway protection on")
+    {
+        Log::NullLogBackend nullLogBackend;
+        Log::LogService log(&nullLogBackend);
+        FurnaceSimulator simulator(SimPreferences(), SimKiln(), log);
+        simulator.RunFor(10s);
+        REQUIRE(simulator.GetStateMachine().StartAutotune(300.0f).success);
+
+        for (int minutes = 0; minutes < 8 * 60 && simulator.GetStateMachine().GetState() == Furnace::StateId::AUTOTUNING; ++minutes)
+        {
+            simulator.RunFor(1min);
+        }
+        REQUIRE(simulator.GetStateMachine().GetState() == Furnace::StateId::IDLE);
+        REQUIRE(simulator.GetStateMachine().GetAutotuner().GetStatus() == Control::AutotuneStatus::DONE);
+        REQUIRE_FALSE(simulator.GetSafetyMonitor().IsTripped());
+        REQUIRE(simulator.GetStateMachine().GetErrorMessage().empty());
+    }
+
+    TEST_CASE("FurnaceSimulator: benchmark", "[.][benchmark]")
+    {
+        Log::NullLogBackend nullLogBackend;
+        Log::LogService log(&nullLogBackend);
+
+        BENCHMARK("20 hour firing")
+        {
+            FurnaceSimulator simulator(SimPreferences(), SimKiln(), log);
+            simulator.RunFor(10s);
+            REQUIRE(simulator.Fire(MakeProfile("long.json", LONG_FIRING)).success);
+            return simulator.RunUntilDone(21h);
+        };
+
+        FurnaceSimulator simulator(SimPreferences(), SimKiln(), log);
+        simulator.RunFor(10s);
+        REQUIRE(simulator.Fire(MakeProfile("long.json", LONG_FIRING)).success);
+        simulator.RunUntilDone(21h);
+        const FiringStats& stats = simulator.GetStats();
+        WARN("Tracking error " << stats.maxTrackingError << " °C, overshoot " << stats.maxOvershoot << " °C, case " << stats.maxCaseTemperature
+            << " °C, " << simulator.GetKiln().EnergyKWh() << " kWh");
+    }
+} //namespace HeatTreatFurnace::Test
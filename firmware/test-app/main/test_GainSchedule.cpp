@@ -0,0 +1,217 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Control/GainSchedule.hpp"
+#include "Control/Pid.hpp"
+#include "Sim/ThermalModel.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Control;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        // Brisk at low temperature where the kiln heats fast, gentle at the top
+        Furnace::PidSchedule MakeSchedule()
+        {
+            Furnace::PidSchedule schedule;
+            schedule.push_back({200.0f, 40.0f, 0.4f, 0.0f});
+            schedule.push_back({600.0f, 20.0f, 0.2f, 10.0f});
+            schedule.push_back({1100.0f, 10.0f, 0.05f, 20.0f});
+            return schedule;
+        }
+    }
+
+    TEST_CASE("GainSchedule: Parse - PID_Schedule text")
+    {
+        Furnace::PidSchedule schedule;
+
+        REQUIRE(GainSchedule::Parse("200:40:0.4:0, 600:20:0.2:10,1100:10:0.05:20", schedule));
+        REQUIRE(schedule.size() == 3);
+        REQUIRE(schedule[1].temperature == 600.0f);
+        REQUIRE(schedule[1].kp == 20.0f);
+        REQUIRE(schedule[2].ki == 0.05f);
+        REQUIRE(schedule[2].kd == 20.0f);
+
+        REQUIRE(GainSchedule::Parse("", schedule));
+        REQUIRE(schedule.empty());
+
+        REQUIRE_FALSE(GainSchedule::Parse("200:40:0.4", schedule));
+        REQUIRE_FALSE(GainSchedule::Parse("200:40:0.4:0; 600:20:0.2:10", schedule));
+        REQUIRE_FALSE(GainSchedule::Parse("hot:40:0.4:0", schedule));
+        REQUIRE_FALSE(GainSchedule::Parse("1:1:1:1,2:1:1:1,3:1:1:1,4:1:1:1,5:1:1:1,6:1:1:1,7:1:1:1,8:1:1:1,9:1:1:1", schedule));
+    }
+
+    TEST_CASE("GainSchedule: Configure - rejects unsorted or negative breakpoints")
+    {
+        GainSchedule schedule;
+        Furnace::PidSchedule table = MakeSchedule();
+        REQUIRE(schedule.Configure(table, {}));
+        REQUIRE(schedule.BandCount() == 3);
+
+        std::swap(table[0], table[1]);
+        REQUIRE_FALSE(schedule.Configure(table, {}));
+
+        table = MakeSchedule();
+        table[1].temperature = table[0].temperature;
+        REQUIRE_FALSE(schedule.Configure(table, {}));
+
+        table = MakeSchedule();
+        table[2].ki = -0.1f;
+        REQUIRE_FALSE(schedule.Configure(table, {}));
+    }
+
+    TEST_CASE("GainSchedule: GainsAt - interpolated between breakpoints, held outside them")
+    {
+        GainSchedule schedule;
+        REQUIRE(schedule.Configure(MakeSchedule(), {}));
+
+        REQUIRE(schedule.GainsAt(20.0f).kp == 40.0f);
+        REQUIRE(schedule.GainsAt(200.0f).kp == 40.0f);
+        REQUIRE(schedule.GainsAt(400.0f).kp == Catch::Approx(30.0f));
+        REQUIRE(schedule.GainsAt(400.0f).ki == Catch::Approx(0.3f));
+        REQUIRE(schedule.GainsAt(400.0f).kd == Catch::Approx(5.0f));
+        REQUIRE(schedule.GainsAt(600.0f).kp == Catch::Approx(20.0f));
+        REQUIRE(schedule.GainsAt(850.0f).kp == Catch::Approx(15.0f));
+        REQUIRE(schedule.GainsAt(1300.0f).kp == 10.0f);
+
+        SECTION("An empty schedule gives the fixed gains everywhere")
+        {
+            REQUIRE(schedule.Configure({}, {5.0f, 0.02f, 1.0f}));
+            REQUIRE(schedule.BandCount() == 1);
+            REQUIRE(schedule.GainsAt(20.0f).kp == 5.0f);
+            REQUIRE(schedule.GainsAt(1000.0f).kd == 1.0f);
+        }
+    }
+
+    TEST_CASE("GainSchedule: GainsAt - the cached band follows the temperature both ways")
+    {
+        GainSchedule schedule;
+        REQUIRE(schedule.Configure(MakeSchedule(), {}));
+
+        REQUIRE(schedule.Band() == 0);
+        for (float temperature = 20.0f; temperature < 1300.0f; temperature += 0.5f)
+        {
+            const PidGains gains = schedule.GainsAt(temperature);
+            REQUIRE(schedule.Band() == (temperature < 600.0f ? 0u : temperature < 1100.0f ? 1u : 2u));
+            REQUIRE(gains.kp <= 40.0f);
+            REQUIRE(gains.kp >= 10.0f);
+        }
+        for (float temperature = 1300.0f; temperature > 20.0f; temperature -= 0.5f)
+        {
+            (void)schedule.GainsAt(temperature);
+            REQUIRE(schedule.Band() == (temperature < 600.0f ? 0u : temperature < 1100.0f ? 1u : 2u));
+        }
+
+        // A jump, e.g. the schedule consulted for a new setpoint, still lands in the right band
+        REQUIRE(schedule.GainsAt(1200.0f).kp == 10.0f);
+        REQUIRE(schedule.Band() == 2);
+        REQUIRE(schedule.GainsAt(100.0f).kp == 40.0f);
+        REQUIRE(schedule.Band() == 0);
+    }
+
+    TEST_CASE("Pid: SetGains - no bump in the output")
+    {
+        FloatPid pid;
+        for (int i = 0; i < 20; ++i)
+        {
+            pid.Update(510.0f, 500.0f);
+        }
+
+        // On the setpoint, once D has seen the error stop changing, only the I term is left
+        pid.Update(500.0f, 500.0f);
+        const float before = pid.Update(500.0f, 500.0f);
+        pid.SetGains(5.0f, 0.05f, 1.0f);
+        REQUIRE(pid.Update(500.0f, 500.0f) == Catch::Approx(before));
+        pid.SetGains(40.0f, 0.8f, 0.0f);
+        REQUIRE(pid.Update(500.0f, 500.0f) == Catch::Approx(before));
+    }
+
+    TEST_CASE("GainScheduledPid: bumpless across breakpoints and schedule changes on a slow ramp")
+    {
+        PidConfig config;
+        config.integralMax = 1000.0f;
+        FloatGainScheduledPid pid(config);
+        REQUIRE(pid.Configure(config, MakeSchedule()));
+
+        // Half the gains, as if an autotune had just been saved
+        Furnace::PidSchedule gentler = MakeSchedule();
+        for (Furnace::PidBreakpoint& point : gentler)
+        {
+            point.kp /= 2.0f;
+            point.ki /= 2.0f;
+            point.kd /= 2.0f;
+        }
+
+        Sim::ThermalModel kiln;
+        float setpoint = 20.0f;
+        float lastOutput = 0.0f;
+        size_t lastBand = 0;
+        int bandChanges = 0;
+        for (std::chrono::milliseconds t{0}; t < 11h; t += config.sampleTime)
+        {
+            setpoint = std::min(setpoint + 100.0f / 720.0f, 1000.0f); // 100 °C/h
+            const bool reconfigured = t == 8h;
+            if (reconfigured)
+            {
+                REQUIRE(pid.Configure(config, gentler));
+            }
+            const float output = pid.Update(setpoint, kiln.SensorTemperature());
+            kiln.Step(output, config.sampleTime);
+
+            if (pid.Schedule().Band() != lastBand || reconfigured)
+            {
+                bandChanges += pid.Schedule().Band() != lastBand;
+                lastBand = pid.Schedule().Band();
+                REQUIRE(std::abs(output - lastOutput) < 1.0f);
+            }
+            lastOutput = output;
+        }
+        REQUIRE(bandChanges == 1);
+        REQUIRE(pid.Gains().kp == Catch::Approx(gentler[1].kp + (gentler[2].kp - gentler[1].kp) * 0.8f));
+        REQUIRE(std::abs(kiln.SensorTemperature() - 1000.0f) < 1.0f);
+    }
+
+    TEST_CASE("GainScheduledPid: an invalid schedule falls back to the fixed gains")
+    {
+        PidConfig config;
+        Furnace::PidSchedule schedule = MakeSchedule();
+        std::swap(schedule[0], schedule[2]);
+
+        FloatGainScheduledPid pid;
+        REQUIRE_FALSE(pid.Configure(config, schedule));
+        pid.Update(800.0f, 790.0f);
+        REQUIRE(pid.Gains().kp == config.kp);
+        REQUIRE(pid.Gains().ki == config.ki);
+    }
+
+    TEST_CASE("GainScheduledPid: benchmark", "[.][benchmark]")
+    {
+        FloatPid fixed;
+        FloatGainScheduledPid scheduled;
+        REQUIRE(scheduled.Configure({}, MakeSchedule()));
+        FixedGainScheduledPid scheduledFixed;
+        REQUIRE(scheduledFixed.Configure({}, MakeSchedule()));
+
+        float setpoint = 20.0f;
+        BENCHMARK("FloatPid::Update")
+        {
+            setpoint = setpoint > 1200.0f ? 20.0f : setpoint + 0.1f;
+            return fixed.Update(setpoint, setpoint - 1.0f);
+        };
+        BENCHMARK("FloatGainScheduledPid::Update")
+        {
+            setpoint = setpoint > 1200.0f ? 20.0f : setpoint + 0.1f;
+            return scheduled.Update(setpoint, setpoint - 1.0f);
+        };
+        BENCHMARK("FixedGainScheduledPid::Update")
+        {
+            setpoint = setpoint > 1200.0f ? 20.0f : setpoint + 0.1f;
+            return scheduledFixed.Update(setpoint, setpoint - 1.0f).Raw();
+        };
+    }
+} //namespace HeatTreatFurnace::Test
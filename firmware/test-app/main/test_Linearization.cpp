@@ -0,0 +1,179 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Sensor/Linearization.hpp"
+#include "Sensor/Nist.hpp"
+#include "Sensor/ReplayThermocouple.hpp"
+#include "Sensor/SensorPublisher.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Sensor;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        constexpr std::array<ThermocoupleType, 4> TYPES{ThermocoupleType::K, ThermocoupleType::N, ThermocoupleType::S, ThermocoupleType::R};
+        constexpr std::array<double, 5> COLD_JUNCTIONS{-40.0, 0.0, 25.0, 70.0, 125.0};
+
+        /** @brief What the chip computes, without its 0.25 °C rounding */
+        double ChipReading(ThermocoupleType aType, double aTemperature, double aColdJunction)
+        {
+            return aColdJunction + (Nist::Voltage(aType, aTemperature) - Nist::Voltage(aType, aColdJunction)) / Nist::Data(aType).max31855Sensitivity;
+        }
+
+        /** @brief The usual run time approach: cold junction polynomial, then NIST's inverse polynomial */
+        double DirectHotJunction(ThermocoupleType aType, double aReported, double aColdJunction)
+        {
+            const double millivolts = (aReported - aColdJunction) * Nist::Data(aType).max31855Sensitivity + Nist::Voltage(aType, aColdJunction);
+            return Nist::InverseTemperature(aType, millivolts);
+        }
+    }
+
+    // The reference functions are evaluated at compile time; NIST table values
+    static_assert(std::abs(Nist::Voltage(ThermocoupleType::K, 1000.0) - 41.276) < 0.0005);
+    static_assert(std::abs(Nist::Voltage(ThermocoupleType::N, 1300.0) - 47.513) < 0.0005);
+    static_assert(std::abs(Nist::Voltage(ThermocoupleType::S, 1000.0) - 9.587) < 0.0005);
+    static_assert(std::abs(Nist::Voltage(ThermocoupleType::R, 1768.1) - 21.103) < 0.0005);
+    static_assert(std::abs(Nist::ExactTemperature(ThermocoupleType::K, Nist::Voltage(ThermocoupleType::K, 1234.5)) - 1234.5) < 1e-6);
+
+    TEST_CASE("Linearization: NIST table values")
+    {
+        struct Point
+        {
+            ThermocoupleType type;
+            double temperature;
+            double millivolts;
+        };
+        const std::array<Point, 12> points{{
+            {ThermocoupleType::K, -200.0, -5.891}, {ThermocoupleType::K, 25.0, 1.000}, {ThermocoupleType::K, 500.0, 20.644},
+            {ThermocoupleType::K, 1372.0, 54.886}, {ThermocoupleType::N, -200.0, -3.990}, {ThermocoupleType::N, 600.0, 20.613},
+            {ThermocoupleType::S, -50.0, -0.236}, {ThermocoupleType::S, 1064.18, 10.334}, {ThermocoupleType::S, 1768.0, 18.693},
+            {ThermocoupleType::R, -50.0, -0.226}, {ThermocoupleType::R, 1000.0, 10.506}, {ThermocoupleType::R, 1664.5, 19.739},
+        }};
+        for (const Point& point : points)
+        {
+            CAPTURE(static_cast<int>(point.type), point.temperature);
+            REQUIRE(Nist::Voltage(point.type, point.temperature) == Catch::Approx(point.millivolts).margin(0.0005));
+            REQUIRE(Nist::ExactTemperature(point.type, Nist::Voltage(point.type, point.temperature)) == Catch::Approx(point.temperature).margin(1e-4));
+        }
+    }
+
+    TEST_CASE("Linearization: corrects the chip's linear approximation")
+    {
+        // Type K at 1200 °C reads 16 °C low on the chip
+        const float reported = Linearization::Reported(ThermocoupleType::K, 1200.0f, 25.0f);
+        REQUIRE(reported == Catch::Approx(1184.0f).margin(0.1f));
+        REQUIRE(Linearization::HotJunction(ThermocoupleType::K, reported, 25.0f) == Catch::Approx(1200.0f).margin(0.01f));
+
+        // Worse for S and R, whose Seebeck coefficient varies more
+        const float platinum = Linearization::Reported(ThermocoupleType::S, 1200.0f, 25.0f);
+        REQUIRE(platinum > 1250.0f);
+        REQUIRE(Linearization::HotJunction(ThermocoupleType::S, platinum, 25.0f) == Catch::Approx(1200.0f).margin(0.01f));
+    }
+
+    TEST_CASE("Linearization: within 0.01 °C of the reference function over every type's range")
+    {
+        for (const ThermocoupleType type : TYPES)
+        {
+            const Nist::ThermocoupleData& data = Nist::Data(type);
+            double worstTable = 0.0;
+            double worstDirect = 0.0;
+            double worstChip = 0.0;
+            for (const double coldJunction : COLD_JUNCTIONS)
+            {
+                for (double temperature = data.minTemperature; temperature <= data.maxTemperature; temperature += 0.5)
+                {
+                    const double reported = ChipReading(type, temperature, coldJunction);
+                    const float table = Linearization::HotJunction(type, static_cast<float>(reported), static_cast<float>(coldJunction));
+                    worstTable = std::max(worstTable, std::abs(table - temperature));
+                    worstDirect = std::max(worstDirect, std::abs(DirectHotJunction(type, reported, coldJunction) - temperature));
+                    worstChip = std::max(worstChip, std::abs(reported - temperature));
+                }
+            }
+            INFO("type " << static_cast<int>(type) << ": table " << worstTable << " °C, NIST inverse " << worstDirect << " °C, uncorrected " << worstChip << " °C");
+            REQUIRE(worstTable < 0.01);
+            REQUIRE(worstTable < worstDirect);
+            REQUIRE(worstChip > 10.0);
+        }
+    }
+
+    TEST_CASE("Linearization: cold junction compensation")
+    {
+        // The same kiln with the controller board at different temperatures
+        for (const ThermocoupleType type : TYPES)
+        {
+            for (const double coldJunction : COLD_JUNCTIONS)
+            {
+                const double reported = ChipReading(type, 1000.0, coldJunction);
+                REQUIRE(Linearization::HotJunction(type, static_cast<float>(reported), static_cast<float>(coldJunction)) == Catch::Approx(1000.0f).margin(0.01f));
+            }
+        }
+    }
+
+    TEST_CASE("Linearization: out of range readings are clamped")
+    {
+        REQUIRE(Linearization::HotJunction(ThermocoupleType::K, 2047.75f, 25.0f) == Catch::Approx(1372.0f).margin(0.01f));
+        REQUIRE(Linearization::HotJunction(ThermocoupleType::K, -2048.0f, 25.0f) == Catch::Approx(-200.0f).margin(0.01f));
+        REQUIRE(Linearization::HotJunction(ThermocoupleType::S, -100.0f, 25.0f) == Catch::Approx(-50.0f).margin(0.01f));
+        REQUIRE(std::isfinite(Linearization::HotJunction(ThermocoupleType::R, 0.0f, 500.0f)));
+        REQUIRE(std::isfinite(Linearization::HotJunction(ThermocoupleType::COUNT, 100.0f, 25.0f)));
+    }
+
+    TEST_CASE("Linearization: through a replayed chip and the publisher")
+    {
+        // A firing to 1300 °C on type K and N in 1 °C steps, read through the 0.25 °C frames every 100 ms and
+        // checked once the pipeline has settled on each step: half a frame step at most, scaled by how much
+        // steeper the thermocouple is than the chip assumes
+        for (const ThermocoupleType type : {ThermocoupleType::K, ThermocoupleType::N})
+        {
+            Time::ManualClock clock;
+            ReplayThermocouple replay(clock, 1, [](size_t, std::chrono::microseconds aNow)
+            {
+                return 20.0f + static_cast<float>(std::chrono::duration_cast<std::chrono::seconds>(aNow).count() / 10);
+            });
+            replay.SetThermocoupleType(type);
+            replay.SetColdJunction(32.0f);
+            SensorPublisher publisher(replay, type);
+
+            float worst = 0.0f;
+            for (int step = 0; step <= 1280; ++step)
+            {
+                for (int batch = 0; batch < 100; ++batch)
+                {
+                    replay.Poll();
+                    publisher.Poll();
+                    clock.Advance(100ms);
+                }
+                worst = std::max(worst, std::abs(publisher.Latest().kilnTemperature - (20.0f + static_cast<float>(step))));
+            }
+            INFO("type " << static_cast<int>(type) << " worst " << worst);
+            REQUIRE(worst < 0.2f);
+        }
+    }
+
+    TEST_CASE("Linearization: benchmark", "[.][benchmark]")
+    {
+        float reported = 1100.0f;
+        BENCHMARK("Linearization::HotJunction (tables)")
+        {
+            reported = reported > 1300.0f ? 1100.0f : reported + 0.25f;
+            return Linearization::HotJunction(ThermocoupleType::K, reported, 27.5f);
+        };
+        BENCHMARK("Cold junction and NIST inverse polynomials")
+        {
+            reported = reported > 1300.0f ? 1100.0f : reported + 0.25f;
+            return DirectHotJunction(ThermocoupleType::K, reported, 27.5);
+        };
+        BENCHMARK("Reference function inverted by Newton's method")
+        {
+            reported = reported > 1300.0f ? 1100.0f : reported + 0.25f;
+            const double millivolts = (reported - 27.5) * Nist::TYPE_K.max31855Sensitivity + Nist::Voltage(ThermocoupleType::K, 27.5);
+            return Nist::ExactTemperature(ThermocoupleType::K, millivolts);
+        };
+    }
+} //namespace HeatTreatFurnace::Test
@@ -0,0 +1,288 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "Control/LoopScheduler.hpp"
+#include "Furnace/Furnace.hpp"
+#include "Furnace/StateMachine.hpp"
+#include "Log/LogBackend.hpp"
+#include "Log/LogService.hpp"
+#include "Time/Clock.hpp"
+#include <string>
+#include <vector>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Control;
+    using namespace HeatTreatFurnace::Log;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        /** @brief A stage that records when it ran and takes a set time on the manual clock */
+        class FakeStage
+        {
+        public:
+            FakeStage(Time::ManualClock& aClock, std::vector<std::string>& aOrder, std::string aName) :
+                myClock(aClock), myOrder(aOrder), myName(std::move(aName))
+            {
+            }
+
+            void Run()
+            {
+                myOrder.push_back(myName);
+                myClock.Advance(myDuration);
+                ++myRuns;
+            }
+
+            LoopScheduler::StageFunction Function()
+            {
+                return LoopScheduler::StageFunction::create<FakeStage, &FakeStage::Run>(*this);
+            }
+
+            std::chrono::microseconds myDuration{0};
+            int myRuns = 0;
+
+        private:
+            Time::ManualClock& myClock;
+            std::vector<std::string>& myOrder;
+            std::string myName;
+        };
+
+        class MissRecorder
+        {
+        public:
+            void OnMiss(etl::string_view aStage)
+            {
+                myMisses.emplace_back(aStage.data(), aStage.size());
+            }
+
+            std::vector<std::string> myMisses;
+        };
+    }
+
+    class LoopSchedulerFixture
+    {
+    public:
+        LoopSchedulerFixture() :
+            myLog(&myNullLogBackend), myScheduler(myClock, myLog),
+            mySensor(myClock, myOrder, "sensor"), myPid(myClock, myOrder, "pid"), mySafety(myClock, myOrder, "safety")
+        {
+        }
+
+        NullLogBackend myNullLogBackend;
+        LogService myLog;
+        Time::ManualClock myClock{1s};
+        LoopScheduler myScheduler;
+        std::vector<std::string> myOrder;
+        FakeStage mySensor;
+        FakeStage myPid;
+        FakeStage mySafety;
+    };
+
+    TEST_CASE_METHOD(LoopSchedulerFixture, "LoopScheduler: AddStage - rejects bad stages")
+    {
+        REQUIRE_FALSE(myScheduler.AddStage("pid", 0us, 1ms, myPid.Function()).success);
+        REQUIRE_FALSE(myScheduler.AddStage("pid", 1ms, 0us, myPid.Function()).success);
+        REQUIRE_FALSE(myScheduler.AddStage("pid", 1ms, 1ms, {}).success);
+
+        for (size_t i = 0; i < LoopScheduler::MAX_STAGES; ++i)
+        {
+            REQUIRE(myScheduler.AddStage("pid", 1ms, 1ms, myPid.Function()).success);
+        }
+        REQUIRE_FALSE(myScheduler.AddStage("pid", 1ms, 1ms, myPid.Function()).success);
+        REQUIRE(myScheduler.StageCount() == LoopScheduler::MAX_STAGES);
+    }
+
+    TEST_CASE_METHOD(LoopSchedulerFixture, "LoopScheduler: runs shorter periods first and each stage at its own rate")
+    {
+        REQUIRE(myScheduler.AddStage("pid", 100ms, 100ms, myPid.Function()).success);
+        REQUIRE(myScheduler.AddStage("sensor", 10ms, 10ms, mySensor.Function()).success);
+        REQUIRE(myScheduler.AddStage("safety", 50ms, 50ms, mySafety.Function(), true).success);
+
+        myScheduler.Start();
+        REQUIRE(myScheduler.Tick() == 1s + 10ms);
+        REQUIRE(myOrder == std::vector<std::string>{"sensor", "safety", "pid"});
+
+        myScheduler.RunUntil(2s);
+        REQUIRE(mySensor.myRuns == 100);
+        REQUIRE(mySafety.myRuns == 20);
+        REQUIRE(myPid.myRuns == 10);
+
+        REQUIRE(myScheduler.GetStats(0).name == "sensor");
+        REQUIRE(myScheduler.GetStats(0).jitter.count == 100);
+        REQUIRE(myScheduler.GetStats(0).jitter.max == 0us);
+        REQUIRE(myScheduler.GetStats(0).deadlineMisses == 0);
+    }
+
+    TEST_CASE_METHOD(LoopSchedulerFixture, "LoopScheduler: measures jitter and execution time per stage")
+    {
+        mySensor.myDuration = 300us;
+        myPid.myDuration = 1ms;
+        REQUIRE(myScheduler.AddStage("sensor", 10ms, 10ms, mySensor.Function()).success);
+        REQUIRE(myScheduler.AddStage("pid", 10ms, 10ms, myPid.Function()).success);
+
+        myScheduler.Start();
+        myScheduler.RunUntil(1s + 100ms);
+
+        const LoopStageStats& sensor = myScheduler.GetStats(0);
+        REQUIRE(sensor.execution.min == 300us);
+        REQUIRE(sensor.execution.max == 300us);
+        REQUIRE(sensor.execution.Average() == 300us);
+        REQUIRE(sensor.jitter.max == 0us);
+        REQUIRE(sensor.jitterHistogram[0] == 10);
+
+        // pid shares the sensor's release and has to wait for it
+        const LoopStageStats& pid = myScheduler.GetStats(1);
+        REQUIRE(pid.jitter.count == 10);
+        REQUIRE(pid.jitter.min == 300us);
+        REQUIRE(pid.jitter.Average() == 300us);
+        REQUIRE(pid.jitterHistogram[0] == 0);
+        REQUIRE(pid.jitterHistogram[2] == 10); // [200us, 400us)
+        REQUIRE(pid.execution.Average() == 1ms);
+        REQUIRE(pid.deadlineMisses == 0);
+
+        SECTION("ResetStats keeps the names")
+        {
+            myScheduler.ResetStats();
+            REQUIRE(myScheduler.GetStats(1).name == "pid");
+            REQUIRE(myScheduler.GetStats(1).jitter.count == 0);
+            REQUIRE(myScheduler.GetStats(1).jitterHistogram[2] == 0);
+        }
+    }
+
+    TEST_CASE_METHOD(LoopSchedulerFixture, "LoopScheduler: an overrun is a deadline miss and skips the releases it covered")
+    {
+        REQUIRE(myScheduler.AddStage("pid", 10ms, 5ms, myPid.Function()).success);
+
+        myScheduler.Start();
+        myPid.myDuration = 6ms;
+        REQUIRE(myScheduler.Tick() == 1s + 10ms);
+        REQUIRE(myScheduler.GetStats(0).deadlineMisses == 1);
+        REQUIRE(myScheduler.GetStats(0).skippedReleases == 0);
+
+        myClock.SleepUntil(1s + 10ms);
+        myPid.myDuration = 25ms;
+        REQUIRE(myScheduler.Tick() == 1s + 40ms); // releases at 20ms and 30ms were overrun
+        REQUIRE(myScheduler.GetStats(0).deadlineMisses == 2);
+        REQUIRE(myScheduler.GetStats(0).skippedReleases == 2);
+        REQUIRE(myScheduler.GetStats(0).execution.max == 25ms);
+    }
+
+    TEST_CASE_METHOD(LoopSchedulerFixture, "LoopScheduler: jitter beyond the histogram goes in the last bucket")
+    {
+        REQUIRE(myScheduler.AddStage("pid", 1s, 10s, myPid.Function()).success);
+
+        myScheduler.Start();
+        myClock.Advance(10s - 1ms);
+        myScheduler.Tick();
+        REQUIRE(myScheduler.GetStats(0).jitterHistogram[JITTER_BUCKETS - 1] == 1);
+        REQUIRE(myScheduler.GetStats(0).deadlineMisses == 0);
+    }
+
+    TEST_CASE_METHOD(LoopSchedulerFixture, "LoopScheduler: only safety stages call the safety miss handler")
+    {
+        MissRecorder recorder;
+        myScheduler.SetSafetyMissHandler(LoopScheduler::SafetyMissHandler::create<MissRecorder, &MissRecorder::OnMiss>(recorder));
+        REQUIRE(myScheduler.AddStage("pid", 10ms, 10ms, myPid.Function()).success);
+        REQUIRE(myScheduler.AddStage("safety", 20ms, 2ms, mySafety.Function(), true).success);
+
+        myPid.myDuration = 3ms;
+        myScheduler.Start();
+        myScheduler.RunUntil(1s + 100ms);
+
+        REQUIRE(myScheduler.GetStats(0).deadlineMisses == 0);
+        REQUIRE(myScheduler.GetStats(1).deadlineMisses == 5);
+        REQUIRE(recorder.myMisses == std::vector<std::string>(5, "safety"));
+    }
+
+    TEST_CASE_METHOD(LoopSchedulerFixture, "LoopScheduler: a missed safety deadline puts the furnace in ERROR")
+    {
+        Furnace::FurnaceState furnace;
+        Furnace::StateMachine stateMachine(furnace, myClock, myLog);
+        REQUIRE(stateMachine.TransitionTo(Furnace::StateId::LOADED));
+        REQUIRE(stateMachine.TransitionTo(Furnace::StateId::RUNNING));
+
+        myScheduler.SetSafetyMissHandler(LoopScheduler::SafetyMissHandler::create<Furnace::StateMachine, &Furnace::StateMachine::OnSafetyDeadlineMissed>(stateMachine));
+        REQUIRE(myScheduler.AddStage("safety", 100ms, 10ms, mySafety.Function(), true).success);
+        myScheduler.Start();
+
+        myScheduler.RunUntil(1s + 500ms);
+        REQUIRE(stateMachine.GetState() == Furnace::StateId::RUNNING);
+
+        mySafety.myDuration = 11ms;
+        myScheduler.RunUntil(1s + 600ms);
+        REQUIRE(stateMachine.GetState() == Furnace::StateId::ERROR);
+    }
+
+    TEST_CASE("LoopScheduler: on a VirtualClock, sleeps stop for the timers due on the way")
+    {
+        NullLogBackend nullLogBackend;
+        LogService log(&nullLogBackend);
+        Time::VirtualClock clock;
+        LoopScheduler scheduler(clock, log);
+
+        struct HourlyStage
+        {
+            explicit HourlyStage(Time::VirtualClock& aClock) :
+                myClock(aClock)
+            {
+            }
+
+            void Run()
+            {
+                if (myEnabled)
+                {
+                    myRuns.push_back(myClock.Now());
+                }
+            }
+
+            Time::VirtualClock& myClock;
+            bool myEnabled = true;
+            std::vector<std::chrono::microseconds> myRuns;
+        } stage{clock};
+        REQUIRE(scheduler.AddStage("hourly", 1h, 1h, LoopScheduler::StageFunction::create<HourlyStage, &HourlyStage::Run>(stage)).success);
+        scheduler.Start();
+
+        std::vector<std::string> events;
+        std::chrono::microseconds disabledAt{0};
+        REQUIRE(clock.CallAt(90min, [&]
+        {
+            disabledAt = clock.Now();
+            stage.myEnabled = false;
+            events.emplace_back("disable");
+        }));
+        REQUIRE(clock.CallAt(30min, [&]
+        {
+            events.emplace_back("first");
+            // Set from a timer, and already due: runs before the sleep goes on, at the current time
+            REQUIRE(clock.CallAt(0us, [&]
+            {
+                REQUIRE(clock.Now() == 30min);
+                events.emplace_back("chained");
+            }));
+        }));
+        REQUIRE(clock.CallAt(90min, [&]
+        {
+            events.emplace_back("tie");
+        }));
+        REQUIRE(clock.PendingTimers() == 3);
+
+        // Ten hours of a one hour stage is one wake-up per hour plus one per timer
+        scheduler.RunUntil(10h);
+        REQUIRE(clock.Now() == 10h);
+        REQUIRE(disabledAt == 90min);
+        REQUIRE(stage.myRuns == std::vector<std::chrono::microseconds>{0h, 1h});
+        REQUIRE(events == std::vector<std::string>{"first", "chained", "disable", "tie"});
+        REQUIRE(clock.PendingTimers() == 0);
+
+        SECTION("Full")
+        {
+            for (size_t i = 0; i < Time::VirtualClock::MAX_TIMERS; ++i)
+            {
+                REQUIRE(clock.CallAt(11h, [] {}));
+            }
+            REQUIRE_FALSE(clock.CallAt(11h, [] {}));
+            clock.Advance(1h);
+            REQUIRE(clock.PendingTimers() == 0);
+        }
+    }
+} //namespace HeatTreatFurnace::Test
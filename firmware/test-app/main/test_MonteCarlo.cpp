@@ -0,0 +1,187 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "Sim/MonteCarlo.hpp"
+#include "Sim/WorkStealingPool.hpp"
+#include "SimFixtures.hpp"
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <string_view>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Sim;
+
+    namespace
+    {
+        // Two segments, 4.5 hours: 400 °C in 3 h, then 500 °C in an hour with half an hour there
+        constexpr std::string_view TWO_SEGMENT_FIRING = R"({ "segments": [
+            { "target": 400, "ramp_time": { "hours": 3 }, "dwell_time": { "minutes": 0 } },
+            { "target": 500, "ramp_time": { "hours": 1 }, "dwell_time": { "minutes": 30 } }
+        ] })";
+
+        PlantVariation Spread()
+        {
+            PlantVariation variation;
+            variation.loadJPerC = Distribution::Uniform(0.0f, 5000.0f);
+            variation.elementAging = Distribution::Uniform(0.0f, 0.05f);
+            variation.ambientShift = Distribution::Normal(0.0f, 5.0f);
+            variation.sensorNoise = Distribution::Uniform(0.0f, 1.0f);
+            return variation;
+        }
+
+        size_t Columns(const std::string& aLine)
+        {
+            return static_cast<size_t>(std::ranges::count(aLine, ',')) + 1;
+        }
+    }
+
+    TEST_CASE("ErrorHistogram: percentiles to within a bin, in fixed memory")
+    {
+        ErrorHistogram histogram;
+        REQUIRE(histogram.Percentile(50.0f) == 0.0f);
+
+        // 0.1 to 10 °C in 0.1 °C steps
+        for (int i = 1; i <= 100; ++i)
+        {
+            histogram.Add(static_cast<float>(i) * 0.1f);
+        }
+        REQUIRE(histogram.Count() == 100);
+        const ErrorBand band = histogram.Band();
+        REQUIRE(band.p5 >= 0.5f);
+        REQUIRE(band.p5 <= 0.5f + ErrorHistogram::BIN_WIDTH + 1e-4f);
+        REQUIRE(band.p50 >= 5.0f);
+        REQUIRE(band.p50 <= 5.0f + ErrorHistogram::BIN_WIDTH + 1e-4f);
+        REQUIRE(band.p95 >= 9.5f);
+        REQUIRE(band.p95 <= 9.5f + ErrorHistogram::BIN_WIDTH + 1e-4f);
+        REQUIRE(std::abs(band.max - 10.0f) < 1e-4f);
+        REQUIRE(histogram.Percentile(100.0f) == band.max);
+
+        SECTION("Errors past MAX_ERROR still count, at the largest seen")
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                histogram.Add(250.0f);
+            }
+            REQUIRE(histogram.Percentile(95.0f) == 250.0f);
+            REQUIRE(histogram.Percentile(25.0f) <= 5.0f + ErrorHistogram::BIN_WIDTH);
+        }
+    }
+
+    TEST_CASE("MonteCarloRunner: each run's plant depends only on the seed and its index")
+    {
+        const ThermalParameters kiln;
+        const MonteCarloRunner runner(SimPreferences(), kiln, Spread(), 7);
+
+        const PlantSample first = runner.Sample(3);
+        const PlantSample again = runner.Sample(3);
+        REQUIRE(first.loadJPerC == again.loadJPerC);
+        REQUIRE(first.ambientTemperature == again.ambientTemperature);
+        REQUIRE(first.noiseSeed == again.noiseSeed);
+        REQUIRE(runner.Sample(4).loadJPerC != first.loadJPerC);
+        REQUIRE(MonteCarloRunner(SimPreferences(), kiln, Spread(), 8).Sample(3).loadJPerC != first.loadJPerC);
+
+        for (size_t i = 0; i < 200; ++i)
+        {
+            const PlantSample sample = runner.Sample(i);
+            REQUIRE(sample.loadJPerC >= 0.0f);
+            REQUIRE(sample.loadJPerC <= 5000.0f);
+            REQUIRE(sample.elementAging >= 0.0f);
+            REQUIRE(sample.elementAging <= 0.05f);
+            REQUIRE(sample.sensorNoise <= 1.0f);
+
+            const ThermalParameters plant = runner.Plant(sample);
+            REQUIRE(plant.thermalMassJPerC == kiln.thermalMassJPerC + sample.loadJPerC);
+            REQUIRE(plant.heaterPowerW == kiln.heaterPowerW * (1.0f - sample.elementAging));
+            REQUIRE(plant.ambientTemperature == sample.ambientTemperature);
+        }
+
+        SECTION("Giving one parameter a spread leaves the others' draws alone")
+        {
+            PlantVariation loadOnly;
+            loadOnly.loadJPerC = Spread().loadJPerC;
+            const PlantSample sample = MonteCarloRunner(SimPreferences(), kiln, loadOnly, 7).Sample(3);
+            REQUIRE(sample.loadJPerC == first.loadJPerC);
+            REQUIRE(sample.noiseSeed == first.noiseSeed);
+        }
+
+        SECTION("With no spread every run is the nominal kiln")
+        {
+            const PlantSample nominal = MonteCarloRunner(SimPreferences(), kiln, {}).Sample(5);
+            REQUIRE(nominal.loadJPerC == 0.0f);
+            REQUIRE(nominal.elementAging == 0.0f);
+            REQUIRE(nominal.ambientTemperature == kiln.ambientTemperature);
+            REQUIRE(nominal.sensorNoise == 0.0f);
+        }
+    }
+
+    TEST_CASE("MonteCarloRunner: streams every run and bands the error by segment")
+    {
+        const std::vector<uint8_t> program = CompileProgram(TWO_SEGMENT_FIRING);
+        const MonteCarloRunner runner(SimPreferences(), ThermalParameters{}, Spread(), 11);
+        WorkStealingPool pool(2);
+
+        constexpr size_t RUNS = 8;
+        std::set<size_t> seen;
+        std::vector<MonteCarloRun> kept;
+        std::string csv = MonteCarloRunner::CsvHeader(2);
+        MonteCarloReport report;
+        REQUIRE(runner.Run(program, RUNS, pool, [&](const MonteCarloRun& aRun)
+        {
+            seen.insert(aRun.index);
+            kept.push_back(aRun);
+            csv += MonteCarloRunner::CsvRow(aRun);
+        }, report));
+
+        REQUIRE(seen.size() == RUNS);
+        REQUIRE(report.runs == RUNS);
+        REQUIRE(report.completed == RUNS);
+        REQUIRE(report.errors == 0);
+        REQUIRE(std::abs(report.simulatedHours - 4.5 * RUNS) < 0.01);
+
+        // Each segment gets its own band, spread by the runs' different kilns
+        REQUIRE(report.segments.size() == 2);
+        for (const SegmentBands& bands : report.segments)
+        {
+            REQUIRE(bands.meanError.p5 <= bands.meanError.p50);
+            REQUIRE(bands.meanError.p50 <= bands.meanError.p95);
+            REQUIRE(bands.meanError.p95 <= bands.meanError.max);
+            REQUIRE(bands.maxError.p50 >= bands.meanError.p50);
+            REQUIRE(bands.meanError.max > 0.0f);
+        }
+        REQUIRE(report.segments[0].meanError.p5 < report.segments[0].meanError.max);
+
+        // A header and a row per run, all the same width
+        REQUIRE(std::ranges::count(csv, '\n') == RUNS + 1);
+        const std::string header = csv.substr(0, csv.find('\n'));
+        REQUIRE(Columns(header) == 10 + 2 * 3);
+        REQUIRE(Columns(MonteCarloRunner::CsvRow(kept.front())) == Columns(header));
+
+        SECTION("A run fired on its own matches the same run in the batch")
+        {
+            const auto batch = std::ranges::find(kept, size_t{0}, &MonteCarloRun::index);
+            REQUIRE(batch != kept.end());
+            MonteCarloRun alone;
+            WorkStealingPool single(1);
+            REQUIRE(runner.Run(program, 1, single, [&](const MonteCarloRun& aRun)
+            {
+                alone = aRun;
+            }, report));
+            REQUIRE(alone.stats.maxTrackingError == batch->stats.maxTrackingError);
+            REQUIRE(alone.stats.energyKWh == batch->stats.energyKWh);
+        }
+
+        SECTION("A program the nominal kiln can't fire is refused before anything runs")
+        {
+            const std::vector<uint8_t> tooFast = CompileProgram(R"({ "segments": [
+                { "target": 600, "ramp_time": { "hours": 1 }, "dwell_time": { "minutes": 0 } }
+            ] })");
+            size_t calls = 0;
+            REQUIRE_FALSE(runner.Run(tooFast, RUNS, pool, [&](const MonteCarloRun&)
+            {
+                ++calls;
+            }, report).success);
+            REQUIRE(calls == 0);
+        }
+    }
+} //namespace HeatTreatFurnace::Test
@@ -0,0 +1,137 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Control/FixedPoint.hpp"
+#include "Control/Pid.hpp"
+#include "Furnace/Preferences.hpp"
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Control;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        PidConfig SimpleConfig()
+        {
+            PidConfig config;
+            config.kp = 2.0f;
+            config.ki = 0.5f;
+            config.kd = 10.0f;
+            config.sampleTime = 2s;
+            return config;
+        }
+    }
+
+    TEST_CASE("Fixed16: saturating Q15.16 arithmetic")
+    {
+        REQUIRE(Fixed16::FromFloat(1.5f).Raw() == 3 * Fixed16::ONE / 2);
+        REQUIRE((Fixed16::FromFloat(1.5f) * Fixed16::FromFloat(-2.0f)).ToFloat() == -3.0f);
+        REQUIRE((Fixed16::FromFloat(7.0f) / Fixed16::FromFloat(2.0f)).ToFloat() == 3.5f);
+        REQUIRE((Fixed16::FromFloat(30000.0f) + Fixed16::FromFloat(30000.0f)).ToFloat() == Catch::Approx(32768.0f));
+        REQUIRE((Fixed16::FromFloat(-300.0f) * Fixed16::FromFloat(300.0f)).ToFloat() == Catch::Approx(-32768.0f));
+        REQUIRE(Fixed16::FromFloat(1.0f) < Fixed16::FromFloat(1.5f));
+    }
+
+    TEST_CASE("Pid: Update - P, I and D terms per SPECIFICATION.md §3.1")
+    {
+        FloatPid pid(SimpleConfig());
+
+        // error 10: P 20, integral 20 -> I 10, D 10 * (10 - 0) / 2 = 50
+        REQUIRE(pid.Update(110.0f, 100.0f) == Catch::Approx(80.0f));
+        REQUIRE(pid.Integral() == Catch::Approx(20.0f));
+
+        // error 10 again: P 20, integral 40 -> I 20, D 0
+        REQUIRE(pid.Update(110.0f, 100.0f) == Catch::Approx(40.0f));
+
+        // error 5: P 10, integral 50 -> I 25, D 10 * (5 - 10) / 2 = -25
+        REQUIRE(pid.Update(105.0f, 100.0f) == Catch::Approx(10.0f));
+    }
+
+    TEST_CASE("Pid: Update - anti-windup and output limits")
+    {
+        FloatPid pid(SimpleConfig());
+
+        for (int i = 0; i < 100; ++i)
+        {
+            REQUIRE(pid.Update(1000.0f, 20.0f) == 100.0f);
+        }
+        REQUIRE(pid.Integral() == 100.0f);
+
+        // Overshoot: integral unwinds from its limit rather than from thousands
+        REQUIRE(pid.Update(500.0f, 510.0f) == 0.0f);
+        REQUIRE(pid.Integral() == Catch::Approx(80.0f));
+    }
+
+    TEST_CASE("Pid: Update - feedforward")
+    {
+        FloatPid pid(SimpleConfig());
+
+        // On the setpoint the feedforward is the whole output
+        REQUIRE(pid.Update(100.0f, 100.0f, 35.0f) == Catch::Approx(35.0f));
+        REQUIRE(pid.Integral() == 0.0f);
+
+        // Added to the PID terms before the output limits
+        REQUIRE(pid.Update(110.0f, 100.0f, 35.0f) == Catch::Approx(100.0f));
+        REQUIRE(pid.Update(90.0f, 100.0f, 35.0f) == Catch::Approx(0.0f));
+    }
+
+    TEST_CASE("Pid: Reset and Configure")
+    {
+        FloatPid pid(SimpleConfig());
+        pid.Update(110.0f, 100.0f);
+
+        SECTION("Reset clears integral and last error")
+        {
+            pid.Reset();
+            REQUIRE(pid.Integral() == 0.0f);
+            REQUIRE(pid.Output() == 0.0f);
+            REQUIRE(pid.Update(110.0f, 100.0f) == Catch::Approx(80.0f));
+        }
+
+        SECTION("Configure keeps the integral")
+        {
+            pid.Configure(PidConfig::FromPreferences(Furnace::Preferences{}));
+            REQUIRE(pid.Integral() == Catch::Approx(20.0f));
+        }
+    }
+
+    TEST_CASE("Pid: fixed point tracks floating point")
+    {
+        PidConfig config = PidConfig::FromPreferences(Furnace::Preferences{});
+        FloatPid floatPid(config);
+        FixedPid fixedPid(config);
+
+        float kiln = 20.0f;
+        for (int i = 0; i < 200; ++i)
+        {
+            const float setpoint = 20.0f + static_cast<float>(i) * 2.0f;
+            const float floatOut = floatPid.Update(setpoint, kiln);
+            const float fixedOut = fixedPid.Update(Fixed16::FromFloat(setpoint), Fixed16::FromFloat(kiln)).ToFloat();
+            REQUIRE(fixedOut == Catch::Approx(floatOut).margin(0.05));
+            kiln += floatOut * 0.03f - (kiln - 20.0f) * 0.001f;
+        }
+    }
+
+    TEST_CASE("Pid: benchmark", "[.][benchmark]")
+    {
+        PidConfig config = PidConfig::FromPreferences(Furnace::Preferences{});
+        FloatPid floatPid(config);
+        FixedPid fixedPid(config);
+        float kiln = 400.0f;
+        Fixed16 fixedKiln = Fixed16::FromFloat(400.0f);
+
+        BENCHMARK("FloatPid::Update")
+        {
+            kiln += 0.01f;
+            return floatPid.Update(500.0f, kiln);
+        };
+
+        BENCHMARK("FixedPid::Update")
+        {
+            fixedKiln += Fixed16::FromRaw(655);
+            return fixedPid.Update(Fixed16::FromFloat(500.0f), fixedKiln);
+        };
+    }
+} //namespace HeatTreatFurnace::Test
@@ -0,0 +1,130 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "Sim/PidSweep.hpp"
+#include "Sim/WorkStealingPool.hpp"
+#include "SimFixtures.hpp"
+#include <atomic>
+#include <cmath>
+#include <string_view>
+#include <thread>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Sim;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        // A short bisque-like program: 4 h up to 600 °C and half an hour at temperature
+        constexpr std::string_view SHORT_FIRING = R"({ "segments": [
+            { "target": 600, "ramp_time": { "hours": 4 }, "dwell_time": { "minutes": 30 } }
+        ] })";
+    }
+
+    TEST_CASE("WorkStealingPool: every job runs once and idle workers steal")
+    {
+        WorkStealingPool pool(4);
+        REQUIRE(pool.WorkerCount() == 4);
+
+        constexpr size_t JOBS = 40;
+        std::array<std::atomic<int>, JOBS> runs{};
+        std::array<std::atomic<size_t>, JOBS> ranOn{};
+        // Worker 0's block is slow, so the others run out and take from it
+        pool.Run(JOBS, [&](size_t aWorker, size_t aJob)
+        {
+            if (aJob < JOBS / 4)
+            {
+                std::this_thread::sleep_for(5ms);
+            }
+            ranOn[aJob] = aWorker;
+            ++runs[aJob];
+        });
+
+        size_t movedOffWorker0 = 0;
+        for (size_t job = 0; job < JOBS; ++job)
+        {
+            REQUIRE(runs[job] == 1);
+            if (job < JOBS / 4 && ranOn[job] != 0)
+            {
+                ++movedOffWorker0;
+            }
+        }
+        REQUIRE(pool.StealCount() > 0);
+        REQUIRE(movedOffWorker0 > 0);
+
+        SECTION("One worker runs everything on the calling thread")
+        {
+            WorkStealingPool single(1);
+            const std::thread::id caller = std::this_thread::get_id();
+            size_t count = 0;
+            single.Run(5, [&](size_t aWorker, size_t)
+            {
+                REQUIRE(aWorker == 0);
+                REQUIRE(std::this_thread::get_id() == caller);
+                ++count;
+            });
+            REQUIRE(count == 5);
+            REQUIRE(single.StealCount() == 0);
+        }
+    }
+
+    TEST_CASE("PidSweep: ranks gains on the simulated kiln")
+    {
+        const std::vector<uint8_t> program = CompileProgram(SHORT_FIRING);
+        PidSweep sweep(SimPreferences(), ThermalParameters{});
+        // Sluggish, about what the autotuner gives, and far higher than the kiln needs
+        const std::array<float, 3> kp{0.2f, 3.0f, 60.0f};
+        const std::array<float, 1> ki{0.01f};
+        const std::array<float, 1> kd{0.0f};
+        sweep.AddGrid(kp, ki, kd);
+        SweepCandidate scheduled{{3.0f, 0.01f, 0.0f}, {}};
+        REQUIRE(Control::GainSchedule::Parse("200:2:0.01:0, 600:4:0.01:0", scheduled.schedule));
+        sweep.Add(scheduled);
+        REQUIRE(sweep.CandidateCount() == 4);
+
+        WorkStealingPool pool(2);
+        SweepReport report;
+        REQUIRE(sweep.Run(program, pool, report));
+        REQUIRE(report.runs.size() == 4);
+        for (size_t i = 0; i < report.runs.size(); ++i)
+        {
+            REQUIRE(report.runs[i].state == Furnace::StateId::COMPLETED);
+            REQUIRE(std::isfinite(report.runs[i].score));
+            REQUIRE(report.runs[i].stats.energyKWh > 0.0f);
+            REQUIRE(report.runs[i].stats.relaySwitches > 0);
+            if (i > 0)
+            {
+                REQUIRE(report.runs[i - 1].score <= report.runs[i].score);
+            }
+        }
+        REQUIRE(report.runs.back().candidate.gains.kp == 60.0f);
+        REQUIRE(report.runs.front().stats.meanTrackingError < report.runs.front().stats.maxTrackingError);
+
+        // Four 4.5 hour firings
+        REQUIRE(std::abs(report.simulatedHours - 18.0) < 0.01);
+        REQUIRE(report.FiringHoursPerSecond() > 0.0);
+
+        SECTION("A run that doesn't complete ranks last")
+        {
+            REQUIRE(std::isinf(PidSweep::Score(report.runs.front().stats, Furnace::StateId::ERROR, {})));
+        }
+
+        SECTION("Invalid schedules and programs are refused before anything runs")
+        {
+            SweepCandidate unsorted;
+            REQUIRE(Control::GainSchedule::Parse("600:4:0.01:0, 200:2:0.01:0", unsorted.schedule));
+            sweep.Add(unsorted);
+            REQUIRE_FALSE(sweep.Run(program, pool, report).success);
+
+            PidSweep empty(SimPreferences(), ThermalParameters{});
+            const std::vector<uint8_t> garbage(64, 0xA5);
+            REQUIRE_FALSE(empty.Run(garbage, pool, report).success);
+
+            // 600 °C in an hour needs more than the 3 kW Kiln_Heater_Power
+            const std::vector<uint8_t> tooFast = CompileProgram(R"({ "segments": [
+                { "target": 600, "ramp_time": { "hours": 1 }, "dwell_time": { "minutes": 30 } }
+            ] })");
+            REQUIRE_FALSE(empty.Run(tooFast, pool, report).success);
+        }
+    }
+} //namespace HeatTreatFurnace::Test
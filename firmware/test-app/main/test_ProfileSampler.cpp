@@ -0,0 +1,127 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Furnace/Profile.hpp"
+#include "Program/ProfileSampler.hpp"
+#include "Program/ProgramJson.hpp"
+#include <format>
+#include <string>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Furnace;
+    using namespace HeatTreatFurnace::Program;
+
+    namespace
+    {
+        Profile MakeProfile(std::string_view aJson)
+        {
+            std::vector<uint8_t> compiled;
+            REQUIRE(ProgramJson::Import(aJson, compiled));
+            Profile profile;
+            REQUIRE(profile.Load("test.json", std::move(compiled)));
+            return profile;
+        }
+
+        Profile MakeLongProfile(int aSegments)
+        {
+            std::string json = R"({ "segments": [)";
+            for (int i = 0; i < aSegments; ++i)
+            {
+                json += i == 0 ? "" : ",";
+                json += std::format(R"({{"target":{},"ramp_time":{{"minutes":30}},"dwell_time":{{"minutes":5}}}})", 100 + (i % 10) * 50);
+            }
+            json += "] }";
+            return MakeProfile(json);
+        }
+    }
+
+    TEST_CASE("ProfileSampler: emits only the vertices of the setpoint curve")
+    {
+        Profile profile = MakeProfile(R"({ "segments": [
+            { "target": 100, "ramp_time": { "hours": 1 }, "dwell_time": { "minutes": 30 } },
+            { "target": 500, "ramp_time": {}, "dwell_time": { "hours": 1 } },
+            { "target": 500, "ramp_time": {}, "dwell_time": { "minutes": 15 } },
+            { "target": 200, "ramp_time": { "hours": 2 }, "dwell_time": {} }
+        ] })");
+
+        std::vector<float> points;
+        ProfileSampler::Sample(profile, 20.0f, 0, points);
+
+        const std::vector<float> expected = {
+            0.0f, 20.0f,
+            60.0f, 100.0f,
+            90.0f, 100.0f,
+            90.0f, 500.0f, // step
+            150.0f, 500.0f,
+            165.0f, 500.0f, // repeated target adds only its dwell
+            285.0f, 200.0f
+        };
+        REQUIRE(points == expected);
+    }
+
+    TEST_CASE("ProfileSampler: decimates long programs to the requested number of points")
+    {
+        Profile profile = MakeLongProfile(100);
+
+        std::vector<float> all;
+        ProfileSampler::Sample(profile, 20.0f, 0, all);
+        REQUIRE(all.size() == 201 * ProfileSampler::FLOATS_PER_POINT);
+
+        std::vector<float> points;
+        ProfileSampler::Sample(profile, 20.0f, 50, points);
+        REQUIRE(points.size() == 50 * ProfileSampler::FLOATS_PER_POINT);
+
+        // Ends are kept and time only moves forward
+        REQUIRE(points[0] == all[0]);
+        REQUIRE(points[1] == all[1]);
+        REQUIRE(points[points.size() - 2] == all[all.size() - 2]);
+        REQUIRE(points.back() == all.back());
+        for (size_t i = ProfileSampler::FLOATS_PER_POINT; i < points.size(); i += ProfileSampler::FLOATS_PER_POINT)
+        {
+            REQUIRE(points[i] >= points[i - ProfileSampler::FLOATS_PER_POINT]);
+        }
+
+        SECTION("Fewer points than asked for are returned as is")
+        {
+            ProfileSampler::Sample(profile, 20.0f, 500, points);
+            REQUIRE(points == all);
+        }
+
+        SECTION("Two points are the ends")
+        {
+            ProfileSampler::Sample(profile, 20.0f, 2, points);
+            REQUIRE(points == std::vector<float>{all[0], all[1], all[all.size() - 2], all.back()});
+        }
+    }
+
+    TEST_CASE("ProfileSampler: Encode - ProgramPreviewResponse")
+    {
+        const std::vector<float> points = {0.0f, 20.0f, 60.0f, 100.0f};
+        flatbuffers::FlatBufferBuilder builder;
+        builder.Finish(ProfileSampler::Encode(builder, "bisque.json", points));
+
+        auto response = flatbuffers::GetRoot<::Furnace::ProgramPreviewResponse>(builder.GetBufferPointer());
+        REQUIRE(response->name()->string_view() == "bisque.json");
+        REQUIRE(response->points()->size() == 4);
+        REQUIRE(response->points()->Get(3) == 100.0f);
+    }
+
+    TEST_CASE("ProfileSampler: benchmark", "[.][benchmark]")
+    {
+        Profile profile = MakeLongProfile(120);
+        std::vector<float> points;
+
+        BENCHMARK("Sample 120 segments, every vertex")
+        {
+            ProfileSampler::Sample(profile, 20.0f, 0, points);
+            return points.size();
+        };
+
+        BENCHMARK("Sample 120 segments, 64 points")
+        {
+            ProfileSampler::Sample(profile, 20.0f, 64, points);
+            return points.size();
+        };
+    }
+} //namespace HeatTreatFurnace::Test
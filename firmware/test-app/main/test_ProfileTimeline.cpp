@@ -0,0 +1,195 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Furnace/Profile.hpp"
+#include "Program/ProfileTimeline.hpp"
+#include "Program/ProgramJson.hpp"
+#include <format>
+#include <string>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Furnace;
+    using namespace HeatTreatFurnace::Program;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        // 0-60min ramp to 100, 60-90 dwell; 90-150 ramp to 400, 150-210 dwell; 210 step to 600, 210-240 dwell
+        constexpr std::string_view TIMELINE_JSON = R"({ "segments": [
+            { "target": 100, "ramp_time": { "hours": 1 }, "dwell_time": { "minutes": 30 } },
+            { "target": 400, "ramp_time": { "hours": 1 }, "dwell_time": { "hours": 1 } },
+            { "target": 600, "ramp_time": {}, "dwell_time": { "minutes": 30 } }
+        ] })";
+
+        Profile MakeProfile(std::string_view aJson)
+        {
+            std::vector<uint8_t> compiled;
+            REQUIRE(ProgramJson::Import(aJson, compiled));
+            Profile profile;
+            REQUIRE(profile.Load("test.json", std::move(compiled)));
+            return profile;
+        }
+    }
+
+    TEST_CASE("ProfileTimeline: segment timing")
+    {
+        Profile profile = MakeProfile(TIMELINE_JSON);
+        ProfileTimeline timeline(profile);
+
+        REQUIRE(timeline.TotalDuration() == 4h);
+        REQUIRE(timeline.SegmentStart(0) == 0min);
+        REQUIRE(timeline.SegmentStart(1) == 90min);
+        REQUIRE(timeline.SegmentStart(2) == 210min);
+    }
+
+    TEST_CASE("ProfileTimeline: Seek - phases and remaining time")
+    {
+        Profile profile = MakeProfile(TIMELINE_JSON);
+        ProfileTimeline timeline(profile);
+
+        SECTION("Start of the program ramps from the kiln temperature")
+        {
+            TimelinePosition position = timeline.Seek(0min, 25.0f);
+            REQUIRE(position.segment == 0);
+            REQUIRE(position.phase == SegmentPhase::RAMP);
+            REQUIRE(position.setpoint == 25.0f);
+            REQUIRE(position.remainingRamp == 1h);
+            REQUIRE(position.remainingDwell == 30min);
+            REQUIRE(position.remainingProgram == 4h);
+        }
+
+        SECTION("Dwell")
+        {
+            TimelinePosition position = timeline.Seek(170min, 390.0f);
+            REQUIRE(position.segment == 1);
+            REQUIRE(position.phase == SegmentPhase::DWELL);
+            REQUIRE(position.setpoint == 400.0f);
+            REQUIRE(position.remainingRamp == 0min);
+            REQUIRE(position.remainingDwell == 40min);
+            REQUIRE(position.remainingProgram == 70min);
+        }
+
+        SECTION("Segment boundary belongs to the next segment")
+        {
+            TimelinePosition position = timeline.Seek(90min, 100.0f);
+            REQUIRE(position.segment == 1);
+            REQUIRE(position.phase == SegmentPhase::RAMP);
+            REQUIRE(position.remainingRamp == 1h);
+        }
+
+        SECTION("Step segment goes straight to its dwell")
+        {
+            TimelinePosition position = timeline.Seek(215min, 420.0f);
+            REQUIRE(position.segment == 2);
+            REQUIRE(position.phase == SegmentPhase::DWELL);
+            REQUIRE(position.setpoint == 600.0f);
+            REQUIRE(position.remainingDwell == 25min);
+        }
+
+        SECTION("Past the end")
+        {
+            TimelinePosition position = timeline.Seek(4h, 600.0f);
+            REQUIRE(position.segment == 3);
+            REQUIRE(position.phase == SegmentPhase::COMPLETE);
+            REQUIRE(position.setpoint == 0.0f);
+            REQUIRE(position.remainingProgram == 0min);
+        }
+    }
+
+    TEST_CASE("ProfileTimeline: Seek - re-anchors the ramp at the kiln temperature")
+    {
+        Profile profile = MakeProfile(TIMELINE_JSON);
+        ProfileTimeline timeline(profile);
+
+        SECTION("Kiln on the programmed ramp")
+        {
+            TimelinePosition position = timeline.Seek(120min, 250.0f);
+            REQUIRE(position.setpoint == Catch::Approx(250.0f));
+            REQUIRE(position.remainingRamp == 30min);
+        }
+
+        SECTION("Kiln cooled below the ramp after a power cut")
+        {
+            // Programmed ramp is at 250°C; at 5°C/min 150°C is 20 minutes further back
+            TimelinePosition position = timeline.Seek(120min, 150.0f);
+            REQUIRE(position.phase == SegmentPhase::RAMP);
+            REQUIRE(position.rampFrom == 150.0f);
+            REQUIRE(position.setpoint == 150.0f);
+            REQUIRE(position.remainingRamp == 50min);
+            REQUIRE(position.remainingProgram == 50min + 1h + 30min);
+        }
+
+        SECTION("Kiln cooled below where the ramp started")
+        {
+            TimelinePosition position = timeline.Seek(120min, 50.0f);
+            REQUIRE(position.setpoint == 50.0f);
+            REQUIRE(position.remainingRamp == 70min);
+        }
+
+        SECTION("Kiln already past the target")
+        {
+            TimelinePosition position = timeline.Seek(120min, 410.0f);
+            REQUIRE(position.phase == SegmentPhase::DWELL);
+            REQUIRE(position.setpoint == 400.0f);
+            REQUIRE(position.remainingDwell == 1h);
+        }
+    }
+
+    TEST_CASE("ProfileTimeline: SeekStart - StartCommand segment and minute")
+    {
+        Profile profile = MakeProfile(TIMELINE_JSON);
+        ProfileTimeline timeline(profile);
+
+        REQUIRE(timeline.SeekStart(0, 0, 20.0f).segment == 0);
+        REQUIRE(timeline.SeekStart(2, 0, 100.0f).segment == 1);
+        REQUIRE(timeline.SeekStart(2, 0, 100.0f).remainingRamp == 1h);
+        REQUIRE(timeline.SeekStart(0, 100, 150.0f).segment == 1);
+        REQUIRE(timeline.SeekStart(3, 100, 150.0f).segment == 2);
+        REQUIRE(timeline.SeekStart(0, 240, 20.0f).phase == SegmentPhase::COMPLETE);
+        REQUIRE(timeline.SeekStart(9, 0, 20.0f).phase == SegmentPhase::COMPLETE);
+    }
+
+    TEST_CASE("ProfileTimeline: SetpointAt - programmed setpoint and slope")
+    {
+        Profile profile = MakeProfile(TIMELINE_JSON);
+        ProfileTimeline timeline(profile);
+
+        // First ramp from the start temperature, 80 °C over an hour
+        REQUIRE(timeline.SetpointAt(0min, 20.0f).setpoint == 20.0f);
+        REQUIRE(timeline.SetpointAt(30min, 20.0f).setpoint == Catch::Approx(60.0f));
+        REQUIRE(timeline.SetpointAt(30min, 20.0f).slope == Catch::Approx(80.0f / 3600.0f));
+
+        // Dwell, then the second ramp from the first target: 300 °C over an hour
+        REQUIRE(timeline.SetpointAt(75min, 20.0f).setpoint == 100.0f);
+        REQUIRE(timeline.SetpointAt(75min, 20.0f).slope == 0.0f);
+        REQUIRE(timeline.SetpointAt(120min, 20.0f).setpoint == Catch::Approx(250.0f));
+        REQUIRE(timeline.SetpointAt(120min, 20.0f).slope == Catch::Approx(300.0f / 3600.0f));
+
+        // A step has no ramp to follow; past the end there's no setpoint
+        REQUIRE(timeline.SetpointAt(210min, 20.0f).setpoint == 600.0f);
+        REQUIRE(timeline.SetpointAt(210min, 20.0f).slope == 0.0f);
+        REQUIRE(timeline.SetpointAt(4h, 20.0f).setpoint == 0.0f);
+    }
+
+    TEST_CASE("ProfileTimeline: benchmark", "[.][benchmark]")
+    {
+        std::string json = R"({ "segments": [)";
+        for (int i = 0; i < 96; ++i)
+        {
+            json += i == 0 ? "" : ",";
+            json += std::format(R"({{ "target": {}, "ramp_time": {{ "hours": 1 }}, "dwell_time": {{ "minutes": 10 }} }})", 100 + (i % 8) * 100);
+        }
+        json += "] }";
+        Profile profile = MakeProfile(json);
+        ProfileTimeline timeline(profile);
+        std::chrono::milliseconds offset{0};
+
+        BENCHMARK("Seek 96 segments")
+        {
+            offset = (offset + 7919s) % timeline.TotalDuration();
+            return timeline.Seek(offset, 300.0f);
+        };
+    }
+} //namespace HeatTreatFurnace::Test
@@ -0,0 +1,358 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "Furnace/Profile.hpp"
+#include "Program/ProgramJson.hpp"
+#include "Program/ProgramStore.hpp"
+#include "Log/LogService.hpp"
+#include "Log/LogBackend.hpp"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Furnace;
+    using namespace HeatTreatFurnace::Program;
+    using namespace HeatTreatFurnace::Log;
+    using namespace std::chrono_literals;
+
+    constexpr std::string_view BISQUE_JSON = R"({
+  "description": "Cone 06 bisque firing",
+  "segments": [
+    {
+      "target": 93,
+      "ramp_time": { "hours": 1, "minutes": 0, "seconds": 0 },
+      "dwell_time": { "hours": 1, "minutes": 0, "seconds": 0 }
+    },
+    {
+      "target": 537.5,
+      "ramp_time": { "hours": 2, "minutes": 30 },
+      "dwell_time": { "seconds": 45 }
+    }
+  ]
+})";
+
+    TEST_CASE("ProgramJson: Import - compiles editor JSON into a loadable program")
+    {
+        std::vector<uint8_t> compiled;
+        REQUIRE(ProgramJson::Import(BISQUE_JSON, compiled));
+
+        Profile profile;
+        REQUIRE(profile.Load("bisque.json", std::move(compiled)));
+        REQUIRE(profile.Name() == "bisque.json");
+        REQUIRE(profile.Description() == "Cone 06 bisque firing");
+        REQUIRE(profile.SegmentCount() == 2);
+
+        ProfileSegment first = profile.Segment(0);
+        REQUIRE(first.target == 93.0f);
+        REQUIRE(first.rampTime == 1h);
+        REQUIRE(first.dwellTime == 1h);
+
+        ProfileSegment second = profile.Segment(1);
+        REQUIRE(second.target == 537.5f);
+        REQUIRE(second.rampTime == 2h + 30min);
+        REQUIRE(second.dwellTime == 45s);
+    }
+
+    TEST_CASE("ProgramJson: Import - rejects malformed programs")
+    {
+        std::vector<uint8_t> compiled;
+
+        SECTION("Not JSON")
+        {
+            REQUIRE_FALSE(ProgramJson::Import("500:60:30", compiled));
+        }
+
+        SECTION("Missing segments")
+        {
+            REQUIRE_FALSE(ProgramJson::Import(R"({ "description": "empty" })", compiled));
+        }
+
+        SECTION("Segment missing a field")
+        {
+            REQUIRE_FALSE(ProgramJson::Import(R"({ "segments": [ { "target": 100, "ramp_time": {} } ] })", compiled));
+        }
+
+        SECTION("Negative time")
+        {
+            Result res = ProgramJson::Import(R"({ "segments": [ { "target": 100, "ramp_time": { "minutes": -5 }, "dwell_time": {} } ] })", compiled);
+            REQUIRE_FALSE(res);
+            REQUIRE(res.message == "Time values must be non-negative numbers");
+        }
+
+        SECTION("Trailing garbage")
+        {
+            REQUIRE_FALSE(ProgramJson::Import(R"({ "segments": [] } x)", compiled));
+        }
+
+        SECTION("Numbers JSON doesn't have")
+        {
+            REQUIRE_FALSE(ProgramJson::Import(R"({ "segments": [ { "target": nan, "ramp_time": {}, "dwell_time": {} } ] })", compiled));
+            REQUIRE_FALSE(ProgramJson::Import(R"({ "segments": [ { "target": 100, "ramp_time": { "hours": inf }, "dwell_time": {} } ] })", compiled));
+        }
+    }
+
+    TEST_CASE("ProgramJson: Import - times past a 32 bit long")
+    {
+        // 1,000,000 hours is 3.6e9 seconds: a uint32_t, but more than long holds on the ESP32
+        std::vector<uint8_t> compiled;
+        REQUIRE(ProgramJson::Import(R"({ "segments": [ { "target": 100, "ramp_time": { "hours": 1000000 }, "dwell_time": {} } ] })", compiled));
+        Profile profile;
+        REQUIRE(profile.Load("long.json", std::move(compiled)));
+        REQUIRE(profile.Segment(0).rampTime == std::chrono::hours(1000000));
+
+        REQUIRE_FALSE(ProgramJson::Import(R"({ "segments": [ { "target": 100, "ramp_time": { "hours": 2000000 }, "dwell_time": {} } ] })", compiled));
+    }
+
+    TEST_CASE("ProgramJson: Export - round trips through the compiled format")
+    {
+        std::vector<uint8_t> compiled;
+        REQUIRE(ProgramJson::Import(R"({ "description": "Line1\nLine \"2\"", "extra": [1, {"a": null}], "segments": [
+            { "target": 1000, "ramp_time": { "hours": 3, "minutes": 15, "seconds": 30 }, "dwell_time": { "minutes": 20 } } ] })", compiled));
+
+        Profile profile;
+        REQUIRE(profile.Load("roundtrip.json", std::move(compiled)));
+
+        std::string json;
+        REQUIRE(ProgramJson::Export(profile, json));
+
+        std::vector<uint8_t> recompiled;
+        REQUIRE(ProgramJson::Import(json, recompiled));
+
+        Profile reloaded;
+        REQUIRE(reloaded.Load("roundtrip.json", std::move(recompiled)));
+        REQUIRE(reloaded.Description() == "Line1\nLine \"2\"");
+        REQUIRE(reloaded.SegmentCount() == 1);
+        REQUIRE(reloaded.Segment(0).target == 1000.0f);
+        REQUIRE(reloaded.Segment(0).rampTime == 3h + 15min + 30s);
+        REQUIRE(reloaded.Segment(0).dwellTime == 20min);
+    }
+
+    TEST_CASE("Profile: segments are read from the program buffer without copying")
+    {
+        std::vector<uint8_t> compiled;
+        REQUIRE(ProgramJson::Import(BISQUE_JSON, compiled));
+
+        SECTION("Load keeps the caller's allocation")
+        {
+            const uint8_t* data = compiled.data();
+            Profile profile;
+            REQUIRE(profile.Load("bisque.json", std::move(compiled)));
+            REQUIRE(profile.Buffer().data() == data);
+
+            Profile moved = std::move(profile);
+            REQUIRE(moved.Buffer().data() == data);
+            REQUIRE(moved.SegmentCount() == 2);
+            REQUIRE_FALSE(profile.IsLoaded());
+        }
+
+        SECTION("Map borrows the buffer")
+        {
+            Profile profile;
+            REQUIRE(profile.Map("bisque.json", compiled));
+            REQUIRE(profile.Buffer().data() == compiled.data());
+            REQUIRE(profile.Segment(1).target == 537.5f);
+        }
+
+        SECTION("Corrupt buffers are rejected")
+        {
+            compiled.resize(compiled.size() / 2);
+            Profile profile;
+            REQUIRE_FALSE(profile.Load("bisque.json", std::move(compiled)));
+            REQUIRE_FALSE(profile.IsLoaded());
+        }
+    }
+
+    class ProgramStoreFixture
+    {
+    public:
+        ProgramStoreFixture() :
+            myDirectory(std::filesystem::temp_directory_path() / "furnace_program_store")
+        {
+            std::filesystem::remove_all(myDirectory);
+            std::filesystem::create_directories(myDirectory);
+            myLog = std::make_shared<LogService>(&myNullLogBackend);
+        }
+
+        ~ProgramStoreFixture()
+        {
+            std::filesystem::remove_all(myDirectory);
+        }
+
+        std::filesystem::path myDirectory;
+        NullLogBackend myNullLogBackend;
+        std::shared_ptr<LogService> myLog;
+    };
+
+    TEST_CASE_METHOD(ProgramStoreFixture, "ProgramStore: Save, Load, Read and Remove")
+    {
+        ProgramStore store(myDirectory.string(), *myLog);
+
+        REQUIRE(store.Save("bisque.json", BISQUE_JSON));
+        REQUIRE(std::filesystem::exists(myDirectory / "bisque.fbp"));
+
+        Profile profile;
+        REQUIRE(store.Load("bisque.json", profile));
+        REQUIRE(profile.SegmentCount() == 2);
+
+        std::string json;
+        REQUIRE(store.Read("bisque.json", json));
+        REQUIRE(json.find("\"target\": 537.5") != std::string::npos);
+
+        REQUIRE(store.Remove("bisque.json"));
+        REQUIRE_FALSE(store.Load("bisque.json", profile));
+    }
+
+    TEST_CASE_METHOD(ProgramStoreFixture, "ProgramStore: rejects names outside the API constraints")
+    {
+        ProgramStore store(myDirectory.string(), *myLog);
+
+        REQUIRE(ProgramStore::IsValidName("program_1.json"));
+        REQUIRE_FALSE(ProgramStore::IsValidName("program1.txt"));
+        REQUIRE_FALSE(ProgramStore::IsValidName("../etc.json"));
+        REQUIRE_FALSE(ProgramStore::IsValidName("a_very_long_program_name.json"));
+        REQUIRE_FALSE(store.Save("bad name.json", BISQUE_JSON));
+    }
+
+    TEST_CASE_METHOD(ProgramStoreFixture, "ProgramStore: invalid JSON is not written")
+    {
+        ProgramStore store(myDirectory.string(), *myLog);
+
+        REQUIRE_FALSE(store.Save("broken.json", "{"));
+        REQUIRE_FALSE(std::filesystem::exists(myDirectory / "broken.fbp"));
+    }
+
+    TEST_CASE_METHOD(ProgramStoreFixture, "ProgramStore: List gives every stored program by name")
+    {
+        ProgramStore store(myDirectory.string(), *myLog);
+        std::vector<StoredProgram> programs;
+        REQUIRE(store.List(programs));
+        REQUIRE(programs.empty());
+
+        REQUIRE(store.Save("glaze.json", BISQUE_JSON));
+        REQUIRE(store.Save("bisque.json", BISQUE_JSON));
+        // Neither is a program
+        std::filesystem::create_directory(myDirectory / "notes.fbp");
+        std::ofstream(myDirectory / "bisque.fbp.tmp") << "half written";
+
+        REQUIRE(store.List(programs));
+        REQUIRE(programs.size() == 2);
+        REQUIRE(programs[0].name == "bisque.json");
+        REQUIRE(programs[1].name == "glaze.json");
+        REQUIRE(programs[0].size == std::filesystem::file_size(myDirectory / "bisque.fbp"));
+
+        REQUIRE(store.Remove("glaze.json"));
+        REQUIRE(store.List(programs));
+        REQUIRE(programs.size() == 1);
+
+        ProgramStore missing((myDirectory / "missing").string(), *myLog);
+        REQUIRE_FALSE(missing.List(programs).success);
+    }
+
+    TEST_CASE_METHOD(ProgramStoreFixture, "ProgramStore: a save interrupted by a power cut is finished or discarded at startup")
+    {
+        {
+            ProgramStore store(myDirectory.string(), *myLog);
+            REQUIRE(store.Save("bisque.json", BISQUE_JSON));
+            REQUIRE(store.Save("glaze.json", BISQUE_JSON));
+            REQUIRE_FALSE(std::filesystem::exists(myDirectory / "bisque.fbp.tmp"));
+        }
+
+        // Cut after the old glaze.fbp was removed for the rename, during a write of new.fbp, and before bisque.fbp was replaced
+        std::filesystem::rename(myDirectory / "glaze.fbp", myDirectory / "glaze.fbp.tmp");
+        std::ofstream(myDirectory / "new.fbp.tmp") << "half written";
+        std::filesystem::copy_file(myDirectory / "bisque.fbp", myDirectory / "bisque.fbp.tmp");
+
+        ProgramStore store(myDirectory.string(), *myLog);
+        Profile profile;
+        REQUIRE(store.Load("glaze.json", profile));
+        REQUIRE(profile.SegmentCount() == 2);
+        REQUIRE(store.Load("bisque.json", profile));
+        REQUIRE_FALSE(std::filesystem::exists(myDirectory / "glaze.fbp.tmp"));
+        REQUIRE_FALSE(std::filesystem::exists(myDirectory / "new.fbp.tmp"));
+        REQUIRE_FALSE(std::filesystem::exists(myDirectory / "bisque.fbp.tmp"));
+        REQUIRE_FALSE(std::filesystem::exists(myDirectory / "new.fbp"));
+    }
+
+    TEST_CASE_METHOD(ProgramStoreFixture, "ProgramStore: programs are served from the cache until saved or removed")
+    {
+        ProgramStore store(myDirectory.string(), *myLog);
+        REQUIRE(store.Save("bisque.json", BISQUE_JSON));
+
+        // Delete the file behind the store's back; the cached copy is still served
+        std::filesystem::remove(myDirectory / "bisque.fbp");
+
+        std::string description;
+        REQUIRE(store.Describe("bisque.json", description));
+        REQUIRE(description == "Cone 06 bisque firing");
+        Profile profile;
+        REQUIRE(store.Load("bisque.json", profile));
+        REQUIRE(store.GetCacheStats().hits == 2);
+        REQUIRE(store.GetCacheStats().misses == 0);
+
+        SECTION("Saving the same program again does not rewrite it")
+        {
+            REQUIRE(store.Save("bisque.json", BISQUE_JSON));
+            REQUIRE_FALSE(std::filesystem::exists(myDirectory / "bisque.fbp"));
+        }
+
+        SECTION("Saving a change replaces the cached program")
+        {
+            REQUIRE(store.Save("bisque.json", R"({ "description": "Changed", "segments": [ { "target": 100, "ramp_time": { "hours": 1 }, "dwell_time": {} } ] })"));
+            REQUIRE(std::filesystem::exists(myDirectory / "bisque.fbp"));
+            REQUIRE(store.Describe("bisque.json", description));
+            REQUIRE(description == "Changed");
+        }
+
+        SECTION("Removing invalidates the cache")
+        {
+            REQUIRE_FALSE(store.Remove("bisque.json"));
+            REQUIRE_FALSE(store.Load("bisque.json", profile));
+            REQUIRE(store.GetCacheStats().misses == 1);
+        }
+    }
+
+    TEST_CASE_METHOD(ProgramStoreFixture, "ProgramStore: reads are cached after the first miss")
+    {
+        ProgramStore writer(myDirectory.string(), *myLog);
+        REQUIRE(writer.Save("bisque.json", BISQUE_JSON));
+
+        ProgramStore store(myDirectory.string(), *myLog);
+        std::string json;
+        REQUIRE(store.Read("bisque.json", json));
+        REQUIRE(store.Read("bisque.json", json));
+        REQUIRE(store.GetCacheStats().misses == 1);
+        REQUIRE(store.GetCacheStats().hits == 1);
+
+        ProgramStore uncached(myDirectory.string(), *myLog, 0);
+        REQUIRE(uncached.Read("bisque.json", json));
+        REQUIRE(uncached.Read("bisque.json", json));
+        REQUIRE(uncached.GetCacheStats().hits == 0);
+        REQUIRE(uncached.GetCacheStats().entries == 0);
+    }
+
+    TEST_CASE("ProgramCache: evicts least recently used programs to stay within budget")
+    {
+        const std::vector<uint8_t> program(1000, 0xAA);
+        ProgramCache cache(3500);
+
+        cache.Insert("a.json", 1, program);
+        cache.Insert("b.json", 2, program);
+        cache.Insert("c.json", 3, program);
+        REQUIRE(cache.GetStats().entries == 3);
+        REQUIRE(cache.GetStats().bytes <= 3500);
+
+        REQUIRE(cache.Find("a.json") != nullptr);
+        cache.Insert("d.json", 4, program);
+
+        REQUIRE(cache.GetStats().evictions == 1);
+        REQUIRE(cache.Contains("a.json", 1));
+        REQUIRE_FALSE(cache.Contains("a.json", 2));
+        REQUIRE(cache.Find("b.json") == nullptr);
+        REQUIRE(cache.Find("d.json") != nullptr);
+
+        cache.Insert("huge.json", 5, std::vector<uint8_t>(4000));
+        REQUIRE(cache.Find("huge.json") == nullptr);
+        REQUIRE(cache.GetStats().entries == 3);
+    }
+}
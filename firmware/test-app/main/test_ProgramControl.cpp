@@ -0,0 +1,262 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "Log/LogBackend.hpp"
+#include "Log/LogService.hpp"
+#include "Sim/FurnaceSimulator.hpp"
+#include "Sim/ThermalModel.hpp"
+#include "SimFixtures.hpp"
+#include <cmath>
+#include <functional>
+#include <string_view>
+
+// The firmware's side of bdd/program-control.feature: each hours-long firing runs on the simulated kiln
+// in virtual time, with the user's actions set as clock timers.
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Sim;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        // Three segments, 8 hours: 200 °C in 1 h for 30 min, 500 °C in 2 h for 1 h, cooling to 400 °C over 3 h for 30 min
+        constexpr std::string_view PROGRAM1 = R"({ "segments": [
+            { "target": 200, "ramp_time": { "hours": 1 }, "dwell_time": { "minutes": 30 } },
+            { "target": 500, "ramp_time": { "hours": 2 }, "dwell_time": { "hours": 1 } },
+            { "target": 400, "ramp_time": { "hours": 3 }, "dwell_time": { "minutes": 30 } }
+        ] })";
+
+        ThermalParameters KilnAt(float aTemperature)
+        {
+            ThermalParameters kiln;
+            kiln.ambientTemperature = aTemperature;
+            return kiln;
+        }
+    }
+
+    class ProgramControlFixture
+    {
+    public:
+        ProgramControlFixture() :
+            myLog(&myNullLogBackend), mySimulator(SimPreferences(), KilnAt(25.0f), myLog)
+        {
+            // Until the sample pipeline has published there's nothing to load against
+            mySimulator.RunFor(10s);
+        }
+
+        Furnace::Result Load(std::string_view aName = "program1.json", std::string_view aJson = PROGRAM1)
+        {
+            return StateMachine().LoadProfile(MakeProfile(aName, aJson), Reading());
+        }
+
+        Furnace::Result Start()
+        {
+            return StateMachine().StartProfile(0, 0, Reading());
+        }
+
+        [[nodiscard]] float Reading() const
+        {
+            return mySimulator.GetPublisher().Latest().kilnTemperature;
+        }
+
+        Furnace::StateMachine& StateMachine()
+        {
+            return mySimulator.GetStateMachine();
+        }
+
+        /** @brief What the last broadcast would say */
+        [[nodiscard]] Furnace::StateSnapshot Broadcast()
+        {
+            return StateMachine().GetStateSnapshot().Read();
+        }
+
+        /** @brief At aTime after now, have the control loop do aAction as a command handler would */
+        void At(std::chrono::microseconds aTime, Time::VirtualClock::TimerFunction aAction)
+        {
+            REQUIRE(mySimulator.GetClock().CallAt(mySimulator.GetClock().Now() + aTime, std::move(aAction)));
+        }
+
+        Log::NullLogBackend myNullLogBackend;
+        Log::LogService myLog;
+        FurnaceSimulator mySimulator;
+    };
+
+    TEST_CASE_METHOD(ProgramControlFixture, "Program control: load a program")
+    {
+        REQUIRE(Load());
+        mySimulator.RunFor(1s);
+        REQUIRE(Broadcast().state == Furnace::StateId::LOADED);
+        REQUIRE(Broadcast().ProgramName() == "program1.json");
+        REQUIRE(StateMachine().GetTimeline()->TotalDuration() == 8h);
+    }
+
+    TEST_CASE_METHOD(ProgramControlFixture, "Program control: start, and no load, start or clear while running")
+    {
+        REQUIRE(Load());
+        REQUIRE(Start());
+        mySimulator.RunFor(1s);
+        REQUIRE(Broadcast().state == Furnace::StateId::RUNNING);
+
+        REQUIRE_FALSE(Load("program2.json").success);
+        REQUIRE_FALSE(Start().success);
+        REQUIRE_FALSE(StateMachine().TransitionTo(Furnace::StateId::IDLE));
+        mySimulator.RunFor(1s);
+        REQUIRE(Broadcast().state == Furnace::StateId::RUNNING);
+        REQUIRE(Broadcast().ProgramName() == "program1.json");
+    }
+
+    TEST_CASE_METHOD(ProgramControlFixture, "Program control: the setpoint follows the segment schedule to the end")
+    {
+        REQUIRE(Load());
+        REQUIRE(Start());
+        const float start = Reading();
+
+        struct Sample
+        {
+            std::chrono::minutes at;
+            float setTemp;
+            int32_t segment;
+        };
+        // Every 15 minutes, each sample setting the timer for the next
+        std::vector<Sample> samples;
+        std::function<void()> sample = [&]
+        {
+            samples.push_back({15min * samples.size(), Broadcast().setTemp, Broadcast().segment});
+            if (samples.size() < 32)
+            {
+                At(15min, sample);
+            }
+        };
+        At(1s, sample);
+        REQUIRE(mySimulator.RunUntilDone(9h) == Furnace::StateId::COMPLETED);
+
+        const auto expected = [start](std::chrono::minutes aAt) -> std::pair<float, int32_t>
+        {
+            const float minutes = static_cast<float>(aAt.count());
+            if (aAt < 60min)
+            {
+                return {start + (200.0f - start) * minutes / 60.0f, 0};
+            }
+            if (aAt < 90min)
+            {
+                return {200.0f, 0};
+            }
+            if (aAt < 210min)
+            {
+                return {200.0f + 300.0f * (minutes - 90.0f) / 120.0f, 1};
+            }
+            if (aAt < 270min)
+            {
+                return {500.0f, 1};
+            }
+            if (aAt < 450min)
+            {
+                return {500.0f - 100.0f * (minutes - 270.0f) / 180.0f, 2};
+            }
+            return {400.0f, 2};
+        };
+
+        // Ramps interpolate linearly, dwells hold, and the step moves on as each segment ends
+        REQUIRE(samples.size() == 32);
+        for (const Sample& sample : samples)
+        {
+            const auto [setTemp, segment] = expected(sample.at);
+            INFO(sample.at.count() << " min");
+            REQUIRE(std::abs(sample.setTemp - setTemp) < 0.5f);
+            REQUIRE(sample.segment == segment);
+        }
+
+        // Finished: target 0, heater off and the kiln cooling
+        REQUIRE(mySimulator.GetStats().finished - StateMachine().GetProgramStart() < 8h + 2s);
+        mySimulator.RunFor(1s);
+        REQUIRE(Broadcast().state == Furnace::StateId::COMPLETED);
+        REQUIRE(Broadcast().setTemp == 0.0f);
+        const float finished = mySimulator.GetKiln().KilnTemperature();
+        mySimulator.RunFor(30min);
+        REQUIRE(mySimulator.GetKiln().HeaterPowerW() < 1.0f);
+        REQUIRE(mySimulator.GetKiln().KilnTemperature() < finished - 20.0f);
+    }
+
+    TEST_CASE_METHOD(ProgramControlFixture, "Program control: the first segment ramps from the kiln temperature")
+    {
+        Log::NullLogBackend nullLogBackend;
+        Log::LogService log(&nullLogBackend);
+        FurnaceSimulator simulator(SimPreferences(), KilnAt(50.0f), log);
+        simulator.RunFor(10s);
+
+        SECTION("With a ramp time")
+        {
+            REQUIRE(simulator.Fire(MakeProfile("ramp.json", R"({ "segments": [
+                { "target": 100, "ramp_time": { "minutes": 30 }, "dwell_time": { "minutes": 30 } }
+            ] })")));
+            simulator.RunFor(1s);
+            REQUIRE(std::abs(simulator.GetStateMachine().GetStateSnapshot().Read().setTemp - 50.0f) < 0.5f);
+            simulator.RunFor(15min);
+            REQUIRE(std::abs(simulator.GetStateMachine().GetStateSnapshot().Read().setTemp - 75.0f) < 0.5f);
+        }
+
+        SECTION("With no ramp time it jumps to the target")
+        {
+            REQUIRE(simulator.Fire(MakeProfile("jump.json", R"({ "segments": [
+                { "target": 100, "ramp_time": { "minutes": 0 }, "dwell_time": { "minutes": 30 } }
+            ] })")));
+            simulator.RunFor(1s);
+            REQUIRE(simulator.GetStateMachine().GetStateSnapshot().Read().setTemp == 100.0f);
+        }
+    }
+
+    TEST_CASE_METHOD(ProgramControlFixture, "Program control: pause holds the program and resume continues where it paused")
+    {
+        REQUIRE(Load());
+        REQUIRE(Start());
+
+        // Paused 2 hours in, in segment 2, for 3 hours
+        float pausedSetTemp = 0.0f;
+        At(2h, [this]
+        {
+            REQUIRE(StateMachine().TransitionTo(Furnace::StateId::PAUSED));
+        });
+        At(2h + 1s, [this, &pausedSetTemp]
+        {
+            REQUIRE(Broadcast().state == Furnace::StateId::PAUSED);
+            REQUIRE(Broadcast().segment == 1);
+            pausedSetTemp = Broadcast().setTemp;
+        });
+        At(4h, [this, &pausedSetTemp]
+        {
+            REQUIRE(Broadcast().setTemp == pausedSetTemp);
+            REQUIRE(std::abs(Reading() - pausedSetTemp) < 5.0f);
+            REQUIRE(StateMachine().GetProgramOffset() == 2h);
+        });
+        At(5h, [this]
+        {
+            REQUIRE(StateMachine().TransitionTo(Furnace::StateId::RUNNING));
+        });
+
+        const std::chrono::microseconds start = mySimulator.GetClock().Now();
+        REQUIRE(mySimulator.RunUntilDone(13h) == Furnace::StateId::COMPLETED);
+        REQUIRE(std::abs(pausedSetTemp - (200.0f + 300.0f * 30.0f / 120.0f)) < 0.5f);
+        REQUIRE(mySimulator.GetStats().finished - start >= 11h);
+        REQUIRE(mySimulator.GetStats().finished - start < 11h + 2s);
+    }
+
+    TEST_CASE_METHOD(ProgramControlFixture, "Program control: stop, then start again from the beginning")
+    {
+        REQUIRE(Load());
+        REQUIRE(Start());
+        mySimulator.RunFor(30min);
+        REQUIRE(StateMachine().TransitionTo(Furnace::StateId::CANCELLED));
+        mySimulator.RunFor(1s);
+        REQUIRE(Broadcast().state == Furnace::StateId::CANCELLED);
+        REQUIRE(Broadcast().setTemp == 0.0f);
+        mySimulator.RunFor(10min);
+        REQUIRE(mySimulator.GetKiln().HeaterPowerW() < 1.0f);
+
+        // Stopped, it can be cleared, then loaded and started again
+        REQUIRE(StateMachine().TransitionTo(Furnace::StateId::IDLE));
+        REQUIRE(Load());
+        REQUIRE(Start());
+        mySimulator.RunFor(1s);
+        REQUIRE(StateMachine().GetProgramOffset() < 2s);
+        REQUIRE(std::abs(Broadcast().setTemp - Reading()) < 1.0f);
+    }
+} //namespace HeatTreatFurnace::Test
@@ -0,0 +1,245 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Furnace/Preferences.hpp"
+#include "Furnace/Profile.hpp"
+#include "Program/ProgramJson.hpp"
+#include "Program/ProgramValidator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <string>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Furnace;
+    using namespace HeatTreatFurnace::Program;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        Profile MakeProfile(std::string_view aJson)
+        {
+            std::vector<uint8_t> compiled;
+            REQUIRE(ProgramJson::Import(aJson, compiled));
+            Profile profile;
+            REQUIRE(profile.Load("test.json", std::move(compiled)));
+            return profile;
+        }
+
+        bool HasViolation(const ValidationReport& aReport, ViolationCode aCode, uint16_t aSegment)
+        {
+            for (const Violation& violation : aReport.violations)
+            {
+                if (violation.code == aCode && violation.segment == aSegment)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    TEST_CASE("ProgramValidator: accepts an achievable bisque firing")
+    {
+        Profile profile = MakeProfile(R"({ "segments": [
+            { "target": 93, "ramp_time": { "hours": 1 }, "dwell_time": { "hours": 1 } },
+            { "target": 537, "ramp_time": { "hours": 2, "minutes": 30 }, "dwell_time": { "minutes": 30 } },
+            { "target": 400, "ramp_time": { "hours": 4 }, "dwell_time": {} }
+        ] })");
+
+        ProgramValidator validator;
+        ValidationReport report = validator.Validate(profile);
+
+        REQUIRE(report.IsValid());
+        REQUIRE(report.totalDuration == 9h);
+        REQUIRE(report.estimatedEnergyKWh > 0.0f);
+    }
+
+    TEST_CASE("ProgramValidator: reports every violation in one pass")
+    {
+        Profile profile = MakeProfile(R"({ "segments": [
+            { "target": 1400, "ramp_time": { "hours": 1 }, "dwell_time": {} },
+            { "target": 5, "ramp_time": { "hours": 10 }, "dwell_time": {} },
+            { "target": 600, "ramp_time": { "hours": 1 }, "dwell_time": {} }
+        ] })");
+
+        ProgramValidator validator;
+        ValidationReport report = validator.Validate(profile);
+
+        REQUIRE_FALSE(report.IsValid());
+        REQUIRE(HasViolation(report, ViolationCode::TARGET_ABOVE_MAX, 0));
+        REQUIRE(HasViolation(report, ViolationCode::RAMP_TOO_FAST, 0));
+        REQUIRE(HasViolation(report, ViolationCode::TARGET_BELOW_MIN, 1));
+        REQUIRE(HasViolation(report, ViolationCode::RAMP_TOO_FAST, 2));
+        REQUIRE_FALSE(HasViolation(report, ViolationCode::RAMP_TOO_FAST, 1));
+
+        Log::LogMessage message;
+        report.Describe(message);
+        REQUIRE(std::string(message.c_str()).find("Segment 1: target 1400°C is above MAX_Temperature 1350°C") != std::string::npos);
+        REQUIRE(std::string(message.c_str()).find("Segment 1: ramp of 1380°C/h exceeds MAX_Heating_Rate 180°C/h") != std::string::npos);
+    }
+
+    TEST_CASE("ProgramValidator: a zero ramp time is a step and is not rate limited")
+    {
+        Profile profile = MakeProfile(R"({ "segments": [ { "target": 500, "ramp_time": {}, "dwell_time": { "hours": 1 } } ] })");
+
+        ProgramValidator validator;
+        REQUIRE(validator.Validate(profile).IsValid());
+    }
+
+    TEST_CASE("ProgramValidator: ramps are measured from the start temperature")
+    {
+        Profile profile = MakeProfile(R"({ "segments": [ { "target": 500, "ramp_time": { "hours": 1 }, "dwell_time": {} } ] })");
+
+        ProgramValidator validator;
+        REQUIRE_FALSE(validator.Validate(profile).IsValid());
+        REQUIRE(validator.Validate(profile, 350.0f).IsValid());
+    }
+
+    TEST_CASE("ProgramValidator: physical feasibility against the kiln model")
+    {
+        Preferences prefs;
+        prefs.maxHeatingRate = 0.0f;
+        prefs.heaterPowerW = 1000.0f;
+        prefs.thermalMassJPerC = 36000.0f; // 10 Wh/°C
+        prefs.lossWPerC = 1.0f;
+        ProgramValidator validator(prefs);
+
+        SECTION("Ramp needs more power than the heater has")
+        {
+            // 200°C/h needs 2000W to raise the load alone
+            Profile profile = MakeProfile(R"({ "segments": [ { "target": 220, "ramp_time": { "hours": 1 }, "dwell_time": {} } ] })");
+            ValidationReport report = validator.Validate(profile);
+            REQUIRE(HasViolation(report, ViolationCode::RAMP_EXCEEDS_HEATER, 0));
+            REQUIRE(report.violations[0].value == Catch::Approx(2200.0f));
+        }
+
+        SECTION("Target can't be held against losses")
+        {
+            Profile profile = MakeProfile(R"({ "segments": [ { "target": 1100, "ramp_time": { "hours": 100 }, "dwell_time": { "hours": 1 } } ] })");
+            ValidationReport report = validator.Validate(profile);
+            REQUIRE(HasViolation(report, ViolationCode::TARGET_UNSUSTAINABLE, 0));
+            REQUIRE(HasViolation(report, ViolationCode::RAMP_EXCEEDS_HEATER, 0));
+        }
+
+        SECTION("Cooling faster than the kiln loses heat")
+        {
+            // Between 520 and 120°C the kiln loses 300W on average, 30°C/h
+            Profile profile = MakeProfile(R"({ "segments": [
+                { "target": 520, "ramp_time": {}, "dwell_time": {} },
+                { "target": 120, "ramp_time": { "hours": 10 }, "dwell_time": {} }
+            ] })");
+            ValidationReport report = validator.Validate(profile);
+            REQUIRE(HasViolation(report, ViolationCode::COOLING_TOO_FAST, 1));
+            REQUIRE(report.violations[0].value == Catch::Approx(40.0f));
+            REQUIRE(report.violations[0].limit == Catch::Approx(30.0f));
+        }
+
+        SECTION("Cooling to ambient at the rate the kiln manages on average")
+        {
+            Profile profile = MakeProfile(R"({ "segments": [
+                { "target": 520, "ramp_time": {}, "dwell_time": {} },
+                { "target": 20, "ramp_time": { "hours": 20 }, "dwell_time": {} }
+            ] })");
+            REQUIRE(validator.Validate(profile).IsValid());
+        }
+
+        SECTION("Every limit the kiln misses is reported, not just the first")
+        {
+            // 1100°C can't be held with 1000W, and 900°C/h is past both the heater and MAX_Heating_Rate
+            Preferences limited = prefs;
+            limited.maxHeatingRate = 300.0f;
+            validator.SetPreferences(limited);
+            Profile profile = MakeProfile(R"({ "segments": [ { "target": 1100, "ramp_time": { "hours": 1 }, "dwell_time": {} } ] })");
+            ValidationReport report = validator.Validate(profile, 200.0f);
+            REQUIRE(HasViolation(report, ViolationCode::TARGET_UNSUSTAINABLE, 0));
+            REQUIRE(HasViolation(report, ViolationCode::RAMP_TOO_FAST, 0));
+            REQUIRE(HasViolation(report, ViolationCode::RAMP_EXCEEDS_HEATER, 0));
+        }
+    }
+
+    TEST_CASE("ProgramValidator: the default preferences accept a ramp at MAX_Heating_Rate")
+    {
+        // A stress relief: MAX_Heating_Rate from ambient to 650°C, soaked, then a slow cool
+        const Preferences prefs;
+        const float rampHours = (650.0f - prefs.ambientTemperature) / prefs.maxHeatingRate;
+        const std::string json = std::format(R"({{ "segments": [
+            {{ "target": 650, "ramp_time": {{ "seconds": {} }}, "dwell_time": {{ "hours": 2 }} }},
+            {{ "target": 100, "ramp_time": {{ "hours": 24 }}, "dwell_time": {{}} }}
+        ] }})", std::ceil(rampHours * 3600.0f));
+        Profile profile = MakeProfile(json);
+
+        ProgramValidator validator;
+        ValidationReport report = validator.Validate(profile);
+        Log::LogMessage message;
+        report.Describe(message);
+        INFO(message.c_str());
+        REQUIRE(report.IsValid());
+    }
+
+    TEST_CASE("ProgramValidator: duration and energy limits")
+    {
+        Preferences prefs;
+        prefs.maxProgramHours = 10;
+        prefs.maxProgramEnergyKWh = 1.0f;
+        prefs.thermalMassJPerC = 36000.0f;
+        prefs.lossWPerC = 0.0f;
+        ProgramValidator validator(prefs);
+
+        // Raising 10 Wh/°C by 200°C stores 2kWh
+        Profile profile = MakeProfile(R"({ "segments": [ { "target": 220, "ramp_time": { "hours": 1 }, "dwell_time": { "hours": 11 } } ] })");
+        ValidationReport report = validator.Validate(profile);
+
+        REQUIRE(report.totalDuration == 12h);
+        REQUIRE(report.estimatedEnergyKWh == Catch::Approx(2.0f));
+        REQUIRE(HasViolation(report, ViolationCode::DURATION_TOO_LONG, 0));
+        REQUIRE(HasViolation(report, ViolationCode::ENERGY_TOO_HIGH, 0));
+    }
+
+    TEST_CASE("ProgramValidator: counts violations beyond the report capacity")
+    {
+        std::string json = R"({ "segments": [)";
+        for (size_t i = 0; i < MAX_VIOLATIONS + 4; ++i)
+        {
+            json += i == 0 ? "" : ",";
+            json += R"({ "target": 1400, "ramp_time": {}, "dwell_time": {} })";
+        }
+        json += "] }";
+
+        ProgramValidator validator;
+        ValidationReport report = validator.Validate(MakeProfile(json));
+
+        REQUIRE(report.violations.size() == MAX_VIOLATIONS);
+        REQUIRE(report.droppedViolations == 4);
+
+        // Far more than a message holds: the lines that fit, then a count of the rest
+        Log::LogMessage message;
+        report.Describe(message);
+        const std::string text(message.c_str());
+        const size_t lines = static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+        REQUIRE(text.starts_with("Segment 1: target 1400°C is above MAX_Temperature 1350°C\n"));
+        const std::string more = std::format("\n...and {} more", MAX_VIOLATIONS + 4 - lines);
+        REQUIRE(text.ends_with(more));
+        REQUIRE(message.size() < message.capacity());
+    }
+
+    TEST_CASE("ProgramValidator: benchmark", "[.][benchmark]")
+    {
+        std::string json = R"({ "segments": [)";
+        for (int i = 0; i < 64; ++i)
+        {
+            json += i == 0 ? "" : ",";
+            json += std::format(R"({{ "target": {}, "ramp_time": {{ "hours": 1 }}, "dwell_time": {{ "minutes": 10 }} }})", 100 + (i % 8) * 100);
+        }
+        json += "] }";
+        Profile profile = MakeProfile(json);
+        ProgramValidator validator;
+
+        BENCHMARK("Validate 64 segments")
+        {
+            return validator.Validate(profile, 20.0f);
+        };
+    }
+} //namespace HeatTreatFurnace::Test
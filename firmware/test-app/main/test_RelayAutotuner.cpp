@@ -0,0 +1,267 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "Control/Pid.hpp"
+#include "Control/RelayAutotuner.hpp"
+#include "Furnace/Furnace.hpp"
+#include "Furnace/StateMachine.hpp"
+#include "Log/LogBackend.hpp"
+#include "Log/LogService.hpp"
+#include "Sim/ThermalModel.hpp"
+#include "Time/Clock.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Control;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        constexpr std::chrono::milliseconds SAMPLE = 1000ms;
+
+        /** @brief Runs the autotune against aKiln until it stops; returns how long it took */
+        std::chrono::milliseconds RunAutotune(RelayAutotuner& aTuner, Sim::ThermalModel& aKiln)
+        {
+            std::chrono::milliseconds elapsed{0};
+            while (true)
+            {
+                const float heat = aTuner.Update(aKiln.SensorTemperature(), elapsed == 0ms ? 0ms : SAMPLE);
+                if (aTuner.GetStatus() != AutotuneStatus::RUNNING)
+                {
+                    return elapsed;
+                }
+                aKiln.Step(heat, SAMPLE);
+                elapsed += SAMPLE;
+            }
+        }
+
+        struct HoldStats
+        {
+            float overshoot = 0.0f;
+            float finalError = 0.0f;
+        };
+
+        /** @brief Heats aKiln to aSetpoint with aConfig for aDuration, the PID updating every sample time */
+        HoldStats RunPid(const PidConfig& aConfig, Sim::ThermalModel& aKiln, float aSetpoint, std::chrono::seconds aDuration)
+        {
+            FloatPid pid(aConfig);
+            HoldStats stats;
+            const std::chrono::milliseconds sample = aConfig.sampleTime;
+            for (std::chrono::milliseconds t{0}; t < aDuration; t += sample)
+            {
+                aKiln.Step(pid.Update(aSetpoint, aKiln.SensorTemperature()), sample);
+                stats.overshoot = std::max(stats.overshoot, aKiln.SensorTemperature() - aSetpoint);
+            }
+            stats.finalError = aKiln.SensorTemperature() - aSetpoint;
+            return stats;
+        }
+    }
+
+    TEST_CASE("RelayAutotuner: Start - rejects unsafe or meaningless configurations")
+    {
+        RelayAutotuner tuner;
+        AutotuneConfig config;
+
+        SECTION("Setpoint at MAX_Temperature")
+        {
+            config.setpoint = config.maxTemperature;
+            REQUIRE_FALSE(tuner.Start(config));
+        }
+
+        SECTION("No relay step")
+        {
+            config.outputStep = 0.0f;
+            REQUIRE_FALSE(tuner.Start(config));
+        }
+
+        SECTION("Runaway margin inside the hysteresis")
+        {
+            config.runawayMargin = config.hysteresis;
+            REQUIRE_FALSE(tuner.Start(config));
+        }
+
+        REQUIRE(tuner.GetStatus() == AutotuneStatus::IDLE);
+        REQUIRE(tuner.Update(20.0f, SAMPLE) == 0.0f);
+    }
+
+    TEST_CASE("RelayAutotuner: tunes the host thermal model end to end")
+    {
+        Sim::ThermalModel kiln;
+        RelayAutotuner tuner;
+        AutotuneConfig config;
+        config.setpoint = 300.0f;
+        REQUIRE(tuner.Start(config));
+
+        const std::chrono::milliseconds took = RunAutotune(tuner, kiln);
+        INFO(tuner.GetError().c_str());
+        REQUIRE(tuner.GetStatus() == AutotuneStatus::DONE);
+        REQUIRE(took < config.maxDuration);
+        REQUIRE(tuner.ConsistentCycles() == config.cycles);
+
+        const AutotuneResult& result = tuner.GetResult();
+        REQUIRE(result.ultimateGain > 0.0f);
+        REQUIRE(result.ultimatePeriod > 10s);
+        REQUIRE(result.ultimatePeriod < 30min);
+        REQUIRE(result.amplitude > config.hysteresis);
+
+        // The bias settles near the power that holds 300 °C, loss × ΔT / heater power
+        const float holding = 100.0f * 1.5f * (300.0f - 20.0f) / 3000.0f;
+        REQUIRE(std::abs(result.bias - holding) < 5.0f);
+
+        SECTION("The proposed gains hold the setpoint without much overshoot")
+        {
+            Sim::ThermalModel fresh;
+            const HoldStats stats = RunPid(tuner.ProposedConfig({}), fresh, 300.0f, 6h);
+            REQUIRE(stats.overshoot < 10.0f);
+            REQUIRE(std::abs(stats.finalError) < 1.0f);
+        }
+
+        SECTION("CheckSchedule compares PID_Schedule at the setpoint with the proposed gains")
+        {
+            const Furnace::PidBreakpoint proposed{300.0f, result.kp, result.ki, result.kd};
+            Furnace::PidSchedule schedule;
+            schedule.push_back({100.0f, proposed.kp, proposed.ki, proposed.kd});
+            schedule.push_back({500.0f, proposed.kp, proposed.ki, proposed.kd});
+            REQUIRE(tuner.CheckSchedule({}, schedule));
+
+            // Interpolated to 4× Kp at 300 °C
+            schedule[1].kp = 7.0f * proposed.kp;
+            const Furnace::Result res = tuner.CheckSchedule({}, schedule);
+            REQUIRE_FALSE(res);
+            REQUIRE(std::string_view(res.message.c_str()).starts_with("PID_Schedule Kp at 300°C"));
+
+            // Empty: the fixed gains are checked instead
+            PidConfig base;
+            base.kp = proposed.kp * 1.5f;
+            base.ki = proposed.ki;
+            base.kd = proposed.kd / 1.5f;
+            REQUIRE(tuner.CheckSchedule(base, {}));
+        }
+
+        SECTION("ProposedSchedule puts the proposed gains at the setpoint, in order")
+        {
+            Furnace::PidSchedule schedule;
+            schedule.push_back({100.0f, 1.0f, 0.1f, 1.0f});
+            schedule.push_back({600.0f, 1.0f, 0.1f, 1.0f});
+
+            Furnace::PidSchedule proposed = tuner.ProposedSchedule(schedule);
+            REQUIRE(proposed.size() == 3);
+            REQUIRE(proposed[1].temperature == 300.0f);
+            REQUIRE(proposed[1].kp == result.kp);
+            REQUIRE(tuner.CheckSchedule({}, proposed));
+
+            // Again at the same setpoint replaces rather than adds
+            REQUIRE(tuner.ProposedSchedule(proposed).size() == 3);
+
+            // Full: the nearest breakpoint gives way
+            schedule.clear();
+            for (int i = 0; i < static_cast<int>(Furnace::MAX_PID_BREAKPOINTS); ++i)
+            {
+                schedule.push_back({100.0f * static_cast<float>(i) + 50.0f, 1.0f, 0.1f, 1.0f});
+            }
+            proposed = tuner.ProposedSchedule(schedule);
+            REQUIRE(proposed.size() == Furnace::MAX_PID_BREAKPOINTS);
+            REQUIRE(proposed[2].temperature == 250.0f);
+            REQUIRE(proposed[3].temperature == 300.0f);
+            REQUIRE(proposed[4].temperature == 450.0f);
+        }
+    }
+
+    TEST_CASE("RelayAutotuner: fails on runaway, over temperature and timeout")
+    {
+        RelayAutotuner tuner;
+        AutotuneConfig config;
+        config.setpoint = 300.0f;
+        config.runawayMargin = 20.0f;
+        config.maxDuration = 60min;
+        REQUIRE(tuner.Start(config));
+        REQUIRE(tuner.Update(250.0f, SAMPLE) == 100.0f);
+
+        SECTION("Runaway")
+        {
+            REQUIRE(tuner.Update(321.0f, SAMPLE) == 0.0f);
+            REQUIRE(tuner.GetStatus() == AutotuneStatus::FAILED);
+            REQUIRE(tuner.GetError() == "Autotune aborted, thermal runaway");
+        }
+
+        SECTION("Over MAX_Temperature")
+        {
+            config.maxTemperature = 310.0f;
+            REQUIRE(tuner.Start(config));
+            REQUIRE(tuner.Update(311.0f, SAMPLE) == 0.0f);
+            REQUIRE(tuner.GetStatus() == AutotuneStatus::FAILED);
+        }
+
+        SECTION("Timeout, here a kiln too weak to reach the setpoint")
+        {
+            Sim::ThermalParameters weak;
+            weak.heaterPowerW = 300.0f;
+            Sim::ThermalModel kiln(weak);
+            REQUIRE(tuner.Start(config));
+            RunAutotune(tuner, kiln);
+            REQUIRE(tuner.GetStatus() == AutotuneStatus::FAILED);
+            REQUIRE(tuner.GetError() == "Autotune timed out before the oscillation settled");
+        }
+
+        SECTION("Output stays off once failed")
+        {
+            REQUIRE(tuner.Update(321.0f, SAMPLE) == 0.0f);
+            REQUIRE(tuner.Update(250.0f, SAMPLE) == 0.0f);
+        }
+    }
+
+    class AutotuneStateMachineFixture
+    {
+    public:
+        AutotuneStateMachineFixture() :
+            myLog(&myNullLogBackend), myStateMachine(myFurnace, myClock, myLog)
+        {
+        }
+
+        Log::NullLogBackend myNullLogBackend;
+        Log::LogService myLog;
+        Furnace::FurnaceState myFurnace;
+        Time::ManualClock myClock;
+        Furnace::StateMachine myStateMachine;
+    };
+
+    TEST_CASE_METHOD(AutotuneStateMachineFixture, "StateMachine: StartAutotune - AUTOTUNING until done, then IDLE")
+    {
+        Sim::ThermalModel kiln;
+        REQUIRE(myStateMachine.StartAutotune(300.0f));
+        REQUIRE(myStateMachine.GetState() == Furnace::StateId::AUTOTUNING);
+        REQUIRE_FALSE(myStateMachine.StartAutotune(300.0f));
+
+        for (int i = 0; i < 8 * 3600 && myStateMachine.GetState() == Furnace::StateId::AUTOTUNING; ++i)
+        {
+            kiln.Step(myStateMachine.UpdateAutotune(kiln.SensorTemperature(), SAMPLE), SAMPLE);
+        }
+
+        REQUIRE(myStateMachine.GetState() == Furnace::StateId::IDLE);
+        REQUIRE(myStateMachine.GetAutotuner().GetStatus() == AutotuneStatus::DONE);
+        REQUIRE(myStateMachine.UpdateAutotune(kiln.SensorTemperature(), SAMPLE) == 0.0f);
+    }
+
+    TEST_CASE_METHOD(AutotuneStateMachineFixture, "StateMachine: StartAutotune - runaway goes to ERROR")
+    {
+        Furnace::Preferences preferences;
+        preferences.thermalRunaway = 15.0f;
+        myStateMachine.ApplyPreferences(preferences);
+
+        REQUIRE(myStateMachine.StartAutotune(300.0f));
+        REQUIRE(myStateMachine.UpdateAutotune(290.0f, SAMPLE) > 0.0f);
+        REQUIRE(myStateMachine.UpdateAutotune(316.0f, SAMPLE) == 0.0f);
+        REQUIRE(myStateMachine.GetState() == Furnace::StateId::ERROR);
+    }
+
+    TEST_CASE_METHOD(AutotuneStateMachineFixture, "StateMachine: StartAutotune - rejected outside IDLE and above MAX_Temperature")
+    {
+        REQUIRE_FALSE(myStateMachine.StartAutotune(1400.0f));
+        REQUIRE(myStateMachine.GetState() == Furnace::StateId::IDLE);
+
+        REQUIRE(myStateMachine.TransitionTo(Furnace::StateId::LOADED));
+        REQUIRE_FALSE(myStateMachine.StartAutotune(300.0f));
+        REQUIRE(myStateMachine.GetState() == Furnace::StateId::LOADED);
+    }
+} //namespace HeatTreatFurnace::Test
@@ -0,0 +1,324 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Control/Pid.hpp"
+#include "Safety/RunawayDetector.hpp"
+#include "Safety/SafetyRules.hpp"
+#include "Sim/ThermalModel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Safety;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        constexpr std::chrono::seconds SAMPLE = 1s;
+        constexpr float THERMAL_RUNAWAY = 25.0f; // °C over setTemp for the §8.2 limit rule
+
+        enum class Fault
+        {
+            None,
+            SsrStuckOn, // the kiln gets full power whatever is asked for
+            ThermocoupleDetached, // the thermocouple falls out of the kiln and cools in the air beside it
+            ElementFailed, // the kiln gets a third of the power asked for
+        };
+
+        /** @brief A firing on the host thermal model: ramp to target, hold, then cool with the heater off */
+        struct Trace
+        {
+            const char* name;
+            Sim::ThermalParameters kiln;
+            Fault fault = Fault::None;
+            std::chrono::seconds faultAt{0};
+            float target = 600.0f;
+            float rampRate = 150.0f; // °C/hour
+            std::chrono::seconds hold{2h};
+            bool idle = false; // no program: the heater is never asked for
+        };
+
+        struct Outcome
+        {
+            std::optional<std::chrono::seconds> excessAt; // detector's unexplained heating over its limit
+            std::optional<std::chrono::seconds> deficitAt; // detector's missing heating over its limit
+            std::optional<std::chrono::seconds> limitRuleAt; // reading > setTemp + Thermal_Runaway while heating (§8.2)
+            std::optional<std::chrono::seconds> overshootAt; // the kiln itself > setTemp + Thermal_Runaway
+
+            [[nodiscard]] std::optional<std::chrono::seconds> DetectedAt() const
+            {
+                if (excessAt && deficitAt)
+                {
+                    return std::min(*excessAt, *deficitAt);
+                }
+                return excessAt ? excessAt : deficitAt;
+            }
+
+            /** @brief How long before the limit rule, or if it never fires the overshoot, the detector tripped */
+            [[nodiscard]] std::optional<std::chrono::seconds> LeadTime() const
+            {
+                const std::optional<std::chrono::seconds> late = limitRuleAt ? limitRuleAt : overshootAt;
+                if (!late || !DetectedAt())
+                {
+                    return std::nullopt;
+                }
+                return *late - *DetectedAt();
+            }
+        };
+
+        /** @brief MAX31855-like readings: 0.5 °C of noise, quantised to 0.25 °C */
+        class NoisyThermocouple
+        {
+        public:
+            float Read(float aTemperature)
+            {
+                return std::round((aTemperature + myNoise(myRandom)) * 4.0f) / 4.0f;
+            }
+
+        private:
+            std::mt19937 myRandom{45};
+            std::normal_distribution<float> myNoise{0.0f, 0.5f};
+        };
+
+        Control::PidConfig TunedConfig()
+        {
+            Control::PidConfig config = Control::PidConfig::FromPreferences({});
+            config.kp = 3.0f;
+            config.ki = 0.01f;
+            config.kd = 0.0f;
+            config.integralMax = config.outputMax / config.ki;
+            return config;
+        }
+
+        /** @brief Fire aTrace with the detector on the readings, modelled on the default Kiln_* preferences */
+        Outcome Run(const Trace& aTrace)
+        {
+            const SafetyConfig limits;
+            const Control::PidConfig config = TunedConfig();
+            Control::FloatPid pid(config);
+            Sim::ThermalModel kiln(aTrace.kiln);
+            RunawayDetector detector(RunawayModel::FromPreferences({}));
+            NoisyThermocouple thermocouple;
+
+            const float start = kiln.SensorTemperature();
+            const std::chrono::seconds rampEnd{static_cast<int64_t>((aTrace.target - start) / aTrace.rampRate * 3600.0f)};
+            const std::chrono::seconds programEnd = rampEnd + aTrace.hold;
+            const std::chrono::seconds end = programEnd + 2h;
+
+            Outcome outcome;
+            float reading = kiln.SensorTemperature();
+            float detached = reading; // what a detached thermocouple reads
+            float heat = 0.0f;
+            for (std::chrono::seconds t{0}; t < end; t += SAMPLE)
+            {
+                const bool faulty = aTrace.fault != Fault::None && t >= aTrace.faultAt;
+                const bool heating = !aTrace.idle && t < programEnd;
+                const float setTemp = aTrace.idle ? start :
+                    std::min(aTrace.target, start + aTrace.rampRate * std::chrono::duration<float, std::ratio<3600>>(t).count());
+
+                if (t % config.sampleTime == 0s)
+                {
+                    heat = heating ? pid.Update(setTemp, reading) : 0.0f;
+                }
+                float applied = heat;
+                if (faulty && aTrace.fault == Fault::SsrStuckOn)
+                {
+                    applied = 100.0f;
+                }
+                else if (faulty && aTrace.fault == Fault::ElementFailed)
+                {
+                    applied = heat / 3.0f;
+                }
+                kiln.Step(applied, SAMPLE);
+
+                detached += (100.0f - detached) * std::chrono::duration<float>(SAMPLE).count() / 60.0f;
+                if (!faulty || aTrace.fault != Fault::ThermocoupleDetached)
+                {
+                    detached = kiln.SensorTemperature();
+                }
+                reading = thermocouple.Read(detached);
+                detector.Update(reading, heat, SAMPLE);
+
+                const std::chrono::seconds now = t + SAMPLE;
+                if (!outcome.excessAt && detector.Excess() > limits.unexplainedHeating)
+                {
+                    outcome.excessAt = now;
+                }
+                if (!outcome.deficitAt && detector.Deficit() > limits.missingHeating)
+                {
+                    outcome.deficitAt = now;
+                }
+                if (!outcome.limitRuleAt && heating && reading > setTemp + THERMAL_RUNAWAY)
+                {
+                    outcome.limitRuleAt = now;
+                }
+                if (!outcome.overshootAt && kiln.KilnTemperature() > setTemp + THERMAL_RUNAWAY)
+                {
+                    outcome.overshootAt = now;
+                }
+            }
+            return outcome;
+        }
+
+        Sim::ThermalParameters Kiln(float aHeaterPowerW = 3000.0f, float aLossWPerC = 1.5f)
+        {
+            Sim::ThermalParameters kiln;
+            kiln.heaterPowerW = aHeaterPowerW;
+            kiln.lossWPerC = aLossWPerC;
+            return kiln;
+        }
+
+        /** @brief Firings that must not trip: kilns up to 20% either side of the Kiln_* preferences, to 600 and 1000 °C */
+        std::vector<Trace> HealthyCorpus()
+        {
+            return {
+                {"nominal kiln, 600 °C", Kiln()},
+                {"nominal kiln, 1000 °C", Kiln(), Fault::None, 0s, 1000.0f, 120.0f},
+                {"20% more power", Kiln(3600.0f), Fault::None, 0s, 1000.0f, 120.0f},
+                {"20% less power", Kiln(2400.0f), Fault::None, 0s, 1000.0f, 100.0f},
+                {"30% more loss", Kiln(3000.0f, 1.95f), Fault::None, 0s, 1000.0f, 120.0f},
+                {"30% less loss", Kiln(3000.0f, 1.05f), Fault::None, 0s, 1000.0f, 120.0f},
+                {"idle", Kiln(), Fault::None, 0s, 600.0f, 150.0f, 2h, true},
+            };
+        }
+
+        /** @brief Faults and when they happen; the same kilns as HealthyCorpus() */
+        std::vector<Trace> FaultCorpus()
+        {
+            return {
+                {"SSR stuck on, holding 600 °C", Kiln(), Fault::SsrStuckOn, 5h},
+                {"SSR stuck on, ramping at 400 °C", Kiln(), Fault::SsrStuckOn, 2h + 30min},
+                {"SSR stuck on, 20% more power", Kiln(3600.0f), Fault::SsrStuckOn, 5h},
+                {"SSR stuck on, 20% less power", Kiln(2400.0f), Fault::SsrStuckOn, 5h},
+                {"SSR stuck on, idle", Kiln(), Fault::SsrStuckOn, 10min, 600.0f, 150.0f, 2h, true},
+                {"thermocouple detached, holding 600 °C", Kiln(), Fault::ThermocoupleDetached, 5h},
+                {"thermocouple detached, ramping at 400 °C", Kiln(), Fault::ThermocoupleDetached, 2h + 30min},
+                {"thermocouple detached, 30% more loss", Kiln(3000.0f, 1.95f), Fault::ThermocoupleDetached, 5h},
+                {"element failed, ramping at 400 °C", Kiln(), Fault::ElementFailed, 2h + 30min},
+            };
+        }
+    }
+
+    TEST_CASE("RunawayDetector: a kiln that behaves like its model adds nothing up")
+    {
+        RunawayDetector detector;
+        Sim::ThermalParameters parameters;
+        parameters.elementLagS = detector.GetModel().elementLagS;
+        parameters.sensorLagS = detector.GetModel().sensorLagS;
+        Sim::ThermalModel kiln(parameters);
+
+        // Steps in heat, not a smooth ramp: the lags have to line up
+        for (int minute = 0; minute < 180; ++minute)
+        {
+            const float heat = minute % 40 < 20 ? 100.0f : 10.0f;
+            for (int second = 0; second < 60; ++second)
+            {
+                kiln.Step(heat, SAMPLE);
+                detector.Update(kiln.SensorTemperature(), heat, SAMPLE);
+            }
+        }
+        REQUIRE(kiln.SensorTemperature() > 300.0f);
+        REQUIRE(detector.Excess() == 0.0f);
+        REQUIRE(detector.Deficit() == 0.0f);
+    }
+
+    TEST_CASE("RunawayDetector: sums what the model doesn't explain, less the slack")
+    {
+        RunawayModel model;
+        model.elementLagS = 0.0f;
+        model.sensorLagS = 0.0f;
+        RunawayDetector detector(model);
+
+        // At ambient with the heater off nothing should move; rising 0.1 °C/s is 0.08 °C/s over the slack
+        float temperature = model.ambientTemperature;
+        detector.Update(temperature, 0.0f, SAMPLE);
+        for (int i = 0; i < 100; ++i)
+        {
+            temperature += 0.1f;
+            detector.Update(temperature, 0.0f, SAMPLE);
+        }
+        REQUIRE(std::abs(detector.Excess() - 8.0f) < 0.1f);
+        REQUIRE(detector.Deficit() == 0.0f);
+
+        // Explained from here: the excess drains at the slack
+        for (int i = 0; i < 100; ++i)
+        {
+            detector.Update(temperature, 0.0f, SAMPLE);
+        }
+        REQUIRE(detector.Excess() < 8.0f - 100.0f * model.slack + 0.5f);
+
+        // A step in the reading counts for no more than the kiln could do, plus noise
+        detector.Reset();
+        detector.Update(20.0f, 0.0f, SAMPLE);
+        detector.Update(520.0f, 0.0f, SAMPLE);
+        REQUIRE(detector.Excess() < 2.5f);
+    }
+
+    TEST_CASE("RunawayDetector: the healthy corpus never trips")
+    {
+        for (const Trace& trace : HealthyCorpus())
+        {
+            INFO(trace.name);
+            const Outcome outcome = Run(trace);
+            REQUIRE_FALSE(outcome.excessAt.has_value());
+            REQUIRE_FALSE(outcome.deficitAt.has_value());
+            REQUIRE_FALSE(outcome.limitRuleAt.has_value());
+        }
+    }
+
+    TEST_CASE("RunawayDetector: the fault corpus trips, minutes ahead of the Thermal_Runaway limit")
+    {
+        for (const Trace& trace : FaultCorpus())
+        {
+            INFO(trace.name);
+            const Outcome outcome = Run(trace);
+            REQUIRE(outcome.DetectedAt().has_value());
+            REQUIRE(*outcome.DetectedAt() > trace.faultAt);
+            switch (trace.fault)
+            {
+            case Fault::SsrStuckOn:
+                REQUIRE(outcome.excessAt.has_value());
+                REQUIRE(*outcome.DetectedAt() - trace.faultAt < 15min);
+                REQUIRE(outcome.LeadTime().has_value());
+                REQUIRE(*outcome.LeadTime() >= 2min);
+                break;
+            case Fault::ThermocoupleDetached:
+                // The reading never overshoots, so the limit rule never fires; the kiln itself does
+                REQUIRE(outcome.deficitAt.has_value());
+                REQUIRE_FALSE(outcome.limitRuleAt.has_value());
+                REQUIRE(outcome.LeadTime().has_value());
+                REQUIRE(*outcome.LeadTime() >= 2min);
+                break;
+            default:
+                REQUIRE(outcome.deficitAt.has_value());
+                REQUIRE(*outcome.DetectedAt() - trace.faultAt < 15min);
+                break;
+            }
+        }
+    }
+
+    TEST_CASE("RunawayDetector: lead time and cost", "[.][benchmark]")
+    {
+        for (const Trace& trace : FaultCorpus())
+        {
+            const Outcome outcome = Run(trace);
+            const auto detected = outcome.DetectedAt() ? (*outcome.DetectedAt() - trace.faultAt).count() : -1;
+            const auto limitRule = outcome.limitRuleAt ? (*outcome.limitRuleAt - trace.faultAt).count() : -1;
+            const auto overshoot = outcome.overshootAt ? (*outcome.overshootAt - trace.faultAt).count() : -1;
+            WARN(trace.name << ": detected after " << detected << " s, limit rule " << limitRule << " s, kiln over it " << overshoot << " s");
+        }
+
+        RunawayDetector detector;
+        float temperature = 600.0f;
+        BENCHMARK("Update")
+        {
+            temperature += 0.01f;
+            detector.Update(temperature, 40.0f, 400ms);
+            return detector.Excess();
+        };
+    }
+} //namespace HeatTreatFurnace::Test
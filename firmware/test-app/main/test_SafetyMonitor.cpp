@@ -0,0 +1,458 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "Control/LoopScheduler.hpp"
+#include "Control/ThermalEstimator.hpp"
+#include "Furnace/Furnace.hpp"
+#include "Furnace/StateMachine.hpp"
+#include "Log/LogBackend.hpp"
+#include "Log/LogService.hpp"
+#include "Safety/SafetyMonitor.hpp"
+#include "Sensor/ReplayThermocouple.hpp"
+#include "Sensor/SensorPublisher.hpp"
+#include "Time/Clock.hpp"
+#include <algorithm>
+#include <optional>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Safety;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        SafetyFaults Only(SafetyFault aFault)
+        {
+            return SafetyFaults().set(static_cast<size_t>(aFault));
+        }
+
+        class FakeHeater : public HeaterSwitch
+        {
+        public:
+            explicit FakeHeater(const Time::Clock& aClock) :
+                myClock(aClock)
+            {
+            }
+
+            void ForceOff() override
+            {
+                if (!myForcedAt)
+                {
+                    myForcedAt = myClock.Now();
+                }
+                ++myForceOffs;
+            }
+
+            void Release() override
+            {
+                myForcedAt.reset();
+            }
+
+            std::optional<std::chrono::microseconds> myForcedAt;
+            int myForceOffs = 0;
+
+        private:
+            const Time::Clock& myClock;
+        };
+
+        class FakeWatchdog : public Watchdog
+        {
+        public:
+            explicit FakeWatchdog(const Time::Clock& aClock) :
+                myClock(aClock)
+            {
+            }
+
+            void Feed() override
+            {
+                myLastFeed = myClock.Now();
+                ++myFeeds;
+            }
+
+            std::chrono::microseconds myLastFeed{0};
+            int myFeeds = 0;
+
+        private:
+            const Time::Clock& myClock;
+        };
+    }
+
+    /**
+     * @brief A furnace on the LoopScheduler and a manual clock: the replayed thermocouples and publisher every 100 ms,
+     * the control loop every second, and the safety monitor every 50 ms.
+     */
+    class SafetyMonitorFixture
+    {
+    public:
+        SafetyMonitorFixture() :
+            myLog(&myNullLogBackend),
+            myReplay(myClock, 2, [this](size_t aChannel, std::chrono::microseconds)
+            {
+                if (aChannel == 1)
+                {
+                    return myCase;
+                }
+                return mySpikeEvery > 0 && ++myBatches % mySpikeEvery == 0 ? myKiln + 400.0f : myKiln;
+            }),
+            myPublisher(myReplay),
+            myHeater(myClock), myWatchdog(myClock),
+            myMonitor(myClock, myPublisher.GetSnapshot(), myStateSnapshot, myHeater, myWatchdog, myLog),
+            myScheduler(myClock, myLog)
+        {
+            myPreferences.maxTemperature = 1300.0f;
+            myPreferences.maxHousingTemperature = 130.0f;
+            myPreferences.thermalRunaway = 50.0f;
+            myPreferences.pidWindowMs = 1000;
+            myReplay.SetThermocoupleType(myPreferences.thermocoupleType);
+            myPublisher.ApplyPreferences(myPreferences);
+            myMonitor.Configure(SafetyConfig::FromPreferences(myPreferences));
+            myMonitor.SetTripHandler(SafetyMonitor::TripHandler::create<SafetyMonitorFixture, &SafetyMonitorFixture::OnTrip>(*this));
+
+            REQUIRE(myScheduler.AddStage("sensor", 100ms, 100ms, Control::LoopScheduler::StageFunction::create<SafetyMonitorFixture, &SafetyMonitorFixture::Sensor>(*this)).success);
+            REQUIRE(myScheduler.AddStage("control", 1s, 1s, Control::LoopScheduler::StageFunction::create<SafetyMonitorFixture, &SafetyMonitorFixture::Control>(*this)).success);
+            REQUIRE(myScheduler.AddStage("safety", 50ms, 50ms, Control::LoopScheduler::StageFunction::create<SafetyMonitorFixture, &SafetyMonitorFixture::Safety>(*this), true).success);
+            myScheduler.Start();
+            myMonitor.Start();
+        }
+
+        void Sensor()
+        {
+            if (mySensorAlive)
+            {
+                myReplay.Poll();
+                myPublisher.Poll();
+            }
+        }
+
+        void Control()
+        {
+            if (myControlAlive)
+            {
+                myMonitor.Heartbeat();
+                Furnace::StateSnapshot state;
+                state.state = myState;
+                state.setTemp = mySetTemp;
+                state.heatPercent = myHeatPercent;
+                myStateSnapshot.Publish(state);
+            }
+        }
+
+        void Safety()
+        {
+            myMonitor.Poll();
+        }
+
+        void OnTrip(const FaultReport& aReport)
+        {
+            if (!myTrippedAt)
+            {
+                myTrippedAt = myClock.Now();
+            }
+            myTripFaults = aReport.faults;
+        }
+
+        /** @brief Run steady for 10 s, break a rule with aInject, and return how long until the trip handler ran */
+        template <typename Inject>
+        std::chrono::microseconds Latency(Inject aInject, std::chrono::microseconds aLimit = 10s)
+        {
+            myScheduler.RunUntil(myClock.Now() + 10s);
+            REQUIRE_FALSE(myMonitor.IsTripped());
+            const std::chrono::microseconds start = myClock.Now();
+            aInject();
+            myScheduler.RunUntil(start + aLimit);
+            REQUIRE(myTrippedAt.has_value());
+            // Off before anyone is told
+            REQUIRE(myHeater.myForcedAt.has_value());
+            REQUIRE(*myHeater.myForcedAt <= *myTrippedAt);
+            return *myTrippedAt - start;
+        }
+
+        Log::NullLogBackend myNullLogBackend;
+        Log::LogService myLog;
+        Time::ManualClock myClock{1s};
+        float myKiln = 800.0f;
+        float myCase = 60.0f;
+        int mySpikeEvery = 0; // batches between one-batch SSR spikes on the kiln, 0 = none
+        int myBatches = 0;
+        Furnace::StateId myState = Furnace::StateId::RUNNING;
+        float mySetTemp = 800.0f;
+        uint8_t myHeatPercent = 0;
+        bool mySensorAlive = true;
+        bool myControlAlive = true;
+        Furnace::Preferences myPreferences;
+        Sensor::ReplayThermocouple myReplay;
+        Sensor::SensorPublisher myPublisher;
+        Sync::Snapshot<Furnace::StateSnapshot> myStateSnapshot;
+        FakeHeater myHeater;
+        FakeWatchdog myWatchdog;
+        SafetyMonitor myMonitor;
+        Control::LoopScheduler myScheduler;
+        std::optional<std::chrono::microseconds> myTrippedAt;
+        SafetyFaults myTripFaults;
+    };
+
+    TEST_CASE_METHOD(SafetyMonitorFixture, "SafetyMonitor: detection latency for each fault, in simulated time")
+    {
+        // The sample pipeline publishes every 400 ms and confirms a step in 3 readings; the median then needs 3 of
+        // its 5 averages to agree. A broken temperature rule is published within 2 s, and caught within a period.
+        SECTION("Kiln thermocouple open circuit: the grace count of 5 batches, then one period")
+        {
+            const std::chrono::microseconds latency = Latency([this]
+            {
+                myReplay.InjectFault({0, Sensor::ThermocoupleFault::OpenCircuit, myClock.Now(), myClock.Now() + 1h});
+            });
+            INFO(latency.count() << " µs");
+            REQUIRE(latency <= 600ms + 50ms);
+            REQUIRE(myTripFaults == Only(SafetyFault::ThermocoupleFailure));
+        }
+
+        SECTION("Case thermocouple shorted")
+        {
+            const std::chrono::microseconds latency = Latency([this]
+            {
+                myReplay.InjectFault({1, Sensor::ThermocoupleFault::ShortToGround, myClock.Now(), myClock.Now() + 1h});
+            });
+            INFO(latency.count() << " µs");
+            REQUIRE(latency <= 600ms + 50ms);
+            REQUIRE(myTripFaults == Only(SafetyFault::ThermocoupleFailure));
+        }
+
+        SECTION("Kiln over MAX_Temperature")
+        {
+            myKiln = 1290.0f;
+            mySetTemp = 1290.0f;
+            const std::chrono::microseconds latency = Latency([this]
+            {
+                myKiln = 1305.0f;
+            });
+            INFO(latency.count() << " µs");
+            REQUIRE(latency <= 2s + 50ms);
+            REQUIRE(myTripFaults == Only(SafetyFault::OverTemperature));
+        }
+
+        SECTION("Thermal runaway")
+        {
+            const std::chrono::microseconds latency = Latency([this]
+            {
+                myKiln = 860.0f;
+            });
+            INFO(latency.count() << " µs");
+            REQUIRE(latency <= 2s + 50ms);
+            REQUIRE(myTripFaults == Only(SafetyFault::ThermalRunaway));
+        }
+
+        SECTION("Case over MAX_Housing_Temperature")
+        {
+            const std::chrono::microseconds latency = Latency([this]
+            {
+                myCase = 135.0f;
+            });
+            INFO(latency.count() << " µs");
+            REQUIRE(latency <= 2s + 50ms);
+            REQUIRE(myTripFaults == Only(SafetyFault::CaseOverTemperature));
+        }
+
+        SECTION("Sensor task stopped: the 2 s timeout, then one period")
+        {
+            const std::chrono::microseconds latency = Latency([this]
+            {
+                mySensorAlive = false;
+            });
+            INFO(latency.count() << " µs");
+            REQUIRE(latency <= 2s + 50ms);
+            REQUIRE(myTripFaults == Only(SafetyFault::SensorStale));
+        }
+
+        SECTION("Control loop hung: two PID windows, then one period, and the watchdog goes hungry")
+        {
+            const std::chrono::microseconds latency = Latency([this]
+            {
+                myControlAlive = false;
+            });
+            INFO(latency.count() << " µs");
+            REQUIRE(latency <= 2s + 50ms);
+            REQUIRE(myTripFaults == Only(SafetyFault::HeartbeatLost));
+            REQUIRE(myWatchdog.myLastFeed < *myTrippedAt);
+        }
+    }
+
+    TEST_CASE_METHOD(SafetyMonitorFixture, "SafetyMonitor: a normal firing with SSR spikes never trips")
+    {
+        // 20 to 1000 °C at 300 °C/hour with the setpoint, and a one-batch spike every 97 s. The heater
+        // is what the Kiln_* model needs for that, so the runaway detector sees a kiln that follows it.
+        myPreferences.heaterPowerW = 6000.0f;
+        myMonitor.Configure(SafetyConfig::FromPreferences(myPreferences));
+        const Control::ThermalEstimator model(myPreferences);
+        myKiln = 20.0f;
+        mySetTemp = 20.0f;
+        mySpikeEvery = 970;
+        const std::chrono::microseconds start = myClock.Now();
+        while (myKiln < 1000.0f)
+        {
+            myHeatPercent = static_cast<uint8_t>(model.FeedforwardPercent(myKiln, 300.0f / 3600.0f));
+            myScheduler.RunUntil(myClock.Now() + 1s);
+            myKiln += 300.0f / 3600.0f;
+            mySetTemp = myKiln;
+        }
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(myClock.Now() - start).count();
+        REQUIRE_FALSE(myMonitor.IsTripped());
+        REQUIRE_FALSE(myTrippedAt.has_value());
+        REQUIRE(myWatchdog.myFeeds >= seconds * 20);
+        REQUIRE(myWatchdog.myLastFeed == myClock.Now() - 50ms);
+    }
+
+    TEST_CASE_METHOD(SafetyMonitorFixture, "SafetyMonitor: an SSR stuck on trips before the kiln overshoots by Thermal_Runaway")
+    {
+        // Holding 600 °C on what the model says it takes; then the kiln heats at 3 °C/min with the heater
+        // asked for less and less, as a PID would
+        const Control::ThermalEstimator model(myPreferences);
+        myKiln = 600.0f;
+        mySetTemp = 600.0f;
+        myHeatPercent = static_cast<uint8_t>(model.FeedforwardPercent(600.0f, 0.0f));
+        myScheduler.RunUntil(myClock.Now() + 10min);
+        REQUIRE_FALSE(myMonitor.IsTripped());
+
+        const std::chrono::microseconds start = myClock.Now();
+        while (!myTrippedAt && myKiln < mySetTemp + myPreferences.thermalRunaway)
+        {
+            myKiln += 0.05f;
+            myHeatPercent = static_cast<uint8_t>(std::max(0.0f, static_cast<float>(myHeatPercent) - 0.5f));
+            myScheduler.RunUntil(myClock.Now() + 1s);
+        }
+        REQUIRE(myTripFaults == Only(SafetyFault::UnexplainedHeating));
+        REQUIRE(myKiln < mySetTemp + myPreferences.thermalRunaway / 2.0f);
+        REQUIRE(*myTrippedAt - start < 5min);
+    }
+
+    TEST_CASE_METHOD(SafetyMonitorFixture, "SafetyMonitor: latched until the fault clears and Reset()")
+    {
+        myScheduler.RunUntil(myClock.Now() + 5s);
+        myCase = 140.0f;
+        myScheduler.RunUntil(myClock.Now() + 5s);
+        REQUIRE(myMonitor.Faults() == Only(SafetyFault::CaseOverTemperature));
+
+        // Still over: refused
+        const Furnace::Result refused = myMonitor.Reset();
+        REQUIRE_FALSE(refused.success);
+        REQUIRE(std::string_view(refused.message.c_str()) == "Safety fault still present: case over MAX_Housing_Temperature");
+
+        // Under the limit but within its 5 °C hysteresis: still refused
+        myCase = 128.0f;
+        myScheduler.RunUntil(myClock.Now() + 5s);
+        REQUIRE_FALSE(myMonitor.Reset().success);
+
+        // Cooled, but still latched: the heater is held off on every poll
+        myCase = 100.0f;
+        myScheduler.RunUntil(myClock.Now() + 5s);
+        REQUIRE(myMonitor.Poll() == Only(SafetyFault::CaseOverTemperature));
+        REQUIRE(myMonitor.IsTripped());
+        const int forceOffs = myHeater.myForceOffs;
+        myScheduler.RunUntil(myClock.Now() + 1s);
+        REQUIRE(myHeater.myForceOffs == forceOffs + 20);
+
+        REQUIRE(myMonitor.Reset().success);
+        REQUIRE_FALSE(myMonitor.IsTripped());
+        REQUIRE_FALSE(myHeater.myForcedAt.has_value());
+        myScheduler.RunUntil(myClock.Now() + 5s);
+        REQUIRE(myHeater.myForceOffs == forceOffs + 20);
+    }
+
+    TEST_CASE_METHOD(SafetyMonitorFixture, "SafetyMonitor: rules that only apply in some states")
+    {
+        SECTION("No runaway check unless the heater follows setTemp")
+        {
+            myState = Furnace::StateId::COMPLETED;
+            mySetTemp = 0.0f;
+            myScheduler.RunUntil(myClock.Now() + 10s);
+            REQUIRE_FALSE(myMonitor.IsTripped());
+        }
+
+        SECTION("Thermal_Runaway 0 disables it")
+        {
+            myPreferences.thermalRunaway = 0.0f;
+            myMonitor.Configure(SafetyConfig::FromPreferences(myPreferences));
+            mySetTemp = 500.0f;
+            myScheduler.RunUntil(myClock.Now() + 10s);
+            REQUIRE_FALSE(myMonitor.IsTripped());
+        }
+
+        SECTION("MAX_Temperature in any state")
+        {
+            myState = Furnace::StateId::IDLE;
+            myKiln = 1350.0f;
+            myScheduler.RunUntil(myClock.Now() + 10s);
+            REQUIRE(myMonitor.Faults() == Only(SafetyFault::OverTemperature));
+        }
+
+        SECTION("Before the first reading only a timeout can trip")
+        {
+            mySensorAlive = false;
+            myScheduler.RunUntil(myClock.Now() + 2s);
+            REQUIRE_FALSE(myMonitor.IsTripped());
+            myScheduler.RunUntil(myClock.Now() + 100ms);
+            REQUIRE(myMonitor.Faults() == Only(SafetyFault::SensorStale));
+        }
+    }
+
+    TEST_CASE_METHOD(SafetyMonitorFixture, "SafetyMonitor: a trip puts the furnace in ERROR")
+    {
+        Furnace::FurnaceState furnace;
+        Furnace::StateMachine stateMachine(furnace, myClock, myLog);
+        REQUIRE(stateMachine.TransitionTo(Furnace::StateId::LOADED));
+        REQUIRE(stateMachine.TransitionTo(Furnace::StateId::RUNNING));
+        myMonitor.SetTripHandler(SafetyMonitor::TripHandler::create<Furnace::StateMachine, &Furnace::StateMachine::OnSafetyTrip>(stateMachine));
+
+        myScheduler.RunUntil(myClock.Now() + 5s);
+        REQUIRE(stateMachine.GetState() == Furnace::StateId::RUNNING);
+
+        myKiln = 900.0f;
+        myScheduler.RunUntil(myClock.Now() + 3s);
+        REQUIRE(stateMachine.GetState() == Furnace::StateId::ERROR);
+        REQUIRE(myHeater.myForcedAt.has_value());
+        REQUIRE(std::string_view(stateMachine.GetErrorMessage().c_str()) == "thermal runaway");
+
+        // A second fault is added to the message, in the order found
+        myCase = 140.0f;
+        myScheduler.RunUntil(myClock.Now() + 3s);
+        const std::string_view message = stateMachine.GetErrorMessage().c_str();
+        REQUIRE(message.starts_with("thermal runaway, then case over MAX_Housing_Temperature "));
+        REQUIRE(message.ends_with(" s later"));
+
+        myKiln = 800.0f;
+        myCase = 60.0f;
+        myScheduler.RunUntil(myClock.Now() + 3s);
+        REQUIRE(myMonitor.Reset().success);
+        REQUIRE(stateMachine.TransitionTo(Furnace::StateId::IDLE));
+        REQUIRE(stateMachine.GetErrorMessage().empty());
+    }
+
+    TEST_CASE_METHOD(SafetyMonitorFixture, "SafetyMonitor: the alarm sounds for Alarm_Timeout after a trip")
+    {
+        myPreferences.alarmTimeoutS = 5;
+        myMonitor.Configure(SafetyConfig::FromPreferences(myPreferences));
+        myScheduler.RunUntil(myClock.Now() + 5s);
+        REQUIRE_FALSE(myMonitor.IsAlarmOn());
+
+        myCase = 140.0f;
+        myScheduler.RunUntil(myClock.Now() + 3s);
+        REQUIRE(myMonitor.IsAlarmOn());
+        myScheduler.RunUntil(*myTrippedAt + 4900ms);
+        REQUIRE(myMonitor.IsAlarmOn());
+        myScheduler.RunUntil(*myTrippedAt + 5050ms);
+        REQUIRE_FALSE(myMonitor.IsAlarmOn());
+        // Still tripped, just quiet
+        REQUIRE(myMonitor.IsTripped());
+
+        SECTION("Alarm_Timeout 0 disables it")
+        {
+            myCase = 60.0f;
+            myScheduler.RunUntil(myClock.Now() + 3s);
+            REQUIRE(myMonitor.Reset().success);
+            myPreferences.alarmTimeoutS = 0;
+            myMonitor.Configure(SafetyConfig::FromPreferences(myPreferences));
+            myCase = 140.0f;
+            myScheduler.RunUntil(myClock.Now() + 3s);
+            REQUIRE(myMonitor.IsTripped());
+            REQUIRE_FALSE(myMonitor.IsAlarmOn());
+        }
+    }
+} //namespace HeatTreatFurnace::Test
@@ -0,0 +1,184 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Safety/SafetyRules.hpp"
+
+#include <string_view>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Safety;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        SafetyFaults Only(SafetyFault aFault)
+        {
+            return SafetyFaults().set(static_cast<size_t>(aFault));
+        }
+
+        /** @brief A running kiln at its setpoint, readings fresh */
+        RuleInputs Steady()
+        {
+            RuleInputs inputs;
+            inputs.readings.kilnTemperature = 800.0f;
+            inputs.readings.caseTemperature = 60.0f;
+            inputs.readings.kilnFaults = 0;
+            inputs.readings.caseFaults = 0;
+            inputs.readings.sequence = 1;
+            inputs.state.state = Furnace::StateId::RUNNING;
+            inputs.state.setTemp = 800.0f;
+            return inputs;
+        }
+
+        SafetyConfig Config()
+        {
+            SafetyConfig config;
+            config.maxTemperature = 1300.0f;
+            config.maxHousingTemperature = 130.0f;
+            config.thermalRunaway = 50.0f;
+            config.sensorTimeout = 2s;
+            config.heartbeatTimeout = 10s;
+            return config;
+        }
+    }
+
+    TEST_CASE("RulePack: latched rules hold until Reset() and their hysteresis")
+    {
+        FurnaceRules rules;
+        rules.Configure(Config());
+        RuleInputs inputs = Steady();
+        REQUIRE(rules.Evaluate(inputs, 1s).none());
+
+        inputs.readings.caseTemperature = 131.0f;
+        REQUIRE(rules.Evaluate(inputs, 2s) == Only(SafetyFault::CaseOverTemperature));
+
+        // Back under the limit: latched
+        inputs.readings.caseTemperature = 100.0f;
+        REQUIRE(rules.Evaluate(inputs, 3s) == Only(SafetyFault::CaseOverTemperature));
+
+        // Within MAX_Housing_Temperature - 5 °C, Reset() leaves it
+        inputs.readings.caseTemperature = 127.0f;
+        rules.Evaluate(inputs, 4s);
+        REQUIRE(rules.Reset() == Only(SafetyFault::CaseOverTemperature));
+        REQUIRE(rules.Report().faults == Only(SafetyFault::CaseOverTemperature));
+
+        inputs.readings.caseTemperature = 124.0f;
+        rules.Evaluate(inputs, 5s);
+        REQUIRE(rules.Reset().none());
+        REQUIRE(rules.Report().faults.none());
+        REQUIRE(rules.Evaluate(inputs, 6s).none());
+    }
+
+    TEST_CASE("RulePack: self-clearing rules follow their input, but stay in the report")
+    {
+        FurnaceRules rules;
+        rules.Configure(Config());
+        RuleInputs inputs = Steady();
+
+        inputs.heartbeatAge = 10.05f;
+        REQUIRE(rules.Evaluate(inputs, 1s) == Only(SafetyFault::HeartbeatLost));
+        inputs.heartbeatAge = 0.0f;
+        REQUIRE(rules.Evaluate(inputs, 2s).none());
+        REQUIRE(rules.Report().faults == Only(SafetyFault::HeartbeatLost));
+        REQUIRE(rules.Report().firstSeen[static_cast<size_t>(SafetyFault::HeartbeatLost)] == 1s);
+
+        // Nothing left active, so Reset() clears the report too
+        REQUIRE(rules.Reset().none());
+        REQUIRE(rules.Report().faults.none());
+
+        inputs.readings.kilnFaults = static_cast<uint8_t>(Sensor::ThermocoupleFault::OpenCircuit);
+        REQUIRE(rules.Evaluate(inputs, 3s) == Only(SafetyFault::ThermocoupleFailure));
+        inputs.readings.kilnFaults = 0;
+        REQUIRE(rules.Evaluate(inputs, 4s).none());
+    }
+
+    TEST_CASE("RulePack: rules that don't apply, or are disabled, never fire")
+    {
+        FurnaceRules rules;
+        SafetyConfig config = Config();
+        RuleInputs inputs = Steady();
+
+        SECTION("Nothing published yet")
+        {
+            inputs = RuleInputs();
+            rules.Configure(config);
+            REQUIRE(rules.Evaluate(inputs, 1s).none());
+        }
+
+        SECTION("Temperature limits on a faulty reading")
+        {
+            rules.Configure(config);
+            inputs.readings.kilnTemperature = 2000.0f;
+            inputs.readings.kilnFaults = static_cast<uint8_t>(Sensor::ThermocoupleFault::ShortToVcc);
+            REQUIRE(rules.Evaluate(inputs, 1s) == Only(SafetyFault::ThermocoupleFailure));
+        }
+
+        SECTION("Thermal_Runaway 0")
+        {
+            config.thermalRunaway = 0.0f;
+            rules.Configure(config);
+            inputs.state.setTemp = 0.0f;
+            REQUIRE(rules.Evaluate(inputs, 1s).none());
+        }
+
+        SECTION("Runaway outside the heating states")
+        {
+            rules.Configure(config);
+            inputs.state.state = Furnace::StateId::COMPLETED;
+            inputs.state.setTemp = 0.0f;
+            REQUIRE(rules.Evaluate(inputs, 1s).none());
+        }
+
+        SECTION("A pack without the rule")
+        {
+            RulePack<Rules::OverTemperature> overTemperatureOnly;
+            overTemperatureOnly.Configure(config);
+            inputs.readings.caseTemperature = 500.0f;
+            inputs.heartbeatAge = 100.0f;
+            REQUIRE(overTemperatureOnly.Evaluate(inputs, 1s).none());
+            inputs.readings.kilnTemperature = 1301.0f;
+            REQUIRE(overTemperatureOnly.Evaluate(inputs, 1s) == Only(SafetyFault::OverTemperature));
+        }
+    }
+
+    TEST_CASE("RulePack: the report lists faults in the order they were first found")
+    {
+        FurnaceRules rules;
+        rules.Configure(Config());
+        RuleInputs inputs = Steady();
+
+        inputs.readings.kilnTemperature = 851.0f;
+        rules.Evaluate(inputs, 10s);
+        inputs.readings.caseTemperature = 131.0f;
+        rules.Evaluate(inputs, 10250ms);
+        inputs.readings.kilnTemperature = 1301.0f;
+        rules.Evaluate(inputs, 11s);
+        // Found again later: the first time stands
+        inputs.readings.caseTemperature = 60.0f;
+        rules.Evaluate(inputs, 12s);
+
+        const FaultReport& report = rules.Report();
+        REQUIRE(report.faults.count() == 3);
+        REQUIRE(report.firstSeen[static_cast<size_t>(SafetyFault::ThermalRunaway)] == 10s);
+        REQUIRE(report.firstSeen[static_cast<size_t>(SafetyFault::CaseOverTemperature)] == 10250ms);
+        REQUIRE(report.firstSeen[static_cast<size_t>(SafetyFault::OverTemperature)] == 11s);
+        REQUIRE(std::string_view(report.Describe().c_str()) ==
+            "thermal runaway, then case over MAX_Housing_Temperature 0.25 s later, then kiln over MAX_Temperature 1.00 s later");
+    }
+
+    TEST_CASE("RulePack: evaluation cost", "[.][benchmark]")
+    {
+        FurnaceRules rules;
+        rules.Configure(Config());
+        RuleInputs inputs = Steady();
+        std::chrono::microseconds now{0};
+
+        BENCHMARK("FurnaceRules::Evaluate, nothing broken")
+        {
+            now += 50ms;
+            inputs.readings.kilnTemperature += 0.001f;
+            return rules.Evaluate(inputs, now);
+        };
+    }
+} //namespace HeatTreatFurnace::Test
@@ -0,0 +1,348 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Sensor/SamplePipeline.hpp"
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Sensor;
+
+    namespace
+    {
+        ThermocoupleSample Reading(float aTemperature, uint8_t aFaults = 0)
+        {
+            return ThermocoupleSample{.temperature = aTemperature, .coldJunction = 30.0f, .faults = aFaults};
+        }
+
+        ThermocoupleSample Fault(ThermocoupleFault aFault = ThermocoupleFault::OpenCircuit)
+        {
+            return Reading(0.0f, static_cast<uint8_t>(aFault));
+        }
+
+        /** @brief What came out of aPipeline, or a single stage, for aInputs in order */
+        template <typename Pipeline>
+        std::vector<ThermocoupleSample> Run(Pipeline& aPipeline, const std::vector<ThermocoupleSample>& aInputs)
+        {
+            std::vector<ThermocoupleSample> outputs;
+            for (ThermocoupleSample sample : aInputs)
+            {
+                if (aPipeline.Process(sample))
+                {
+                    outputs.push_back(sample);
+                }
+            }
+            return outputs;
+        }
+
+        // The same stages behind a virtual call each, for the benchmark
+        struct VirtualStage
+        {
+            virtual ~VirtualStage() = default;
+            virtual bool Process(ThermocoupleSample& aSample) = 0;
+        };
+
+        template <typename Stage>
+        struct VirtualAdapter : VirtualStage
+        {
+            bool Process(ThermocoupleSample& aSample) override
+            {
+                return stage.Process(aSample);
+            }
+
+            Stage stage;
+        };
+    }
+
+    static_assert(SampleStage<OutlierRejection<>>);
+    static_assert(SampleStage<GraceCounter>);
+    static_assert(SampleStage<Oversampler<4>>);
+    static_assert(SampleStage<RunningMedian<5>>);
+    // Fixed by the template arguments; no heap behind it
+    static_assert(sizeof(SensorPipeline) <= 128);
+
+    TEST_CASE("SamplePipeline: an SSR spike doesn't reach the consumers")
+    {
+        SensorPipeline pipeline;
+        std::vector<ThermocoupleSample> inputs(200, Reading(850.0f));
+        inputs[57] = Reading(930.0f);
+        inputs[58] = Reading(-12.5f);
+        inputs[131] = Reading(851.0f + 40.0f);
+
+        const std::vector<ThermocoupleSample> outputs = Run(pipeline, inputs);
+        REQUIRE(outputs.size() == 50);
+        for (const ThermocoupleSample& output : outputs)
+        {
+            REQUIRE(output.IsValid());
+            REQUIRE(output.temperature == 850.0f);
+        }
+    }
+
+    TEST_CASE("SamplePipeline: OutlierRejection")
+    {
+        OutlierRejection<3> rejection;
+        rejection.SetMaxStep(5.0f);
+
+        ThermocoupleSample sample = Reading(600.0f);
+        REQUIRE(rejection.Process(sample));
+        REQUIRE(sample.IsValid());
+
+        SECTION("Readings within a step of the last accepted one pass")
+        {
+            for (float temperature = 600.0f; temperature < 700.0f; temperature += 4.75f)
+            {
+                sample = Reading(temperature);
+                REQUIRE(rejection.Process(sample));
+                REQUIRE(sample.IsValid());
+            }
+        }
+
+        SECTION("A single wild reading is flagged, and the reference kept")
+        {
+            sample = Reading(640.0f);
+            REQUIRE(rejection.Process(sample));
+            REQUIRE(sample.Has(ThermocoupleFault::Outlier));
+            REQUIRE(sample.temperature == 640.0f);
+
+            sample = Reading(601.0f);
+            rejection.Process(sample);
+            REQUIRE(sample.IsValid());
+        }
+
+        SECTION("A real step is accepted once three readings agree on it")
+        {
+            for (const float temperature : {700.0f, 701.0f})
+            {
+                sample = Reading(temperature);
+                rejection.Process(sample);
+                REQUIRE(sample.Has(ThermocoupleFault::Outlier));
+            }
+            sample = Reading(700.5f);
+            rejection.Process(sample);
+            REQUIRE(sample.IsValid());
+            sample = Reading(702.0f);
+            rejection.Process(sample);
+            REQUIRE(sample.IsValid());
+        }
+
+        SECTION("Outliers that disagree with each other never confirm")
+        {
+            for (int i = 0; i < 20; ++i)
+            {
+                sample = Reading(i % 2 == 0 ? 700.0f : 500.0f);
+                rejection.Process(sample);
+                REQUIRE(sample.Has(ThermocoupleFault::Outlier));
+            }
+        }
+
+        SECTION("Faults pass untouched")
+        {
+            sample = Fault(ThermocoupleFault::ShortToVcc);
+            REQUIRE(rejection.Process(sample));
+            REQUIRE(sample.faults == static_cast<uint8_t>(ThermocoupleFault::ShortToVcc));
+        }
+    }
+
+    TEST_CASE("SamplePipeline: GraceCounter - MAX31855_Error_Grace_Count")
+    {
+        GraceCounter grace;
+        grace.SetGraceCount(5);
+
+        SECTION("Before any valid reading a fault passes")
+        {
+            ThermocoupleSample sample = Fault();
+            REQUIRE(grace.Process(sample));
+            REQUIRE_FALSE(sample.IsValid());
+        }
+
+        ThermocoupleSample sample = Reading(412.25f);
+        grace.Process(sample);
+
+        SECTION("Up to the grace count, the last valid reading stands in")
+        {
+            for (int i = 0; i < 5; ++i)
+            {
+                sample = Fault();
+                REQUIRE(grace.Process(sample));
+                REQUIRE(sample.IsValid());
+                REQUIRE(sample.temperature == 412.25f);
+                REQUIRE(sample.coldJunction == 30.0f);
+            }
+            sample = Fault();
+            grace.Process(sample);
+            REQUIRE(sample.Has(ThermocoupleFault::OpenCircuit));
+            REQUIRE(grace.Errors() == 6);
+        }
+
+        SECTION("Sporadic faults never add up")
+        {
+            for (int i = 0; i < 1000; ++i)
+            {
+                sample = i % 2 == 0 ? Fault() : Reading(412.0f);
+                grace.Process(sample);
+                REQUIRE(sample.IsValid());
+            }
+        }
+
+        SECTION("A sensor failing more often than it reads trips, however spread out")
+        {
+            int tripped = -1;
+            for (int i = 0; i < 100 && tripped < 0; ++i)
+            {
+                sample = i % 3 == 2 ? Reading(412.0f) : Fault();
+                grace.Process(sample);
+                tripped = sample.IsValid() ? -1 : i;
+            }
+            REQUIRE(tripped == 13);
+        }
+
+        SECTION("A grace count of 0 passes every fault")
+        {
+            grace.SetGraceCount(0);
+            sample = Fault();
+            grace.Process(sample);
+            REQUIRE_FALSE(sample.IsValid());
+        }
+    }
+
+    TEST_CASE("SamplePipeline: Oversampler")
+    {
+        Oversampler<4> oversampler;
+        const std::vector<ThermocoupleSample> outputs = Run(oversampler, {Reading(100.0f), Reading(100.25f), Reading(100.5f), Reading(100.25f),
+                                                                          Reading(200.0f), Reading(201.0f)});
+        REQUIRE(outputs.size() == 1);
+        REQUIRE(outputs[0].temperature == 100.25f);
+        REQUIRE(outputs[0].coldJunction == 30.0f);
+
+        // A fault comes out at once, and the partial average is dropped
+        ThermocoupleSample sample = Fault();
+        REQUIRE(oversampler.Process(sample));
+        REQUIRE_FALSE(sample.IsValid());
+        for (int i = 0; i < 3; ++i)
+        {
+            sample = Reading(300.0f);
+            REQUIRE_FALSE(oversampler.Process(sample));
+        }
+        sample = Reading(300.0f);
+        REQUIRE(oversampler.Process(sample));
+        REQUIRE(sample.temperature == 300.0f);
+    }
+
+    TEST_CASE("SamplePipeline: RunningMedian matches a sort of the window")
+    {
+        RunningMedian<7> median;
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> temperatures(0.0f, 1300.0f);
+        std::vector<float> history;
+        for (int i = 0; i < 5000; ++i)
+        {
+            // Repeated values too, which the sorted window has to find the right copy of
+            const float temperature = i % 5 == 0 && !history.empty() ? history.back() : temperatures(random);
+            history.push_back(temperature);
+            ThermocoupleSample sample = Reading(temperature);
+            REQUIRE(median.Process(sample));
+
+            std::vector<float> window(history.end() - std::min<std::ptrdiff_t>(7, std::ssize(history)), history.end());
+            std::ranges::sort(window);
+            REQUIRE(sample.temperature == window[window.size() / 2]);
+        }
+
+        // A fault empties the window
+        ThermocoupleSample sample = Fault();
+        REQUIRE(median.Process(sample));
+        REQUIRE_FALSE(sample.IsValid());
+        sample = Reading(55.0f);
+        median.Process(sample);
+        REQUIRE(sample.temperature == 55.0f);
+    }
+
+    TEST_CASE("SamplePipeline: composition")
+    {
+        SECTION("A swallowed sample doesn't reach later stages")
+        {
+            SamplePipeline<Oversampler<2>, RunningMedian<3>> pipeline;
+            const std::vector<ThermocoupleSample> outputs = Run(pipeline, {Reading(10.0f), Reading(20.0f), Reading(30.0f), Reading(40.0f),
+                                                                           Reading(1000.0f), Reading(1000.0f), Reading(50.0f), Reading(60.0f)});
+            REQUIRE(outputs.size() == 4);
+            REQUIRE(outputs[0].temperature == 15.0f);
+            REQUIRE(outputs[1].temperature == 35.0f);
+            REQUIRE(outputs[2].temperature == 35.0f);
+            REQUIRE(outputs[3].temperature == 55.0f);
+        }
+
+        SECTION("Once the grace count has run out, a fault goes straight through")
+        {
+            SensorPipeline pipeline;
+            pipeline.GetStage<GraceCounter>().SetGraceCount(2);
+            std::vector<ThermocoupleSample> inputs(8, Reading(700.0f));
+            inputs.insert(inputs.end(), 3, Fault(ThermocoupleFault::ShortToGround));
+            const std::vector<ThermocoupleSample> outputs = Run(pipeline, inputs);
+            REQUIRE(outputs.size() == 3);
+            REQUIRE(outputs[1].IsValid());
+            REQUIRE(outputs[2].Has(ThermocoupleFault::ShortToGround));
+        }
+
+        SECTION("Outliers past the grace count are a fault")
+        {
+            SensorPipeline pipeline;
+            pipeline.GetStage<GraceCounter>().SetGraceCount(1);
+            const std::vector<ThermocoupleSample> outputs = Run(pipeline, {Reading(700.0f), Reading(700.0f), Reading(700.0f), Reading(700.0f),
+                                                                           Reading(900.0f), Reading(100.0f)});
+            REQUIRE(outputs.size() == 2);
+            REQUIRE(outputs[1].Has(ThermocoupleFault::Outlier));
+        }
+
+        SECTION("Reset forgets every stage")
+        {
+            SamplePipeline<OutlierRejection<>, Oversampler<2>> pipeline;
+            Run(pipeline, {Reading(700.0f), Reading(700.0f), Reading(700.0f)});
+            pipeline.Reset();
+            const std::vector<ThermocoupleSample> outputs = Run(pipeline, {Reading(20.0f), Reading(20.0f)});
+            REQUIRE(outputs.size() == 1);
+            REQUIRE(outputs[0].IsValid());
+            REQUIRE(outputs[0].temperature == 20.0f);
+        }
+    }
+
+    TEST_CASE("SamplePipeline: benchmark", "[.][benchmark]")
+    {
+        std::mt19937 random(7);
+        std::normal_distribution<float> noise(0.0f, 0.5f);
+        std::array<ThermocoupleSample, 1024> inputs{};
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            inputs[i] = i % 97 == 0 ? Reading(2000.0f) : Reading(900.0f + static_cast<float>(i) * 0.01f + noise(random));
+        }
+
+        SensorPipeline pipeline;
+        size_t next = 0;
+        BENCHMARK("SensorPipeline, per sample")
+        {
+            ThermocoupleSample sample = inputs[next++ % inputs.size()];
+            return pipeline.Process(sample) ? sample.temperature : 0.0f;
+        };
+
+        std::vector<std::unique_ptr<VirtualStage>> stages;
+        stages.push_back(std::make_unique<VirtualAdapter<OutlierRejection<>>>());
+        stages.push_back(std::make_unique<VirtualAdapter<GraceCounter>>());
+        stages.push_back(std::make_unique<VirtualAdapter<Oversampler<4>>>());
+        stages.push_back(std::make_unique<VirtualAdapter<RunningMedian<5>>>());
+        BENCHMARK("Same stages behind virtual calls, per sample")
+        {
+            ThermocoupleSample sample = inputs[next++ % inputs.size()];
+            for (const std::unique_ptr<VirtualStage>& stage : stages)
+            {
+                if (!stage->Process(sample))
+                {
+                    return 0.0f;
+                }
+            }
+            return sample.temperature;
+        };
+    }
+} //namespace HeatTreatFurnace::Test
@@ -0,0 +1,297 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Furnace/StateSnapshot.hpp"
+#include "Sensor/ReplayThermocouple.hpp"
+#include "Sensor/SensorPublisher.hpp"
+#include "Sync/Snapshot.hpp"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Sync;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        /** @brief Every field is the same count, so a torn copy shows as a mismatch */
+        template <size_t FIELDS>
+        struct Stamped
+        {
+            std::array<uint32_t, FIELDS> fields{};
+
+            explicit Stamped(uint32_t aCount = 0)
+            {
+                fields.fill(aCount);
+            }
+
+            [[nodiscard]] bool IsWhole() const
+            {
+                for (const uint32_t field : fields)
+                {
+                    if (field != fields[0])
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        };
+
+        struct StressResult
+        {
+            long reads = 0;
+            long retries = 0;
+            int problems = 0;
+        };
+
+        /** @brief aWriters snapshots, each with its own writer; aReaders readers reading all of them */
+        template <size_t FIELDS>
+        StressResult Stress(size_t aWriters, size_t aReaders, uint32_t aPublishes)
+        {
+            std::vector<std::unique_ptr<Snapshot<Stamped<FIELDS>>>> snapshots;
+            for (size_t i = 0; i < aWriters; ++i)
+            {
+                snapshots.push_back(std::make_unique<Snapshot<Stamped<FIELDS>>>());
+            }
+
+            std::atomic<size_t> writing{aWriters};
+            std::atomic<long> reads{0};
+            std::atomic<long> retries{0};
+            std::atomic<int> problems{0};
+
+            std::vector<std::thread> threads;
+            for (size_t reader = 0; reader < aReaders; ++reader)
+            {
+                threads.emplace_back([&]
+                {
+                    std::vector<uint32_t> last(snapshots.size(), 0);
+                    long myReads = 0;
+                    long myRetries = 0;
+                    while (writing.load(std::memory_order_relaxed) > 0)
+                    {
+                        for (size_t i = 0; i < snapshots.size(); ++i)
+                        {
+                            Stamped<FIELDS> value;
+                            uint32_t version;
+                            while (!snapshots[i]->TryRead(value, version))
+                            {
+                                ++myRetries;
+                            }
+                            // Each publish is stamped with its own version
+                            if (!value.IsWhole() || value.fields[0] < last[i] || value.fields[0] != version)
+                            {
+                                ++problems;
+                            }
+                            last[i] = value.fields[0];
+                            ++myReads;
+                        }
+                    }
+                    reads += myReads;
+                    retries += myRetries;
+                });
+            }
+            for (size_t writer = 0; writer < aWriters; ++writer)
+            {
+                threads.emplace_back([&, writer]
+                {
+                    for (uint32_t count = 1; count <= aPublishes; ++count)
+                    {
+                        snapshots[writer]->Publish(Stamped<FIELDS>(count));
+                    }
+                    --writing;
+                });
+            }
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+
+            for (const auto& snapshot : snapshots)
+            {
+                if (snapshot->Read().fields[0] != aPublishes || snapshot->Version() != aPublishes)
+                {
+                    ++problems;
+                }
+            }
+            return {reads.load(), retries.load(), problems.load()};
+        }
+    }
+
+    TEST_CASE("Snapshot: publish and read")
+    {
+        Snapshot<Stamped<5>> snapshot(Stamped<5>(7));
+        REQUIRE(snapshot.Version() == 0);
+        REQUIRE(snapshot.Read().fields[0] == 7);
+        REQUIRE(snapshot.Read().IsWhole());
+
+        // Round the ring a few times
+        for (uint32_t count = 1; count <= 10; ++count)
+        {
+            snapshot.Publish(Stamped<5>(count));
+            Stamped<5> value;
+            REQUIRE(snapshot.TryRead(value));
+            REQUIRE(value.fields[0] == count);
+            REQUIRE(value.IsWhole());
+            REQUIRE(snapshot.Version() == count);
+
+            uint32_t version = 0;
+            REQUIRE(snapshot.Read(version).fields[0] == count);
+            REQUIRE(version == count);
+        }
+    }
+
+    TEST_CASE("Snapshot: sizes that aren't whole words")
+    {
+        struct Odd
+        {
+            uint8_t a = 0;
+            uint16_t b = 0;
+            std::array<char, 6> c{};
+            double d = 0.0;
+            uint8_t e = 0;
+        };
+        Snapshot<Odd, 2> snapshot;
+        snapshot.Publish({1, 2, {'a', 'b', 'c', 'd', 'e', 'f'}, 3.5, 4});
+        const Odd value = snapshot.Read();
+        REQUIRE(value.a == 1);
+        REQUIRE(value.b == 2);
+        REQUIRE(value.c[5] == 'f');
+        REQUIRE(value.d == 3.5);
+        REQUIRE(value.e == 4);
+    }
+
+    TEST_CASE("Snapshot: concurrent readers and writers never see a torn or older value")
+    {
+        SECTION("Sensor sized, one writer, four readers")
+        {
+            const StressResult result = Stress<6>(1, 4, 1000000);
+            INFO(result.reads << " reads, " << result.retries << " retries");
+            REQUIRE(result.reads > 0);
+            REQUIRE(result.problems == 0);
+        }
+
+        SECTION("State sized, two snapshots with a writer each, three readers")
+        {
+            const StressResult result = Stress<20>(2, 3, 300000);
+            INFO(result.reads << " reads, " << result.retries << " retries");
+            REQUIRE(result.reads > 0);
+            REQUIRE(result.problems == 0);
+        }
+    }
+
+    TEST_CASE("Snapshot: SensorPublisher - kiln, environment and case from one batch")
+    {
+        Time::ManualClock clock;
+        Sensor::ReplayThermocouple replay(clock, 2, [](size_t aChannel, std::chrono::microseconds aNow)
+        {
+            const float minutes = std::chrono::duration<float, std::ratio<60>>(aNow).count();
+            return aChannel == 0 ? 20.0f + minutes : 25.0f + minutes / 10.0f;
+        });
+        replay.SetThermocoupleType(Sensor::ThermocoupleType::K);
+        Sensor::SensorPublisher publisher(replay, Sensor::ThermocoupleType::K);
+        Furnace::Preferences preferences;
+        preferences.max31855ErrorGraceCount = 0;
+        publisher.ApplyPreferences(preferences);
+
+        Sensor::SensorReadings readings = publisher.Latest();
+        REQUIRE(readings.sequence == 0);
+        REQUIRE_FALSE(readings.IsKilnValid());
+
+        // The pipeline averages four batches into a reading
+        clock.Advance(10min);
+        replay.SetColdJunction(31.5f);
+        for (int batch = 0; batch < 4; ++batch)
+        {
+            REQUIRE(publisher.GetSnapshot().Version() == 0);
+            replay.Poll();
+            publisher.Poll();
+        }
+        readings = publisher.Latest();
+        REQUIRE(readings.sequence == 4);
+        REQUIRE(readings.IsKilnValid());
+        // Within the chip's 0.25 °C steps
+        REQUIRE(readings.kilnTemperature == Catch::Approx(30.0f).margin(0.15f));
+        REQUIRE(readings.envTemperature == 31.5f);
+        REQUIRE(readings.caseTemperature == Catch::Approx(26.0f).margin(0.15f));
+
+        // Nothing new, nothing published
+        publisher.Poll();
+        REQUIRE(publisher.GetSnapshot().Version() == 1);
+
+        // With no grace a fault is published at once; the case keeps its last reading
+        replay.InjectFault({0, Sensor::ThermocoupleFault::OpenCircuit, 0us, std::chrono::microseconds(1h)});
+        replay.Poll();
+        publisher.Poll();
+        readings = publisher.Latest();
+        REQUIRE(readings.sequence == 5);
+        REQUIRE_FALSE(readings.IsKilnValid());
+        REQUIRE(readings.caseFaults == 0);
+        REQUIRE(readings.caseTemperature == Catch::Approx(26.0f).margin(0.15f));
+        REQUIRE(publisher.GetSnapshot().Version() == 2);
+    }
+
+    TEST_CASE("Snapshot: StateSnapshot")
+    {
+        Furnace::StateSnapshot state;
+        state.state = Furnace::StateId::RUNNING;
+        state.SetProgramName("cone 6 glaze with a slow cool and a long hold");
+        state.kilnTemp = 1180.5f;
+        state.segment = 3;
+        state.currTimeMs = 1'760'000'000'000;
+        REQUIRE(state.ProgramName() == "cone 6 glaze with a slow cool a");
+
+        Snapshot<Furnace::StateSnapshot> snapshot;
+        REQUIRE(snapshot.Read().state == Furnace::StateId::IDLE);
+        REQUIRE(snapshot.Read().ProgramName().empty());
+        snapshot.Publish(state);
+        const Furnace::StateSnapshot read = snapshot.Read();
+        REQUIRE(read.state == Furnace::StateId::RUNNING);
+        REQUIRE(read.ProgramName() == state.ProgramName());
+        REQUIRE(read.kilnTemp == 1180.5f);
+        REQUIRE(read.segment == 3);
+        REQUIRE(read.currTimeMs == 1'760'000'000'000);
+
+        state.SetProgramName("bisque");
+        REQUIRE(state.ProgramName() == "bisque");
+    }
+
+    TEST_CASE("Snapshot: reader latency", "[.][benchmark]")
+    {
+        Snapshot<Sensor::SensorReadings> sensors;
+        Snapshot<Furnace::StateSnapshot> state;
+        sensors.Publish({});
+        state.Publish({});
+
+        BENCHMARK("Read SensorReadings, no writer")
+        {
+            return sensors.Read().kilnTemperature;
+        };
+        BENCHMARK("Read StateSnapshot, no writer")
+        {
+            return state.Read().kilnTemp;
+        };
+
+        std::atomic<bool> stop{false};
+        std::thread writer([&]
+        {
+            Sensor::SensorReadings readings;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                readings.kilnTemperature += 0.25f;
+                sensors.Publish(readings);
+            }
+        });
+        BENCHMARK("Read SensorReadings, writer publishing flat out")
+        {
+            return sensors.Read().kilnTemperature;
+        };
+        stop = true;
+        writer.join();
+    }
+} //namespace HeatTreatFurnace::Test
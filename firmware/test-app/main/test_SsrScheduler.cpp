@@ -0,0 +1,184 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+#include "Control/SsrScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Control;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        constexpr std::chrono::milliseconds TICK = 100ms;
+
+        struct OutputStats
+        {
+            uint32_t switches = 0;
+            std::chrono::milliseconds onTime{0};
+            std::chrono::milliseconds requestedOnTime{0};
+        };
+
+        /** @brief Runs aDuration ticks, with heat percent from aDuty(elapsed); the duty is re-read every PID window like the PID would */
+        OutputStats RunScheduler(SsrScheduler& aScheduler, std::chrono::milliseconds aDuration, const std::function<float(std::chrono::milliseconds)>& aDuty)
+        {
+            OutputStats stats;
+            const uint32_t startSwitches = aScheduler.SwitchCount();
+            double requestedMs = 0.0;
+            for (std::chrono::milliseconds t{0}; t < aDuration; t += TICK)
+            {
+                if (t % 5000ms == 0ms)
+                {
+                    aScheduler.SetDuty(aDuty(t));
+                }
+                requestedMs += aScheduler.GetDuty() / 100.0 * static_cast<double>(TICK.count());
+                if (aScheduler.Update(TICK))
+                {
+                    stats.onTime += TICK;
+                }
+            }
+            stats.switches = aScheduler.SwitchCount() - startSwitches;
+            stats.requestedOnTime = std::chrono::milliseconds(std::llround(requestedMs));
+            return stats;
+        }
+
+        /** @brief The usual time-proportioning: on for duty × window, to the nearest tick, at the start of every window */
+        OutputStats RunNaiveWindow(std::chrono::milliseconds aDuration, const std::function<float(std::chrono::milliseconds)>& aDuty)
+        {
+            OutputStats stats;
+            bool on = false;
+            std::chrono::milliseconds onFor{0};
+            for (std::chrono::milliseconds t{0}; t < aDuration; t += TICK)
+            {
+                if (t % 5000ms == 0ms)
+                {
+                    onFor = TICK * std::lround(aDuty(t) / 100.0f * 5000.0f / static_cast<float>(TICK.count()));
+                }
+                const bool next = t % 5000ms < onFor;
+                stats.switches += next != on ? 1 : 0;
+                on = next;
+                stats.onTime += on ? TICK : 0ms;
+            }
+            return stats;
+        }
+    }
+
+    TEST_CASE("SsrScheduler: 0% and 100% never switch")
+    {
+        SsrScheduler scheduler;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            REQUIRE_FALSE(scheduler.Update(TICK));
+        }
+        REQUIRE(scheduler.TimeToNextSwitch() == std::chrono::milliseconds::max());
+
+        scheduler.SetDuty(100.0f);
+        for (int i = 0; i < 100; ++i)
+        {
+            REQUIRE(scheduler.Update(TICK)); // it has been off for longer than the minimum
+        }
+        REQUIRE(scheduler.SwitchCount() == 1);
+        REQUIRE(scheduler.TimeToNextSwitch() == std::chrono::milliseconds::max());
+    }
+
+    TEST_CASE("SsrScheduler: one cycle per window, stretched by the minimum times near 0% and 100%")
+    {
+        SsrScheduler scheduler({5000ms, 1000ms, 500ms});
+
+        SECTION("Mid range: one cycle per window")
+        {
+            RunScheduler(scheduler, 60s, [](auto) { return 50.0f; });
+            REQUIRE(scheduler.SwitchCount() >= 23);
+            REQUIRE(scheduler.SwitchCount() <= 24);
+        }
+
+        SECTION("Low duty: minimum on, long off")
+        {
+            RunScheduler(scheduler, 60s, [](auto) { return 10.0f; }); // 1s on, 9s off
+            REQUIRE(scheduler.SwitchCount() >= 11);
+            REQUIRE(scheduler.SwitchCount() <= 12);
+        }
+
+        SECTION("High duty: minimum off, long on")
+        {
+            RunScheduler(scheduler, 60s, [](auto) { return 95.0f; }); // 9.5s on, 0.5s off
+            REQUIRE(scheduler.SwitchCount() >= 11);
+            REQUIRE(scheduler.SwitchCount() <= 12);
+        }
+
+        SECTION("Delivered on-time matches the duty")
+        {
+            const OutputStats stats = RunScheduler(scheduler, 600s, [](auto) { return 37.0f; });
+            REQUIRE(std::abs((stats.onTime - stats.requestedOnTime).count()) <= 5000);
+        }
+    }
+
+    TEST_CASE("SsrScheduler: TimeToNextSwitch follows duty changes mid-window")
+    {
+        SsrScheduler scheduler({5000ms, 1000ms, 1000ms});
+        const float duties[] = {50.0f, 20.0f, 90.0f, 35.0f, 5.0f, 60.0f};
+
+        for (const float duty : duties)
+        {
+            scheduler.SetDuty(duty);
+            scheduler.Update(700ms); // part way into whatever the output is doing
+
+            const std::chrono::milliseconds wait = scheduler.TimeToNextSwitch();
+            REQUIRE(wait > 1ms);
+            REQUIRE(wait <= 20s);
+            const bool wasOn = scheduler.IsOn();
+            REQUIRE(scheduler.Update(wait - 1ms) == wasOn);
+            REQUIRE(scheduler.Update(1ms) != wasOn);
+        }
+
+        scheduler.SetDuty(100.0f);
+        REQUIRE(scheduler.Update(scheduler.TimeToNextSwitch()));
+        scheduler.SetDuty(0.0f);
+        REQUIRE(scheduler.TimeToNextSwitch() == 1000ms); // still has to finish its minimum on time
+        scheduler.Update(1000ms);
+        REQUIRE_FALSE(scheduler.IsOn());
+        REQUIRE(scheduler.TimeToNextSwitch() == std::chrono::milliseconds::max());
+
+        SECTION("Reset turns the output off and forgets the error")
+        {
+            scheduler.SetDuty(100.0f);
+            REQUIRE(scheduler.Update(1000ms));
+            scheduler.Reset();
+            REQUIRE_FALSE(scheduler.IsOn());
+            REQUIRE_FALSE(scheduler.Update(100ms));
+        }
+    }
+
+    TEST_CASE("SsrScheduler: a third fewer switches than a fixed window over a firing")
+    {
+        // Heat percent through an 8 hour firing: a ramp that ends up near full power, a long soak near
+        // the bottom of the range, then natural cooling. The wobble stands in for the PID's sample to
+        // sample changes.
+        const auto duty = [](std::chrono::milliseconds aTime)
+        {
+            const float hours = std::chrono::duration<float, std::ratio<3600>>(aTime).count();
+            const float wobble = std::sin(static_cast<float>(aTime.count()) / 37000.0f);
+            if (hours < 4.0f)
+            {
+                return std::min(100.0f, 60.0f + 10.0f * hours + 10.0f * wobble);
+            }
+            if (hours < 6.0f)
+            {
+                return 8.0f + 6.0f * wobble;
+            }
+            return 0.0f;
+        };
+
+        const OutputStats naive = RunNaiveWindow(8h, duty);
+        SsrScheduler scheduler({5000ms, 1000ms, 1000ms});
+        const OutputStats scheduled = RunScheduler(scheduler, 8h, duty);
+
+        REQUIRE(scheduled.switches * 3 < naive.switches * 2);
+        REQUIRE(std::abs((scheduled.onTime - scheduled.requestedOnTime).count()) <= 5000);
+        REQUIRE(scheduled.onTime.count() == Catch::Approx(naive.onTime.count()).epsilon(0.01));
+    }
+} //namespace HeatTreatFurnace::Test
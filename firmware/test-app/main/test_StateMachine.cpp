@@ -1,11 +1,15 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/trompeloeil.hpp>
 
+#include <catch2/catch_approx.hpp>
+
 #include "Furnace/StateMachine.hpp"
 #include "Furnace/State.hpp"
 #include "Furnace/Result.hpp"
 #include "Log/LogService.hpp"
 #include "Log/LogBackend.hpp"
+#include "Program/ProgramJson.hpp"
+#include "Time/Clock.hpp"
 #include <memory>
 
 #include "Furnace/Furnace.hpp"
@@ -14,6 +18,7 @@ namespace HeatTreatFurnace::Test
 {
     using namespace HeatTreatFurnace::Furnace;
     using namespace HeatTreatFurnace::Log;
+    using namespace std::chrono_literals;
 
     class MockBaseState : public BaseState
     {
@@ -39,19 +44,34 @@ namespace HeatTreatFurnace::Test
         }
 
         FurnaceState myFurnaceState;
+        Time::ManualClock myClock;
         LogService::LogBackendVec myLogBackends{};
         NullLogBackend myNullLogBackend;
     };
 
     TEST_CASE_METHOD(StateMachineFixture, "StateMachine: Constructor - initializes to IDLE state")
     {
-        StateMachine stateMachine(myFurnaceState, *myLog);
+        StateMachine stateMachine(myFurnaceState, myClock, *myLog);
         REQUIRE(stateMachine.GetState() == StateId::IDLE);
     }
 
+    TEST_CASE_METHOD(StateMachineFixture, "State: Name - each state has its own name")
+    {
+        REQUIRE(TransitioningState(myFurnaceState).Name() == "Transitioning");
+        REQUIRE(IdleState(myFurnaceState).Name() == "Idle");
+        REQUIRE(LoadedState(myFurnaceState).Name() == "Loaded");
+        REQUIRE(RunningState(myFurnaceState).Name() == "Running");
+        REQUIRE(PausedState(myFurnaceState).Name() == "Paused");
+        REQUIRE(CompletedState(myFurnaceState).Name() == "Completed");
+        REQUIRE(CancelledState(myFurnaceState).Name() == "Cancelled");
+        REQUIRE(ErrorState(myFurnaceState).Name() == "Error");
+        REQUIRE(WaitingForTempState(myFurnaceState).Name() == "WaitingForTemp");
+        REQUIRE(AutotuningState(myFurnaceState).Name() == "Autotuning");
+    }
+
     TEST_CASE_METHOD(StateMachineFixture, "StateMachine: GetState - returns current state")
     {
-        StateMachine stateMachine(myFurnaceState, *myLog);
+        StateMachine stateMachine(myFurnaceState, myClock, *myLog);
 
         SECTION("Returns IDLE after construction")
         {
@@ -67,7 +87,7 @@ namespace HeatTreatFurnace::Test
 
     TEST_CASE_METHOD(StateMachineFixture, "StateMachine: CanTransition - valid transitions are allowed")
     {
-        StateMachine stateMachine(myFurnaceState, *myLog);
+        StateMachine stateMachine(myFurnaceState, myClock, *myLog);
 
         SECTION("From IDLE state")
         {
@@ -151,7 +171,7 @@ namespace HeatTreatFurnace::Test
 
     TEST_CASE_METHOD(StateMachineFixture, "StateMachine: CanTransition - invalid transitions are rejected")
     {
-        StateMachine stateMachine(myFurnaceState, *myLog);
+        StateMachine stateMachine(myFurnaceState, myClock, *myLog);
 
         SECTION("IDLE cannot transition to RUNNING")
         {
@@ -230,7 +250,7 @@ namespace HeatTreatFurnace::Test
         mockStates.insert({StateId::IDLE, std::move(mockIdleState)});
         mockStates.insert({StateId::LOADED, std::move(mockLoadedState)});
 
-        StateMachine stateMachine(mockFurnace, *myLog);
+        StateMachine stateMachine(mockFurnace, std::move(mockStates), myClock, *myLog);
 
         REQUIRE(stateMachine.GetState() == StateId::IDLE);
         REQUIRE(stateMachine.TransitionTo(StateId::LOADED));
@@ -240,7 +260,7 @@ namespace HeatTreatFurnace::Test
     TEST_CASE_METHOD(StateMachineFixture, "StateMachine: TransitionTo - multiple sequential transitions")
     {
         FurnaceState mockFurnace;
-        StateMachine stateMachine(mockFurnace, *myLog);
+        StateMachine stateMachine(mockFurnace, myClock, *myLog);
 
         REQUIRE(stateMachine.GetState() == StateId::IDLE);
         REQUIRE(stateMachine.TransitionTo(StateId::LOADED));
@@ -256,7 +276,7 @@ namespace HeatTreatFurnace::Test
     TEST_CASE_METHOD(StateMachineFixture, "StateMachine: TransitionTo - invalid transition returns false")
     {
         FurnaceState mockFurnace;
-        StateMachine stateMachine(mockFurnace, *myLog);
+        StateMachine stateMachine(mockFurnace, myClock, *myLog);
 
         REQUIRE(stateMachine.GetState() == StateId::IDLE);
         REQUIRE_FALSE(stateMachine.TransitionTo(StateId::RUNNING));
@@ -285,7 +305,7 @@ namespace HeatTreatFurnace::Test
         mockStates.insert({StateId::IDLE, std::move(mockIdleState)});
         mockStates.insert({StateId::ERROR, std::move(mockErrorState)});
 
-        StateMachine stateMachine(mockFurnace, *myLog);
+        StateMachine stateMachine(mockFurnace, std::move(mockStates), myClock, *myLog);
 
         REQUIRE(stateMachine.GetState() == StateId::IDLE);
         REQUIRE_FALSE(stateMachine.TransitionTo(StateId::LOADED));
@@ -321,10 +341,93 @@ namespace HeatTreatFurnace::Test
         mockStates.insert({StateId::LOADED, std::move(mockLoadedState)});
         mockStates.insert({StateId::ERROR, std::move(mockErrorState)});
 
-        StateMachine stateMachine(mockFurnace, *myLog);
+        StateMachine stateMachine(mockFurnace, std::move(mockStates), myClock, *myLog);
 
         REQUIRE(stateMachine.GetState() == StateId::IDLE);
         REQUIRE_FALSE(stateMachine.TransitionTo(StateId::LOADED));
         REQUIRE(stateMachine.GetState() == StateId::ERROR);
     }
+
+    TEST_CASE_METHOD(StateMachineFixture, "StateMachine: TransitionTo - resets the PID on stop, finish and error")
+    {
+        StateMachine stateMachine(myFurnaceState, myClock, *myLog);
+        REQUIRE(stateMachine.TransitionTo(StateId::LOADED));
+        REQUIRE(stateMachine.TransitionTo(StateId::RUNNING));
+
+        stateMachine.GetPid().Update(500.0f, 20.0f);
+        REQUIRE(stateMachine.GetPid().Integral() != 0.0f);
+
+        SECTION("Pausing keeps the integral")
+        {
+            REQUIRE(stateMachine.TransitionTo(StateId::PAUSED));
+            REQUIRE(stateMachine.GetPid().Integral() != 0.0f);
+        }
+
+        SECTION("Stopping resets it")
+        {
+            REQUIRE(stateMachine.TransitionTo(StateId::CANCELLED));
+            REQUIRE(stateMachine.GetPid().Integral() == 0.0f);
+        }
+
+        SECTION("Finishing resets it")
+        {
+            REQUIRE(stateMachine.TransitionTo(StateId::COMPLETED));
+            REQUIRE(stateMachine.GetPid().Integral() == 0.0f);
+        }
+
+        SECTION("An error resets it")
+        {
+            REQUIRE(stateMachine.TransitionTo(StateId::ERROR));
+            REQUIRE(stateMachine.GetPid().Integral() == 0.0f);
+        }
+    }
+
+    TEST_CASE_METHOD(StateMachineFixture, "StateMachine: GetSetpoint - follows the ramp StartProfile() re-anchored")
+    {
+        // 275 °C in 2 h, then 500 °C in 2 h for 1 h
+        std::vector<uint8_t> compiled;
+        REQUIRE(Program::ProgramJson::Import(R"({ "segments": [
+            { "target": 275, "ramp_time": { "hours": 2 }, "dwell_time": {} },
+            { "target": 500, "ramp_time": { "hours": 2 }, "dwell_time": { "hours": 1 } }
+        ] })", compiled));
+        auto profile = std::make_unique<Profile>();
+        REQUIRE(profile->Load("reanchor.json", std::move(compiled)));
+
+        StateMachine stateMachine(myFurnaceState, myClock, *myLog);
+        REQUIRE(stateMachine.LoadProfile(std::move(profile), 25.0f));
+
+        SECTION("Minute 60 of the first ramp, with the kiln still cold")
+        {
+            REQUIRE(stateMachine.StartProfile(0, 60, 25.0f));
+            REQUIRE(stateMachine.GetSetpoint().setpoint == Catch::Approx(25.0f));
+            REQUIRE(stateMachine.GetSetpoint().slope == Catch::Approx(250.0f / 3600.0f));
+            REQUIRE(stateMachine.GetSegment() == 0);
+
+            myClock.Advance(30min);
+            REQUIRE(stateMachine.GetSetpoint().setpoint == Catch::Approx(150.0f));
+            myClock.Advance(30min);
+            REQUIRE(stateMachine.GetSetpoint().setpoint == Catch::Approx(275.0f));
+            REQUIRE(stateMachine.GetSegment() == 1);
+        }
+
+        SECTION("Segment 2, with the kiln behind where its ramp starts")
+        {
+            REQUIRE(stateMachine.StartProfile(2, 0, 25.0f));
+            REQUIRE(stateMachine.GetStartPosition().segment == 1);
+            REQUIRE(stateMachine.GetSetpoint().setpoint == Catch::Approx(25.0f));
+            REQUIRE(stateMachine.GetSetpoint().slope == Catch::Approx(225.0f / 7200.0f));
+            REQUIRE(stateMachine.GetSegment() == 1);
+
+            // At the programmed rate from 25 °C, then the dwell
+            myClock.Advance(2h);
+            REQUIRE(stateMachine.GetSetpoint().setpoint == Catch::Approx(250.0f));
+            REQUIRE(stateMachine.GetSegment() == 1);
+            myClock.Advance(2h);
+            REQUIRE(stateMachine.GetSetpoint().setpoint == Catch::Approx(475.0f));
+            myClock.Advance(30min);
+            REQUIRE(stateMachine.GetSetpoint().setpoint == 500.0f);
+            REQUIRE(stateMachine.GetSetpoint().slope == 0.0f);
+            REQUIRE(stateMachine.GetSegment() == 1);
+        }
+    }
 }
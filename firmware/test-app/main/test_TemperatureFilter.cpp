@@ -0,0 +1,241 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Control/Pid.hpp"
+#include "Control/TemperatureFilter.hpp"
+#include "Sim/ThermalModel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Control;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        constexpr std::chrono::milliseconds SAMPLE = 1000ms;
+
+        /** @brief MAX31855-like readings: 0.5 °C of noise, quantised to 0.25 °C */
+        class NoisyThermocouple
+        {
+        public:
+            float Read(float aTemperature)
+            {
+                return std::round((aTemperature + myNoise(myRandom)) * 4.0f) / 4.0f;
+            }
+
+        private:
+            std::mt19937 myRandom{38};
+            std::normal_distribution<float> myNoise{0.0f, 0.5f};
+        };
+
+        struct Spread
+        {
+            double sum = 0.0;
+            double sumSquares = 0.0;
+            int count = 0;
+
+            void Add(double aValue)
+            {
+                sum += aValue;
+                sumSquares += aValue * aValue;
+                ++count;
+            }
+
+            [[nodiscard]] double StandardDeviation() const
+            {
+                const double mean = sum / count;
+                return std::sqrt(std::max(0.0, sumSquares / count - mean * mean));
+            }
+        };
+    }
+
+    TEST_CASE("TemperatureFilter: first reading starts the estimate")
+    {
+        TemperatureFilter filter;
+
+        const TemperatureEstimate& estimate = filter.Update(123.25f, SAMPLE);
+        REQUIRE(estimate.temperature == 123.25f);
+        REQUIRE(estimate.rate == 0.0f);
+        REQUIRE(estimate.variance == Catch::Approx(0.25f));
+
+        filter.Reset();
+        REQUIRE(filter.Update(50.0f, SAMPLE).temperature == 50.0f);
+    }
+
+    TEST_CASE("TemperatureFilter: steady kiln - noise out of temperature and rate")
+    {
+        TemperatureFilter filter;
+        NoisyThermocouple thermocouple;
+        Spread raw;
+        Spread filtered;
+        Spread rate;
+        Spread rawRate;
+        float lastReading = 0.0f;
+        for (int i = 0; i < 3600; ++i)
+        {
+            const float reading = thermocouple.Read(500.0f);
+            const TemperatureEstimate& estimate = filter.Update(reading, SAMPLE);
+            if (i >= 300)
+            {
+                raw.Add(reading - 500.0f);
+                filtered.Add(estimate.temperature - 500.0f);
+                rate.Add(estimate.RatePerHour());
+                rawRate.Add((reading - lastReading) * 3600.0f);
+            }
+            lastReading = reading;
+        }
+
+        INFO("raw " << raw.StandardDeviation() << " °C, filtered " << filtered.StandardDeviation() << " °C; rate " << rate.StandardDeviation() << " °C/h, differenced " << rawRate.StandardDeviation() << " °C/h");
+        REQUIRE(filtered.StandardDeviation() < raw.StandardDeviation() / 3.0);
+        REQUIRE(std::abs(filtered.sum / filtered.count) < 0.05);
+        REQUIRE(rate.StandardDeviation() < 15.0);
+        REQUIRE(rate.StandardDeviation() < rawRate.StandardDeviation() / 100.0);
+
+        // The variance settles to a constant, well under a reading's
+        const float settled = filter.Estimate().variance;
+        filter.Update(thermocouple.Read(500.0f), SAMPLE);
+        REQUIRE(filter.Estimate().variance == Catch::Approx(settled).epsilon(0.001));
+        REQUIRE(settled < 0.25f / 10.0f);
+    }
+
+    TEST_CASE("TemperatureFilter: step response")
+    {
+        TemperatureFilter filter;
+        NoisyThermocouple thermocouple;
+        for (int i = 0; i < 600; ++i)
+        {
+            filter.Update(thermocouple.Read(100.0f), SAMPLE);
+        }
+
+        float peak = 0.0f;
+        int lastOutside = 0;
+        for (int i = 1; i <= 600; ++i)
+        {
+            const float temperature = filter.Update(thermocouple.Read(110.0f), SAMPLE).temperature;
+            peak = std::max(peak, temperature);
+            if (std::abs(temperature - 110.0f) > 1.0f)
+            {
+                lastOutside = i;
+            }
+        }
+
+        // A real thermocouple can't step like this, which is why the filter can afford to be slow to
+        // believe one; it still settles within two minutes and overshoots by a quarter at most
+        INFO("settled after " << lastOutside << " s, peak " << peak);
+        REQUIRE(lastOutside < 150);
+        REQUIRE(peak < 112.5f);
+    }
+
+    TEST_CASE("TemperatureFilter: ramp - no lag, and the rate for temp_change")
+    {
+        TemperatureFilter filter;
+        NoisyThermocouple thermocouple;
+        constexpr float RATE = 100.0f / 3600.0f; // 100 °C/h
+        Spread error;
+        Spread rate;
+        for (int i = 0; i < 7200; ++i)
+        {
+            const float actual = 20.0f + RATE * static_cast<float>(i);
+            const TemperatureEstimate& estimate = filter.Update(thermocouple.Read(actual), SAMPLE);
+            if (i >= 1200)
+            {
+                error.Add(estimate.temperature - actual);
+                rate.Add(estimate.RatePerHour());
+            }
+        }
+        REQUIRE(std::abs(error.sum / error.count) < 0.1);
+        REQUIRE(rate.sum / rate.count == Catch::Approx(100.0).epsilon(0.02));
+        REQUIRE(rate.StandardDeviation() < 15.0);
+    }
+
+    TEST_CASE("TemperatureFilter: heater steps on the host thermal model")
+    {
+        Sim::ThermalModel kiln(Sim::ThermalParameters{}, 500.0f);
+        for (int i = 0; i < 3600; ++i)
+        {
+            kiln.Step(60.0f, SAMPLE);
+        }
+
+        TemperatureFilter filter;
+        NoisyThermocouple thermocouple;
+        Spread raw;
+        Spread filtered;
+        float worst = 0.0f;
+        for (int i = 0; i < 4 * 3600; ++i)
+        {
+            kiln.Step((i / 1800) % 2 == 0 ? 100.0f : 0.0f, SAMPLE);
+            const float actual = kiln.SensorTemperature();
+            const float reading = thermocouple.Read(actual);
+            const float estimate = filter.Update(reading, SAMPLE).temperature;
+            if (i >= 60)
+            {
+                raw.Add(reading - actual);
+                filtered.Add(estimate - actual);
+                worst = std::max(worst, std::abs(estimate - actual));
+            }
+        }
+        REQUIRE(filtered.StandardDeviation() < raw.StandardDeviation() / 2.0);
+        REQUIRE(worst < 1.5f);
+    }
+
+    TEST_CASE("TemperatureFilter: irregular samples")
+    {
+        TemperatureFilter filter;
+        for (int i = 0; i < 600; ++i)
+        {
+            filter.Update(300.0f + static_cast<float>(i) * 0.05f, SAMPLE);
+        }
+        const float settled = filter.Estimate().variance;
+
+        // A missed minute of readings: the prediction carries on at the rate, and is trusted less
+        const TemperatureEstimate& estimate = filter.Update(300.0f + 660.0f * 0.05f, 61s);
+        REQUIRE(estimate.temperature == Catch::Approx(333.0f).margin(0.1f));
+        REQUIRE(estimate.variance > settled);
+    }
+
+    TEST_CASE("TemperatureFilter: quietens the PID derivative term")
+    {
+        PidConfig config;
+        config.kp = 5.0f;
+        config.ki = 0.0f;
+        config.kd = 200.0f;
+        config.sampleTime = SAMPLE;
+        config.outputMin = -1000.0f;
+        config.outputMax = 1000.0f;
+        FloatPid rawPid(config);
+        FloatPid filteredPid(config);
+        TemperatureFilter filter;
+        NoisyThermocouple thermocouple;
+
+        Spread raw;
+        Spread filtered;
+        for (int i = 0; i < 3600; ++i)
+        {
+            const float reading = thermocouple.Read(500.0f);
+            const float rawOutput = rawPid.Update(500.0f, reading);
+            const float filteredOutput = filteredPid.Update(500.0f, filter.Update(reading, SAMPLE).temperature);
+            if (i >= 300)
+            {
+                raw.Add(rawOutput);
+                filtered.Add(filteredOutput);
+            }
+        }
+        INFO("output noise raw " << raw.StandardDeviation() << ", filtered " << filtered.StandardDeviation());
+        REQUIRE(filtered.StandardDeviation() < raw.StandardDeviation() / 10.0);
+    }
+
+    TEST_CASE("TemperatureFilter: benchmark", "[.][benchmark]")
+    {
+        TemperatureFilter filter;
+        float reading = 20.0f;
+        BENCHMARK("TemperatureFilter::Update")
+        {
+            reading += 0.01f;
+            return filter.Update(reading, SAMPLE).temperature;
+        };
+    }
+} //namespace HeatTreatFurnace::Test
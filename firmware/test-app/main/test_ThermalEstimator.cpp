@@ -0,0 +1,177 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Control/Pid.hpp"
+#include "Control/ThermalEstimator.hpp"
+#include "Furnace/Profile.hpp"
+#include "Program/ProfileTimeline.hpp"
+#include "Program/ProgramJson.hpp"
+#include "Sim/ThermalModel.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Control;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        // A kiln that isn't the one the Kiln_* preferences describe, as after a rebuild or with a heavy load
+        Sim::ThermalParameters ActualKiln()
+        {
+            Sim::ThermalParameters kiln;
+            kiln.heaterPowerW = 3600.0f;
+            kiln.thermalMassJPerC = 50000.0f;
+            kiln.lossWPerC = 2.0f;
+            return kiln;
+        }
+
+        Furnace::Profile MakeFiring()
+        {
+            // 150 °C/h to 600, hold, 100 °C/h to 900, hold
+            std::vector<uint8_t> compiled;
+            REQUIRE(Program::ProgramJson::Import(R"({ "segments": [
+                { "target": 600, "ramp_time": { "hours": 3, "minutes": 52 }, "dwell_time": { "hours": 1 } },
+                { "target": 900, "ramp_time": { "hours": 3 }, "dwell_time": { "hours": 1 } }
+            ] })", compiled));
+            Furnace::Profile profile;
+            REQUIRE(profile.Load("firing.json", std::move(compiled)));
+            return profile;
+        }
+
+        struct FiringStats
+        {
+            float overshoot = 0.0f; // worst °C over the target after a ramp
+            std::chrono::seconds settleTime{0}; // worst time after a ramp to stay within SETTLE_BAND
+            float rampLag = 0.0f; // worst °C behind the setpoint mid-ramp
+        };
+
+        constexpr float SETTLE_BAND = 2.0f;
+        constexpr std::chrono::seconds LEAD{60}; // about the element and thermocouple lags
+
+        // Gains of the order the autotuner proposes, with the integral able to reach full output
+        PidConfig TunedConfig()
+        {
+            PidConfig config = PidConfig::FromPreferences({});
+            config.kp = 3.0f;
+            config.ki = 0.01f;
+            config.kd = 0.0f;
+            config.integralMax = config.outputMax / config.ki;
+            return config;
+        }
+
+        /** @brief Fires aProfile on aKiln with TunedConfig, with or without model feedforward */
+        FiringStats Fire(const Furnace::Profile& aProfile, const Sim::ThermalParameters& aKiln, bool aFeedforward, ThermalEstimator* anEstimator = nullptr)
+        {
+            const Furnace::Preferences preferences;
+            const PidConfig config = TunedConfig();
+            FloatPid pid(config);
+            ThermalEstimator ownEstimator(preferences);
+            ThermalEstimator& estimator = anEstimator ? *anEstimator : ownEstimator;
+            Sim::ThermalModel kiln(aKiln);
+            const Program::ProfileTimeline timeline(aProfile);
+            const float start = kiln.SensorTemperature();
+
+            FiringStats stats;
+            std::chrono::milliseconds lastRampEnd{-1};
+            std::chrono::milliseconds lastOutOfBand{0};
+            float target = 0.0f;
+            const auto finishSettle = [&]
+            {
+                if (lastRampEnd.count() >= 0)
+                {
+                    stats.settleTime = std::max(stats.settleTime, std::chrono::duration_cast<std::chrono::seconds>(lastOutOfBand - lastRampEnd));
+                }
+            };
+
+            for (std::chrono::milliseconds t{0}; t < timeline.TotalDuration(); t += config.sampleTime)
+            {
+                const Program::SetpointSample now = timeline.SetpointAt(t, start);
+                const Program::SetpointSample ahead = timeline.SetpointAt(t + LEAD, start);
+                const float measured = kiln.SensorTemperature();
+                const float heat = pid.Update(now.setpoint, measured, aFeedforward ? estimator.FeedforwardPercent(ahead.setpoint, ahead.slope) : 0.0f);
+                kiln.Step(heat, config.sampleTime);
+                estimator.Update(kiln.SensorTemperature(), heat, config.sampleTime);
+
+                if (now.slope > 0.0f)
+                {
+                    stats.rampLag = std::max(stats.rampLag, now.setpoint - measured);
+                    if (lastRampEnd.count() >= 0 && target != 0.0f)
+                    {
+                        finishSettle();
+                        lastRampEnd = std::chrono::milliseconds(-1);
+                    }
+                    continue;
+                }
+                if (lastRampEnd.count() < 0)
+                {
+                    lastRampEnd = t;
+                    lastOutOfBand = t;
+                    target = now.setpoint;
+                }
+                stats.overshoot = std::max(stats.overshoot, measured - now.setpoint);
+                if (std::abs(measured - now.setpoint) > SETTLE_BAND)
+                {
+                    lastOutOfBand = t;
+                }
+            }
+            finishSettle();
+            return stats;
+        }
+    }
+
+    TEST_CASE("ThermalEstimator: starts from the Kiln_* preferences")
+    {
+        Furnace::Preferences preferences;
+        const ThermalEstimator estimator(preferences);
+        REQUIRE(std::abs(estimator.ThermalMassJPerC() - preferences.thermalMassJPerC) < 1.0f);
+        REQUIRE(std::abs(estimator.LossWPerC() - preferences.lossWPerC) < 0.001f);
+
+        // Holding 500 °C costs 720 W of 3000 W; ramping at 0.05 °C/s another 2000 W
+        REQUIRE(std::abs(estimator.FeedforwardPercent(500.0f, 0.0f) - 24.0f) < 0.01f);
+        REQUIRE(std::abs(estimator.FeedforwardPercent(500.0f, 0.05f) - 90.67f) < 0.01f);
+        REQUIRE(estimator.FeedforwardPercent(1300.0f, 0.1f) == 100.0f);
+        REQUIRE(estimator.FeedforwardPercent(20.0f, -0.1f) == 0.0f);
+    }
+
+    TEST_CASE("ThermalEstimator: learns a kiln that differs from its preferences")
+    {
+        const Sim::ThermalParameters actual = ActualKiln();
+        ThermalEstimator estimator;
+        Fire(MakeFiring(), actual, true, &estimator);
+
+        // Within 15% despite the element and thermocouple lags the first-order model doesn't have
+        REQUIRE(std::abs(estimator.ThermalMassJPerC() / (actual.thermalMassJPerC * 3000.0f / 3600.0f) - 1.0f) < 0.15f);
+        REQUIRE(std::abs(estimator.LossWPerC() / (actual.lossWPerC * 3000.0f / 3600.0f) - 1.0f) < 0.15f);
+    }
+
+    TEST_CASE("ThermalEstimator: feedforward cuts overshoot and settle time on the host thermal model")
+    {
+        const Furnace::Profile profile = MakeFiring();
+        const FiringStats pidOnly = Fire(profile, ActualKiln(), false);
+        const FiringStats feedforward = Fire(profile, ActualKiln(), true);
+
+        REQUIRE(feedforward.overshoot < pidOnly.overshoot / 2.0f);
+        REQUIRE(feedforward.settleTime < pidOnly.settleTime);
+        REQUIRE(feedforward.rampLag < pidOnly.rampLag / 2.0f);
+    }
+
+    TEST_CASE("ThermalEstimator: benchmark", "[.][benchmark]")
+    {
+        const Furnace::Profile profile = MakeFiring();
+        const FiringStats pidOnly = Fire(profile, ActualKiln(), false);
+        const FiringStats feedforward = Fire(profile, ActualKiln(), true);
+        WARN("PID only:    overshoot " << pidOnly.overshoot << " °C, settle " << pidOnly.settleTime.count() << " s, ramp lag " << pidOnly.rampLag << " °C");
+        WARN("Feedforward: overshoot " << feedforward.overshoot << " °C, settle " << feedforward.settleTime.count() << " s, ramp lag " << feedforward.rampLag << " °C");
+
+        ThermalEstimator estimator;
+        float temperature = 20.0f;
+        BENCHMARK("Update + FeedforwardPercent")
+        {
+            temperature += 0.25f;
+            estimator.Update(temperature, 60.0f, 5000ms);
+            return estimator.FeedforwardPercent(temperature, 0.05f);
+        };
+    }
+} //namespace HeatTreatFurnace::Test
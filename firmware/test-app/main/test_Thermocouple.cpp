@@ -0,0 +1,375 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Sensor/Max31855Driver.hpp"
+#include "Sensor/ReplayThermocouple.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Sensor;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        /** @brief Bus whose reads finish, fail or hang when the test says so */
+        class FakeSpiBus : public SpiBus
+        {
+        public:
+            bool StartRead(std::span<uint8_t> aReceive, size_t aDeviceCount) override
+            {
+                ++starts;
+                lastDeviceCount = aDeviceCount;
+                if (refuse || myStatus == SpiStatus::Busy)
+                {
+                    return false;
+                }
+                myReceive = aReceive;
+                myStatus = SpiStatus::Busy;
+                return true;
+            }
+
+            SpiStatus Poll() override
+            {
+                const SpiStatus status = myStatus;
+                if (status == SpiStatus::Done || status == SpiStatus::Failed)
+                {
+                    myStatus = SpiStatus::Idle;
+                }
+                return status;
+            }
+
+            /** @brief The chips answer with aFrames, most significant byte first */
+            void Complete(std::span<const uint32_t> aFrames)
+            {
+                for (size_t i = 0; i < aFrames.size() && 4 * i + 3 < myReceive.size(); ++i)
+                {
+                    myReceive[4 * i] = static_cast<uint8_t>(aFrames[i] >> 24);
+                    myReceive[4 * i + 1] = static_cast<uint8_t>(aFrames[i] >> 16);
+                    myReceive[4 * i + 2] = static_cast<uint8_t>(aFrames[i] >> 8);
+                    myReceive[4 * i + 3] = static_cast<uint8_t>(aFrames[i]);
+                }
+                myStatus = SpiStatus::Done;
+            }
+
+            void Fail()
+            {
+                myStatus = SpiStatus::Failed;
+            }
+
+            int starts = 0;
+            size_t lastDeviceCount = 0;
+            bool refuse = false;
+
+        private:
+            std::span<uint8_t> myReceive;
+            SpiStatus myStatus = SpiStatus::Idle;
+        };
+    }
+
+    TEST_CASE("Thermocouple: MAX31855 frames")
+    {
+        SECTION("Datasheet temperatures")
+        {
+            // Table 2 and 3 of the datasheet: 1600 °C, -250 °C, 25 °C; cold junction 127 °C, -20 °C, 25 °C
+            ThermocoupleSample sample = Max31855Frame::Decode((0x1900u << 18) | (0x7F0u << 4));
+            REQUIRE(sample.temperature == 1600.0f);
+            REQUIRE(sample.coldJunction == 127.0f);
+            REQUIRE(sample.IsValid());
+
+            sample = Max31855Frame::Decode((0x3C18u << 18) | (0xEC0u << 4));
+            REQUIRE(sample.temperature == -250.0f);
+            REQUIRE(sample.coldJunction == -20.0f);
+
+            sample = Max31855Frame::Decode((0x0064u << 18) | (0x190u << 4));
+            REQUIRE(sample.temperature == 25.0f);
+            REQUIRE(sample.coldJunction == 25.0f);
+        }
+
+        SECTION("Fault bits")
+        {
+            const uint32_t frame = (0x0064u << 18) | (0x190u << 4);
+            REQUIRE(Max31855Frame::Decode(frame | (1u << 16) | 0x1).Has(ThermocoupleFault::OpenCircuit));
+            REQUIRE(Max31855Frame::Decode(frame | (1u << 16) | 0x2).Has(ThermocoupleFault::ShortToGround));
+            REQUIRE(Max31855Frame::Decode(frame | (1u << 16) | 0x4).Has(ThermocoupleFault::ShortToVcc));
+            REQUIRE_FALSE(Max31855Frame::Decode(frame | (1u << 16)).IsValid());
+        }
+
+        SECTION("No chip")
+        {
+            REQUIRE(Max31855Frame::Decode(Max31855Frame::NO_RESPONSE).Has(ThermocoupleFault::NoResponse));
+            REQUIRE(Max31855Frame::Decode(1u << 17).Has(ThermocoupleFault::NoResponse));
+            REQUIRE(Max31855Frame::Decode(1u << 3).Has(ThermocoupleFault::NoResponse));
+        }
+
+        SECTION("Encode round trip")
+        {
+            for (const float temperature : {-200.0f, -0.25f, 0.0f, 20.5f, 999.75f, 1372.0f})
+            {
+                const ThermocoupleSample sample = Max31855Frame::Decode(Max31855Frame::Encode(temperature, -3.125f));
+                REQUIRE(sample.temperature == temperature);
+                REQUIRE(sample.coldJunction == -3.125f);
+                REQUIRE(sample.IsValid());
+            }
+            REQUIRE(Max31855Frame::Decode(Max31855Frame::Encode(20.1f, 25.0f)).temperature == 20.0f);
+            REQUIRE(Max31855Frame::Decode(Max31855Frame::Encode(5000.0f, 25.0f)).temperature == 2047.75f);
+
+            const auto shorted = static_cast<uint8_t>(ThermocoupleFault::ShortToGround);
+            REQUIRE(Max31855Frame::Decode(Max31855Frame::Encode(20.0f, 25.0f, shorted)).faults == shorted);
+        }
+    }
+
+    TEST_CASE("Thermocouple: Max31855Driver reads every chip in one batch")
+    {
+        FakeSpiBus bus;
+        Max31855Driver driver(bus, 3);
+        REQUIRE(driver.ChannelCount() == 3);
+        REQUIRE(driver.Latest(0).Has(ThermocoupleFault::NoResponse));
+
+        driver.Poll();
+        REQUIRE(bus.starts == 1);
+        REQUIRE(bus.lastDeviceCount == 3);
+        REQUIRE(driver.Sequence() == 0);
+
+        SECTION("A finished batch is published and the next started")
+        {
+            const std::array<uint32_t, 3> frames{
+                Max31855Frame::Encode(100.0f, 25.0f), Max31855Frame::Encode(200.0f, 25.0f), Max31855Frame::Encode(300.0f, 25.0f)
+            };
+            bus.Complete(frames);
+            driver.Poll();
+            REQUIRE(driver.Sequence() == 1);
+            REQUIRE(bus.starts == 2);
+            REQUIRE(driver.Latest(0).temperature == 100.0f);
+            REQUIRE(driver.Latest(1).temperature == 200.0f);
+            REQUIRE(driver.Latest(2).temperature == 300.0f);
+            REQUIRE(driver.Latest(2).sequence == 1);
+            REQUIRE(driver.Latest(3).Has(ThermocoupleFault::NoResponse));
+        }
+
+        SECTION("A busy bus doesn't hold up the caller, and the last readings stand")
+        {
+            const std::array<uint32_t, 3> frames{
+                Max31855Frame::Encode(100.0f, 25.0f), Max31855Frame::Encode(200.0f, 25.0f), Max31855Frame::Encode(300.0f, 25.0f)
+            };
+            bus.Complete(frames);
+            driver.Poll();
+            for (int i = 0; i < 10; ++i)
+            {
+                driver.Poll();
+            }
+            REQUIRE(bus.starts == 2);
+            REQUIRE(driver.Sequence() == 1);
+            REQUIRE(driver.Latest(1).temperature == 200.0f);
+            REQUIRE(driver.BusErrorCount() == 0);
+        }
+
+        SECTION("A chip fault is reported on its channel only")
+        {
+            const std::array<uint32_t, 3> frames{
+                Max31855Frame::Encode(100.0f, 25.0f),
+                Max31855Frame::Encode(0.0f, 25.0f, static_cast<uint8_t>(ThermocoupleFault::OpenCircuit)),
+                Max31855Frame::NO_RESPONSE
+            };
+            bus.Complete(frames);
+            driver.Poll();
+            REQUIRE(driver.Latest(0).IsValid());
+            REQUIRE(driver.Latest(1).Has(ThermocoupleFault::OpenCircuit));
+            REQUIRE(driver.Latest(2).Has(ThermocoupleFault::NoResponse));
+            REQUIRE(driver.BusErrorCount() == 0);
+        }
+
+        SECTION("A failed batch is NoResponse on every channel")
+        {
+            bus.Fail();
+            driver.Poll();
+            REQUIRE(driver.BusErrorCount() == 1);
+            REQUIRE(driver.Sequence() == 1);
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                REQUIRE(driver.Latest(channel).Has(ThermocoupleFault::NoResponse));
+            }
+            REQUIRE(bus.starts == 2);
+        }
+
+        SECTION("A bus that won't start is NoResponse too")
+        {
+            bus.Fail();
+            bus.refuse = true;
+            driver.Poll();
+            REQUIRE(driver.BusErrorCount() == 2);
+            REQUIRE(driver.Latest(0).Has(ThermocoupleFault::NoResponse));
+
+            bus.refuse = false;
+            driver.Poll();
+            const std::array<uint32_t, 3> frames{
+                Max31855Frame::Encode(100.0f, 25.0f), Max31855Frame::Encode(200.0f, 25.0f), Max31855Frame::Encode(300.0f, 25.0f)
+            };
+            bus.Complete(frames);
+            driver.Poll();
+            REQUIRE(driver.Latest(0).temperature == 100.0f);
+        }
+    }
+
+    TEST_CASE("Thermocouple: ReplayThermocouple replays a trace")
+    {
+        const std::array<TracePoint, 3> trace{TracePoint{0ms, 20.0f}, TracePoint{60000ms, 80.0f}, TracePoint{120000ms, 80.0f}};
+        Time::ManualClock clock;
+        ReplayThermocouple replay(clock, 2, ReplayThermocouple::Trace(trace));
+
+        replay.Poll();
+        REQUIRE(replay.Latest(0).temperature == 20.0f);
+        REQUIRE(replay.Latest(1).temperature == 20.0f);
+        REQUIRE(replay.Latest(0).coldJunction == 25.0f);
+
+        clock.Advance(30s);
+        replay.Poll();
+        REQUIRE(replay.Latest(0).temperature == 50.0f);
+
+        clock.Advance(10100ms);
+        replay.Poll();
+        REQUIRE(replay.Latest(0).temperature == 60.0f); // 60.1, in the chip's 0.25 °C steps
+
+        clock.Advance(1h);
+        replay.Poll();
+        REQUIRE(replay.Latest(0).temperature == 80.0f);
+        REQUIRE(replay.Sequence() == 4);
+    }
+
+    TEST_CASE("Thermocouple: ReplayThermocouple injects faults")
+    {
+        Time::ManualClock clock;
+        ReplayThermocouple replay(clock, 3, [](size_t aChannel, std::chrono::microseconds)
+        {
+            return 500.0f + static_cast<float>(aChannel);
+        });
+
+        REQUIRE(replay.InjectFault({0, ThermocoupleFault::OpenCircuit, 10s, 20s}));
+        REQUIRE(replay.InjectFault({1, ThermocoupleFault::ShortToGround, 15s, 16s}));
+        REQUIRE(replay.InjectFault({1, ThermocoupleFault::ShortToVcc, 15s, 17s}));
+        REQUIRE(replay.InjectFault({2, ThermocoupleFault::NoResponse, 0s, 1s}));
+
+        std::array<int, 3> faultySeconds{};
+        for (int second = 0; second < 30; ++second)
+        {
+            replay.Poll();
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                const ThermocoupleSample sample = replay.Latest(channel);
+                if (!sample.IsValid())
+                {
+                    ++faultySeconds[channel];
+                }
+                else
+                {
+                    REQUIRE(sample.temperature == 500.0f + static_cast<float>(channel));
+                }
+            }
+            if (second == 15)
+            {
+                REQUIRE(replay.Latest(1).Has(ThermocoupleFault::ShortToGround));
+                REQUIRE(replay.Latest(1).Has(ThermocoupleFault::ShortToVcc));
+            }
+            if (second == 0)
+            {
+                REQUIRE(replay.Latest(2).Has(ThermocoupleFault::NoResponse));
+            }
+            clock.Advance(1s);
+        }
+        REQUIRE(faultySeconds == std::array<int, 3>{10, 2, 1});
+
+        replay.ClearFaults();
+        clock.SleepUntil(std::chrono::microseconds(15s));
+        replay.Poll();
+        REQUIRE(replay.Latest(0).IsValid());
+
+        for (size_t i = 0; i < ReplayThermocouple::MAX_INJECTED_FAULTS; ++i)
+        {
+            REQUIRE(replay.InjectFault({0, ThermocoupleFault::OpenCircuit, 0s, 1s}));
+        }
+        REQUIRE_FALSE(replay.InjectFault({0, ThermocoupleFault::OpenCircuit, 0s, 1s}));
+    }
+
+    TEST_CASE("Thermocouple: readers never see a torn or out of order reading")
+    {
+        // The writer publishes a rising count on every channel, as temperature within round as cold
+        // junction; a reader on another thread must only ever see whole frames, never going backwards
+        constexpr size_t CHANNELS = 8;
+        constexpr int COUNTS = 8000;
+        constexpr int ROUNDS = 25;
+        Time::ManualClock clock;
+        int batch = 0;
+        ReplayThermocouple replay(clock, CHANNELS, [&batch](size_t aChannel, std::chrono::microseconds)
+        {
+            return static_cast<float>(batch % COUNTS + static_cast<int>(aChannel)) * 0.25f;
+        });
+
+        std::atomic<bool> done{false};
+        std::atomic<int> problems{0};
+        std::atomic<long> reads{0};
+        std::thread reader([&]
+        {
+            std::array<std::pair<float, float>, CHANNELS> last{};
+            uint32_t lastSequence = 0;
+            while (!done.load(std::memory_order_relaxed))
+            {
+                const uint32_t sequence = replay.Sequence();
+                if (sequence < lastSequence)
+                {
+                    ++problems;
+                }
+                lastSequence = sequence;
+                for (size_t channel = 0; channel < CHANNELS; ++channel)
+                {
+                    const ThermocoupleSample sample = replay.Latest(channel);
+                    if (sample.sequence == 0)
+                    {
+                        continue;
+                    }
+                    const std::pair<float, float> reading{sample.coldJunction, sample.temperature};
+                    if (!sample.IsValid() || reading < last[channel])
+                    {
+                        ++problems;
+                    }
+                    last[channel] = reading;
+                }
+                ++reads;
+            }
+        });
+
+        for (batch = 0; batch < COUNTS * ROUNDS; ++batch)
+        {
+            replay.SetColdJunction(static_cast<float>(batch / COUNTS));
+            replay.Poll();
+        }
+        done = true;
+        reader.join();
+        INFO(reads.load() << " reads");
+        REQUIRE(reads.load() > 0);
+        REQUIRE(problems.load() == 0);
+        REQUIRE(replay.Latest(0).coldJunction == static_cast<float>(ROUNDS - 1));
+    }
+
+    TEST_CASE("Thermocouple: benchmark", "[.][benchmark]")
+    {
+        FakeSpiBus bus;
+        Max31855Driver driver(bus, MAX_THERMOCOUPLES);
+        std::vector<uint32_t> frames(MAX_THERMOCOUPLES, Max31855Frame::Encode(850.25f, 27.0f));
+        BENCHMARK("Max31855Driver: collect and start a 65 chip batch")
+        {
+            bus.Complete(frames);
+            driver.Poll();
+            return driver.Sequence();
+        };
+        BENCHMARK("ThermocoupleDriver::Latest")
+        {
+            return driver.Latest(7).temperature;
+        };
+    }
+} //namespace HeatTreatFurnace::Test
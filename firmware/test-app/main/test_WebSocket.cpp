@@ -0,0 +1,228 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <arpa/inet.h>
+#include <filesystem>
+#include <fstream>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Log/LogBackend.hpp"
+#include "Log/LogService.hpp"
+#include "Net/WebSocket.hpp"
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Net;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        std::span<const uint8_t> Bytes(std::string_view aText)
+        {
+            return {reinterpret_cast<const uint8_t*>(aText.data()), aText.size()};
+        }
+
+        // A blocking client on the loopback, with the server polled while it waits
+        class TestClient
+        {
+        public:
+            TestClient(WebSocketServer& aServer) :
+                myServer(aServer),
+                mySocket(socket(AF_INET, SOCK_STREAM, 0))
+            {
+                sockaddr_in address{};
+                address.sin_family = AF_INET;
+                address.sin_port = htons(aServer.Port());
+                address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                REQUIRE(connect(mySocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+            }
+
+            ~TestClient()
+            {
+                close(mySocket);
+            }
+
+            void Write(std::span<const uint8_t> aBytes)
+            {
+                REQUIRE(send(mySocket, aBytes.data(), aBytes.size(), 0) == static_cast<ssize_t>(aBytes.size()));
+            }
+
+            // Everything that arrives before the server has nothing more to say, or the connection closes
+            std::string Read()
+            {
+                std::string received;
+                for (int idle = 0; idle < 20; ++idle)
+                {
+                    myServer.Poll(5ms);
+                    char buffer[4096];
+                    ssize_t count;
+                    while ((count = recv(mySocket, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0)
+                    {
+                        received.append(buffer, static_cast<size_t>(count));
+                        idle = 0;
+                    }
+                    if (count == 0)
+                    {
+                        break;
+                    }
+                }
+                return received;
+            }
+
+            std::string Upgrade()
+            {
+                Write(Bytes("GET /ws HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n"));
+                return Read();
+            }
+
+        private:
+            WebSocketServer& myServer;
+            int mySocket;
+        };
+    }
+
+    TEST_CASE("WebSocketCodec: RFC 6455's handshake and SHA-1 vectors")
+    {
+        REQUIRE(WebSocketCodec::AcceptKey("dGhlIHNhbXBsZSBub25jZQ==") == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+        REQUIRE(WebSocketCodec::Base64(WebSocketCodec::Sha1(Bytes("abc"))) == "qZk+NkcGgWq6PiVxeFDCbJzQ2J0=");
+        REQUIRE(WebSocketCodec::Base64(Bytes("")).empty());
+        REQUIRE(WebSocketCodec::Base64(Bytes("fo")) == "Zm8=");
+        REQUIRE(WebSocketCodec::Base64(Bytes("foo")) == "Zm9v");
+    }
+
+    TEST_CASE("WebSocketCodec: frames round trip at each length encoding")
+    {
+        for (const size_t length : {size_t{0}, size_t{125}, size_t{126}, size_t{65535}, size_t{65536}})
+        {
+            std::vector<uint8_t> payload(length);
+            for (size_t i = 0; i < length; ++i)
+            {
+                payload[i] = static_cast<uint8_t>(i * 7);
+            }
+            for (const std::optional<uint32_t> mask : {std::optional<uint32_t>(), std::optional<uint32_t>(0x12345678)})
+            {
+                std::vector<uint8_t> wire;
+                WebSocketCodec::AppendFrame(wire, Opcode::BINARY, payload, mask);
+
+                Frame frame;
+                size_t consumed = 0;
+                REQUIRE(WebSocketCodec::ParseFrame(std::span(wire).first(wire.size() - 1), 128 * 1024, frame, consumed) == FrameStatus::NEED_MORE);
+                REQUIRE(WebSocketCodec::ParseFrame(wire, 128 * 1024, frame, consumed) == FrameStatus::FRAME);
+                REQUIRE(consumed == wire.size());
+                REQUIRE(frame.fin);
+                REQUIRE(frame.opcode == Opcode::BINARY);
+                REQUIRE(frame.masked == mask.has_value());
+                REQUIRE(frame.payload == payload);
+            }
+        }
+
+        std::vector<uint8_t> wire;
+        WebSocketCodec::AppendFrame(wire, Opcode::BINARY, std::vector<uint8_t>(1000));
+        Frame frame;
+        size_t consumed = 0;
+        REQUIRE(WebSocketCodec::ParseFrame(wire, 999, frame, consumed) == FrameStatus::TOO_BIG);
+
+        // RSV bits set, and a fragmented ping
+        REQUIRE(WebSocketCodec::ParseFrame(std::vector<uint8_t>{0xC2, 0x00}, 999, frame, consumed) == FrameStatus::PROTOCOL_ERROR);
+        REQUIRE(WebSocketCodec::ParseFrame(std::vector<uint8_t>{0x09, 0x00}, 999, frame, consumed) == FrameStatus::PROTOCOL_ERROR);
+    }
+
+    TEST_CASE("WebSocketServer: upgrades /ws, answers and broadcasts binary messages, and serves the frontend")
+    {
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "furnace_www";
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root / "assets");
+        std::ofstream(root / "index.html") << "<html>furnace</html>";
+        std::ofstream(root / "assets" / "app.js") << "console.log(1)";
+
+        Log::NullLogBackend nullLogBackend;
+        Log::LogService log(&nullLogBackend);
+        WebSocketServer server(log);
+        REQUIRE(server.Listen(0));
+        REQUIRE(server.Port() != 0);
+        server.SetStaticRoot(root.string());
+
+        std::vector<WebSocketServer::ClientId> connected;
+        server.SetConnectHandler([&connected](WebSocketServer::ClientId aClient)
+        {
+            connected.push_back(aClient);
+        });
+        server.SetMessageHandler([&server](WebSocketServer::ClientId aClient, std::span<const uint8_t> aMessage)
+        {
+            std::vector<uint8_t> reply(aMessage.rbegin(), aMessage.rend());
+            server.Send(aClient, reply);
+        });
+
+        SECTION("WebSocket")
+        {
+            TestClient first(server);
+            TestClient second(server);
+            REQUIRE(first.Upgrade().starts_with("HTTP/1.1 101 Switching Protocols\r\n"));
+            REQUIRE(second.Upgrade().find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n") != std::string::npos);
+            REQUIRE(connected.size() == 2);
+            REQUIRE(server.ClientCount() == 2);
+
+            // A fragmented message from the first, answered to it alone
+            std::vector<uint8_t> wire;
+            WebSocketCodec::AppendFrame(wire, Opcode::BINARY, Bytes("abc"), 0x01020304);
+            wire[0] &= 0x7F;
+            WebSocketCodec::AppendFrame(wire, Opcode::CONTINUATION, Bytes("def"), 0x05060708);
+            first.Write(wire);
+            std::string reply = first.Read();
+            Frame frame;
+            size_t consumed = 0;
+            REQUIRE(WebSocketCodec::ParseFrame(Bytes(reply), 1024, frame, consumed) == FrameStatus::FRAME);
+            REQUIRE(frame.payload == std::vector<uint8_t>{'f', 'e', 'd', 'c', 'b', 'a'});
+            REQUIRE(server.GetStats().messagesReceived == 1);
+
+            server.Broadcast(Bytes("state"));
+            for (TestClient* client : {&first, &second})
+            {
+                reply = client->Read();
+                REQUIRE(WebSocketCodec::ParseFrame(Bytes(reply), 1024, frame, consumed) == FrameStatus::FRAME);
+                REQUIRE(consumed == reply.size());
+                REQUIRE(std::string(frame.payload.begin(), frame.payload.end()) == "state");
+            }
+
+            // Clients must mask their frames
+            wire.clear();
+            WebSocketCodec::AppendFrame(wire, Opcode::BINARY, Bytes("abc"));
+            second.Write(wire);
+            reply = second.Read();
+            REQUIRE(WebSocketCodec::ParseFrame(Bytes(reply), 1024, frame, consumed) == FrameStatus::FRAME);
+            REQUIRE(frame.opcode == Opcode::CLOSE);
+            REQUIRE(frame.payload == std::vector<uint8_t>{0x03, 0xEA});
+            REQUIRE(server.ClientCount() == 1);
+        }
+
+        SECTION("Static files")
+        {
+            TestClient page(server);
+            page.Write(Bytes("GET /assets/app.js HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+            std::string response = page.Read();
+            REQUIRE(response.starts_with("HTTP/1.1 200 OK\r\n"));
+            REQUIRE(response.find("Content-Type: text/javascript") != std::string::npos);
+            REQUIRE(response.ends_with("\r\n\r\nconsole.log(1)"));
+
+            // A frontend route
+            TestClient route(server);
+            route.Write(Bytes("GET /programs/edit HTTP/1.1\r\n\r\n"));
+            REQUIRE(route.Read().ends_with("<html>furnace</html>"));
+
+            TestClient missing(server);
+            missing.Write(Bytes("GET /assets/none.js HTTP/1.1\r\n\r\n"));
+            REQUIRE(missing.Read().starts_with("HTTP/1.1 404"));
+
+            TestClient escape(server);
+            escape.Write(Bytes("GET /../etc/passwd HTTP/1.1\r\n\r\n"));
+            REQUIRE(escape.Read().starts_with("HTTP/1.1 404"));
+            REQUIRE(server.GetStats().filesServed == 2);
+        }
+
+        std::filesystem::remove_all(root);
+    }
+} //namespace HeatTreatFurnace::Test
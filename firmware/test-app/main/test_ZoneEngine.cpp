@@ -0,0 +1,179 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "Control/Pid.hpp"
+#include "Control/ZoneEngine.hpp"
+#include "Sim/ThermalModel.hpp"
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace HeatTreatFurnace::Test
+{
+    using namespace HeatTreatFurnace::Control;
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        // Top, middle and bottom: the bottom element works against the hearth and a heavy load
+        std::array<Sim::ThermalModel, 3> MakeZones()
+        {
+            Sim::ThermalParameters top;
+            Sim::ThermalParameters middle;
+            middle.thermalMassJPerC = 50000.0f;
+            Sim::ThermalParameters bottom;
+            bottom.thermalMassJPerC = 70000.0f;
+            bottom.lossWPerC = 2.0f;
+            return {Sim::ThermalModel(top), Sim::ThermalModel(middle), Sim::ThermalModel(bottom)};
+        }
+
+        /** @brief Ramps three zones at 150 °C/h to 800 and holds; returns the largest spread seen between them */
+        float RunRamp(ZoneEngine& anEngine, std::array<Sim::ThermalModel, 3>& aZones, const PidConfig& aConfig)
+        {
+            float largestSpread = 0.0f;
+            float setpoint = 20.0f;
+            std::array<float, 3> measured{};
+            for (std::chrono::milliseconds t{0}; t < 8h; t += aConfig.sampleTime)
+            {
+                setpoint = std::min(setpoint + 150.0f / 720.0f, 800.0f);
+                for (size_t i = 0; i < aZones.size(); ++i)
+                {
+                    measured[i] = aZones[i].SensorTemperature();
+                }
+                const std::span<const float> heat = anEngine.Update(setpoint, measured);
+                for (size_t i = 0; i < aZones.size(); ++i)
+                {
+                    aZones[i].Step(heat[i], aConfig.sampleTime);
+                }
+                const auto [coldest, hottest] = std::minmax_element(measured.begin(), measured.end());
+                largestSpread = std::max(largestSpread, *hottest - *coldest);
+            }
+            return largestSpread;
+        }
+    }
+
+    TEST_CASE("ZoneEngine: Configure - zone count")
+    {
+        ZoneEngine engine;
+        REQUIRE(engine.ZoneCount() == 1);
+        REQUIRE(engine.Configure({3, 0.0f}, {}));
+        REQUIRE(engine.ZoneCount() == 3);
+        REQUIRE_FALSE(engine.Configure({0, 0.0f}, {}));
+        REQUIRE_FALSE(engine.Configure({MAX_ZONES + 1, 0.0f}, {}));
+        REQUIRE(engine.ZoneCount() == 3);
+    }
+
+    TEST_CASE("ZoneEngine: Update - each zone matches a single Pid")
+    {
+        PidConfig config;
+        config.kp = 2.0f;
+        config.ki = 0.5f;
+        config.kd = 10.0f;
+        config.sampleTime = 2s;
+
+        constexpr size_t ZONES = 5;
+        ZoneEngine engine({ZONES, 0.0f}, config);
+        engine.SetGains(3, 4.0f, 0.25f, 5.0f);
+        engine.SetOffset(4, 5.0f);
+        std::vector<FloatPid> pids(ZONES, FloatPid(config));
+        pids[3].SetGains(4.0f, 0.25f, 5.0f);
+
+        std::array<float, ZONES> measured{};
+        for (int step = 0; step < 200; ++step)
+        {
+            for (size_t i = 0; i < ZONES; ++i)
+            {
+                measured[i] = 100.0f + static_cast<float>((step * 7 + static_cast<int>(i) * 13) % 40);
+            }
+            const std::span<const float> heat = engine.Update(120.0f, measured);
+            REQUIRE(heat.size() == ZONES);
+            for (size_t i = 0; i < ZONES; ++i)
+            {
+                const float expected = pids[i].Update(i == 4 ? 125.0f : 120.0f, measured[i]);
+                REQUIRE(heat[i] == Catch::Approx(expected).margin(1e-4));
+                REQUIRE(engine.Integrals()[i] == Catch::Approx(pids[i].Integral()).margin(1e-4));
+            }
+        }
+
+        engine.Reset();
+        REQUIRE(engine.Integrals()[0] == 0.0f);
+        REQUIRE(engine.Outputs()[2] == 0.0f);
+    }
+
+    TEST_CASE("ZoneEngine: SetGains - no bump in a zone's output")
+    {
+        ZoneEngine engine({2, 0.0f}, {});
+        const std::array<float, 2> measured{490.0f, 490.0f};
+        for (int i = 0; i < 20; ++i)
+        {
+            engine.Update(500.0f, measured);
+        }
+        const std::array<float, 2> onSetpoint{500.0f, 500.0f};
+        engine.Update(500.0f, onSetpoint);
+        const float before = engine.Update(500.0f, onSetpoint)[1];
+
+        engine.SetGains(1, 5.0f, 0.05f, 1.0f);
+        REQUIRE(engine.Update(500.0f, onSetpoint)[1] == Catch::Approx(before));
+    }
+
+    TEST_CASE("ZoneEngine: the spread limit holds fast zones back for the slow one")
+    {
+        PidConfig config;
+        config.kp = 5.0f;
+        config.ki = 0.02f;
+        config.kd = 0.0f;
+        config.integralMax = config.outputMax / config.ki;
+
+        ZoneEngine free({3, 0.0f}, config);
+        auto freeZones = MakeZones();
+        const float freeSpread = RunRamp(free, freeZones, config);
+
+        ZoneEngine coupled({3, 5.0f}, config);
+        auto coupledZones = MakeZones();
+        const float coupledSpread = RunRamp(coupled, coupledZones, config);
+
+        INFO("free " << freeSpread << " °C, coupled " << coupledSpread << " °C");
+        REQUIRE(freeSpread > 15.0f);
+        REQUIRE(coupledSpread < 6.0f);
+
+        // Both still get there
+        for (const Sim::ThermalModel& zone : coupledZones)
+        {
+            REQUIRE(std::abs(zone.SensorTemperature() - 800.0f) < 1.0f);
+        }
+        REQUIRE(coupled.Setpoints()[0] == Catch::Approx(800.0f));
+    }
+
+    TEST_CASE("ZoneEngine: benchmark", "[.][benchmark]")
+    {
+        for (size_t zones : {1u, 4u, 16u, 64u})
+        {
+            ZoneEngine engine({zones, 5.0f}, {});
+            std::vector<FloatPid> pids(zones);
+            std::vector<float> measured(zones);
+            for (size_t i = 0; i < zones; ++i)
+            {
+                measured[i] = 500.0f + static_cast<float>(i % 7);
+            }
+
+            float setpoint = 500.0f;
+            BENCHMARK("ZoneEngine::Update, " + std::to_string(zones) + " zones")
+            {
+                setpoint += 0.01f;
+                return engine.Update(setpoint, measured)[zones - 1];
+            };
+            BENCHMARK("FloatPid per zone, " + std::to_string(zones) + " zones")
+            {
+                setpoint += 0.01f;
+                float last = 0.0f;
+                for (size_t i = 0; i < zones; ++i)
+                {
+                    last = pids[i].Update(setpoint, measured[i]);
+                }
+                return last;
+            };
+        }
+    }
+} //namespace HeatTreatFurnace::Test
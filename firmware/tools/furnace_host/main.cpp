@@ -0,0 +1,554 @@
+// Runs the controller on the host against the simulated kiln, speaking the real FlatBuffers protocol, so the
+// frontend and the bdd/ scenarios can be run against the production state machine, safety monitor and program
+// store instead of simulator/'s TypeScript stand-in.
+//
+//   furnace_host --www frontend/dist --import frontend/programs --time-scale 10
+//
+// then open http://localhost:3000. The frontend is served from --www as the ESP32 serves it from SPIFFS, and the
+// protocol is on ws://localhost:3000/ws. State is broadcast to every client on connect, on every change of state,
+// after every command and each --broadcast-ms (SPECIFICATION.md §9.1). The simulated clock runs --time-scale
+// times faster than the wall clock, and SetTimeScaleCommand changes it, between 1 and 100 (§5.1).
+//
+//   furnace_host --soak 200 --soak-seconds 30 --broadcast-ms 50
+//
+// measures the broadcast path instead: that many clients connect from threads of this process, each counting the
+// State broadcasts it is sent and timing a ListProgramsRequest every --soak-request-ms, and the summary gives the
+// frames and bytes per second delivered, the broadcasts dropped for clients that fell behind, and the round trip
+// percentiles.
+//
+// Build on the host with: cmake -S firmware/tools -B build/tools && cmake --build build/tools, which builds build/tools/furnace_host/furnace_host
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "Furnace/Preferences.hpp"
+#include "Log/ConsoleLogBackend.hpp"
+#include "Log/LogService.hpp"
+#include "Net/FurnaceService.hpp"
+#include "Net/WebSocket.hpp"
+#include "Program/ProgramStore.hpp"
+#include "Sim/FurnaceSimulator.hpp"
+#include "Sim/ThermalModel.hpp"
+
+namespace HeatTreatFurnace
+{
+    namespace
+    {
+        constexpr std::string_view USAGE = R"(usage: furnace_host [options]
+
+Server
+  --port N                (default 3000, as simulator/)
+  --address IPV4          (default 127.0.0.1)
+  --www DIR               the built frontend to serve (default: none, the protocol only)
+  --store DIR             where programs are kept (default: furnace_host under the temp directory)
+  --import DIR            save every .json program in DIR to the store first, e.g. frontend/programs
+  --time-scale X          simulated seconds per wall second, 1 to 100 (default 1)
+  --broadcast-ms MS       State broadcast period (default 1000)
+
+Kiln, which the controller is also set up for (default: SPECIFICATION.md §4)
+  --kiln-power W  --kiln-mass J/°C  --kiln-loss W/°C  --ambient °C
+
+Controller
+  --kp K  --ki K  --kd K  PID_Kp/Ki/Kd (default: the preference defaults)
+  --window-ms MS          PID_Window (default 1000)
+
+Soak
+  --soak N                connect N clients from this process and report on the broadcasts they get
+  --soak-seconds S        (default 10)
+  --soak-request-ms MS    each client's request period, for the round trip (default 250)
+)";
+
+        constexpr float MIN_TIME_SCALE = 1.0f;
+        constexpr float MAX_TIME_SCALE = 100.0f;
+        constexpr std::chrono::milliseconds POLL_PERIOD{10};
+
+        std::atomic<bool> stopping{false};
+
+        void OnSignal(int)
+        {
+            stopping = true;
+        }
+
+        bool ParseFloat(std::string_view aText, float& aOut)
+        {
+            const auto [end, error] = std::from_chars(aText.data(), aText.data() + aText.size(), aOut);
+            return error == std::errc() && end == aText.data() + aText.size();
+        }
+
+        template <typename T>
+        bool ParseCount(std::string_view aText, T& aOut)
+        {
+            const auto [end, error] = std::from_chars(aText.data(), aText.data() + aText.size(), aOut);
+            return error == std::errc() && end == aText.data() + aText.size();
+        }
+
+        std::string_view Text(const Furnace::Result& aResult)
+        {
+            return {aResult.message.data(), aResult.message.size()};
+        }
+
+        int Fail(std::string_view aMessage)
+        {
+            std::cerr << "furnace_host: " << aMessage << "\n";
+            return 1;
+        }
+
+        /** @brief Every .json program in aDirectory into aStore, by file name */
+        void Import(const std::filesystem::path& aDirectory, Program::ProgramStore& aStore)
+        {
+            std::error_code error;
+            for (const auto& entry : std::filesystem::directory_iterator(aDirectory, error))
+            {
+                if (!entry.is_regular_file() || entry.path().extension() != ".json")
+                {
+                    continue;
+                }
+                std::ifstream file(entry.path());
+                std::stringstream json;
+                json << file.rdbuf();
+                const std::string name = entry.path().filename().string();
+                const Furnace::Result res = aStore.Save(name, json.str());
+                if (!res)
+                {
+                    std::cerr << std::format("furnace_host: not importing {}: {}\n", name, Text(res));
+                }
+            }
+            if (error)
+            {
+                std::cerr << std::format("furnace_host: can't read {}: {}\n", aDirectory.string(), error.message());
+            }
+        }
+
+        /** @brief One soak client's counts */
+        struct SoakCounts
+        {
+            bool connected = false;
+            uint64_t broadcasts = 0;
+            uint64_t bytes = 0; // on the wire
+            std::vector<double> roundTripsMs;
+        };
+
+        /** @brief Connect to the server as the frontend does, and count what it sends until stopped */
+        void SoakClient(uint16_t aPort, std::chrono::milliseconds aRequestPeriod, const std::atomic<bool>& aStop, SoakCounts& aCounts)
+        {
+            using Clock = std::chrono::steady_clock;
+            const int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(aPort);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            const timeval timeout{0, 20'000};
+            const int on = 1;
+            setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            if (connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+            {
+                ::close(socket);
+                return;
+            }
+
+            constexpr std::string_view HANDSHAKE = "GET /ws HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+            send(socket, HANDSHAKE.data(), HANDSHAKE.size(), MSG_NOSIGNAL);
+
+            std::vector<uint8_t> inbox;
+            std::array<uint8_t, 16 * 1024> buffer{};
+            bool open = false;
+            flatbuffers::FlatBufferBuilder builder;
+            std::vector<uint8_t> frame;
+            uint32_t requestId = 0;
+            Clock::time_point requested{};
+            bool waiting = false;
+            Clock::time_point nextRequest = Clock::now() + aRequestPeriod;
+
+            while (!aStop)
+            {
+                if (open && !waiting && Clock::now() >= nextRequest)
+                {
+                    builder.Clear();
+                    builder.Finish(::Furnace::CreateClientEnvelope(builder, ++requestId, ::Furnace::ClientMessage::ListProgramsRequest,
+                        ::Furnace::CreateListProgramsRequest(builder).Union()));
+                    frame.clear();
+                    Net::WebSocketCodec::AppendFrame(frame, Net::Opcode::BINARY, {builder.GetBufferPointer(), builder.GetSize()}, requestId * 2654435761u);
+                    send(socket, frame.data(), frame.size(), MSG_NOSIGNAL);
+                    requested = Clock::now();
+                    waiting = true;
+                    nextRequest = requested + aRequestPeriod;
+                }
+
+                const ssize_t count = recv(socket, buffer.data(), buffer.size(), 0);
+                if (count == 0)
+                {
+                    break;
+                }
+                if (count < 0)
+                {
+                    continue;
+                }
+                inbox.insert(inbox.end(), buffer.begin(), buffer.begin() + count);
+
+                size_t offset = 0;
+                if (!open)
+                {
+                    const std::string_view received(reinterpret_cast<const char*>(inbox.data()), inbox.size());
+                    const size_t end = received.find("\r\n\r\n");
+                    if (end == std::string_view::npos)
+                    {
+                        continue;
+                    }
+                    if (!received.starts_with("HTTP/1.1 101"))
+                    {
+                        break;
+                    }
+                    open = true;
+                    aCounts.connected = true;
+                    offset = end + 4;
+                }
+
+                Net::Frame message;
+                size_t consumed = 0;
+                while (Net::WebSocketCodec::ParseFrame(std::span(inbox).subspan(offset), Net::WebSocketServer::MAX_MESSAGE, message, consumed) ==
+                    Net::FrameStatus::FRAME)
+                {
+                    offset += consumed;
+                    aCounts.bytes += consumed;
+                    if (message.opcode != Net::Opcode::BINARY)
+                    {
+                        continue;
+                    }
+                    const uint32_t id = ::Furnace::GetServerEnvelope(message.payload.data())->request_id();
+                    if (id == 0)
+                    {
+                        ++aCounts.broadcasts;
+                    }
+                    else if (waiting && id == requestId)
+                    {
+                        aCounts.roundTripsMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - requested).count());
+                        waiting = false;
+                    }
+                }
+                inbox.erase(inbox.begin(), inbox.begin() + static_cast<ptrdiff_t>(offset));
+            }
+            ::close(socket);
+        }
+
+        double Percentile(std::vector<double>& aValues, double aShare)
+        {
+            if (aValues.empty())
+            {
+                return 0.0;
+            }
+            const size_t at = std::min(aValues.size() - 1, static_cast<size_t>(aShare * static_cast<double>(aValues.size())));
+            std::ranges::nth_element(aValues, aValues.begin() + static_cast<ptrdiff_t>(at));
+            return aValues[at];
+        }
+    }
+
+    /** @brief The whole tool; returns the exit code */
+    int FurnaceHost(int argc, char** argv)
+    {
+        uint16_t port = 3000;
+        std::string address = "127.0.0.1";
+        std::string www;
+        std::string store = (std::filesystem::temp_directory_path() / "furnace_host").string();
+        std::string import;
+        float timeScale = 1.0f;
+        uint32_t broadcastMs = 1000;
+        size_t soakClients = 0;
+        uint32_t soakSeconds = 10;
+        uint32_t soakRequestMs = 250;
+        Sim::ThermalParameters kiln;
+        Furnace::Preferences preferences;
+        preferences.pidWindowMs = 1000;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view option = argv[i];
+            if (option == "--help" || option == "-h")
+            {
+                std::cout << USAGE;
+                return 0;
+            }
+            if (i + 1 >= argc)
+            {
+                return Fail(std::format("{} needs a value", option));
+            }
+            const std::string_view value = argv[++i];
+
+            float* number = nullptr;
+            uint32_t* count = nullptr;
+            if (option == "--address")
+            {
+                address = value;
+            }
+            else if (option == "--www")
+            {
+                www = value;
+            }
+            else if (option == "--store")
+            {
+                store = value;
+            }
+            else if (option == "--import")
+            {
+                import = value;
+            }
+            else if (option == "--port")
+            {
+                if (!ParseCount(value, port))
+                {
+                    return Fail("--port takes a port number");
+                }
+            }
+            else if (option == "--soak")
+            {
+                if (!ParseCount(value, soakClients))
+                {
+                    return Fail("--soak takes a count");
+                }
+            }
+            else if (option == "--time-scale")
+            {
+                number = &timeScale;
+            }
+            else if (option == "--kiln-power")
+            {
+                number = &kiln.heaterPowerW;
+            }
+            else if (option == "--kiln-mass")
+            {
+                number = &kiln.thermalMassJPerC;
+            }
+            else if (option == "--kiln-loss")
+            {
+                number = &kiln.lossWPerC;
+            }
+            else if (option == "--ambient")
+            {
+                number = &kiln.ambientTemperature;
+            }
+            else if (option == "--kp")
+            {
+                number = &preferences.pidKp;
+            }
+            else if (option == "--ki")
+            {
+                number = &preferences.pidKi;
+            }
+            else if (option == "--kd")
+            {
+                number = &preferences.pidKd;
+            }
+            else if (option == "--broadcast-ms")
+            {
+                count = &broadcastMs;
+            }
+            else if (option == "--window-ms")
+            {
+                count = &preferences.pidWindowMs;
+            }
+            else if (option == "--soak-seconds")
+            {
+                count = &soakSeconds;
+            }
+            else if (option == "--soak-request-ms")
+            {
+                count = &soakRequestMs;
+            }
+            else
+            {
+                return Fail(std::format("unknown option {}, see --help", option));
+            }
+
+            if (number != nullptr && !ParseFloat(value, *number))
+            {
+                return Fail(std::format("{} takes a number", option));
+            }
+            if (count != nullptr && (!ParseCount(value, *count) || *count == 0))
+            {
+                return Fail(std::format("{} takes a positive whole number", option));
+            }
+        }
+        if (timeScale < MIN_TIME_SCALE || timeScale > MAX_TIME_SCALE)
+        {
+            return Fail("--time-scale is 1 to 100");
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(store, error);
+        if (error)
+        {
+            return Fail(std::format("can't create {}: {}", store, error.message()));
+        }
+
+        preferences.heaterPowerW = kiln.heaterPowerW;
+        preferences.thermalMassJPerC = kiln.thermalMassJPerC;
+        preferences.lossWPerC = kiln.lossWPerC;
+        preferences.ambientTemperature = kiln.ambientTemperature;
+
+        // A soak's thousands of connections aren't worth a line each
+        Log::ConsoleLogBackend logBackend(soakClients > 0 ? Log::LogLevel::Warn : Log::LogLevel::Info);
+        Log::LogService log(&logBackend);
+        Sim::FurnaceSimulator simulator(preferences, kiln, log);
+        Program::ProgramStore programs(store, log);
+        programs.SetPreferences(preferences);
+        if (!import.empty())
+        {
+            Import(import, programs);
+        }
+
+        Net::FurnaceService service(simulator.GetStateMachine(), programs, simulator.GetPublisher(), simulator.GetSafetyMonitor(), log);
+        service.SetPreferences(preferences);
+        service.SetEpoch(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()));
+        auto setTimeScale = [&timeScale](float aTimeScale)
+        {
+            if (aTimeScale < MIN_TIME_SCALE || aTimeScale > MAX_TIME_SCALE)
+            {
+                return Furnace::Result{false, "Time scale is 1 to 100"};
+            }
+            timeScale = aTimeScale;
+            return Furnace::Result{true, ""};
+        };
+        service.SetTimeScaleHandler(Net::FurnaceService::TimeScaleHandler(setTimeScale));
+        if (timeScale != 1.0f)
+        {
+            // Through the service, so State reports it from the first broadcast
+            flatbuffers::FlatBufferBuilder request;
+            flatbuffers::FlatBufferBuilder reply;
+            request.Finish(::Furnace::CreateClientEnvelope(request, 0, ::Furnace::ClientMessage::SetTimeScaleCommand,
+                ::Furnace::CreateSetTimeScaleCommand(request, timeScale).Union()));
+            service.Handle({request.GetBufferPointer(), request.GetSize()}, reply);
+        }
+
+        Net::WebSocketServer server(log);
+        Furnace::Result res = server.Listen(soakClients > 0 ? 0 : port, address);
+        if (!res)
+        {
+            return Fail(Text(res));
+        }
+        server.SetStaticRoot(www);
+
+        flatbuffers::FlatBufferBuilder builder;
+        bool broadcastDue = false;
+        server.SetConnectHandler([&](Net::WebSocketServer::ClientId aClient)
+        {
+            service.EncodeState(builder);
+            server.Send(aClient, {builder.GetBufferPointer(), builder.GetSize()});
+        });
+        server.SetMessageHandler([&](Net::WebSocketServer::ClientId aClient, std::span<const uint8_t> aMessage)
+        {
+            service.Handle(aMessage, builder);
+            server.Send(aClient, {builder.GetBufferPointer(), builder.GetSize()});
+            broadcastDue = true;
+        });
+
+        std::signal(SIGINT, OnSignal);
+        std::signal(SIGTERM, OnSignal);
+
+        std::atomic<bool> soakStop{false};
+        std::vector<SoakCounts> soakCounts(soakClients);
+        std::vector<std::thread> soakThreads;
+        soakThreads.reserve(soakClients);
+        for (size_t i = 0; i < soakClients; ++i)
+        {
+            soakThreads.emplace_back(SoakClient, server.Port(), std::chrono::milliseconds(soakRequestMs), std::cref(soakStop), std::ref(soakCounts[i]));
+        }
+        if (soakClients == 0)
+        {
+            std::cout << std::format("Serving http://{}:{} at {}x, Ctrl-C to stop\n", address, server.Port(), timeScale);
+        }
+
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point started = Clock::now();
+        const Clock::time_point soakEnd = started + std::chrono::seconds(soakSeconds);
+        Clock::time_point last = started;
+        Clock::time_point lastBroadcast = started;
+        double owedUs = 0.0; // simulated time not yet run, under a microsecond
+        uint64_t broadcasts = 0;
+        Furnace::StateId state = simulator.GetStateMachine().GetState();
+
+        while (!stopping && (soakClients == 0 || Clock::now() < soakEnd))
+        {
+            server.Poll(POLL_PERIOD);
+
+            const Clock::time_point now = Clock::now();
+            owedUs += std::chrono::duration<double, std::micro>(now - last).count() * timeScale;
+            last = now;
+            const std::chrono::microseconds step(static_cast<int64_t>(owedUs));
+            owedUs -= static_cast<double>(step.count());
+            simulator.RunFor(step);
+
+            const Furnace::StateId current = simulator.GetStateMachine().GetState();
+            if (broadcastDue || current != state || now - lastBroadcast >= std::chrono::milliseconds(broadcastMs))
+            {
+                service.EncodeState(builder);
+                server.Broadcast({builder.GetBufferPointer(), builder.GetSize()});
+                ++broadcasts;
+                lastBroadcast = now;
+                broadcastDue = false;
+                state = current;
+            }
+        }
+        if (soakClients == 0)
+        {
+            std::cout << "Stopped\n";
+            return 0;
+        }
+
+        // Drain what is still queued, so the clients' counts match what the server sent
+        const size_t connected = server.ClientCount();
+        for (int i = 0; i < 20; ++i)
+        {
+            server.Poll(POLL_PERIOD);
+        }
+        soakStop = true;
+        for (std::thread& thread : soakThreads)
+        {
+            thread.join();
+        }
+
+        const double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+        uint64_t received = 0;
+        uint64_t bytes = 0;
+        size_t opened = 0;
+        std::vector<double> roundTrips;
+        for (SoakCounts& counts : soakCounts)
+        {
+            opened += counts.connected ? 1 : 0;
+            received += counts.broadcasts;
+            bytes += counts.bytes;
+            roundTrips.insert(roundTrips.end(), counts.roundTripsMs.begin(), counts.roundTripsMs.end());
+        }
+        const Net::WebSocketServer::Stats& stats = server.GetStats();
+        std::cout << std::format("{} of {} clients connected, {} still open at the end\n", opened, soakClients, connected);
+        std::cout << std::format("{} broadcasts every {} ms: {} State frames delivered, {} dropped for clients behind by over {} KiB\n",
+            broadcasts, broadcastMs, received, stats.broadcastsDropped, Net::WebSocketServer::MAX_BACKLOG / 1024);
+        std::cout << std::format("{:.0f} frames/s, {:.2f} MB/s to the clients ({:.2f} MB/s sent by the server)\n",
+            static_cast<double>(received) / seconds, static_cast<double>(bytes) / seconds / 1e6, static_cast<double>(stats.bytesSent) / seconds / 1e6);
+        std::cout << std::format("{} requests: round trip p50 {:.2f} ms, p99 {:.2f} ms\n", roundTrips.size(), Percentile(roundTrips, 0.5),
+            Percentile(roundTrips, 0.99));
+        return 0;
+    }
+} //namespace HeatTreatFurnace
+
+int main(int argc, char** argv)
+{
+    return HeatTreatFurnace::FurnaceHost(argc, argv);
+}
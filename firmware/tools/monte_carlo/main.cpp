@@ -0,0 +1,333 @@
+// Fires a program on many randomly varied simulated kilns, to see how it holds up before it goes on the real one.
+//
+//   monte_carlo --program alloy.json --runs 2000 --load 0:15000 --element-aging 0:0.15
+//               --ambient-shift 0~5 --sensor-noise 0:0.75 --csv runs.csv
+//
+// Each run samples a plant: extra thermal mass for the load, elements down on power, a warmer or
+// colder room, and thermocouple noise, each as a fixed value "v", a uniform range "lo:hi" or a
+// normal "mean~sd". The controller keeps the nominal kiln and gains throughout. Every run is written
+// to the CSV as it finishes; the summary gives percentile bands of the tracking error per segment.
+// Run n's plant depends only on --seed and n.
+//
+// Build on the host with: cmake -S firmware/tools -B build/tools && cmake --build build/tools, which builds build/tools/monte_carlo/monte_carlo
+
+#include <charconv>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Furnace/Preferences.hpp"
+#include "Program/ProgramJson.hpp"
+#include "Sim/MonteCarlo.hpp"
+#include "Sim/ThermalModel.hpp"
+#include "Sim/WorkStealingPool.hpp"
+
+namespace HeatTreatFurnace
+{
+    namespace
+    {
+        constexpr std::string_view USAGE = R"(usage: monte_carlo --program FILE [options]
+
+Plant spread, each a value "v", a uniform range "lo:hi" or a normal "mean~sd" (default: none)
+  --load J/°C             thermal mass of the ware and furniture, on top of --kiln-mass
+  --element-aging SHARE   rated power the elements have lost, 0.1 = 10 %
+  --ambient-shift °C      room temperature away from --ambient
+  --sensor-noise °C       standard deviation of each thermocouple reading
+
+Nominal kiln, which the controller is set up for (default: SPECIFICATION.md §4)
+  --kiln-power W  --kiln-mass J/°C  --kiln-loss W/°C  --ambient °C
+  --element-lag s  --sensor-lag s  --element-coefficient 1/°C  --supply-voltage FRACTION
+
+Controller
+  --kp K  --ki K  --kd K  PID_Kp/Ki/Kd (default: the preference defaults)
+  --window-ms MS          PID_Window (default 1000)
+
+Runs
+  --runs N                firings (default 1000)
+  --seed N                (default 1)
+  --threads N             workers (default one per hardware thread)
+  --csv FILE              write every run to FILE as it finishes, "-" for stdout
+)";
+
+        bool ParseFloat(std::string_view aText, float& aOut)
+        {
+            const auto [end, error] = std::from_chars(aText.data(), aText.data() + aText.size(), aOut);
+            return error == std::errc() && end == aText.data() + aText.size();
+        }
+
+        template <typename T>
+        bool ParseCount(std::string_view aText, T& aOut)
+        {
+            const auto [end, error] = std::from_chars(aText.data(), aText.data() + aText.size(), aOut);
+            return error == std::errc() && end == aText.data() + aText.size();
+        }
+
+        /** @brief "v", "lo:hi" or "mean~sd" */
+        bool ParseDistribution(std::string_view aText, Sim::Distribution& aOut)
+        {
+            float first = 0.0f;
+            float second = 0.0f;
+            for (const char separator : {':', '~'})
+            {
+                const size_t at = aText.find(separator);
+                if (at == std::string_view::npos)
+                {
+                    continue;
+                }
+                if (!ParseFloat(aText.substr(0, at), first) || !ParseFloat(aText.substr(at + 1), second))
+                {
+                    return false;
+                }
+                aOut = separator == ':' ? Sim::Distribution::Uniform(first, second) : Sim::Distribution::Normal(first, second);
+                return true;
+            }
+            if (!ParseFloat(aText, first))
+            {
+                return false;
+            }
+            aOut = Sim::Distribution::Fixed(first);
+            return true;
+        }
+
+        std::string BandText(const Sim::ErrorBand& aBand)
+        {
+            return std::format("{:>7.2f} {:>7.2f} {:>7.2f} {:>7.2f}", aBand.p5, aBand.p50, aBand.p95, aBand.max);
+        }
+
+        int Fail(std::string_view aMessage)
+        {
+            std::cerr << "monte_carlo: " << aMessage << "\n";
+            return 1;
+        }
+    }
+
+    /** @brief The whole tool; returns the exit code */
+    int MonteCarlo(int argc, char** argv)
+    {
+        std::string programPath;
+        std::string csvPath;
+        Sim::PlantVariation variation;
+        Sim::ThermalParameters kiln;
+        Furnace::Preferences preferences;
+        preferences.pidWindowMs = 1000;
+        size_t runs = 1000;
+        uint32_t seed = 1;
+        size_t threads = 0;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view option = argv[i];
+            if (option == "--help" || option == "-h")
+            {
+                std::cout << USAGE;
+                return 0;
+            }
+            if (i + 1 >= argc)
+            {
+                return Fail(std::format("{} needs a value", option));
+            }
+            const std::string_view value = argv[++i];
+
+            float* number = nullptr;
+            Sim::Distribution* distribution = nullptr;
+            if (option == "--program")
+            {
+                programPath = value;
+            }
+            else if (option == "--csv")
+            {
+                csvPath = value;
+            }
+            else if (option == "--load")
+            {
+                distribution = &variation.loadJPerC;
+            }
+            else if (option == "--element-aging")
+            {
+                distribution = &variation.elementAging;
+            }
+            else if (option == "--ambient-shift")
+            {
+                distribution = &variation.ambientShift;
+            }
+            else if (option == "--sensor-noise")
+            {
+                distribution = &variation.sensorNoise;
+            }
+            else if (option == "--kiln-power")
+            {
+                number = &kiln.heaterPowerW;
+            }
+            else if (option == "--kiln-mass")
+            {
+                number = &kiln.thermalMassJPerC;
+            }
+            else if (option == "--kiln-loss")
+            {
+                number = &kiln.lossWPerC;
+            }
+            else if (option == "--ambient")
+            {
+                number = &kiln.ambientTemperature;
+            }
+            else if (option == "--element-lag")
+            {
+                number = &kiln.elementLagS;
+            }
+            else if (option == "--sensor-lag")
+            {
+                number = &kiln.sensorLagS;
+            }
+            else if (option == "--element-coefficient")
+            {
+                number = &kiln.elementResistanceCoefficient;
+            }
+            else if (option == "--supply-voltage")
+            {
+                number = &kiln.supplyVoltage;
+            }
+            else if (option == "--kp")
+            {
+                number = &preferences.pidKp;
+            }
+            else if (option == "--ki")
+            {
+                number = &preferences.pidKi;
+            }
+            else if (option == "--kd")
+            {
+                number = &preferences.pidKd;
+            }
+            else if (option == "--runs" || option == "--threads")
+            {
+                if (!ParseCount(value, option == "--runs" ? runs : threads))
+                {
+                    return Fail(std::format("{} takes a count", option));
+                }
+            }
+            else if (option == "--seed")
+            {
+                if (!ParseCount(value, seed))
+                {
+                    return Fail("--seed takes a number");
+                }
+            }
+            else if (option == "--window-ms")
+            {
+                float window = 0.0f;
+                if (!ParseFloat(value, window) || window < 1.0f)
+                {
+                    return Fail("--window-ms takes a positive number of milliseconds");
+                }
+                preferences.pidWindowMs = static_cast<uint32_t>(window);
+            }
+            else
+            {
+                return Fail(std::format("unknown option {}, see --help", option));
+            }
+
+            if (number != nullptr && !ParseFloat(value, *number))
+            {
+                return Fail(std::format("{} takes a number", option));
+            }
+            if (distribution != nullptr && !ParseDistribution(value, *distribution))
+            {
+                return Fail(std::format("{} takes a value \"v\", a range \"lo:hi\" or a normal \"mean~sd\"", option));
+            }
+        }
+
+        if (programPath.empty())
+        {
+            std::cerr << USAGE;
+            return 1;
+        }
+        std::ifstream file(programPath);
+        if (!file)
+        {
+            return Fail(std::format("can't open {}", programPath));
+        }
+        std::stringstream json;
+        json << file.rdbuf();
+        std::vector<uint8_t> program;
+        Furnace::Result res = Program::ProgramJson::Import(json.str(), program);
+        if (!res)
+        {
+            return Fail(std::format("{}: {}", programPath, std::string_view(res.message.data(), res.message.size())));
+        }
+
+        std::ofstream csvFile;
+        std::ostream* csv = nullptr;
+        if (csvPath == "-")
+        {
+            csv = &std::cout;
+        }
+        else if (!csvPath.empty())
+        {
+            csvFile.open(csvPath);
+            if (!csvFile)
+            {
+                return Fail(std::format("can't write {}", csvPath));
+            }
+            csv = &csvFile;
+        }
+
+        preferences.heaterPowerW = kiln.heaterPowerW;
+        preferences.thermalMassJPerC = kiln.thermalMassJPerC;
+        preferences.lossWPerC = kiln.lossWPerC;
+        preferences.ambientTemperature = kiln.ambientTemperature;
+
+        const Sim::MonteCarloRunner runner(preferences, kiln, variation, seed);
+        Sim::WorkStealingPool pool(threads);
+        // The summary goes to stderr when the runs are going to stdout
+        std::ostream& out = csv == &std::cout ? std::cerr : std::cout;
+        out << std::format("Firing {} runs on {} workers\n", runs, pool.WorkerCount());
+
+        bool headed = false;
+        Sim::MonteCarloReport report;
+        res = runner.Run(program, runs, pool, [&](const Sim::MonteCarloRun& aRun)
+        {
+            if (csv == nullptr)
+            {
+                return;
+            }
+            if (!headed)
+            {
+                *csv << Sim::MonteCarloRunner::CsvHeader(aRun.stats.segments.size());
+                headed = true;
+            }
+            *csv << Sim::MonteCarloRunner::CsvRow(aRun);
+        }, report);
+        if (!res)
+        {
+            return Fail(std::string_view(res.message.data(), res.message.size()));
+        }
+        if (csv != nullptr)
+        {
+            csv->flush();
+        }
+
+        out << std::format("\n{} completed, {} in error, {} overran\n\n", report.completed, report.errors,
+            report.runs - report.completed - report.errors);
+        out << std::format("{:>7}  {:^31}  {:^31}\n", "", "mean |error| °C", "worst |error| °C");
+        out << std::format("{:>7}  {:>7} {:>7} {:>7} {:>7}  {:>7} {:>7} {:>7} {:>7}\n",
+            "segment", "p5", "p50", "p95", "max", "p5", "p50", "p95", "max");
+        for (size_t segment = 0; segment < report.segments.size(); ++segment)
+        {
+            out << std::format("{:>7}  {}  {}\n", segment + 1, BandText(report.segments[segment].meanError), BandText(report.segments[segment].maxError));
+        }
+
+        const double perSecond = report.wallSeconds > 0.0 ? report.simulatedHours / report.wallSeconds : 0.0;
+        out << std::format("\n{:.1f} simulated firing-hours in {:.2f} s: {:.1f} firing-hours per second\n",
+            report.simulatedHours, report.wallSeconds, perSecond);
+        return 0;
+    }
+} //namespace HeatTreatFurnace
+
+int main(int argc, char** argv)
+{
+    return HeatTreatFurnace::MonteCarlo(argc, argv);
+}
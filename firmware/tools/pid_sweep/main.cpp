@@ -0,0 +1,339 @@
+// Searches PID gains for a kiln by firing a program on the simulated kiln once per candidate.
+//
+//   pid_sweep --program firing.json --kp 1:8:1 --ki 0.005,0.01,0.02 --kd 0
+//             --kiln-power 3000 --kiln-mass 40000 --kiln-loss 1.5 --element-coefficient 4e-5
+//
+// Gains are comma separated lists or lo:hi:step ranges and every combination is fired. Each
+// --schedule adds a PID_Schedule candidate, with the first --kp/--ki/--kd as its defaults. The kiln
+// options are the model to tune against, normally the one the thermal estimator identified; they
+// also set Kiln_Heater_Power and the rest, so feedforward and the program checks see the same kiln.
+//
+// Build on the host with: cmake -S firmware/tools -B build/tools && cmake --build build/tools, which builds build/tools/pid_sweep/pid_sweep
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Control/GainSchedule.hpp"
+#include "Furnace/Preferences.hpp"
+#include "Program/ProgramJson.hpp"
+#include "Sim/PidSweep.hpp"
+#include "Sim/ThermalModel.hpp"
+#include "Sim/WorkStealingPool.hpp"
+
+namespace HeatTreatFurnace
+{
+    namespace
+    {
+        constexpr std::string_view USAGE = R"(usage: pid_sweep --program FILE [options]
+
+Gains, each a list "1,2,4" or a range "lo:hi:step" (default: the PID_Kp/Ki/Kd defaults)
+  --kp LIST  --ki LIST  --kd LIST
+  --schedule TEXT         PID_Schedule candidate, "°C:Kp:Ki:Kd, ..."; repeatable
+
+Kiln model (default: SPECIFICATION.md §4)
+  --kiln-power W  --kiln-mass J/°C  --kiln-loss W/°C  --ambient °C
+  --element-lag s  --sensor-lag s  --element-coefficient 1/°C  --supply-voltage FRACTION
+
+Controller
+  --window-ms MS          PID_Window (default 1000)
+
+Scoring, lower is better (default 1, 2, 0.05, 0.0001)
+  --weight-overshoot PER_°C  --weight-tracking PER_°C  --weight-energy PER_KWH  --weight-switches PER_SWITCH
+
+Output
+  --threads N             workers (default one per hardware thread)
+  --top N                 rows to print (default 20)
+)";
+
+        bool ParseFloat(std::string_view aText, float& aOut)
+        {
+            const auto [end, error] = std::from_chars(aText.data(), aText.data() + aText.size(), aOut);
+            return error == std::errc() && end == aText.data() + aText.size();
+        }
+
+        bool ParseCount(std::string_view aText, size_t& aOut)
+        {
+            const auto [end, error] = std::from_chars(aText.data(), aText.data() + aText.size(), aOut);
+            return error == std::errc() && end == aText.data() + aText.size();
+        }
+
+        /** @brief "1,2,4" or "lo:hi:step" */
+        bool ParseValues(std::string_view aText, std::vector<float>& aOut)
+        {
+            aOut.clear();
+            const size_t colon = aText.find(':');
+            if (colon != std::string_view::npos)
+            {
+                const size_t second = aText.find(':', colon + 1);
+                float low = 0.0f;
+                float high = 0.0f;
+                float step = 0.0f;
+                if (second == std::string_view::npos || !ParseFloat(aText.substr(0, colon), low)
+                    || !ParseFloat(aText.substr(colon + 1, second - colon - 1), high)
+                    || !ParseFloat(aText.substr(second + 1), step) || step <= 0.0f || high < low)
+                {
+                    return false;
+                }
+                // By index, so the steps don't accumulate rounding and drop the last value
+                const int count = static_cast<int>(std::floor((high - low) / step + 1e-4f)) + 1;
+                for (int i = 0; i < count; ++i)
+                {
+                    aOut.push_back(low + step * static_cast<float>(i));
+                }
+                return true;
+            }
+
+            while (!aText.empty())
+            {
+                const size_t comma = aText.find(',');
+                float value = 0.0f;
+                if (!ParseFloat(aText.substr(0, comma), value))
+                {
+                    return false;
+                }
+                aOut.push_back(value);
+                aText = comma == std::string_view::npos ? std::string_view() : aText.substr(comma + 1);
+            }
+            return !aOut.empty();
+        }
+
+        std::string_view StateText(Furnace::StateId aState)
+        {
+            switch (aState)
+            {
+            case Furnace::StateId::COMPLETED:
+                return "completed";
+            case Furnace::StateId::ERROR:
+                return "error";
+            default:
+                return "overran";
+            }
+        }
+
+        std::string ScheduleText(const Furnace::PidSchedule& aSchedule)
+        {
+            std::string text;
+            for (const Furnace::PidBreakpoint& point : aSchedule)
+            {
+                text += std::format("{}{:g}:{:g}:{:g}:{:g}", text.empty() ? "" : ",", point.temperature, point.kp, point.ki, point.kd);
+            }
+            return text.empty() ? "-" : text;
+        }
+
+        int Fail(std::string_view aMessage)
+        {
+            std::cerr << "pid_sweep: " << aMessage << "\n";
+            return 1;
+        }
+    }
+
+    /** @brief The whole tool; returns the exit code */
+    int Sweep(int argc, char** argv)
+    {
+        std::string programPath;
+        std::vector<float> kp;
+        std::vector<float> ki;
+        std::vector<float> kd;
+        std::vector<std::string_view> schedules;
+        Sim::ThermalParameters kiln;
+        Furnace::Preferences preferences;
+        preferences.pidWindowMs = 1000;
+        Sim::SweepWeights weights;
+        size_t threads = 0;
+        size_t top = 20;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view option = argv[i];
+            if (option == "--help" || option == "-h")
+            {
+                std::cout << USAGE;
+                return 0;
+            }
+            if (i + 1 >= argc)
+            {
+                return Fail(std::format("{} needs a value", option));
+            }
+            const std::string_view value = argv[++i];
+
+            float* number = nullptr;
+            if (option == "--program")
+            {
+                programPath = value;
+            }
+            else if (option == "--kp" || option == "--ki" || option == "--kd")
+            {
+                std::vector<float>& values = option == "--kp" ? kp : option == "--ki" ? ki : kd;
+                if (!ParseValues(value, values))
+                {
+                    return Fail(std::format("{} takes a list \"1,2,4\" or a range \"lo:hi:step\"", option));
+                }
+            }
+            else if (option == "--schedule")
+            {
+                schedules.push_back(value);
+            }
+            else if (option == "--kiln-power")
+            {
+                number = &kiln.heaterPowerW;
+            }
+            else if (option == "--kiln-mass")
+            {
+                number = &kiln.thermalMassJPerC;
+            }
+            else if (option == "--kiln-loss")
+            {
+                number = &kiln.lossWPerC;
+            }
+            else if (option == "--ambient")
+            {
+                number = &kiln.ambientTemperature;
+            }
+            else if (option == "--element-lag")
+            {
+                number = &kiln.elementLagS;
+            }
+            else if (option == "--sensor-lag")
+            {
+                number = &kiln.sensorLagS;
+            }
+            else if (option == "--element-coefficient")
+            {
+                number = &kiln.elementResistanceCoefficient;
+            }
+            else if (option == "--supply-voltage")
+            {
+                number = &kiln.supplyVoltage;
+            }
+            else if (option == "--weight-overshoot")
+            {
+                number = &weights.overshoot;
+            }
+            else if (option == "--weight-tracking")
+            {
+                number = &weights.tracking;
+            }
+            else if (option == "--weight-energy")
+            {
+                number = &weights.energy;
+            }
+            else if (option == "--weight-switches")
+            {
+                number = &weights.switches;
+            }
+            else if (option == "--threads" || option == "--top")
+            {
+                if (!ParseCount(value, option == "--threads" ? threads : top))
+                {
+                    return Fail(std::format("{} takes a count", option));
+                }
+            }
+            else if (option == "--window-ms")
+            {
+                float window = 0.0f;
+                if (!ParseFloat(value, window) || window < 1.0f)
+                {
+                    return Fail("--window-ms takes a positive number of milliseconds");
+                }
+                preferences.pidWindowMs = static_cast<uint32_t>(window);
+            }
+            else
+            {
+                return Fail(std::format("unknown option {}, see --help", option));
+            }
+
+            if (number != nullptr && !ParseFloat(value, *number))
+            {
+                return Fail(std::format("{} takes a number", option));
+            }
+        }
+
+        if (programPath.empty())
+        {
+            std::cerr << USAGE;
+            return 1;
+        }
+        std::ifstream file(programPath);
+        if (!file)
+        {
+            return Fail(std::format("can't open {}", programPath));
+        }
+        std::stringstream json;
+        json << file.rdbuf();
+        std::vector<uint8_t> program;
+        Furnace::Result res = Program::ProgramJson::Import(json.str(), program);
+        if (!res)
+        {
+            return Fail(std::format("{}: {}", programPath, std::string_view(res.message.data(), res.message.size())));
+        }
+
+        preferences.heaterPowerW = kiln.heaterPowerW;
+        preferences.thermalMassJPerC = kiln.thermalMassJPerC;
+        preferences.lossWPerC = kiln.lossWPerC;
+        preferences.ambientTemperature = kiln.ambientTemperature;
+        if (kp.empty())
+        {
+            kp.push_back(preferences.pidKp);
+        }
+        if (ki.empty())
+        {
+            ki.push_back(preferences.pidKi);
+        }
+        if (kd.empty())
+        {
+            kd.push_back(preferences.pidKd);
+        }
+
+        Sim::PidSweep sweep(preferences, kiln, weights);
+        sweep.AddGrid(kp, ki, kd);
+        for (const std::string_view text : schedules)
+        {
+            Sim::SweepCandidate candidate{{kp.front(), ki.front(), kd.front()}, {}};
+            res = Control::GainSchedule::Parse(text, candidate.schedule);
+            if (!res)
+            {
+                return Fail(std::format("--schedule {}: {}", text, std::string_view(res.message.data(), res.message.size())));
+            }
+            sweep.Add(candidate);
+        }
+
+        Sim::WorkStealingPool pool(threads);
+        std::cout << std::format("Firing {} candidates on {} workers\n", sweep.CandidateCount(), pool.WorkerCount());
+        Sim::SweepReport report;
+        res = sweep.Run(program, pool, report);
+        if (!res)
+        {
+            return Fail(std::string_view(res.message.data(), res.message.size()));
+        }
+
+        std::cout << std::format("{:>4}  {:>8} {:>8} {:>8}  {:>8}  {:>9} {:>9} {:>9}  {:>7} {:>8}  {:<9}  {}\n",
+            "rank", "Kp", "Ki", "Kd", "score", "overshoot", "mean err", "max err", "kWh", "switches", "state", "schedule");
+        const size_t rows = std::min(report.runs.size(), top);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            const Sim::SweepRun& run = report.runs[i];
+            std::cout << std::format("{:>4}  {:>8.4g} {:>8.4g} {:>8.4g}  {:>8.3f}  {:>9.2f} {:>9.2f} {:>9.2f}  {:>7.2f} {:>8}  {:<9}  {}\n",
+                i + 1, run.candidate.gains.kp, run.candidate.gains.ki, run.candidate.gains.kd, run.score,
+                run.stats.maxOvershoot, run.stats.meanTrackingError, run.stats.maxTrackingError, run.stats.energyKWh,
+                run.stats.relaySwitches, StateText(run.state), ScheduleText(run.candidate.schedule));
+        }
+
+        std::cout << std::format("\n{} firings, {:.1f} simulated firing-hours in {:.2f} s: {:.1f} firing-hours per second ({} stolen)\n",
+            report.runs.size(), report.simulatedHours, report.wallSeconds, report.FiringHoursPerSecond(), report.steals);
+        return 0;
+    }
+} //namespace HeatTreatFurnace
+
+int main(int argc, char** argv)
+{
+    return HeatTreatFurnace::Sweep(argc, argv);
+}
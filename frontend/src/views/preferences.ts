@@ -24,9 +24,9 @@ export async function loadPreferences() {
       WiFi: ['WiFi_SSID', 'WiFi_Password', 'WiFi_Mode', 'WiFi_Retry_cnt'],
       'HTTP Server': ['Auth_Username', 'Auth_Password', 'HTTP_Local_JS'],
       Time: ['NTP_Server1', 'NTP_Server2', 'NTP_Server3', 'GMT_Offset_sec', 'Daylight_Offset_sec'],
-      PID: ['PID_Window', 'PID_Kp', 'PID_Ki', 'PID_Kd', 'PID_POE', 'PID_Temp_Threshold'],
+      PID: ['PID_Window', 'SSR_Min_On', 'SSR_Min_Off', 'PID_Kp', 'PID_Ki', 'PID_Kd', 'PID_Schedule', 'PID_POE', 'PID_Temp_Threshold'],
       Logging: ['LOG_Window', 'LOG_Files_Limit'],
-      Safety: ['MIN_Temperature', 'MAX_Temperature', 'MAX_Housing_Temperature', 'Thermal_Runaway', 'Alarm_Timeout', 'MAX31855_Error_Grace_Count'],
+      Safety: ['MIN_Temperature', 'MAX_Temperature', 'MAX_Housing_Temperature', 'Thermal_Runaway', 'Alarm_Timeout', 'MAX31855_Error_Grace_Count', 'Thermocouple_Type'],
       Debug: ['DBG_Serial', 'DBG_Syslog', 'DBG_Syslog_Srv', 'DBG_Syslog_Port'],
     };
 
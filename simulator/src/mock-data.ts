@@ -973,9 +973,12 @@ export const preferences: Record<string, string | number> = {
   Initial_Date: '2022-05-30',
   Initial_Time: '11:00:00',
   PID_Window: 5000,
+  SSR_Min_On: 1000,
+  SSR_Min_Off: 1000,
   PID_Kp: 20,
   PID_Ki: 0.2,
   PID_Kd: 0.1,
+  PID_Schedule: '',
   PID_POE: 0,
   PID_Temp_Threshold: -1,
   LOG_Window: 10,
@@ -989,7 +992,8 @@ export const preferences: Record<string, string | number> = {
   MAX_Housing_Temperature: 130,
   Thermal_Runaway: 0,
   Alarm_Timeout: 5,
-  MAX31855_Error_Grace_Count: 5
+  MAX31855_Error_Grace_Count: 5,
+  Thermocouple_Type: 'K'
 };
 
 /**
@@ -1019,6 +1023,11 @@ export const debugInfo: Record<string, string> = {
   LARGEST_HEAP: '170',
   TOTAL_KB: '1500',
   USED_KB: '450',
+  PROGRAM_CACHE_HITS: '0',
+  PROGRAM_CACHE_MISSES: '0',
+  PROGRAM_CACHE_EVICTIONS: '0',
+  PROGRAM_CACHE_ENTRIES: '0',
+  PROGRAM_CACHE_BYTES: '0',
   VERSION: 'Furnace v1.0.0 (Simulator)'
 };
 